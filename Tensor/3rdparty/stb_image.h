@@ -430,6 +430,18 @@ STBIDEF stbi_uc *stbi_load_from_file  (FILE *f, int *x, int *y, int *channels_in
 STBIDEF stbi_uc *stbi_load_gif_from_memory(stbi_uc const *buffer, int len, int **delays, int *x, int *y, int *z, int *comp, int req_comp);
 #endif
 
+#ifndef STBI_NO_JPEG
+// Decode a JPEG at 1 / (1 << scale_shift) of its size (scale_shift in [0, 3]) with a reduced
+// IDCT, the output is ceil(x / scale) by ceil(y / scale) and *x, *y report that size. When out
+// is not NULL the rows are written there, out_stride bytes apart, and out is returned instead
+// of a new allocation. Only JPEG input is accepted, vertical flipping is not applied.
+STBIDEF stbi_uc *stbi_load_jpeg_scaled_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels, int scale_shift, stbi_uc *out, int out_stride);
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_uc *stbi_load_jpeg_scaled(char const *filename, int *x, int *y, int *channels_in_file, int desired_channels, int scale_shift, stbi_uc *out, int out_stride);
+STBIDEF stbi_uc *stbi_load_jpeg_scaled_from_file(FILE *f, int *x, int *y, int *channels_in_file, int desired_channels, int scale_shift, stbi_uc *out, int out_stride);
+#endif
+#endif
+
 #ifdef STBI_WINDOWS_UTF8
 STBIDEF int stbi_convert_wchar_to_utf8(char *buffer, size_t bufferlen, const wchar_t* input);
 #endif
@@ -600,6 +612,12 @@ STBIDEF int   stbi_zlib_decode_noheader_buffer(char *obuffer, int olen, const ch
 #define STBI_ASSERT(x) assert(x)
 #endif
 
+// STBI_PARALLEL_ROWS(n, func, ctx) calls func(ctx, begin, end) on disjoint ranges covering
+// [0, n), possibly from several threads at once. The default is one call on the whole range.
+#ifndef STBI_PARALLEL_ROWS
+#define STBI_PARALLEL_ROWS(n, func, ctx) (func)((ctx), 0, (n))
+#endif
+
 #ifdef __cplusplus
 #define STBI_EXTERN extern "C"
 #else
@@ -1974,6 +1992,11 @@ typedef struct
    int scan_n, order[4];
    int restart_interval, todo;
 
+   // reduced size decoding, blocks are written as (8 >> scale_shift) squared pixels
+   int scale_shift;
+   stbi_uc *out_buffer;   // caller provided output, NULL to allocate
+   int out_stride;
+
 // kernels
    void (*idct_block_kernel)(stbi_uc *out, int out_stride, short data[64]);
    void (*YCbCr_to_RGB_kernel)(stbi_uc *out, const stbi_uc *y, const stbi_uc *pcb, const stbi_uc *pcr, int count, int step);
@@ -2489,6 +2512,67 @@ static void stbi__idct_block(stbi_uc *out, int out_stride, short data[64])
    }
 }
 
+// reduced size IDCT: for a 1 / s scale only the N = 8 / s lowest frequencies are kept and the
+// N point inverse transform is evaluated at the centers of the s x s pixel groups, which is
+//    out(x,y) = 1/4 sum_{u,v < N} C(u) C(v) F(v,u) cos((2x+1) u pi / 2N) cos((2y+1) v pi / 2N)
+// scale_shift 3 keeps the DC term only.
+static void stbi__idct_scaled(stbi_uc *out, int out_stride, short data[64], int scale_shift)
+{
+   // C(u) / 2 * cos((2x+1) u pi / 2N), [x][u]
+   static const int t4[4][4] = {
+      { stbi__f2f(0.353553391f), stbi__f2f( 0.461939766f), stbi__f2f( 0.353553391f), stbi__f2f( 0.191341716f) },
+      { stbi__f2f(0.353553391f), stbi__f2f( 0.191341716f), stbi__f2f(-0.353553391f), stbi__f2f(-0.461939766f) },
+      { stbi__f2f(0.353553391f), stbi__f2f(-0.191341716f), stbi__f2f(-0.353553391f), stbi__f2f( 0.461939766f) },
+      { stbi__f2f(0.353553391f), stbi__f2f(-0.461939766f), stbi__f2f( 0.353553391f), stbi__f2f(-0.191341716f) },
+   };
+   static const int t2[2][2] = {
+      { stbi__f2f(0.353553391f), stbi__f2f( 0.353553391f) },
+      { stbi__f2f(0.353553391f), stbi__f2f(-0.353553391f) },
+   };
+   int tmp[16];
+   int n, x, y, u, v;
+   const int *t;
+
+   if (scale_shift == 3) {
+      // DC / 8 + 128, rounded
+      out[0] = stbi__clamp(((data[0] + 4) >> 3) + 128);
+      return;
+   }
+
+   n = 8 >> scale_shift;
+   t = n == 4 ? &t4[0][0] : &t2[0][0];
+
+   // rows, 12 fractional bits are dropped so the column pass stays in 32 bits
+   for (v=0; v < n; ++v) {
+      for (x=0; x < n; ++x) {
+         int sum = 0;
+         for (u=0; u < n; ++u)
+            sum += t[x*n+u] * data[v*8+u];
+         tmp[v*n+x] = (sum + 2048) >> 12;
+      }
+   }
+   // columns, bias by 128 (<< 12) with rounding
+   for (y=0; y < n; ++y, out += out_stride) {
+      for (x=0; x < n; ++x) {
+         int sum = (128 << 12) + 2048;
+         for (v=0; v < n; ++v)
+            sum += t[y*n+v] * tmp[v*n+x];
+         out[x] = stbi__clamp(sum >> 12);
+      }
+   }
+}
+
+// idct block (bx, by) of component n into its plane
+static void stbi__jpeg_idct_block(stbi__jpeg *z, int n, int bx, int by, short data[64])
+{
+   int bs = 8 >> z->scale_shift;
+   stbi_uc *out = z->img_comp[n].data + z->img_comp[n].w2*by*bs + bx*bs;
+   if (z->scale_shift)
+      stbi__idct_scaled(out, z->img_comp[n].w2, data, z->scale_shift);
+   else
+      z->idct_block_kernel(out, z->img_comp[n].w2, data);
+}
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2930,7 +3014,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
             for (i=0; i < w; ++i) {
                int ha = z->img_comp[n].ha;
                if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+               stbi__jpeg_idct_block(z, n, i, j, data);
                // every data block is an MCU, so countdown the restart interval
                if (--z->todo <= 0) {
                   if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -2954,11 +3038,11 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
                   // by the basic H and V specified for the component
                   for (y=0; y < z->img_comp[n].v; ++y) {
                      for (x=0; x < z->img_comp[n].h; ++x) {
-                        int x2 = (i*z->img_comp[n].h + x)*8;
-                        int y2 = (j*z->img_comp[n].v + y)*8;
+                        int x2 = (i*z->img_comp[n].h + x);
+                        int y2 = (j*z->img_comp[n].v + y);
                         int ha = z->img_comp[n].ha;
                         if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                        z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
+                        stbi__jpeg_idct_block(z, n, x2, y2, data);
                      }
                   }
                }
@@ -3043,21 +3127,38 @@ static void stbi__jpeg_dequantize(short *data, stbi__uint16 *dequant)
       data[i] *= dequant[i];
 }
 
+typedef struct
+{
+   stbi__jpeg *z;
+   int n;
+} stbi__jpeg_finish_rows_ctx;
+
+// dequantize and idct the block rows [j0, j1) of one component, rows are independent
+static void stbi__jpeg_finish_rows(void *ctx, int j0, int j1)
+{
+   stbi__jpeg *z = ((stbi__jpeg_finish_rows_ctx *) ctx)->z;
+   int n = ((stbi__jpeg_finish_rows_ctx *) ctx)->n;
+   int w = (z->img_comp[n].x+7) >> 3;
+   int i,j;
+   for (j=j0; j < j1; ++j) {
+      for (i=0; i < w; ++i) {
+         short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
+         stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
+         stbi__jpeg_idct_block(z, n, i, j, data);
+      }
+   }
+}
+
 static void stbi__jpeg_finish(stbi__jpeg *z)
 {
    if (z->progressive) {
       // dequantize and idct the data
-      int i,j,n;
+      int n;
       for (n=0; n < z->s->img_n; ++n) {
-         int w = (z->img_comp[n].x+7) >> 3;
-         int h = (z->img_comp[n].y+7) >> 3;
-         for (j=0; j < h; ++j) {
-            for (i=0; i < w; ++i) {
-               short *data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
-               stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-               z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
-            }
-         }
+         stbi__jpeg_finish_rows_ctx ctx;
+         ctx.z = z;
+         ctx.n = n;
+         STBI_PARALLEL_ROWS((z->img_comp[n].y+7) >> 3, stbi__jpeg_finish_rows, &ctx);
       }
    }
 }
@@ -3294,8 +3395,8 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       //
       // img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
       // so these muls can't overflow with 32-bit ints (which we require)
-      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+      z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * (8 >> z->scale_shift);
+      z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * (8 >> z->scale_shift);
       z->img_comp[i].coeff = 0;
       z->img_comp[i].raw_coeff = 0;
       z->img_comp[i].linebuf = NULL;
@@ -3305,10 +3406,10 @@ static int stbi__process_frame_header(stbi__jpeg *z, int scan)
       // align blocks for idct using mmx/sse
       z->img_comp[i].data = (stbi_uc*) (((size_t) z->img_comp[i].raw_data + 15) & ~15);
       if (z->progressive) {
-         // w2, h2 are multiples of 8 (see above)
-         z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-         z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+         // coefficients are kept for every block whatever the output scale
+         z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+         z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+         z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 8, z->img_comp[i].coeff_h * 8, sizeof(short), 15);
          if (z->img_comp[i].raw_coeff == NULL)
             return stbi__free_jpeg_components(z, i+1, stbi__err("outofmem", "Out of memory"));
          z->img_comp[i].coeff = (short*) (((size_t) z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3623,7 +3724,7 @@ static void stbi__YCbCr_to_RGB_row(stbi_uc *out, const stbi_uc *y, const stbi_uc
       out[0] = (stbi_uc)r;
       out[1] = (stbi_uc)g;
       out[2] = (stbi_uc)b;
-      out[3] = 255;
+      if (step == 4) out[3] = 255; // rows may be converted concurrently, never touch the next one
       out += step;
    }
 }
@@ -3757,7 +3858,7 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
       out[0] = (stbi_uc)r;
       out[1] = (stbi_uc)g;
       out[2] = (stbi_uc)b;
-      out[3] = 255;
+      if (step == 4) out[3] = 255;
       out += step;
    }
 }
@@ -3766,6 +3867,10 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc *out, stbi_uc const *y, stbi_uc cons
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg *j)
 {
+   j->scale_shift = 0;
+   j->out_buffer = NULL;
+   j->out_stride = 0;
+
    j->idct_block_kernel = stbi__idct_block;
    j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_row;
    j->resample_row_hv_2_kernel = stbi__resample_row_hv_2;
@@ -3808,6 +3913,147 @@ static stbi_uc stbi__blinn_8x8(stbi_uc x, stbi_uc y)
    return (stbi_uc) ((t + (t >>8)) >> 8);
 }
 
+typedef struct
+{
+   stbi__jpeg *z;
+   stbi__resample *res_comp;
+   int n, decode_n, is_rgb;
+   stbi_uc *output;
+   size_t out_stride;
+   int failed;
+} stbi__jpeg_convert_ctx;
+
+// resample and color-convert the output rows [j0, j1), the resampler state is derived from j0
+// so that ranges can be converted independently
+static void stbi__jpeg_convert_rows(void *ctx_, int j0, int j1)
+{
+   stbi__jpeg_convert_ctx *ctx = (stbi__jpeg_convert_ctx *) ctx_;
+   stbi__jpeg *z = ctx->z;
+   int n = ctx->n, decode_n = ctx->decode_n, is_rgb = ctx->is_rgb;
+   int k;
+   unsigned int i;
+   int j;
+   stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
+   stbi_uc *linebuf[4] = { NULL, NULL, NULL, NULL };
+   stbi__resample res_comp[4];
+
+   for (k=0; k < decode_n; ++k) {
+      stbi__resample *r = &res_comp[k];
+      int t, q;
+      *r = ctx->res_comp[k];
+      // allocate line buffer big enough for upsampling off the edges
+      // with upsample factor of 4
+      linebuf[k] = (stbi_uc *) stbi__malloc(z->s->img_x + 3);
+      if (!linebuf[k]) { ctx->failed = 1; goto done; }
+      // row j0 is reached after q full vertical expansions
+      t = j0 + r->ystep;
+      q = t / r->vs;
+      r->ystep = t % r->vs;
+      r->ypos  = q;
+      r->line1 = z->img_comp[k].data + z->img_comp[k].w2 * (q < z->img_comp[k].y-1 ? q : z->img_comp[k].y-1);
+      r->line0 = q == 0 ? r->line1 : z->img_comp[k].data + z->img_comp[k].w2 * (q-1 < z->img_comp[k].y-1 ? q-1 : z->img_comp[k].y-1);
+   }
+
+   for (j=j0; j < j1; ++j) {
+      stbi_uc *out = ctx->output + ctx->out_stride * j;
+      for (k=0; k < decode_n; ++k) {
+         stbi__resample *r = &res_comp[k];
+         int y_bot = r->ystep >= (r->vs >> 1);
+         coutput[k] = r->resample(linebuf[k],
+                                  y_bot ? r->line1 : r->line0,
+                                  y_bot ? r->line0 : r->line1,
+                                  r->w_lores, r->hs);
+         if (++r->ystep >= r->vs) {
+            r->ystep = 0;
+            r->line0 = r->line1;
+            if (++r->ypos < z->img_comp[k].y)
+               r->line1 += z->img_comp[k].w2;
+         }
+      }
+      if (n >= 3) {
+         stbi_uc *y = coutput[0];
+         if (z->s->img_n == 3) {
+            if (is_rgb) {
+               for (i=0; i < z->s->img_x; ++i) {
+                  out[0] = y[i];
+                  out[1] = coutput[1][i];
+                  out[2] = coutput[2][i];
+                  if (n == 4) out[3] = 255;
+                  out += n;
+               }
+            } else {
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+            }
+         } else if (z->s->img_n == 4) {
+            if (z->app14_color_transform == 0) { // CMYK
+               for (i=0; i < z->s->img_x; ++i) {
+                  stbi_uc m = coutput[3][i];
+                  out[0] = stbi__blinn_8x8(coutput[0][i], m);
+                  out[1] = stbi__blinn_8x8(coutput[1][i], m);
+                  out[2] = stbi__blinn_8x8(coutput[2][i], m);
+                  if (n == 4) out[3] = 255;
+                  out += n;
+               }
+            } else if (z->app14_color_transform == 2) { // YCCK
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+               for (i=0; i < z->s->img_x; ++i) {
+                  stbi_uc m = coutput[3][i];
+                  out[0] = stbi__blinn_8x8(255 - out[0], m);
+                  out[1] = stbi__blinn_8x8(255 - out[1], m);
+                  out[2] = stbi__blinn_8x8(255 - out[2], m);
+                  out += n;
+               }
+            } else { // YCbCr + alpha?  Ignore the fourth channel for now
+               z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+            }
+         } else
+            for (i=0; i < z->s->img_x; ++i) {
+               out[0] = out[1] = out[2] = y[i];
+               if (n == 4) out[3] = 255;
+               out += n;
+            }
+      } else {
+         if (is_rgb) {
+            if (n == 1)
+               for (i=0; i < z->s->img_x; ++i)
+                  *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+            else {
+               for (i=0; i < z->s->img_x; ++i, out += 2) {
+                  out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+                  out[1] = 255;
+               }
+            }
+         } else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
+            for (i=0; i < z->s->img_x; ++i) {
+               stbi_uc m = coutput[3][i];
+               stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
+               stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
+               stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
+               out[0] = stbi__compute_y(r, g, b);
+               out[1] = 255;
+               out += n;
+            }
+         } else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
+            for (i=0; i < z->s->img_x; ++i) {
+               out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
+               out[1] = 255;
+               out += n;
+            }
+         } else {
+            stbi_uc *y = coutput[0];
+            if (n == 1)
+               for (i=0; i < z->s->img_x; ++i) out[i] = y[i];
+            else
+               for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
+         }
+      }
+   }
+
+done:
+   for (k=0; k < decode_n; ++k)
+      STBI_FREE(linebuf[k]);
+}
+
 static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp, int req_comp)
 {
    int n, decode_n, is_rgb;
@@ -3819,6 +4065,17 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    // load a jpeg image from whichever source, but leave in YCbCr format
    if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
 
+   // from here on the geometry is the one of the reduced planes
+   if (z->scale_shift) {
+      int i, s = 1 << z->scale_shift;
+      z->s->img_x = (z->s->img_x + s-1) >> z->scale_shift;
+      z->s->img_y = (z->s->img_y + s-1) >> z->scale_shift;
+      for (i=0; i < z->s->img_n; ++i) {
+         z->img_comp[i].x = (z->s->img_x * z->img_comp[i].h + z->img_h_max-1) / z->img_h_max;
+         z->img_comp[i].y = (z->s->img_y * z->img_comp[i].v + z->img_v_max-1) / z->img_v_max;
+      }
+   }
+
    // determine actual number of components to generate
    n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
 
@@ -3836,20 +4093,13 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
    // resample and color-convert
    {
       int k;
-      unsigned int i,j;
       stbi_uc *output;
-      stbi_uc *coutput[4] = { NULL, NULL, NULL, NULL };
-
       stbi__resample res_comp[4];
+      stbi__jpeg_convert_ctx ctx;
 
       for (k=0; k < decode_n; ++k) {
          stbi__resample *r = &res_comp[k];
 
-         // allocate line buffer big enough for upsampling off the edges
-         // with upsample factor of 4
-         z->img_comp[k].linebuf = (stbi_uc *) stbi__malloc(z->s->img_x + 3);
-         if (!z->img_comp[k].linebuf) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
-
          r->hs      = z->img_h_max / z->img_comp[k].h;
          r->vs      = z->img_v_max / z->img_comp[k].v;
          r->ystep   = r->vs >> 1;
@@ -3864,106 +4114,30 @@ static stbi_uc *load_jpeg_image(stbi__jpeg *z, int *out_x, int *out_y, int *comp
          else                               r->resample = stbi__resample_row_generic;
       }
 
-      // can't error after this so, this is safe
-      output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
-      if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+      if (z->out_buffer) {
+         output = z->out_buffer;
+         ctx.out_stride = (size_t) z->out_stride;
+      } else {
+         output = (stbi_uc *) stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
+         if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
+         ctx.out_stride = (size_t) n * z->s->img_x;
+      }
 
       // now go ahead and resample
-      for (j=0; j < z->s->img_y; ++j) {
-         stbi_uc *out = output + n * z->s->img_x * j;
-         for (k=0; k < decode_n; ++k) {
-            stbi__resample *r = &res_comp[k];
-            int y_bot = r->ystep >= (r->vs >> 1);
-            coutput[k] = r->resample(z->img_comp[k].linebuf,
-                                     y_bot ? r->line1 : r->line0,
-                                     y_bot ? r->line0 : r->line1,
-                                     r->w_lores, r->hs);
-            if (++r->ystep >= r->vs) {
-               r->ystep = 0;
-               r->line0 = r->line1;
-               if (++r->ypos < z->img_comp[k].y)
-                  r->line1 += z->img_comp[k].w2;
-            }
-         }
-         if (n >= 3) {
-            stbi_uc *y = coutput[0];
-            if (z->s->img_n == 3) {
-               if (is_rgb) {
-                  for (i=0; i < z->s->img_x; ++i) {
-                     out[0] = y[i];
-                     out[1] = coutput[1][i];
-                     out[2] = coutput[2][i];
-                     out[3] = 255;
-                     out += n;
-                  }
-               } else {
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-               }
-            } else if (z->s->img_n == 4) {
-               if (z->app14_color_transform == 0) { // CMYK
-                  for (i=0; i < z->s->img_x; ++i) {
-                     stbi_uc m = coutput[3][i];
-                     out[0] = stbi__blinn_8x8(coutput[0][i], m);
-                     out[1] = stbi__blinn_8x8(coutput[1][i], m);
-                     out[2] = stbi__blinn_8x8(coutput[2][i], m);
-                     out[3] = 255;
-                     out += n;
-                  }
-               } else if (z->app14_color_transform == 2) { // YCCK
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-                  for (i=0; i < z->s->img_x; ++i) {
-                     stbi_uc m = coutput[3][i];
-                     out[0] = stbi__blinn_8x8(255 - out[0], m);
-                     out[1] = stbi__blinn_8x8(255 - out[1], m);
-                     out[2] = stbi__blinn_8x8(255 - out[2], m);
-                     out += n;
-                  }
-               } else { // YCbCr + alpha?  Ignore the fourth channel for now
-                  z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-               }
-            } else
-               for (i=0; i < z->s->img_x; ++i) {
-                  out[0] = out[1] = out[2] = y[i];
-                  out[3] = 255; // not used if n==3
-                  out += n;
-               }
-         } else {
-            if (is_rgb) {
-               if (n == 1)
-                  for (i=0; i < z->s->img_x; ++i)
-                     *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-               else {
-                  for (i=0; i < z->s->img_x; ++i, out += 2) {
-                     out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-                     out[1] = 255;
-                  }
-               }
-            } else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
-               for (i=0; i < z->s->img_x; ++i) {
-                  stbi_uc m = coutput[3][i];
-                  stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
-                  stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
-                  stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
-                  out[0] = stbi__compute_y(r, g, b);
-                  out[1] = 255;
-                  out += n;
-               }
-            } else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
-               for (i=0; i < z->s->img_x; ++i) {
-                  out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
-                  out[1] = 255;
-                  out += n;
-               }
-            } else {
-               stbi_uc *y = coutput[0];
-               if (n == 1)
-                  for (i=0; i < z->s->img_x; ++i) out[i] = y[i];
-               else
-                  for (i=0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
-            }
-         }
-      }
+      ctx.z = z;
+      ctx.res_comp = res_comp;
+      ctx.n = n;
+      ctx.decode_n = decode_n;
+      ctx.is_rgb = is_rgb;
+      ctx.output = output;
+      ctx.failed = 0;
+      STBI_PARALLEL_ROWS((int) z->s->img_y, stbi__jpeg_convert_rows, &ctx);
+
       stbi__cleanup_jpeg(z);
+      if (ctx.failed) {
+         if (output != z->out_buffer) STBI_FREE(output);
+         return stbi__errpuc("outofmem", "Out of memory");
+      }
       *out_x = z->s->img_x;
       *out_y = z->s->img_y;
       if (comp) *comp = z->s->img_n >= 3 ? 3 : 1; // report original components, not output
@@ -3984,6 +4158,56 @@ static void *stbi__jpeg_load(stbi__context *s, int *x, int *y, int *comp, int re
    return result;
 }
 
+static stbi_uc *stbi__jpeg_load_scaled(stbi__context *s, int *x, int *y, int *comp, int req_comp, int scale_shift, stbi_uc *out, int out_stride)
+{
+   unsigned char* result;
+   stbi__jpeg* j;
+   if (scale_shift < 0 || scale_shift > 3) return stbi__errpuc("bad scale", "Internal error");
+   // no separate stbi__jpeg_test pass, the header decode of load_jpeg_image rejects other formats
+   j = (stbi__jpeg*) stbi__malloc(sizeof(stbi__jpeg));
+   if (!j) return stbi__errpuc("outofmem", "Out of memory");
+   j->s = s;
+   stbi__setup_jpeg(j);
+   j->scale_shift = scale_shift;
+   j->out_buffer = out;
+   j->out_stride = out_stride;
+   result = load_jpeg_image(j, x,y,comp,req_comp);
+   STBI_FREE(j);
+   return result;
+}
+
+STBIDEF stbi_uc *stbi_load_jpeg_scaled_from_memory(stbi_uc const *buffer, int len, int *x, int *y, int *comp, int req_comp, int scale_shift, stbi_uc *out, int out_stride)
+{
+   stbi__context s;
+   stbi__start_mem(&s,buffer,len);
+   return stbi__jpeg_load_scaled(&s,x,y,comp,req_comp,scale_shift,out,out_stride);
+}
+
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_uc *stbi_load_jpeg_scaled(char const *filename, int *x, int *y, int *comp, int req_comp, int scale_shift, stbi_uc *out, int out_stride)
+{
+   unsigned char *result;
+   FILE *f = stbi__fopen(filename, "rb");
+   if (!f) return stbi__errpuc("can't fopen", "Unable to open file");
+   result = stbi_load_jpeg_scaled_from_file(f,x,y,comp,req_comp,scale_shift,out,out_stride);
+   fclose(f);
+   return result;
+}
+
+STBIDEF stbi_uc *stbi_load_jpeg_scaled_from_file(FILE *f, int *x, int *y, int *comp, int req_comp, int scale_shift, stbi_uc *out, int out_stride)
+{
+   unsigned char *result;
+   stbi__context s;
+   stbi__start_file(&s,f);
+   result = stbi__jpeg_load_scaled(&s,x,y,comp,req_comp,scale_shift,out,out_stride);
+   if (result) {
+      // need to 'unget' all the characters in the IO buffer
+      fseek(f, - (int) (s.img_buffer_end - s.img_buffer), SEEK_CUR);
+   }
+   return result;
+}
+#endif
+
 static int stbi__jpeg_test(stbi__context *s)
 {
    int r;
@@ -0,0 +1,128 @@
+//
+//  ActivationLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "ActivationLayer.hpp"
+#include "Parallel.hpp"
+
+#if __SSE2__
+#include "QuantizeX86.hpp"
+#elif __ARM_NEON__
+#include "QuantizeNeon.hpp"
+#endif
+
+namespace otter {
+
+// The residual variant is the convolution epilogue, activation(x) + residual then post_activation in one pass
+template <bool with_residual>
+static void activation_inplace_kernel(float* ptr, const float* residual, int64_t size, int activation_type, float alpha, float beta, int post_activation_type, float post_alpha, float post_beta) {
+    int64_t i = 0;
+#if __SSE2__
+#if __AVX__
+    for (; i + 7 < size; i += 8) {
+        __m256 _p = activation_avx(_mm256_loadu_ps(ptr), activation_type, alpha, beta);
+        if (with_residual) {
+            _p = _mm256_add_ps(_p, _mm256_loadu_ps(residual));
+            _p = activation_avx(_p, post_activation_type, post_alpha, post_beta);
+            residual += 8;
+        }
+        _mm256_storeu_ps(ptr, _p);
+        ptr += 8;
+    }
+#endif  // __AVX__
+    for (; i + 3 < size; i += 4) {
+        __m128 _p = activation_sse(_mm_loadu_ps(ptr), activation_type, alpha, beta);
+        if (with_residual) {
+            _p = _mm_add_ps(_p, _mm_loadu_ps(residual));
+            _p = activation_sse(_p, post_activation_type, post_alpha, post_beta);
+            residual += 4;
+        }
+        _mm_storeu_ps(ptr, _p);
+        ptr += 4;
+    }
+#elif __ARM_NEON__
+    for (; i + 3 < size; i += 4) {
+        float32x4_t _p = activation_ps(vld1q_f32(ptr), activation_type, alpha, beta);
+        if (with_residual) {
+            _p = vaddq_f32(_p, vld1q_f32(residual));
+            _p = activation_ps(_p, post_activation_type, post_alpha, post_beta);
+            residual += 4;
+        }
+        vst1q_f32(ptr, _p);
+        ptr += 4;
+    }
+#endif
+    for (; i < size; ++i) {
+        float v = activation_ss(*ptr, activation_type, alpha, beta);
+        if (with_residual) {
+            v = activation_ss(v + *residual, post_activation_type, post_alpha, post_beta);
+            residual++;
+        }
+        *ptr = v;
+        ptr++;
+    }
+}
+
+static bool is_float_blob(const Tensor& self) {
+    return self.scalar_type() == ScalarType::Float || self.scalar_type() == ScalarType::Float4 || self.scalar_type() == ScalarType::Float8;
+}
+
+// Blocks of whole vectors so that every thread stays on the SIMD path
+static constexpr int64_t kActivationBlock = 256;
+
+void activation_inplace(Tensor& self, int activation_type, const Tensor& activation_params) {
+    if (activation_type == 0 || !self.defined())
+        return;
+
+    OTTER_CHECK(is_float_blob(self), "Fused activation expect float input but get ", self.scalar_type());
+
+    if (!self.is_contiguous())
+        self = self.contiguous();
+
+    float alpha, beta;
+    activation_scalar_params(activation_type, activation_params, alpha, beta);
+
+    float* ptr = (float*)self.data_ptr();
+    const int64_t size = self.numel() * self.elempack();
+    const int64_t num_blocks = (size + kActivationBlock - 1) / kActivationBlock;
+
+    otter::parallel_for(0, num_blocks, 0, [&](int64_t begin, int64_t end) {
+        const int64_t start = begin * kActivationBlock;
+        const int64_t stop = std::min(end * kActivationBlock, size);
+        activation_inplace_kernel<false>(ptr + start, nullptr, stop - start, activation_type, alpha, beta, 0, 0.f, 0.f);
+    });
+}
+
+void residual_activation_inplace(Tensor& self, int activation_type, const Tensor& activation_params, const Tensor& residual, int post_activation_type, const Tensor& post_activation_params) {
+    if (!residual.defined()) {
+        activation_inplace(self, activation_type, activation_params);
+        return;
+    }
+    
+    OTTER_CHECK(is_float_blob(self) && self.scalar_type() == residual.scalar_type(), "Residual epilogue expect float blobs with the same layout but get ", self.scalar_type(), " and ", residual.scalar_type());
+    OTTER_CHECK(self.sizes() == residual.sizes(), "Residual epilogue expect the shape ", self.sizes(), " but get ", residual.sizes());
+    
+    if (!self.is_contiguous())
+        self = self.contiguous();
+    const Tensor residual_ = residual.contiguous();
+    
+    float alpha, beta, post_alpha, post_beta;
+    activation_scalar_params(activation_type, activation_params, alpha, beta);
+    activation_scalar_params(post_activation_type, post_activation_params, post_alpha, post_beta);
+    
+    float* ptr = (float*)self.data_ptr();
+    const float* residual_ptr = (const float*)residual_.data_ptr();
+    const int64_t size = self.numel() * self.elempack();
+    const int64_t num_blocks = (size + kActivationBlock - 1) / kActivationBlock;
+    
+    otter::parallel_for(0, num_blocks, 0, [&](int64_t begin, int64_t end) {
+        const int64_t start = begin * kActivationBlock;
+        const int64_t stop = std::min(end * kActivationBlock, size);
+        activation_inplace_kernel<true>(ptr + start, residual_ptr + start, stop - start, activation_type, alpha, beta, post_activation_type, post_alpha, post_beta);
+    });
+}
+
+}   // end namespace otter
@@ -14,15 +14,69 @@
 
 namespace otter {
 
-static OTTER_ALWAYS_INLINE float activation_ss(float v, int activation_type, const Tensor& activation_params) {
+// Fused activation types shared by Convolution, Deconvolution, Convolution1D, InnerProduct and
+// the int8 requantize kernels
+// 1 Relu, 2 LRelu, 3 Relu6, 4 Sigmoid, 5 Mish, 6 HardSwish, 7 HardSigmoid, 8 Swish (x * sigmoid(x), SiLU), 9 GELU (tanh approximation)
+static inline int activation_type_from_string(const std::string& activation) {
+    if (activation == "Relu") {
+        return 1;
+    } else if (activation == "LRelu") {
+        return 2;
+    } else if (activation == "Relu6") {
+        return 3;
+    } else if (activation == "Sigmoid") {
+        return 4;
+    } else if (activation == "Mish") {
+        return 5;
+    } else if (activation == "HardSwish") {
+        return 6;
+    } else if (activation == "HardSigmoid") {
+        return 7;
+    } else if (activation == "Swish") {
+        return 8;
+    } else if (activation == "GELU") {
+        return 9;
+    }
+    
+    return 0;
+}
+
+// HardSwish and HardSigmoid compute clamp(x * alpha + beta, 0, 1), default to the PyTorch definition
+static OTTER_ALWAYS_INLINE void activation_hard_params(const Tensor& activation_params, float& alpha, float& beta) {
+    alpha = 1.f / 6;
+    beta = 0.5f;
+    if (activation_params.defined() && activation_params.numel() >= 2) {
+        const float* activation_params_data = activation_params.data_ptr<float>();
+        alpha = activation_params_data[0];
+        beta = activation_params_data[1];
+    }
+}
+
+// Resolve the params once before a loop, alpha is the LRelu slope (0.1 by default) or the hard alpha, beta the hard beta
+static OTTER_ALWAYS_INLINE void activation_scalar_params(int activation_type, const Tensor& activation_params, float& alpha, float& beta) {
+    alpha = 0.f;
+    beta = 0.f;
+    if (activation_type == 2) {
+        alpha = 0.1f;
+        if (activation_params.defined() && activation_params.numel() >= 1)
+            alpha = activation_params.data_ptr<float>()[0];
+    } else if (activation_type == 6 || activation_type == 7) {
+        activation_hard_params(activation_params, alpha, beta);
+    }
+}
+
+// sqrt(2 / pi) * 2, GELU(x) = 0.5x(1 + tanh(sqrt(2 / pi)(x + 0.044715x^3))) = x * sigmoid(2 * sqrt(2 / pi)(x + 0.044715x^3))
+constexpr float GELU_SIGMOID_SCALE = 1.5957691216057308f;
+constexpr float GELU_CUBIC_COEFF = 0.044715f;
+
+static OTTER_ALWAYS_INLINE float activation_ss(float v, int activation_type, float alpha, float beta) {
     switch (activation_type) {
         case 1: {
             v = fmax(v, 0.f);
             break;
         }
         case 2: {
-            float slope = activation_params.item().toFloat();
-            v = v > 0.f ? v : v * slope;
+            v = v > 0.f ? v : v * alpha;
             break;
         }
         case 3: {
@@ -40,11 +94,38 @@ static OTTER_ALWAYS_INLINE float activation_ss(float v, int activation_type, con
             v = 1.f / (1.f + exp(-v));
             break;
         }
+        case 5: {
+            v = v * tanh(log(exp(v) + 1.f));
+            break;
+        }
+        case 6:
+        case 7: {
+            float gate = std::min(std::max(v * alpha + beta, 0.f), 1.f);
+            v = activation_type == 6 ? v * gate : gate;
+            break;
+        }
+        case 8: {
+            v = v / (1.f + exp(-std::max(v, -88.3762626647949f)));
+            break;
+        }
+        case 9: {
+            float t = GELU_SIGMOID_SCALE * (v + GELU_CUBIC_COEFF * v * v * v);
+            t = std::min(std::max(t, -88.3762626647949f), 88.3762626647949f);
+            v = v / (1.f + exp(-t));
+            break;
+        }
     }
             
     return v;
 }
 
+static OTTER_ALWAYS_INLINE float activation_ss(float v, int activation_type, const Tensor& activation_params) {
+    float alpha, beta;
+    activation_scalar_params(activation_type, activation_params, alpha, beta);
+    
+    return activation_ss(v, activation_type, alpha, beta);
+}
+
 static Layer* create_activation_layer(int activation_type, const Tensor& activation_params) {
     Layer* activation = nullptr;
     
@@ -53,21 +134,44 @@ static Layer* create_activation_layer(int activation_type, const Tensor& activat
     } else if (activation_type == 2) {
         activation = LayerRegistry::CreateLayer("LRelu");
         
-        float default_value[] = {0.1f};
-        auto activation_params_data = activation_params.defined() ? activation_params.data_ptr<float>() : default_value;
+        float slope, unused;
+        activation_scalar_params(activation_type, activation_params, slope, unused);
         ParamDict pd;
-        pd.set(0, activation_params_data[0]);
+        pd.set(0, slope);
         
         activation->load_param(pd);
     } else if (activation_type == 3) {
         activation = LayerRegistry::CreateLayer("Relu6");
     } else if (activation_type == 4) {
         activation = LayerRegistry::CreateLayer("Sigmoid");
+    } else if (activation_type == 5) {
+        activation = LayerRegistry::CreateLayer("Mish");
+    } else if (activation_type == 6 || activation_type == 7) {
+        activation = LayerRegistry::CreateLayer(activation_type == 6 ? "HardSwish" : "HardSigmoid");
+        
+        float alpha, beta;
+        activation_hard_params(activation_params, alpha, beta);
+        ParamDict pd;
+        pd.set(0, alpha);
+        pd.set(1, beta);
+        
+        activation->load_param(pd);
+    } else if (activation_type == 8) {
+        activation = LayerRegistry::CreateLayer("Swish");
+    } else if (activation_type == 9) {
+        activation = LayerRegistry::CreateLayer("GELU");
     }
     
     return activation;
 }
 
+// Apply the fused activation in place, one vectorized pass over a packed or unpacked blob
+void activation_inplace(Tensor& self, int activation_type, const Tensor& activation_params);
+
+// Convolution epilogue, self = post_activation(activation(self) + residual) in the same single pass,
+// residual has the shape and layout of self. Falls back to activation_inplace without residual
+void residual_activation_inplace(Tensor& self, int activation_type, const Tensor& activation_params, const Tensor& residual, int post_activation_type, const Tensor& post_activation_params);
+
 }   // end namespace otter
 
 #endif /* ActivationLayer_h */
@@ -0,0 +1,68 @@
+//
+//  AdaptiveAvgPoolLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "AdaptiveAvgPoolLayer.hpp"
+#include "Pool.hpp"
+
+#include "TensorMaker.hpp"
+
+namespace otter {
+
+AdaptiveAvgPoolLayer::AdaptiveAvgPoolLayer() {
+    one_blob_only = true;
+    support_inplace = false;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int AdaptiveAvgPoolLayer::parse_param(LayerOption& option, ParamDict& pd) {
+    pd.clear();
+    int output_height = opt_find_int(option, "output_h", -1);
+    int output_width  = opt_find_int(option, "output_w", -1);
+    int output_size   = opt_find_int(option, "output_size", 1);
+    if (output_height < 1 || output_width < 1) {
+        if (output_height < 0) output_height = output_size;
+        if (output_width < 0)  output_width  = output_size;
+    }
+    
+    pd.set((int)AdaptiveAvgPoolParam::Output_height, output_height);
+    pd.set((int)AdaptiveAvgPoolParam::Output_width,  output_width);
+    
+    return 0;
+}
+
+int AdaptiveAvgPoolLayer::compute_output_shape(ParamDict &pd) {
+    auto shape_a = bottom_shapes[0].accessor<int, 2>()[0];
+    int input_batch = shape_a[0];
+    int input_channels = shape_a[1];
+    
+    int output_height = pd.get((int)AdaptiveAvgPoolParam::Output_height, 1);
+    int output_width  = pd.get((int)AdaptiveAvgPoolParam::Output_width,  1);
+    
+    pd.set(OUTPUT_SHAPE_HINT, otter::tensor({input_batch, input_channels, output_height, output_width}, ScalarType::Int).view({1, -1}));
+    
+    return 0;
+}
+
+int AdaptiveAvgPoolLayer::load_param(const ParamDict &pd) {
+    output_height = pd.get((int)AdaptiveAvgPoolParam::Output_height, 1);
+    output_width  = pd.get((int)AdaptiveAvgPoolParam::Output_width,  1);
+    
+    return 0;
+}
+
+int AdaptiveAvgPoolLayer::forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& /*opt*/) const {
+    top_blob = otter::adaptive_avg_pool2d(bottom_blob, {output_height, output_width});
+    
+    return 0;
+}
+
+}   // end namespace otter
@@ -0,0 +1,40 @@
+//
+//  AdaptiveAvgPoolLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef AdaptiveAvgPoolLayer_hpp
+#define AdaptiveAvgPoolLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class AdaptiveAvgPoolLayer : public Layer {
+public:
+    AdaptiveAvgPoolLayer();
+    
+    virtual int parse_param(LayerOption& option, ParamDict& pd);
+    
+    virtual int compute_output_shape(ParamDict &pd);
+    
+    virtual int load_param(const ParamDict &pd);
+    
+    virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "AdaptiveAvgPool"; }
+private:
+    int output_height;
+    int output_width;
+};
+
+enum class AdaptiveAvgPoolParam {
+    Output_height,
+    Output_width
+};
+
+}   // end namespace otter
+
+#endif /* AdaptiveAvgPoolLayer_hpp */
@@ -29,7 +29,9 @@ void otter_free(void *ptr);
 #define otter_calloc(m, s)   otter_calloc_log(m, s, OTTER_LOC)
 #define otter_realloc(p, s)  otter_realloc_log(p, s, OTTER_LOC)
 
-#if OTTER_MOBILE
+// The AVX kernels use aligned 32-byte loads and stores, so a mobile build on
+// an AVX capable x86 (Linux defaults to OTTER_MOBILE) keeps the large alignment.
+#if OTTER_MOBILE && !__AVX__
 // Use 16-byte alignment on mobile
 // - ARM NEON AArch32 and AArch64
 // - x86[-64] < AVX
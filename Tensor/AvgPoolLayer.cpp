@@ -0,0 +1,106 @@
+//
+//  AvgPoolLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "AvgPoolLayer.hpp"
+#include "Pool.hpp"
+
+#include "TensorMaker.hpp"
+
+namespace otter {
+
+AvgPoolLayer::AvgPoolLayer() {
+    one_blob_only = true;
+    support_inplace = false;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int AvgPoolLayer::parse_param(LayerOption& option, ParamDict& pd) {
+    pd.clear();
+    int stride_height = opt_find_int(option, "stride_h", -1);
+    int stride_width  = opt_find_int(option, "stride_w", -1);
+    int stride        = opt_find_int(option, "stride", 1);
+    if (stride_height < 1 || stride_width < 1) {
+        if (stride_height < 0) stride_height = stride;
+        if (stride_width < 0)  stride_width  = stride;
+    }
+    int kernel_height = opt_find_int(option, "kernel_h", -1);
+    int kernel_width  = opt_find_int(option, "kernel_w", -1);
+    int kernel        = opt_find_int(option, "kernel", stride);
+    if (kernel_height < 1 || kernel_width < 1) {
+        if (kernel_height < 0) kernel_height = kernel;
+        if (kernel_width < 0)  kernel_width  = kernel;
+    }
+    int padding_height = opt_find_int(option, "padding_h", -1);
+    int padding_width  = opt_find_int(option, "padding_w", -1);
+    int padding        = opt_find_int(option, "padding", 0);
+    if (padding_height < 0 || padding_width < 0) {
+        if (padding_height < 0) padding_height = padding;
+        if (padding_width < 0)  padding_width  = padding;
+    }
+    int ceil_mode = (opt_check_string(option, "ceil_mode")) ? 1 : 0;
+    int count_include_pad = (opt_check_string(option, "count_include_pad")) ? 1 : 0;
+    
+    pd.set((int)AvgPoolParam::Kernel_height, kernel_height);
+    pd.set((int)AvgPoolParam::Kernel_width, kernel_width);
+    pd.set((int)AvgPoolParam::Stride_height, stride_height);
+    pd.set((int)AvgPoolParam::Stride_width,  stride_width);
+    pd.set((int)AvgPoolParam::Padding_height, padding_height);
+    pd.set((int)AvgPoolParam::Padding_width,  padding_width);
+    pd.set((int)AvgPoolParam::Ceil_mode, ceil_mode);
+    pd.set((int)AvgPoolParam::Count_include_pad, count_include_pad);
+    
+    return 0;
+}
+
+int AvgPoolLayer::compute_output_shape(ParamDict &pd) {
+    auto shape_a = bottom_shapes[0].accessor<int, 2>()[0];
+    int input_batch = shape_a[0];
+    int input_channels = shape_a[1];
+    int input_height = shape_a[2];
+    int input_width = shape_a[3];
+    
+    int kernel_height   = pd.get((int)AvgPoolParam::Kernel_height, 2);
+    int kernel_width    = pd.get((int)AvgPoolParam::Kernel_width, 2);
+    int stride_height   = pd.get((int)AvgPoolParam::Stride_height, 1);
+    int stride_width    = pd.get((int)AvgPoolParam::Stride_width,  1);
+    int padding_height  = pd.get((int)AvgPoolParam::Padding_height, 0);
+    int padding_width   = pd.get((int)AvgPoolParam::Padding_width,  0);
+    int ceil_mode       = pd.get((int)AvgPoolParam::Ceil_mode, 0);
+    
+    int out_height = pooling_output_shape(input_height, kernel_height, padding_height, stride_height, 1, ceil_mode);
+    int out_width = pooling_output_shape(input_width, kernel_width, padding_width, stride_width, 1, ceil_mode);
+    
+    pd.set(OUTPUT_SHAPE_HINT, otter::tensor({input_batch, input_channels, out_height, out_width}, ScalarType::Int).view({1, -1}));
+    
+    return 0;
+}
+
+int AvgPoolLayer::load_param(const ParamDict &pd) {
+    stride_height     = pd.get((int)AvgPoolParam::Stride_height, 1);
+    stride_width      = pd.get((int)AvgPoolParam::Stride_width,  1);
+    kernel_height     = pd.get((int)AvgPoolParam::Kernel_height, stride_height);
+    kernel_width      = pd.get((int)AvgPoolParam::Kernel_width, stride_width);
+    padding_height    = pd.get((int)AvgPoolParam::Padding_height, 0);
+    padding_width     = pd.get((int)AvgPoolParam::Padding_width,  0);
+    ceil_mode         = pd.get((int)AvgPoolParam::Ceil_mode, 0);
+    count_include_pad = pd.get((int)AvgPoolParam::Count_include_pad, 0);
+    
+    return 0;
+}
+
+int AvgPoolLayer::forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& /*opt*/) const {
+    top_blob = otter::avg_pool2d(bottom_blob, {kernel_height, kernel_width}, {stride_height, stride_width}, {padding_height, padding_width}, ceil_mode, count_include_pad);
+    
+    return 0;
+}
+
+}   // end namespace otter
@@ -0,0 +1,52 @@
+//
+//  AvgPoolLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef AvgPoolLayer_hpp
+#define AvgPoolLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class AvgPoolLayer : public Layer {
+public:
+    AvgPoolLayer();
+    
+    virtual int parse_param(LayerOption& option, ParamDict& pd);
+    
+    virtual int compute_output_shape(ParamDict &pd);
+    
+    virtual int load_param(const ParamDict &pd);
+    
+    virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "AvgPool"; }
+private:
+    int kernel_height;
+    int kernel_width;
+    int stride_height;
+    int stride_width;
+    int padding_height;
+    int padding_width;
+    int ceil_mode;
+    int count_include_pad;
+};
+
+enum class AvgPoolParam {
+    Kernel_height,
+    Kernel_width,
+    Stride_height,
+    Stride_width,
+    Padding_height,
+    Padding_width,
+    Ceil_mode,
+    Count_include_pad
+};
+
+}   // end namespace otter
+
+#endif /* AvgPoolLayer_hpp */
@@ -15,6 +15,7 @@ namespace otter {
 BatchNormalizationLayer::BatchNormalizationLayer() {
     one_blob_only = true;
     support_inplace = true;
+    support_tiling = true;
 }
 
 int BatchNormalizationLayer::parse_param(LayerOption& option, ParamDict &pd) {
@@ -8,20 +8,11 @@
 #ifndef Benchmark_hpp
 #define Benchmark_hpp
 
-#include "Layer.hpp"
-#include "Tensor.hpp"
-
 namespace otter {
 
+// Monotonic time in milliseconds, only the difference between two calls is meaningful.
 double get_current_time();
 
-#if OTTER_BENCHMARK
-
-void benchmark(const Layer* layer, double start, double end);
-void benchmark(const Layer* layer, const Tensor& bottom_blob, Tensor& top_blob, double start, double end);
-
-#endif
-
 }
 
 #endif /* Benchmark_hpp */
@@ -7,6 +7,7 @@
 
 #include "CPUCachingAllocator.hpp"
 #include "CPUProfilingAllocator.hpp"
+#include "CPUSizeClassAllocator.hpp"
 #include "CPUAllocator.hpp"
 #include "Macro.hpp"
 #include "Config.hpp"
@@ -84,8 +85,14 @@ public:
         } else if (profiling_allocator_ptr != nullptr) {
             data = profiling_allocator_ptr->allocate(alloc_size);
         } else {
-            data = alloc_cpu(alloc_size);
             auto allocation_planner = GetThreadLocalAllocationPlanner();
+#if OTTER_SIZE_CLASS_ALLOCATOR
+            // The block header of the size class allocator stands in for the pre guard
+            if (allocation_planner == nullptr) {
+                return GetSizeClassCPUAllocator()->allocate(nbytes + PostGuardBytes);
+            }
+#endif
+            data = alloc_cpu(alloc_size);
             if (allocation_planner != nullptr) {
                 allocation_planner->record_allocation(alloc_size, data);
             }
@@ -118,7 +125,11 @@ Allocator* GetDefaultCPUAllocator() {
 static DefaultCPUAllocator g_cpu_alloc;
 
 Allocator* GetDefaultCPUAllocator() {
+#if OTTER_SIZE_CLASS_ALLOCATOR
+    return GetSizeClassCPUAllocator();
+#else
     return &g_cpu_alloc;
+#endif
 }
 #endif  // OTTER_MOBILE
 
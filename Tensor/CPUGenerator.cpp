@@ -27,10 +27,11 @@ inline uint64_t make64BitsFrom32Bits(uint32_t hi, uint32_t lo) {
 
 }   // end namespace detail
 
-CPUGeneratorNucleus::CPUGeneratorNucleus(uint64_t seed_in) : otter::GeneratorNucleus(Device::CPU), engine_{seed_in} {}
+CPUGeneratorNucleus::CPUGeneratorNucleus(uint64_t seed_in) : otter::GeneratorNucleus(Device::CPU), engine_{seed_in}, philox_offset_{0} {}
 
 void CPUGeneratorNucleus::set_current_seed(uint64_t seed) {
     engine_ = mt19937(seed);
+    philox_offset_ = 0;
 }
 
 uint64_t CPUGeneratorNucleus::current_seed() const {
@@ -62,6 +63,21 @@ void CPUGeneratorNucleus::set_engine(otter::mt19937 engine) {
     engine_ = engine;
 }
 
+uint64_t CPUGeneratorNucleus::philox_offset_reserve(uint64_t count) {
+    // keep every reservation aligned to a whole group
+    count = (count + PHILOX_GROUP_COUNTERS - 1) / PHILOX_GROUP_COUNTERS * PHILOX_GROUP_COUNTERS;
+    return philox_offset_.fetch_add(count, std::memory_order_relaxed);
+}
+
+uint64_t CPUGeneratorNucleus::philox_offset() const {
+    return philox_offset_.load(std::memory_order_relaxed);
+}
+
+void CPUGeneratorNucleus::set_philox_offset(uint64_t offset) {
+    offset = (offset + PHILOX_GROUP_COUNTERS - 1) / PHILOX_GROUP_COUNTERS * PHILOX_GROUP_COUNTERS;
+    philox_offset_.store(offset, std::memory_order_relaxed);
+}
+
 std::shared_ptr<CPUGeneratorNucleus> CPUGeneratorNucleus::clone() const {
     return std::shared_ptr<CPUGeneratorNucleus>(this->clone_impl());
 }
@@ -69,6 +85,7 @@ std::shared_ptr<CPUGeneratorNucleus> CPUGeneratorNucleus::clone() const {
 CPUGeneratorNucleus* CPUGeneratorNucleus::clone_impl() const {
     auto gen = new CPUGeneratorNucleus();
     gen->set_engine(engine_);
+    gen->set_philox_offset(philox_offset());
     //    gen->set_next_float_normal_sample(next_float_normal_sample_);
     //    gen->set_next_double_normal_sample(next_double_normal_sample_);
     return gen;
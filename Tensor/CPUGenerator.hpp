@@ -8,8 +8,11 @@
 #ifndef CPUGenerator_hpp
 #define CPUGenerator_hpp
 
+#include <atomic>
+
 #include "GeneratorNucleus.hpp"
 #include "MT19937.hpp"
+#include "Philox.hpp"
 
 namespace otter {
 
@@ -40,10 +43,18 @@ struct CPUGeneratorNucleus : public GeneratorNucleus {
 //    void set_next_double_normal_sample(c10::optional<double> randn);
     otter::mt19937 engine();
     void set_engine(otter::mt19937 engine);
+    
+    // Philox stream used by the parallel samplers, see Note [Philox4x32 counter based engine].
+    // Reserve count counters and return the first one, lock free so concurrent calls
+    // on the same generator get disjoint ranges without taking mutex_.
+    uint64_t philox_offset_reserve(uint64_t count);
+    uint64_t philox_offset() const;
+    void set_philox_offset(uint64_t offset);
 
 private:
     CPUGeneratorNucleus* clone_impl() const override;
     otter::mt19937 engine_;
+    std::atomic<uint64_t> philox_offset_;
 //    c10::optional<float> next_float_normal_sample_;
 //    c10::optional<double> next_double_normal_sample_;
 };
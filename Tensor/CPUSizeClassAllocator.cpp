@@ -0,0 +1,361 @@
+//
+//  CPUSizeClassAllocator.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "CPUSizeClassAllocator.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace otter {
+
+namespace {
+
+constexpr int kMinClassShift = 6;       // 64 bytes
+constexpr int kMaxClassShift = 40;
+constexpr int kClassesPerDoubling = 4;
+constexpr int kNumClasses = (kMaxClassShift - kMinClassShift) * kClassesPerDoubling + 1;
+// Blocks above the largest class go straight back to the OS
+constexpr int kUncached = kNumClasses;
+
+// The header sits in front of every block so that the size class is found without a lookup
+constexpr size_t kHeaderBytes = gAlignment;
+constexpr size_t kHugePageBytes = size_t(2) << 20;
+
+constexpr size_t kThreadCacheBytes = size_t(32) << 20;
+constexpr size_t kThreadCacheMaxBlock = size_t(4) << 20;
+constexpr size_t kThreadCacheBinCount = 64;
+// Bytes moved at once from the depot to an empty thread cache bin
+constexpr size_t kTransferBytes = size_t(256) << 10;
+
+struct BlockHeader {
+    int size_class;
+    size_t bytes;   // Block bytes, header included
+};
+
+static_assert(sizeof(BlockHeader) <= kHeaderBytes, "Block header does not fit in the alignment");
+
+inline int floor_log2(size_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, (unsigned long long)value);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll((unsigned long long)value);
+#endif
+}
+
+// Class 0 is 64 bytes, then every power of two [2^p, 2^(p+1)) is split in four classes
+inline int size_class_of(size_t bytes) {
+    if (bytes <= (size_t(1) << kMinClassShift))
+        return 0;
+    
+    const size_t s = bytes - 1;
+    const int p = floor_log2(s);
+    if (p >= kMaxClassShift)
+        return kUncached;
+    
+    const int k = (int)(s >> (p - 2));  // 4 ~ 7
+    return (p - kMinClassShift) * kClassesPerDoubling + (k - 4) + 1;
+}
+
+inline size_t class_bytes(int size_class) {
+    if (size_class == 0)
+        return size_t(1) << kMinClassShift;
+    
+    const int j = size_class - 1;
+    const int p = kMinClassShift + j / kClassesPerDoubling;
+    const size_t k = 4 + j % kClassesPerDoubling;
+    return (k + 1) << (p - 2);
+}
+
+struct Depot {
+    std::mutex mutex;
+    std::vector<void*> bins[kNumClasses];
+    
+    std::atomic<size_t> max_cached_bytes{size_t(512) << 20};
+    std::atomic<bool> huge_page{true};
+    
+    std::atomic<size_t> bytes_in_use{0};
+    std::atomic<size_t> bytes_cached{0};
+    std::atomic<size_t> peak_bytes_in_use{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> cache_hits{0};
+};
+
+// Never destroyed, tensors may be released by static destructors
+Depot& depot() {
+    static Depot* instance = new Depot;
+    return *instance;
+}
+
+// 0 before the cache of the thread is created, 2 once it is destroyed
+thread_local int thread_cache_state = 0;
+
+struct ThreadCache {
+    std::vector<void*> bins[kNumClasses];
+    size_t cached_bytes = 0;
+    
+    ThreadCache() { thread_cache_state = 1; }
+    
+    ~ThreadCache() {
+        release();
+        thread_cache_state = 2;
+    }
+    
+    // Hand every block over to the depot
+    void release() {
+        Depot& d = depot();
+        std::lock_guard<std::mutex> guard(d.mutex);
+        for (int c = 0; c < kNumClasses; ++c) {
+            d.bins[c].insert(d.bins[c].end(), bins[c].begin(), bins[c].end());
+            bins[c].clear();
+        }
+        cached_bytes = 0;
+    }
+};
+
+// nullptr for the blocks which skip the thread cache and on a terminating thread
+ThreadCache* thread_cache(size_t bytes) {
+    if (bytes > kThreadCacheMaxBlock || thread_cache_state == 2)
+        return nullptr;
+    
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+void free_depot() {
+    Depot& d = depot();
+    std::lock_guard<std::mutex> guard(d.mutex);
+    for (int c = 0; c < kNumClasses; ++c) {
+        for (void* block : d.bins[c]) {
+            d.bytes_cached.fetch_sub(static_cast<BlockHeader*>(block)->bytes, std::memory_order_relaxed);
+            free_cpu(block);
+        }
+        d.bins[c].clear();
+    }
+}
+
+// Return the largest depot blocks to the OS until bytes are released
+void trim_depot(size_t bytes) {
+    Depot& d = depot();
+    std::lock_guard<std::mutex> guard(d.mutex);
+    size_t released = 0;
+    for (int c = kNumClasses - 1; c >= 0 && released < bytes; --c) {
+        std::vector<void*>& bin = d.bins[c];
+        while (!bin.empty() && released < bytes) {
+            void* block = bin.back();
+            bin.pop_back();
+            released += class_bytes(c);
+            free_cpu(block);
+        }
+    }
+    d.bytes_cached.fetch_sub(released, std::memory_order_relaxed);
+}
+
+void* os_allocate(size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // Only the blocks covering whole huge pages, the others would waste the tail page
+    if (bytes % kHugePageBytes == 0 && depot().huge_page.load(std::memory_order_relaxed)) {
+        void* data = nullptr;
+        if (posix_memalign(&data, kHugePageBytes, bytes) != 0)
+            throw "CPUSizeClassAllocator: can't allocate memory";
+        madvise(data, bytes, MADV_HUGEPAGE);
+        return data;
+    }
+#endif
+    return alloc_cpu(bytes);
+}
+
+void* cache_pop(int size_class, size_t bytes) {
+    Depot& d = depot();
+    
+    ThreadCache* cache = thread_cache(bytes);
+    if (!cache) {
+        std::lock_guard<std::mutex> guard(d.mutex);
+        std::vector<void*>& bin = d.bins[size_class];
+        if (bin.empty())
+            return nullptr;
+        
+        void* block = bin.back();
+        bin.pop_back();
+        d.bytes_cached.fetch_sub(bytes, std::memory_order_relaxed);
+        return block;
+    }
+    
+    std::vector<void*>& bin = cache->bins[size_class];
+    if (bin.empty()) {
+        const size_t batch = std::max<size_t>(1, std::min<size_t>(16, kTransferBytes / bytes));
+        
+        std::lock_guard<std::mutex> guard(d.mutex);
+        std::vector<void*>& depot_bin = d.bins[size_class];
+        const size_t count = std::min(batch, depot_bin.size());
+        bin.insert(bin.end(), depot_bin.end() - count, depot_bin.end());
+        depot_bin.resize(depot_bin.size() - count);
+        cache->cached_bytes += count * bytes;
+    }
+    if (bin.empty())
+        return nullptr;
+    
+    void* block = bin.back();
+    bin.pop_back();
+    cache->cached_bytes -= bytes;
+    d.bytes_cached.fetch_sub(bytes, std::memory_order_relaxed);
+    return block;
+}
+
+void cache_push(void* block, int size_class, size_t bytes) {
+    Depot& d = depot();
+    
+    ThreadCache* cache = thread_cache(bytes);
+    if (cache) {
+        std::vector<void*>& bin = cache->bins[size_class];
+        
+        // Give half of the bin back to the depot when the thread keeps too much
+        if (!bin.empty() && (bin.size() >= kThreadCacheBinCount || cache->cached_bytes + bytes > kThreadCacheBytes)) {
+            const size_t count = (bin.size() + 1) / 2;
+            
+            std::lock_guard<std::mutex> guard(d.mutex);
+            d.bins[size_class].insert(d.bins[size_class].end(), bin.end() - count, bin.end());
+            bin.resize(bin.size() - count);
+            cache->cached_bytes -= count * bytes;
+        }
+        
+        if (cache->cached_bytes + bytes <= kThreadCacheBytes) {
+            bin.push_back(block);
+            cache->cached_bytes += bytes;
+            return;
+        }
+    }
+    
+    std::lock_guard<std::mutex> guard(d.mutex);
+    d.bins[size_class].push_back(block);
+}
+
+}   // end namespace
+
+DataPtr CPUSizeClassAllocator::allocate(size_t nbytes) const {
+    if (nbytes == 0) {
+        return {nullptr, nullptr, &deallocate, Device::CPU};
+    }
+    
+    Depot& d = depot();
+    
+    const int size_class = size_class_of(nbytes + kHeaderBytes);
+    const size_t bytes = (size_class == kUncached) ? nbytes + kHeaderBytes : class_bytes(size_class);
+    
+    void* block = (size_class == kUncached) ? nullptr : cache_pop(size_class, bytes);
+    
+    d.allocations.fetch_add(1, std::memory_order_relaxed);
+    if (block) {
+        d.cache_hits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        try {
+            block = os_allocate(bytes);
+        } catch (...) {
+            // Out of memory, give the cached blocks back and try again
+            if (ThreadCache* cache = thread_cache(0))
+                cache->release();
+            free_depot();
+            block = os_allocate(bytes);
+        }
+    }
+    
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->size_class = size_class;
+    header->bytes = bytes;
+    
+    const size_t in_use = d.bytes_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    size_t peak = d.peak_bytes_in_use.load(std::memory_order_relaxed);
+    while (in_use > peak && !d.peak_bytes_in_use.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+    
+    void* data = static_cast<char*>(block) + kHeaderBytes;
+    return {data, data, &deallocate, Device::CPU};
+}
+
+DeleterFnPtr CPUSizeClassAllocator::raw_deleter() const {
+    return &deallocate;
+}
+
+void CPUSizeClassAllocator::deallocate(void* ptr) {
+    if (!ptr)
+        return;
+    
+    Depot& d = depot();
+    
+    void* block = static_cast<char*>(ptr) - kHeaderBytes;
+    const BlockHeader* header = static_cast<BlockHeader*>(block);
+    const int size_class = header->size_class;
+    const size_t bytes = header->bytes;
+    
+    d.bytes_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    
+    const size_t max_cached_bytes = d.max_cached_bytes.load(std::memory_order_relaxed);
+    if (size_class == kUncached || bytes > max_cached_bytes) {
+        free_cpu(block);
+        return;
+    }
+    
+    // Make room by evicting the largest blocks of the depot, the recent sizes are more likely reused
+    const size_t cached_bytes = d.bytes_cached.load(std::memory_order_relaxed);
+    if (cached_bytes + bytes > max_cached_bytes) {
+        trim_depot(cached_bytes + bytes - max_cached_bytes);
+        
+        if (d.bytes_cached.load(std::memory_order_relaxed) + bytes > max_cached_bytes) {
+            free_cpu(block);
+            return;
+        }
+    }
+    
+    d.bytes_cached.fetch_add(bytes, std::memory_order_relaxed);
+    cache_push(block, size_class, bytes);
+}
+
+Allocator* GetSizeClassCPUAllocator() {
+    static CPUSizeClassAllocator allocator;
+    return &allocator;
+}
+
+CPUAllocatorStats GetCPUAllocatorStats() {
+    Depot& d = depot();
+    
+    CPUAllocatorStats stats;
+    stats.bytes_in_use      = d.bytes_in_use.load(std::memory_order_relaxed);
+    stats.bytes_cached      = d.bytes_cached.load(std::memory_order_relaxed);
+    stats.peak_bytes_in_use = d.peak_bytes_in_use.load(std::memory_order_relaxed);
+    stats.allocations       = d.allocations.load(std::memory_order_relaxed);
+    stats.cache_hits        = d.cache_hits.load(std::memory_order_relaxed);
+    
+    return stats;
+}
+
+void ResetCPUAllocatorPeakStats() {
+    Depot& d = depot();
+    d.peak_bytes_in_use.store(d.bytes_in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void EmptyCPUAllocatorCache() {
+    if (ThreadCache* cache = thread_cache(0))
+        cache->release();
+    free_depot();
+}
+
+void SetCPUAllocatorMaxCachedBytes(size_t bytes) {
+    depot().max_cached_bytes.store(bytes, std::memory_order_relaxed);
+}
+
+void SetCPUAllocatorHugePage(bool enable) {
+    depot().huge_page.store(enable, std::memory_order_relaxed);
+}
+
+}   // end namespace otter
@@ -0,0 +1,60 @@
+//
+//  CPUSizeClassAllocator.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef CPUSizeClassAllocator_hpp
+#define CPUSizeClassAllocator_hpp
+
+#include <cstdint>
+
+#include "Allocator.hpp"
+
+namespace otter {
+
+// Caching allocator for the CPU tensors.
+// The requests are rounded up to a size class, four classes per power of two,
+// so the blocks are reused across close sizes with at most 25% waste.
+// Freed blocks go to a cache of the freeing thread first, then to a global depot
+// shared by every thread, and are returned to the OS above the cache limit.
+// Blocks made of whole 2MB pages are aligned and advised for transparent huge pages on Linux.
+class CPUSizeClassAllocator : public Allocator {
+public:
+    DataPtr allocate(size_t nbytes) const override;
+    
+    DeleterFnPtr raw_deleter() const override;
+    
+    static void deallocate(void* ptr);
+};
+
+Allocator* GetSizeClassCPUAllocator();
+
+struct CPUAllocatorStats {
+    size_t bytes_in_use = 0;        // Size class bytes held by the tensors
+    size_t bytes_cached = 0;        // Freed bytes kept in the thread caches and the depot
+    size_t peak_bytes_in_use = 0;
+    uint64_t allocations = 0;
+    uint64_t cache_hits = 0;        // Allocations served without asking the OS
+    
+    double hit_rate() const { return allocations ? double(cache_hits) / double(allocations) : 0; }
+};
+
+CPUAllocatorStats GetCPUAllocatorStats();
+
+// Restart the peak from the current bytes in use
+void ResetCPUAllocatorPeakStats();
+
+// Return the cached blocks of the calling thread and of the depot to the OS
+void EmptyCPUAllocatorCache();
+
+// Upper bound of the cached bytes of all threads, 512MB by default
+void SetCPUAllocatorMaxCachedBytes(size_t bytes);
+
+// Advise the blocks of 2MB and more for transparent huge pages, enabled by default
+void SetCPUAllocatorHugePage(bool enable);
+
+}   // end namespace otter
+
+#endif /* CPUSizeClassAllocator_hpp */
@@ -11,6 +11,12 @@
 #include "TensorFactory.hpp"
 #include "TensorResize.hpp"
 #include "Dispatch.hpp"
+#include "Parallel.hpp"
+#include "VecIntrinsic.hpp"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
 
 #if __ARM_NEON
 #include <arm_neon.h>
@@ -19,102 +25,907 @@
 namespace otter {
 namespace cv {
 
-void convertCheck(const Tensor& self, int in_channels);
+enum class ColorKind {
+    Gray,
+    Swap,
+    HSV,
+    YUV
+};
 
-Tensor convertRGBtoGray(const Tensor& self);
+// How the chroma of a row is stored, see YUVRow
+enum class ChromaKind {
+    NV,         // interleaved UV or VU, one pair for 2 pixels
+    Planar,     // U and V planes, one sample for 2 pixels
+    Full,       // U and V planes, one sample per pixel
+    YUYV        // Y0 U Y1 V
+};
 
-Tensor convertColor(const Tensor& self, int mode) {
+struct ColorOp {
+    ColorKind kind;
+    int scn;
+    int dcn;
+    int map[4];     // source channel of each output channel, -1 is an opaque alpha
+    bool bgr;
+    ChromaKind chroma;
+};
+
+static ColorOp color_op(int mode) {
     switch (mode) {
-        case RGB_TO_GRAY:
-            return convertRGBtoGray(self);
-            break;
-            
+        case RGB_TO_GRAY: return {ColorKind::Gray, 3, 1, {0, 1, 2, 0}, false, ChromaKind::NV};
+        case BGR_TO_GRAY: return {ColorKind::Gray, 3, 1, {2, 1, 0, 0}, true, ChromaKind::NV};
+
+        case RGB_TO_BGR:
+        case BGR_TO_RGB: return {ColorKind::Swap, 3, 3, {2, 1, 0, 0}, false, ChromaKind::NV};
+        case RGBA_TO_RGB:
+        case BGRA_TO_BGR: return {ColorKind::Swap, 4, 3, {0, 1, 2, 0}, false, ChromaKind::NV};
+        case RGBA_TO_BGR:
+        case BGRA_TO_RGB: return {ColorKind::Swap, 4, 3, {2, 1, 0, 0}, false, ChromaKind::NV};
+        case RGB_TO_RGBA:
+        case BGR_TO_BGRA: return {ColorKind::Swap, 3, 4, {0, 1, 2, -1}, false, ChromaKind::NV};
+        case RGB_TO_BGRA:
+        case BGR_TO_RGBA: return {ColorKind::Swap, 3, 4, {2, 1, 0, -1}, false, ChromaKind::NV};
+        case RGBA_TO_BGRA:
+        case BGRA_TO_RGBA: return {ColorKind::Swap, 4, 4, {2, 1, 0, 3}, false, ChromaKind::NV};
+
+        case RGB_TO_HSV: return {ColorKind::HSV, 3, 3, {0, 1, 2, 0}, false, ChromaKind::NV};
+        case BGR_TO_HSV: return {ColorKind::HSV, 3, 3, {2, 1, 0, 0}, true, ChromaKind::NV};
+
+        case NV12_TO_RGB:
+        case NV21_TO_RGB: return {ColorKind::YUV, 1, 3, {0, 0, 0, 0}, false, ChromaKind::NV};
+        case NV12_TO_BGR:
+        case NV21_TO_BGR: return {ColorKind::YUV, 1, 3, {0, 0, 0, 0}, true, ChromaKind::NV};
+        case I420_TO_RGB: return {ColorKind::YUV, 1, 3, {0, 0, 0, 0}, false, ChromaKind::Planar};
+        case I420_TO_BGR: return {ColorKind::YUV, 1, 3, {0, 0, 0, 0}, true, ChromaKind::Planar};
+        case YUYV_TO_RGB: return {ColorKind::YUV, 2, 3, {0, 0, 0, 0}, false, ChromaKind::YUYV};
+        case YUYV_TO_BGR: return {ColorKind::YUV, 2, 3, {0, 0, 0, 0}, true, ChromaKind::YUYV};
+
         default:
             break;
     }
     OTTER_CHECK(false, "Invalid convert mode!");
-    return Tensor();
+    return {};
 }
 
-void convertCheck(const Tensor& self, int in_channels) {
-    OTTER_CHECK(self.dim() == 3, "Expect input tensor has 3 dimensions but get ", self.dim());
-    OTTER_CHECK(self.size(2) == in_channels, "Expect input tensor has ", in_channels, " but get ", self.size(2));
+// round half up, the SIMD paths add 0.5 and truncate the same way
+static inline unsigned char saturate_byte(float v) {
+    int iv = (int)std::floor(v + 0.5f);
+    return (unsigned char)std::min(std::max(iv, 0), 255);
+}
+
+template <typename D>
+static inline D cast_pixel(float v) {
+    return static_cast<D>(v);
+}
+
+template <>
+inline unsigned char cast_pixel<unsigned char>(float v) {
+    return saturate_byte(v);
+}
+
+// ---------------------------------------------------------------------------------------------
+// YUV
+//
+// BT.601 limited range in 6 bits fixed point, evaluated with 16 bits saturating arithmetic
+// so that the scalar tail gives the same values as the SIMD bodies.
+// R = 1.164 (Y - 16) + 1.596 (V - 128)
+// G = 1.164 (Y - 16) - 0.813 (V - 128) - 0.391 (U - 128)
+// B = 1.164 (Y - 16) + 2.018 (U - 128)
+
+static constexpr int YUV_Y = 75;
+static constexpr int YUV_RV = 102;
+static constexpr int YUV_GV = 52;
+static constexpr int YUV_GU = 25;
+static constexpr int YUV_BU = 129;
+
+static inline int saturate_short(int v) {
+    return std::min(std::max(v, -32768), 32767);
+}
+
+static inline unsigned char yuv_channel(int v) {
+    return (unsigned char)std::min(std::max(v >> 6, 0), 255);
+}
+
+static inline void yuv_pixel(int y, int u, int v, unsigned char* dst, bool bgr) {
+    const int yy = (y - 16) * YUV_Y + 32;
+    const int uu = u - 128;
+    const int vv = v - 128;
+
+    const unsigned char r = yuv_channel(saturate_short(yy + vv * YUV_RV));
+    const unsigned char g = yuv_channel(saturate_short(saturate_short(yy - vv * YUV_GV) - uu * YUV_GU));
+    const unsigned char b = yuv_channel(saturate_short(yy + uu * YUV_BU));
+
+    dst[0] = bgr ? b : r;
+    dst[1] = g;
+    dst[2] = bgr ? r : b;
+}
+
+// Pixel x of the row is y[x * y_step], its chroma is u[(x >> uv_shift) * uv_step] and v[...]
+struct YUVRow {
+    const unsigned char* y;
+    const unsigned char* u;
+    const unsigned char* v;
+    int y_step;
+    int uv_step;
+    int uv_shift;
+};
+
+static YUVRow yuv_row(ChromaKind chroma, const unsigned char* y, const unsigned char* u, const unsigned char* v) {
+    switch (chroma) {
+        case ChromaKind::NV: return {y, u, v, 1, 2, 1};
+        case ChromaKind::Planar: return {y, u, v, 1, 1, 1};
+        case ChromaKind::Full: return {y, u, v, 1, 1, 0};
+        case ChromaKind::YUYV: return {y, y + 1, y + 3, 2, 4, 1};
+    }
+    return {};
+}
+
+#if __AVX2__
+struct InterleaveMasks {
+    // masks[k][c] picks the bytes of channel c going to the k-th 16 bytes of 16 interleaved pixels
+    __m128i masks[3][3];
+
+    InterleaveMasks() {
+        alignas(16) unsigned char bytes[16];
+        for (int k = 0; k < 3; ++k) {
+            for (int c = 0; c < 3; ++c) {
+                for (int p = 0; p < 16; ++p) {
+                    const int q = 16 * k + p;
+                    bytes[p] = (q % 3 == c) ? (unsigned char)(q / 3) : 0x80;
+                }
+                masks[k][c] = _mm_load_si128((const __m128i*)bytes);
+            }
+        }
+    }
+};
+
+static inline void store_rgb16(__m128i c0, __m128i c1, __m128i c2, unsigned char* dst, const InterleaveMasks& m) {
+    for (int k = 0; k < 3; ++k) {
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, m.masks[k][0]), _mm_shuffle_epi8(c1, m.masks[k][1])), _mm_shuffle_epi8(c2, m.masks[k][2]));
+        _mm_storeu_si128((__m128i*)(dst + 16 * k), out);
+    }
+}
+
+// 16 pixels, u and v hold one sample per pixel
+static inline void yuv16_to_rgb(__m128i y, __m128i u, __m128i v, unsigned char* dst, bool bgr, const InterleaveMasks& m) {
+    const __m256i y16 = _mm256_cvtepu8_epi16(y);
+    const __m256i u16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(u), _mm256_set1_epi16(128));
+    const __m256i v16 = _mm256_sub_epi16(_mm256_cvtepu8_epi16(v), _mm256_set1_epi16(128));
+
+    const __m256i yy = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_sub_epi16(y16, _mm256_set1_epi16(16)), _mm256_set1_epi16(YUV_Y)), _mm256_set1_epi16(32));
+
+    const __m256i r = _mm256_srai_epi16(_mm256_adds_epi16(yy, _mm256_mullo_epi16(v16, _mm256_set1_epi16(YUV_RV))), 6);
+    const __m256i g = _mm256_srai_epi16(_mm256_subs_epi16(_mm256_subs_epi16(yy, _mm256_mullo_epi16(v16, _mm256_set1_epi16(YUV_GV))), _mm256_mullo_epi16(u16, _mm256_set1_epi16(YUV_GU))), 6);
+    const __m256i b = _mm256_srai_epi16(_mm256_adds_epi16(yy, _mm256_mullo_epi16(u16, _mm256_set1_epi16(YUV_BU))), 6);
+
+    const __m128i r8 = _mm_packus_epi16(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+    const __m128i g8 = _mm_packus_epi16(_mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1));
+    const __m128i b8 = _mm_packus_epi16(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1));
+
+    store_rgb16(bgr ? b8 : r8, g8, bgr ? r8 : b8, dst, m);
+}
+
+struct DeinterleaveMasks {
+    // masks[c][k] picks the bytes of channel c from the k-th 16 bytes of 16 interleaved pixels
+    __m128i masks[3][3];
+
+    DeinterleaveMasks() {
+        alignas(16) unsigned char bytes[16];
+        for (int c = 0; c < 3; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                for (int p = 0; p < 16; ++p) {
+                    const int q = 3 * p + c;
+                    bytes[p] = (q / 16 == k) ? (unsigned char)(q % 16) : 0x80;
+                }
+                masks[c][k] = _mm_load_si128((const __m128i*)bytes);
+            }
+        }
+    }
+};
+
+static inline __m128i load_channel16(const __m128i* blocks, const DeinterleaveMasks& m, int c) {
+    return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(blocks[0], m.masks[c][0]), _mm_shuffle_epi8(blocks[1], m.masks[c][1])), _mm_shuffle_epi8(blocks[2], m.masks[c][2]));
+}
+
+// 16 int32 (two halves of 8 pixels) to 16 saturated bytes
+static inline __m128i pack_byte16(__m256i a, __m256i b) {
+    __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+}
+#endif // __AVX2__
+
+#if __ARM_NEON
+static inline void yuv8_to_rgb(uint8x8_t y, uint8x8_t u, uint8x8_t v, uint8x8_t* r8, uint8x8_t* g8, uint8x8_t* b8) {
+    const int16x8_t y16 = vreinterpretq_s16_u16(vmovl_u8(y));
+    const int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+    const int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+
+    const int16x8_t yy = vaddq_s16(vmulq_n_s16(vsubq_s16(y16, vdupq_n_s16(16)), YUV_Y), vdupq_n_s16(32));
+
+    *r8 = vqshrun_n_s16(vqaddq_s16(yy, vmulq_n_s16(v16, YUV_RV)), 6);
+    *g8 = vqshrun_n_s16(vqsubq_s16(vqsubq_s16(yy, vmulq_n_s16(v16, YUV_GV)), vmulq_n_s16(u16, YUV_GU)), 6);
+    *b8 = vqshrun_n_s16(vqaddq_s16(yy, vmulq_n_s16(u16, YUV_BU)), 6);
 }
 
-Tensor convertRGBtoGray(const Tensor& self) {
-    convertCheck(self, 3);
-    
-    auto out = otter::empty({self.size(0), self.size(1), 1}, otter::ScalarType::Float);
-    
+// 16 pixels, u and v hold one sample per pixel
+static inline void yuv16_to_rgb(uint8x16_t y, uint8x16_t u, uint8x16_t v, unsigned char* dst, bool bgr) {
+    uint8x8x3_t lo;
+    uint8x8x3_t hi;
+    yuv8_to_rgb(vget_low_u8(y), vget_low_u8(u), vget_low_u8(v), &lo.val[0], &lo.val[1], &lo.val[2]);
+    yuv8_to_rgb(vget_high_u8(y), vget_high_u8(u), vget_high_u8(v), &hi.val[0], &hi.val[1], &hi.val[2]);
+    if (bgr) {
+        std::swap(lo.val[0], lo.val[2]);
+        std::swap(hi.val[0], hi.val[2]);
+    }
+    vst3_u8(dst, lo);
+    vst3_u8(dst + 24, hi);
+}
+
+static inline uint8x16_t duplicate_u8(uint8x8_t a) {
+    uint8x8x2_t z = vzip_u8(a, a);
+    return vcombine_u8(z.val[0], z.val[1]);
+}
+#endif // __ARM_NEON
+
+template <ChromaKind Chroma>
+static void yuv_row_to_rgb(const YUVRow& row, int w, unsigned char* dst, bool bgr) {
+    int x = 0;
+
+#if __AVX2__
+    static const InterleaveMasks masks;
+    const __m128i even = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i odd = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+    const __m128i yuyv_y = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yuyv_u = _mm_setr_epi8(1, 1, 5, 5, 9, 9, 13, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i yuyv_v = _mm_setr_epi8(3, 3, 7, 7, 11, 11, 15, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    for (; x + 16 <= w; x += 16) {
+        __m128i y, u, v;
+        if (Chroma == ChromaKind::NV) {
+            y = _mm_loadu_si128((const __m128i*)(row.y + x));
+            const bool u_first = row.u < row.v;
+            const __m128i uv = _mm_loadu_si128((const __m128i*)((u_first ? row.u : row.v) + x));
+            u = _mm_shuffle_epi8(uv, u_first ? even : odd);
+            v = _mm_shuffle_epi8(uv, u_first ? odd : even);
+        } else if (Chroma == ChromaKind::Planar) {
+            y = _mm_loadu_si128((const __m128i*)(row.y + x));
+            u = _mm_loadl_epi64((const __m128i*)(row.u + x / 2));
+            v = _mm_loadl_epi64((const __m128i*)(row.v + x / 2));
+            u = _mm_unpacklo_epi8(u, u);
+            v = _mm_unpacklo_epi8(v, v);
+        } else if (Chroma == ChromaKind::Full) {
+            y = _mm_loadu_si128((const __m128i*)(row.y + x));
+            u = _mm_loadu_si128((const __m128i*)(row.u + x));
+            v = _mm_loadu_si128((const __m128i*)(row.v + x));
+        } else {
+            const __m128i a = _mm_loadu_si128((const __m128i*)(row.y + x * 2));
+            const __m128i b = _mm_loadu_si128((const __m128i*)(row.y + x * 2 + 16));
+            y = _mm_unpacklo_epi64(_mm_shuffle_epi8(a, yuyv_y), _mm_shuffle_epi8(b, yuyv_y));
+            u = _mm_unpacklo_epi64(_mm_shuffle_epi8(a, yuyv_u), _mm_shuffle_epi8(b, yuyv_u));
+            v = _mm_unpacklo_epi64(_mm_shuffle_epi8(a, yuyv_v), _mm_shuffle_epi8(b, yuyv_v));
+        }
+        yuv16_to_rgb(y, u, v, dst + x * 3, bgr, masks);
+    }
+#elif __ARM_NEON
+    for (; x + 16 <= w; x += 16) {
+        uint8x16_t y, u, v;
+        if (Chroma == ChromaKind::NV) {
+            y = vld1q_u8(row.y + x);
+            const bool u_first = row.u < row.v;
+            uint8x8x2_t uv = vld2_u8((u_first ? row.u : row.v) + x);
+            u = duplicate_u8(u_first ? uv.val[0] : uv.val[1]);
+            v = duplicate_u8(u_first ? uv.val[1] : uv.val[0]);
+        } else if (Chroma == ChromaKind::Planar) {
+            y = vld1q_u8(row.y + x);
+            u = duplicate_u8(vld1_u8(row.u + x / 2));
+            v = duplicate_u8(vld1_u8(row.v + x / 2));
+        } else if (Chroma == ChromaKind::Full) {
+            y = vld1q_u8(row.y + x);
+            u = vld1q_u8(row.u + x);
+            v = vld1q_u8(row.v + x);
+        } else {
+            uint8x8x4_t yuyv = vld4_u8(row.y + x * 2);
+            uint8x8x2_t yz = vzip_u8(yuyv.val[0], yuyv.val[2]);
+            y = vcombine_u8(yz.val[0], yz.val[1]);
+            u = duplicate_u8(yuyv.val[1]);
+            v = duplicate_u8(yuyv.val[3]);
+        }
+        yuv16_to_rgb(y, u, v, dst + x * 3, bgr);
+    }
+#endif
+
+    for (; x < w; ++x) {
+        const int c = (x >> row.uv_shift) * row.uv_step;
+        yuv_pixel(row.y[x * row.y_step], row.u[c], row.v[c], dst + x * 3, bgr);
+    }
+}
+
+static void yuv_row_to_rgb(ChromaKind chroma, const YUVRow& row, int w, unsigned char* dst, bool bgr) {
+    switch (chroma) {
+        case ChromaKind::NV: return yuv_row_to_rgb<ChromaKind::NV>(row, w, dst, bgr);
+        case ChromaKind::Planar: return yuv_row_to_rgb<ChromaKind::Planar>(row, w, dst, bgr);
+        case ChromaKind::Full: return yuv_row_to_rgb<ChromaKind::Full>(row, w, dst, bgr);
+        case ChromaKind::YUYV: return yuv_row_to_rgb<ChromaKind::YUYV>(row, w, dst, bgr);
+    }
+}
+
+template <typename D>
+static void store_row(const unsigned char* src, D* dst, int64_t n) {
+    for (int64_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<D>(src[i]);
+    }
+}
+
+void yuv420_to_rgb(const unsigned char* y, int y_stride, const unsigned char* u, const unsigned char* v, int uv_stride, int w, int h, unsigned char* dst, int dst_stride, int mode) {
+    const ColorOp op = color_op(mode);
+    OTTER_CHECK(op.kind == ColorKind::YUV && op.chroma != ChromaKind::YUYV, "yuv420_to_rgb expects a NV12, NV21 or I420 mode");
+
+    otter::parallel_for(0, h, 0, [&](int64_t begin, int64_t end) {
+        for (const auto i : otter::irange(begin, end)) {
+            const int64_t c = (i / 2) * uv_stride;
+            const YUVRow row = yuv_row(op.chroma, y + i * y_stride, u + c, v + c);
+            yuv_row_to_rgb(op.chroma, row, w, dst + i * dst_stride, op.bgr);
+        }
+    });
+}
+
+// ---------------------------------------------------------------------------------------------
+// Channel swap
+
+#if __AVX2__
+// pshufb masks moving 16 / max(scn, dcn) pixels per 16 bytes, a missing source channel is 0 and
+// the alpha mask fills it with 255
+static void swap_masks(const ColorOp& op, __m128i* shuffle, __m128i* alpha) {
+    alignas(16) unsigned char s[16];
+    alignas(16) unsigned char a[16];
+    const int pixels = 16 / std::max(op.scn, op.dcn);
+    for (int p = 0; p < 16; ++p) {
+        const int pixel = p / op.dcn;
+        const int c = p % op.dcn;
+        s[p] = 0x80;
+        a[p] = 0;
+        if (pixel < pixels) {
+            if (op.map[c] < 0)
+                a[p] = 0xFF;
+            else
+                s[p] = (unsigned char)(pixel * op.scn + op.map[c]);
+        }
+    }
+    *shuffle = _mm_load_si128((const __m128i*)s);
+    *alpha = _mm_load_si128((const __m128i*)a);
+}
+#endif // __AVX2__
+
+#if __ARM_NEON
+template <int scn, int dcn>
+static int swap_row_neon(const ColorOp& op, const unsigned char* src, unsigned char* dst, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t in[4];
+        if (scn == 3) {
+            uint8x16x3_t v = vld3q_u8(src + i * 3);
+            in[0] = v.val[0];
+            in[1] = v.val[1];
+            in[2] = v.val[2];
+        } else {
+            uint8x16x4_t v = vld4q_u8(src + i * 4);
+            in[0] = v.val[0];
+            in[1] = v.val[1];
+            in[2] = v.val[2];
+            in[3] = v.val[3];
+        }
+
+        uint8x16_t out[4];
+        for (int c = 0; c < dcn; ++c) {
+            out[c] = op.map[c] < 0 ? vdupq_n_u8(255) : in[op.map[c]];
+        }
+
+        if (dcn == 3) {
+            uint8x16x3_t v = {{out[0], out[1], out[2]}};
+            vst3q_u8(dst + i * 3, v);
+        } else {
+            uint8x16x4_t v = {{out[0], out[1], out[2], out[3]}};
+            vst4q_u8(dst + i * 4, v);
+        }
+    }
+    return i;
+}
+#endif // __ARM_NEON
+
+template <typename S, typename D>
+static void swap_row(const ColorOp& op, const S* src, D* dst, int n) {
+    int i = 0;
+
+    if (std::is_same<S, unsigned char>::value && std::is_same<D, unsigned char>::value) {
+        const unsigned char* src8 = (const unsigned char*)src;
+        unsigned char* dst8 = (unsigned char*)dst;
+#if __AVX2__
+        __m128i shuffle, alpha;
+        swap_masks(op, &shuffle, &alpha);
+        const int pixels = 16 / std::max(op.scn, op.dcn);
+        // every iteration reads and writes 16 bytes but only moves pixels pixels,
+        // the extra bytes are rewritten by the next iteration or the tail
+        for (; (i * op.scn + 16 <= n * op.scn) && (i * op.dcn + 16 <= n * op.dcn); i += pixels) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(src8 + i * op.scn));
+            v = _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha);
+            _mm_storeu_si128((__m128i*)(dst8 + i * op.dcn), v);
+        }
+#elif __ARM_NEON
+        if (op.scn == 3 && op.dcn == 3) i = swap_row_neon<3, 3>(op, src8, dst8, n);
+        else if (op.scn == 3 && op.dcn == 4) i = swap_row_neon<3, 4>(op, src8, dst8, n);
+        else if (op.scn == 4 && op.dcn == 3) i = swap_row_neon<4, 3>(op, src8, dst8, n);
+        else i = swap_row_neon<4, 4>(op, src8, dst8, n);
+#else
+        (void)src8;
+        (void)dst8;
+#endif
+    }
+
+    const D opaque = static_cast<D>(255);
+    for (; i < n; ++i) {
+        const S* s = src + i * op.scn;
+        D* d = dst + i * op.dcn;
+        for (int c = 0; c < op.dcn; ++c) {
+            d[c] = op.map[c] < 0 ? opaque : static_cast<D>(s[op.map[c]]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Gray and HSV
+
+template <typename S, typename D>
+static void gray_row(const ColorOp& op, const S* src, D* dst, int n) {
     const unsigned char Y_shift = 8; //14
     const unsigned char R2Y = 77;
     const unsigned char G2Y = 150;
     const unsigned char B2Y = 29;
-    
-    int w = (int)(self.size(0) * self.size(1));
-    
-    // Byte neon optimize
-    if (self.scalar_type() == otter::ScalarType::Byte) {
-        unsigned char *rgb = self.data_ptr<unsigned char>();
-        float *ptr = out.data_ptr<float>();
-        
-#if __ARM_NEON
-        int nn = w >> 3;
-        int remain = w - (nn << 3);
-#else
-        int remain = w;
-#endif // __ARM_NEON
-        
-        
+
+    const int r = op.map[0];
+    const int b = op.map[2];
+    int i = 0;
+
 #if __ARM_NEON
 #if __aarch64__
+    if (std::is_same<S, unsigned char>::value && std::is_same<D, float>::value) {
+        const unsigned char* rgb = (const unsigned char*)src;
+        float* ptr = (float*)dst;
         uint8x8_t _R2Y = vdup_n_u8(R2Y);
         uint8x8_t _G2Y = vdup_n_u8(G2Y);
         uint8x8_t _B2Y = vdup_n_u8(B2Y);
-        for (; nn > 0; nn--) {
-            uint8x8x3_t _rgb = vld3_u8(rgb);
-            
-            uint16x8_t _y16 = vmull_u8(_rgb.val[0], _R2Y);
+        for (; i + 8 <= n; i += 8) {
+            uint8x8x3_t _rgb = vld3_u8(rgb + i * 3);
+
+            uint16x8_t _y16 = vmull_u8(_rgb.val[r], _R2Y);
             _y16 = vmlal_u8(_y16, _rgb.val[1], _G2Y);
-            _y16 = vmlal_u8(_y16, _rgb.val[2], _B2Y);
+            _y16 = vmlal_u8(_y16, _rgb.val[b], _B2Y);
             _y16 = vshrq_n_u16(_y16, Y_shift);
-            
+
             float32x4_t _ylow = vcvtq_f32_u32(vmovl_u16(vget_low_u16(_y16)));
             float32x4_t _yhigh = vcvtq_f32_u32(vmovl_u16(vget_high_u16(_y16)));
-            
-            vst1q_f32(ptr, _ylow);
-            vst1q_f32(ptr + 4, _yhigh);
-            
-            rgb += 3 * 8;
-            ptr += 8;
+
+            vst1q_f32(ptr + i, _ylow);
+            vst1q_f32(ptr + i + 4, _yhigh);
         }
-#else
-        
+    }
 #endif // __aarch64__
 #endif // __ARM_NEON
-        
-        for (; remain > 0; remain--) {
-            *ptr = static_cast<unsigned char>((rgb[0] * R2Y + rgb[1] * G2Y + rgb[2] * B2Y) >> Y_shift);
-            
-            rgb += 3;
-            ptr++;
+
+    for (; i < n; ++i) {
+        const S* s = src + i * 3;
+        if constexpr (std::is_same<S, unsigned char>::value) {
+            dst[i] = static_cast<D>((s[r] * R2Y + s[1] * G2Y + s[b] * B2Y) >> Y_shift);
+        } else {
+            dst[i] = cast_pixel<D>((s[r] * R2Y + s[1] * G2Y + s[b] * B2Y) / (float)(1 << Y_shift));
+        }
+    }
+}
+
+#if __AVX2__
+static inline void hsv8(__m256 r, __m256 g, __m256 b, __m256* h, __m256* s, __m256* v) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 max = _mm256_max_ps(_mm256_max_ps(r, g), b);
+    const __m256 diff = _mm256_sub_ps(max, _mm256_min_ps(_mm256_min_ps(r, g), b));
+
+    // lanes with max == 0 or diff == 0 divide by zero, they are masked out
+    const __m256 sat = _mm256_div_ps(_mm256_mul_ps(diff, _mm256_set1_ps(255.f)), max);
+    *s = _mm256_blendv_ps(sat, zero, _mm256_cmp_ps(max, zero, _CMP_LE_OQ));
+
+    const __m256 scale = _mm256_div_ps(_mm256_set1_ps(60.f), diff);
+    const __m256 hr = _mm256_mul_ps(_mm256_sub_ps(g, b), scale);
+    const __m256 hg = _mm256_add_ps(_mm256_set1_ps(120.f), _mm256_mul_ps(_mm256_sub_ps(b, r), scale));
+    const __m256 hb = _mm256_add_ps(_mm256_set1_ps(240.f), _mm256_mul_ps(_mm256_sub_ps(r, g), scale));
+
+    __m256 hue = hb;
+    hue = _mm256_blendv_ps(hue, hg, _mm256_cmp_ps(max, g, _CMP_EQ_OQ));
+    hue = _mm256_blendv_ps(hue, hr, _mm256_cmp_ps(max, r, _CMP_EQ_OQ));
+    hue = _mm256_add_ps(hue, _mm256_and_ps(_mm256_cmp_ps(hue, zero, _CMP_LT_OQ), _mm256_set1_ps(360.f)));
+    hue = _mm256_blendv_ps(hue, zero, _mm256_cmp_ps(diff, zero, _CMP_LE_OQ));
+
+    *h = _mm256_mul_ps(hue, _mm256_set1_ps(0.5f));
+    *v = max;
+}
+
+// h, s and v are not negative
+static inline __m256i round_epi32(__m256 x) {
+    return _mm256_cvttps_epi32(_mm256_add_ps(x, _mm256_set1_ps(0.5f)));
+}
+
+static inline __m256i hue_byte8(__m256 h) {
+    __m256i hi = round_epi32(h);
+    return _mm256_sub_epi32(hi, _mm256_and_si256(_mm256_cmpgt_epi32(hi, _mm256_set1_epi32(179)), _mm256_set1_epi32(180)));
+}
+
+// 16 Byte pixels to HSV
+template <typename D>
+static inline void hsv16(const unsigned char* src, D* dst, int ri, int bi, const DeinterleaveMasks& dm, const InterleaveMasks& im) {
+    __m128i blocks[3];
+    blocks[0] = _mm_loadu_si128((const __m128i*)src);
+    blocks[1] = _mm_loadu_si128((const __m128i*)(src + 16));
+    blocks[2] = _mm_loadu_si128((const __m128i*)(src + 32));
+
+    const __m128i r8 = load_channel16(blocks, dm, ri);
+    const __m128i g8 = load_channel16(blocks, dm, 1);
+    const __m128i b8 = load_channel16(blocks, dm, bi);
+
+    __m256 h[2], s[2], v[2];
+    for (int half = 0; half < 2; ++half) {
+        const __m256 r = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(half ? _mm_srli_si128(r8, 8) : r8));
+        const __m256 g = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(half ? _mm_srli_si128(g8, 8) : g8));
+        const __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(half ? _mm_srli_si128(b8, 8) : b8));
+        hsv8(r, g, b, &h[half], &s[half], &v[half]);
+    }
+
+    if constexpr (std::is_same<D, unsigned char>::value) {
+        const __m128i h8 = pack_byte16(hue_byte8(h[0]), hue_byte8(h[1]));
+        const __m128i s8 = pack_byte16(round_epi32(s[0]), round_epi32(s[1]));
+        const __m128i v8 = pack_byte16(round_epi32(v[0]), round_epi32(v[1]));
+        store_rgb16(h8, s8, v8, (unsigned char*)dst, im);
+    } else {
+        alignas(32) float hs[16], ss[16], vs[16];
+        _mm256_store_ps(hs, h[0]);
+        _mm256_store_ps(hs + 8, h[1]);
+        _mm256_store_ps(ss, s[0]);
+        _mm256_store_ps(ss + 8, s[1]);
+        _mm256_store_ps(vs, v[0]);
+        _mm256_store_ps(vs + 8, v[1]);
+        for (int i = 0; i < 16; ++i) {
+            dst[i * 3 + 0] = hs[i];
+            dst[i * 3 + 1] = ss[i];
+            dst[i * 3 + 2] = vs[i];
+        }
+    }
+}
+#endif // __AVX2__
+
+template <typename S, typename D>
+static void hsv_row(const ColorOp& op, const S* src, D* dst, int n) {
+    const int ri = op.map[0];
+    const int bi = op.map[2];
+    int i = 0;
+
+#if __AVX2__
+    if constexpr (std::is_same<S, unsigned char>::value) {
+        static const DeinterleaveMasks dm;
+        static const InterleaveMasks im;
+        for (; i + 16 <= n; i += 16) {
+            hsv16<D>(src + i * 3, dst + i * 3, ri, bi, dm, im);
+        }
+    }
+#endif // __AVX2__
+
+    for (; i < n; ++i) {
+        const S* s = src + i * 3;
+        const float r = s[ri];
+        const float g = s[1];
+        const float b = s[bi];
+
+        const float v = std::max(std::max(r, g), b);
+        const float diff = v - std::min(std::min(r, g), b);
+        const float sat = v > 0 ? diff * 255.f / v : 0.f;
+
+        float h = 0;
+        if (diff > 0) {
+            const float scale = 60.f / diff;
+            if (v == r)
+                h = (g - b) * scale;
+            else if (v == g)
+                h = 120.f + (b - r) * scale;
+            else
+                h = 240.f + (r - g) * scale;
+            if (h < 0)
+                h += 360.f;
+        }
+        h *= 0.5f;
+
+        D* d = dst + i * 3;
+        if (std::is_same<D, unsigned char>::value) {
+            const unsigned char hb = saturate_byte(h);
+            d[0] = static_cast<D>(hb >= 180 ? hb - 180 : hb);
+        } else {
+            d[0] = static_cast<D>(h);
+        }
+        d[1] = cast_pixel<D>(sat);
+        d[2] = cast_pixel<D>(v);
+    }
+}
+
+template <typename S, typename D>
+static void color_row(const ColorOp& op, const S* src, D* dst, int n) {
+    switch (op.kind) {
+        case ColorKind::Gray: return gray_row<S, D>(op, src, dst, n);
+        case ColorKind::Swap: return swap_row<S, D>(op, src, dst, n);
+        case ColorKind::HSV: return hsv_row<S, D>(op, src, dst, n);
+        default: break;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Bilinear row sampling for the fused resize, same coordinates as the OpenCV linear resize
+
+static constexpr int RESIZE_BITS = 11;
+static constexpr int RESIZE_ONE = 1 << RESIZE_BITS;
+
+struct LinearTable {
+    std::vector<int> i0;
+    std::vector<int> i1;
+    std::vector<int> a;     // weight of i1 in RESIZE_BITS fixed point
+};
+
+static LinearTable linear_table(int src, int dst) {
+    LinearTable table;
+    table.i0.resize(dst);
+    table.i1.resize(dst);
+    table.a.resize(dst);
+
+    const double scale = (double)src / dst;
+    for (int i = 0; i < dst; ++i) {
+        double f = (i + 0.5) * scale - 0.5;
+        int i0 = (int)std::floor(f);
+        f -= i0;
+        if (i0 < 0) {
+            i0 = 0;
+            f = 0;
+        }
+        if (i0 >= src - 1) {
+            i0 = src - 1;
+            f = 0;
+        }
+        table.i0[i] = i0;
+        table.i1[i] = std::min(i0 + 1, src - 1);
+        table.a[i] = (int)std::lround(f * RESIZE_ONE);
+    }
+    return table;
+}
+
+// out[x * out_step] = bilinear sample of the rows row0 / row1 (elements src_step apart)
+static void resize_row(const unsigned char* row0, const unsigned char* row1, int ay, int src_step, const LinearTable& tx, unsigned char* out, int out_step) {
+    const int n = (int)tx.i0.size();
+    const int by = RESIZE_ONE - ay;
+    for (int x = 0; x < n; ++x) {
+        const int o0 = tx.i0[x] * src_step;
+        const int o1 = tx.i1[x] * src_step;
+        const int ax = tx.a[x];
+        const int bx = RESIZE_ONE - ax;
+        const int top = row0[o0] * bx + row0[o1] * ax;
+        const int bottom = row1[o0] * bx + row1[o1] * ax;
+        out[x * out_step] = (unsigned char)((top * by + bottom * ay + (1 << (2 * RESIZE_BITS - 1))) >> (2 * RESIZE_BITS));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+
+struct YUVImage {
+    int h;
+    int w;
+    const unsigned char* y;
+    const unsigned char* u;
+    const unsigned char* v;
+    int64_t y_stride;
+    int64_t uv_stride;
+};
+
+static YUVImage yuv_image(const Tensor& self, int mode, const ColorOp& op) {
+    OTTER_CHECK(self.scalar_type() == ScalarType::Byte, "Expect Byte input for YUV conversion but get ", self.scalar_type());
+    OTTER_CHECK(self.is_contiguous(), "Expect contiguous input for YUV conversion");
+
+    YUVImage image;
+    const unsigned char* data = self.data_ptr<unsigned char>();
+
+    if (op.chroma == ChromaKind::YUYV) {
+        OTTER_CHECK(self.dim() == 3 && self.size(2) == 2, "Expect YUYV input with shape (h, w, 2)");
+        image.h = (int)self.size(0);
+        image.w = (int)self.size(1);
+        OTTER_CHECK(image.w % 2 == 0, "Expect even width for YUYV but get ", image.w);
+        image.y = data;
+        image.u = data + 1;
+        image.v = data + 3;
+        image.y_stride = image.w * 2;
+        image.uv_stride = image.w * 2;
+        return image;
+    }
+
+    OTTER_CHECK(self.dim() == 2 || (self.dim() == 3 && self.size(2) == 1), "Expect YUV420 input with shape (h * 3 / 2, w)");
+    OTTER_CHECK(self.size(0) % 3 == 0, "Expect YUV420 input with h * 3 / 2 rows but get ", self.size(0));
+    image.h = (int)(self.size(0) / 3 * 2);
+    image.w = (int)self.size(1);
+    OTTER_CHECK(image.h % 2 == 0 && image.w % 2 == 0, "Expect even size for YUV420 but get ", image.h, "x", image.w);
+
+    const unsigned char* chroma = data + (int64_t)image.h * image.w;
+    image.y = data;
+    image.y_stride = image.w;
+
+    if (op.chroma == ChromaKind::Planar) {
+        image.u = chroma;
+        image.v = chroma + (int64_t)image.h / 2 * image.w / 2;
+        image.uv_stride = image.w / 2;
+    } else {
+        const bool nv21 = (mode == NV21_TO_RGB || mode == NV21_TO_BGR);
+        image.u = chroma + (nv21 ? 1 : 0);
+        image.v = chroma + (nv21 ? 0 : 1);
+        image.uv_stride = image.w;
+    }
+    return image;
+}
+
+template <typename D>
+static void convert_yuv(const YUVImage& image, const ColorOp& op, D* out) {
+    const int w = image.w;
+
+    otter::parallel_for(0, image.h, 0, [&](int64_t begin, int64_t end) {
+        std::vector<unsigned char> buffer(std::is_same<D, unsigned char>::value ? 0 : w * 3);
+
+        for (const auto i : otter::irange(begin, end)) {
+            const int64_t c = (op.chroma == ChromaKind::YUYV) ? i * image.uv_stride : (i / 2) * image.uv_stride;
+            const YUVRow row = yuv_row(op.chroma, image.y + i * image.y_stride, image.u + c, image.v + c);
+            D* dst = out + i * w * 3;
+
+            if (std::is_same<D, unsigned char>::value) {
+                yuv_row_to_rgb(op.chroma, row, w, (unsigned char*)dst, op.bgr);
+            } else {
+                yuv_row_to_rgb(op.chroma, row, w, buffer.data(), op.bgr);
+                store_row(buffer.data(), dst, w * 3);
+            }
         }
+    });
+}
+
+template <typename S, typename D>
+static void convert_rows(const ColorOp& op, const S* src, D* dst, int64_t h, int64_t w) {
+    otter::parallel_for(0, h, 0, [&](int64_t begin, int64_t end) {
+        for (const auto i : otter::irange(begin, end)) {
+            color_row<S, D>(op, src + i * w * op.scn, dst + i * w * op.dcn, (int)w);
+        }
+    });
+}
+
+Tensor convertColor(const Tensor& self, int mode) {
+    const bool gray = (mode == RGB_TO_GRAY || mode == BGR_TO_GRAY);
+
+    return convertColor(self, mode, gray ? ScalarType::Float : self.scalar_type());
+}
+
+Tensor convertColor(const Tensor& self, int mode, ScalarType dtype) {
+    const ColorOp op = color_op(mode);
+    OTTER_CHECK(dtype == ScalarType::Byte || dtype == ScalarType::Float, "Expect Byte or Float output but get ", dtype);
+
+    if (op.kind == ColorKind::YUV) {
+        const YUVImage image = yuv_image(self, mode, op);
+        Tensor out = otter::empty({image.h, image.w, 3}, dtype);
+        if (dtype == ScalarType::Byte)
+            convert_yuv(image, op, out.data_ptr<unsigned char>());
+        else
+            convert_yuv(image, op, out.data_ptr<float>());
+        return out;
+    }
+
+    OTTER_CHECK(self.dim() == 3, "Expect input tensor has 3 dimensions but get ", self.dim());
+    OTTER_CHECK(self.size(2) == op.scn, "Expect input tensor has ", op.scn, " channels but get ", self.size(2));
+    OTTER_CHECK(self.scalar_type() == ScalarType::Byte || self.scalar_type() == ScalarType::Float, "Expect Byte or Float input but get ", self.scalar_type());
+
+    const Tensor input = self.contiguous();
+    const int64_t h = input.size(0);
+    const int64_t w = input.size(1);
+    Tensor out = otter::empty({h, w, op.dcn}, dtype);
+
+    if (input.scalar_type() == ScalarType::Byte) {
+        if (dtype == ScalarType::Byte)
+            convert_rows(op, input.data_ptr<unsigned char>(), out.data_ptr<unsigned char>(), h, w);
+        else
+            convert_rows(op, input.data_ptr<unsigned char>(), out.data_ptr<float>(), h, w);
     } else {
-        int remain = w;
-        
-        OTTER_DISPATCH_ALL_TYPES(self.scalar_type(), "RGBtoGray", [&] {
-            unsigned char *rgb = self.data_ptr<unsigned char>();
-            scalar_t *ptr = out.data_ptr<scalar_t>();
-            
-            for (; remain > 0; remain--) {
-                *ptr = static_cast<scalar_t>((rgb[0] * R2Y + rgb[1] * G2Y + rgb[2] * B2Y) >> Y_shift);
-                
-                rgb += 3;
-                ptr++;
+        if (dtype == ScalarType::Byte)
+            convert_rows(op, input.data_ptr<float>(), out.data_ptr<unsigned char>(), h, w);
+        else
+            convert_rows(op, input.data_ptr<float>(), out.data_ptr<float>(), h, w);
+    }
+
+    return out;
+}
+
+template <typename D>
+static void convert_yuv_resize(const YUVImage& image, const ColorOp& op, D* out, int out_h, int out_w) {
+    const int chroma_w = image.w / 2;
+    const int chroma_h = (op.chroma == ChromaKind::YUYV) ? image.h : image.h / 2;
+    const int y_step = (op.chroma == ChromaKind::YUYV) ? 2 : 1;
+    const int uv_step = (op.chroma == ChromaKind::YUYV) ? 4 : (op.chroma == ChromaKind::NV) ? 2 : 1;
+
+    const LinearTable luma_x = linear_table(image.w, out_w);
+    const LinearTable luma_y = linear_table(image.h, out_h);
+    const LinearTable chroma_x = linear_table(chroma_w, out_w);
+    const LinearTable chroma_y = linear_table(chroma_h, out_h);
+
+    otter::parallel_for(0, out_h, 0, [&](int64_t begin, int64_t end) {
+        // resampled Y, U, V rows with one sample per output pixel, then the packed output
+        std::vector<unsigned char> planes(out_w * 3);
+        std::vector<unsigned char> buffer(std::is_same<D, unsigned char>::value ? 0 : out_w * 3);
+        unsigned char* y = planes.data();
+        unsigned char* u = y + out_w;
+        unsigned char* v = u + out_w;
+
+        for (const auto i : otter::irange(begin, end)) {
+            resize_row(image.y + luma_y.i0[i] * image.y_stride, image.y + luma_y.i1[i] * image.y_stride, luma_y.a[i], y_step, luma_x, y, 1);
+
+            const int64_t c0 = chroma_y.i0[i] * image.uv_stride;
+            const int64_t c1 = chroma_y.i1[i] * image.uv_stride;
+            resize_row(image.u + c0, image.u + c1, chroma_y.a[i], uv_step, chroma_x, u, 1);
+            resize_row(image.v + c0, image.v + c1, chroma_y.a[i], uv_step, chroma_x, v, 1);
+
+            const YUVRow row = yuv_row(ChromaKind::Full, y, u, v);
+            D* dst = out + i * out_w * 3;
+            if (std::is_same<D, unsigned char>::value) {
+                yuv_row_to_rgb(ChromaKind::Full, row, out_w, (unsigned char*)dst, op.bgr);
+            } else {
+                yuv_row_to_rgb(ChromaKind::Full, row, out_w, buffer.data(), op.bgr);
+                store_row(buffer.data(), dst, out_w * 3);
+            }
+        }
+    });
+}
+
+template <typename D>
+static void convert_rows_resize(const ColorOp& op, const unsigned char* src, int h, int w, D* out, int out_h, int out_w) {
+    const LinearTable tx = linear_table(w, out_w);
+    const LinearTable ty = linear_table(h, out_h);
+    const int64_t stride = (int64_t)w * op.scn;
+
+    otter::parallel_for(0, out_h, 0, [&](int64_t begin, int64_t end) {
+        std::vector<unsigned char> buffer(out_w * op.scn);
+
+        for (const auto i : otter::irange(begin, end)) {
+            for (int c = 0; c < op.scn; ++c) {
+                resize_row(src + ty.i0[i] * stride + c, src + ty.i1[i] * stride + c, ty.a[i], op.scn, tx, buffer.data() + c, op.scn);
             }
-        });
+            color_row<unsigned char, D>(op, buffer.data(), out + i * out_w * op.dcn, out_w);
+        }
+    });
+}
+
+Tensor convertColorResize(const Tensor& self, int mode, int out_h, int out_w, ScalarType dtype) {
+    const ColorOp op = color_op(mode);
+    OTTER_CHECK(out_h > 0 && out_w > 0, "Expect positive output size but get ", out_h, "x", out_w);
+    OTTER_CHECK(dtype == ScalarType::Byte || dtype == ScalarType::Float, "Expect Byte or Float output but get ", dtype);
+    OTTER_CHECK(self.scalar_type() == ScalarType::Byte, "convertColorResize expects Byte input but get ", self.scalar_type());
+
+    Tensor out = otter::empty({out_h, out_w, op.dcn}, dtype);
+
+    if (op.kind == ColorKind::YUV) {
+        const YUVImage image = yuv_image(self, mode, op);
+        if (dtype == ScalarType::Byte)
+            convert_yuv_resize(image, op, out.data_ptr<unsigned char>(), out_h, out_w);
+        else
+            convert_yuv_resize(image, op, out.data_ptr<float>(), out_h, out_w);
+        return out;
     }
-    
+
+    OTTER_CHECK(self.dim() == 3, "Expect input tensor has 3 dimensions but get ", self.dim());
+    OTTER_CHECK(self.size(2) == op.scn, "Expect input tensor has ", op.scn, " channels but get ", self.size(2));
+
+    const Tensor input = self.contiguous();
+    if (dtype == ScalarType::Byte)
+        convert_rows_resize(op, input.data_ptr<unsigned char>(), (int)input.size(0), (int)input.size(1), out.data_ptr<unsigned char>(), out_h, out_w);
+    else
+        convert_rows_resize(op, input.data_ptr<unsigned char>(), (int)input.size(0), (int)input.size(1), out.data_ptr<float>(), out_h, out_w);
+
     return out;
 }
 
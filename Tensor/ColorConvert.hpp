@@ -8,18 +8,61 @@
 #ifndef ColorConvert_hpp
 #define ColorConvert_hpp
 
+#include "ScalarType.hpp"
+
 namespace otter {
 
 class Tensor;
 
 namespace cv {
 
+// Images are HWC, values of Float images are in [0, 255] like Byte ones.
 enum {
-    RGB_TO_GRAY
+    RGB_TO_GRAY,
+    BGR_TO_GRAY,
+
+    RGB_TO_BGR,
+    BGR_TO_RGB,
+    RGBA_TO_RGB,
+    RGBA_TO_BGR,
+    BGRA_TO_RGB,
+    BGRA_TO_BGR,
+    RGB_TO_RGBA,
+    BGR_TO_BGRA,
+    RGB_TO_BGRA,
+    BGR_TO_RGBA,
+    RGBA_TO_BGRA,
+    BGRA_TO_RGBA,
+
+    // H in [0, 180), S and V in [0, 255]
+    RGB_TO_HSV,
+    BGR_TO_HSV,
+
+    // Camera formats, Byte input in BT.601 limited range
+    NV12_TO_RGB,    // (h * 3 / 2, w), Y plane followed by the interleaved UV plane
+    NV12_TO_BGR,
+    NV21_TO_RGB,    // same as NV12 with VU order
+    NV21_TO_BGR,
+    I420_TO_RGB,    // (h * 3 / 2, w), Y plane followed by the U and V planes
+    I420_TO_BGR,
+    YUYV_TO_RGB,    // (h, w, 2), Y0 U Y1 V
+    YUYV_TO_BGR
 };
 
+// The output has the dtype of the input, except RGB_TO_GRAY and BGR_TO_GRAY which output Float.
 Tensor convertColor(const Tensor& self, int mode);
 
+Tensor convertColor(const Tensor& self, int mode, ScalarType dtype);
+
+// Convert and bilinear resize to (out_h, out_w) in one pass over the rows, the full size
+// converted image is never materialized. Byte input only.
+Tensor convertColorResize(const Tensor& self, int mode, int out_h, int out_w, ScalarType dtype = ScalarType::Byte);
+
+// Raw camera buffers (NV12_TO_* / NV21_TO_* / I420_TO_* modes) to a packed 3 channels Byte image.
+// u and v point to the first U and V samples, uv + 0 and uv + 1 for NV12, vu + 1 and vu + 0
+// for NV21, the two planes for I420, uv_stride is the byte stride of the chroma rows.
+void yuv420_to_rgb(const unsigned char* y, int y_stride, const unsigned char* u, const unsigned char* v, int uv_stride, int w, int h, unsigned char* dst, int dst_stride, int mode);
+
 }   // end namespace cv
 }   // end namespace otter
 
@@ -25,6 +25,11 @@ void Composer::init(const char* nanodet_param, const char* nanodet_weight, const
     simplepose.load_otter(simplepose_param, otter::CompileMode::Inference);
     simplepose.load_weight(simplepose_weight, otter::Net::WeightType::Ncnn);
     
+    nanodet_input     = nanodet.blob_handle("data_1");
+    nanodet_output    = nanodet.blob_handle("nanodet");
+    simplepose_input  = simplepose.blob_handle("data_1");
+    simplepose_output = simplepose.blob_handle("conv_56");
+    
     enable_pose_stabilizer = pose_stable;
     enable_object_stabilizer = object_stable;
     target_size = 416;
@@ -52,9 +57,9 @@ void Composer::detect(Tensor frame) {
     
     auto nanodet_extractor = nanodet.create_extractor();
         
-    nanodet_extractor.input("data_1", nanodet_pre_process);
+    nanodet_extractor.input(nanodet_input, nanodet_pre_process);
     otter::Tensor nanodet_predict;
-    nanodet_extractor.extract("nanodet", nanodet_predict, 0);
+    nanodet_extractor.extract(nanodet_output, nanodet_predict, 0);
     auto nanodet_post_process = otter::nanodet_post_process(nanodet_predict, frame_width, frame_height, scale, wpad, hpad);
     
     // Normalize width and height
@@ -92,10 +97,10 @@ void Composer::detect(Tensor frame) {
             auto simplepose_input = pose_pre_process(target_object, frame);
                         
             auto simplepose_extractor = simplepose.create_extractor();
-            simplepose_extractor.input("data_1", simplepose_input.image);
+            simplepose_extractor.input(this->simplepose_input, simplepose_input.image);
                         
             otter::Tensor simplepose_predict;
-            simplepose_extractor.extract("conv_56", simplepose_predict, 0);
+            simplepose_extractor.extract(simplepose_output, simplepose_predict, 0);
                         
             keypoints = otter::pose_post_process(simplepose_predict, simplepose_input);
             
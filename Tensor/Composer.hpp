@@ -49,6 +49,11 @@ private:
     Net nanodet;
     Net simplepose;
     
+    BlobHandle nanodet_input;
+    BlobHandle nanodet_output;
+    BlobHandle simplepose_input;
+    BlobHandle simplepose_output;
+    
     otter::core::Stabilizer object_stabilizer;
     otter::cv::PoseStabilizer pose_stabilizer;
     
@@ -16,6 +16,10 @@
 #define OTTER_MOBILE 0
 #endif
 
+#ifndef OTTER_SIZE_CLASS_ALLOCATOR
+#define OTTER_SIZE_CLASS_ALLOCATOR 1
+#endif
+
 #ifndef OTTER_OPENMP
 #define OTTER_OPENMP 1
 #endif
@@ -28,10 +32,6 @@
 #define OTTER_OPENCV_DRAW 1
 #endif
 
-#ifndef OTTER_BENCHMARK
-#define OTTER_BENCHMARK 1
-#endif
-
 #if OTTER_MOBILE
 
 #else
@@ -7,6 +7,8 @@
 
 #include "Tensor.hpp"
 #include "TensorShape.hpp"
+#include "TensorFactory.hpp"
+#include "Parallel.hpp"
 #include "Convolution.hpp"
 #include "ConvolutionMM2D.hpp"
 #include "ConvolutionMM2DNeon.hpp"
@@ -19,6 +21,8 @@
 #include "ConvolutionMM2DTranspose.hpp"
 #include "ConvolutionMM2DTransposeNeon.hpp"
 #include "DepthwiseConvTransposeKernelNeon.hpp"
+#include "Profiler.hpp"
+#include "ActivationLayer.hpp"
 
 #if __SSE2__
 #include "ConvolutionMM2DX86Pack.hpp"
@@ -161,15 +165,33 @@ ConvBackend select_proper_conv_backend(
             if (input.dim() == 4) {
                 if (params.is_dilated()) {
                     if (params.is_int8(input, weight)) {
+                        // im2col dilates, the depthwise kernel keeps the per channel loop
+                        if (params.use_cpu_x86(input, weight)) {
+                            if (params.is_dilated_depthwise(input, weight)) {
+                                return ConvBackend::DepthwiseInt8X86Pack1;
+                            }
+                            return ConvBackend::Sgemm2dInt8X86;
+                        }
                         return ConvBackend::SlideWin2dInt8;
                     }
                     return ConvBackend::SlowDilated2d;
                 } else {
                     if (params.is_int8(input, weight)) {
                         if (params.use_cpu_x86(input, weight)) {
+                            if (params.is_depthwise(input, weight)) {
+                                return ConvBackend::DepthwiseInt8X86Pack1;
+                            }
                             if (kernel_w == 1 && kernel_h == 1 && stride_w == 1 && stride_h == 1) {
                                 return ConvBackend::Sgemm2dInt8X86_1x1s1;
                             }
+                            if (kernel_w == 3 && kernel_h == 3 && stride_w == 1 && stride_h == 1 && params.groups == 1) {
+                                int tile = conv3x3s1_winograd_int8_x86_tile(num_input, num_output);
+                                if (tile == 4) {
+                                    return ConvBackend::Winograd43Int8X86_3x3s1;
+                                } else if (tile == 2) {
+                                    return ConvBackend::Winograd23Int8X86_3x3s1;
+                                }
+                            }
                             return ConvBackend::Sgemm2dInt8X86;
                         } else if (params.use_cpu_neon(input, weight)) {
                             return ConvBackend::Sgemm2dInt8Neon;
@@ -274,14 +296,6 @@ static auto view4d(const Tensor& tensor) -> Tensor {
     return tensor.unsqueeze(2);
 }
 
-static Tensor subtensor(Tensor& tensor, int dim, int groups, int g) {
-    if (!tensor.defined()) {
-        return Tensor();
-    }
-    int64_t n = tensor.sizes()[dim] / groups;
-    return tensor.narrow(dim, n * g, n).contiguous();
-}
-
 Tensor convolution(
     const Tensor& input_r,
     const Tensor& weight_r,
@@ -295,7 +309,9 @@ Tensor convolution(
     int64_t groups_,
     bool packed_,
     const Tensor& input_int8_scales,
-    const Tensor& weight_int8_scales) {
+    const Tensor& weight_int8_scales,
+    int activation_type,
+    const Tensor& activation_params) {
     
     if (packed_) {
         return convolution_packed(
@@ -310,7 +326,9 @@ Tensor convolution(
             output_padding_,
             groups_,
             input_int8_scales,
-            weight_int8_scales);
+            weight_int8_scales,
+            activation_type,
+            activation_params);
     }
     
     auto input = input_r.packing(1);
@@ -343,6 +361,7 @@ Tensor convolution(
     
     bool need_backward = false; // TODO: backward propogation
     ConvBackend backend = select_proper_conv_backend(input, weight, bias, need_backward, params);
+    set_profile_backend(conv_backend_name(backend));
     
     Tensor output;
     
@@ -368,6 +387,11 @@ Tensor convolution(
         case ConvBackend::DepthwiseX86_3x3s2:
             output = depthwise_conv2d_3x3s2_x86_sse(input.contiguous(), weight, bias, params.stride, params.padding);
             break;
+#if __SSE2__
+        case ConvBackend::DepthwiseInt8X86Pack1:
+            output = depthwise_conv2d_int8_x86_pack1(input.contiguous(), weight, weight_o, weight.sizes().slice(2), params.stride, params.padding, params.dilation);
+            break;
+#endif
         case ConvBackend::DepthwiseTransposeNeon:
             output = depthwise_deconv2d_neon(input.contiguous(), weight, weight_o, bias, params.stride, params.padding, params.output_padding, params.dilation);
             break;
@@ -381,6 +405,8 @@ Tensor convolution(
         case ConvBackend::Sgemm2dX86:
         case ConvBackend::Sgemm2dInt8X86:
         case ConvBackend::Sgemm2dInt8X86_1x1s1:
+        case ConvBackend::Winograd23Int8X86_3x3s1:
+        case ConvBackend::Winograd43Int8X86_3x3s1:
         case ConvBackend::Sgemm2dInt8Neon:
         case ConvBackend::SlideWin2dNeon_1x1s1:
         case ConvBackend::SlideWin2d:
@@ -394,17 +420,7 @@ Tensor convolution(
             if (params.groups == 1) {
                 output = otter::convolution_nogroup_backend(input.contiguous(), weight, weight_o, bias, backend, params, input_int8_scales, weight_int8_scales);
             } else {
-                std::vector<Tensor> outputs(params.groups);
-                input = input.contiguous();
-                for (const auto g : otter::irange(params.groups)) {
-                    auto input_g = subtensor(input, 1, static_cast<int>(params.groups), static_cast<int>(g));
-                    auto weight_g = subtensor(weight, 0, static_cast<int>(params.groups), static_cast<int>(g));
-                    auto bias_g = subtensor(bias, 0, static_cast<int>(params.groups), static_cast<int>(g));
-                    auto input_int8_scales_g = (input_int8_scales.defined()) ? input_int8_scales[g].view({-1}) : Tensor();
-                    auto weight_int8_scales_g = (weight_int8_scales.defined()) ? weight_int8_scales[g].view({-1}) : Tensor();
-                    outputs[g] = otter::convolution_nogroup_backend(input_g, weight_g, weight_o, bias_g, backend, params, input_int8_scales_g, weight_int8_scales_g);
-                }
-                output = otter::native::cat(outputs, 1);
+                output = otter::convolution_group(input.contiguous(), weight, {}, bias, params.stride, params.padding, params.dilation, params.groups, false, input_int8_scales, weight_int8_scales);
             }
             
         default:
@@ -415,6 +431,8 @@ Tensor convolution(
         output = view3d(output);
     }
     
+    activation_inplace(output, activation_type, activation_params);
+    
     return output;
 }
 
@@ -459,6 +477,10 @@ Tensor convolution_nogroup_backend(const Tensor& self, const Tensor& weight, con
             return otter::sgemm_conv2d_int8_x86(self, weight, weight_o, kernel_size, params.stride, params.padding, params.dilation);
         case ConvBackend::Sgemm2dInt8X86_1x1s1:
             return otter::sgemm_conv2d_1x1s1_int8_x86(self, weight, weight_o, params.padding);
+        case ConvBackend::Winograd23Int8X86_3x3s1:
+            return otter::conv2d_3x3s1_winograd23_int8_x86(self, weight, weight_o, params.padding);
+        case ConvBackend::Winograd43Int8X86_3x3s1:
+            return otter::conv2d_3x3s1_winograd43_int8_x86(self, weight, weight_o, params.padding);
         case ConvBackend::Sgemm2dInt8Neon:
             return otter::sgemm_conv2d_int8_neon(self, weight, weight_o, kernel_size, params.stride, params.padding, params.dilation);
         default:
@@ -481,7 +503,8 @@ ConvBackend select_proper_conv_packed_backend(
     const int64_t kernel_h = weight.size(2);
     const int64_t stride_w = params.stride[1];
     const int64_t stride_h = params.stride[0];
-    const int64_t num_input = input.size(1);
+    // the input is packed, count the channels like the layer does when it transforms the weight
+    const int64_t num_input = input.size(1) * input.elempack();
     const int64_t num_output = weight.size(0);
     
     int64_t elempack = input.elempack();
@@ -528,9 +551,26 @@ ConvBackend select_proper_conv_packed_backend(
 #elif __ARM_NEON__
                     out_elempack_int32 = num_output % 4 == 0 ? 4 : 1;
 #endif
+                    if (params.use_cpu_x86(input, weight) && params.is_dilated_depthwise(input, weight)) {
+                        if (elempack == 8) {
+                            return ConvBackend::DepthwiseInt8X86Pack8;
+                        } else if (elempack == 1) {
+                            return ConvBackend::DepthwiseInt8X86Pack1;
+                        }
+                    }
+                    
                     if (params.is_depthwise(input, weight)) {
                         if (params.use_cpu_x86(input, weight)) {
                             if (elempack == 8) {
+                                if (kernel_h == 3 && kernel_w == 3 && stride_h == 1 && stride_w == 1) {
+                                    return ConvBackend::DepthwiseInt8X86Pack8_3x3s1;
+                                } else if (kernel_h == 3 && kernel_w == 3 && stride_h == 2 && stride_w == 2) {
+                                    return ConvBackend::DepthwiseInt8X86Pack8_3x3s2;
+                                } else if (kernel_h == 5 && kernel_w == 5 && stride_h == 1 && stride_w == 1) {
+                                    return ConvBackend::DepthwiseInt8X86Pack8_5x5s1;
+                                } else if (kernel_h == 5 && kernel_w == 5 && stride_h == 2 && stride_w == 2) {
+                                    return ConvBackend::DepthwiseInt8X86Pack8_5x5s2;
+                                }
                                 return ConvBackend::DepthwiseInt8X86Pack8;
                             } else if (elempack == 1) {
                                 return ConvBackend::DepthwiseInt8X86Pack1;
@@ -551,6 +591,15 @@ ConvBackend select_proper_conv_packed_backend(
                     }
                     
                     if (params.use_cpu_x86(input, weight)) {
+                        if (kernel_h == 3 && kernel_w == 3 && stride_h == 1 && stride_w == 1 && !params.is_dilated() && params.groups == 1) {
+                            int tile = conv3x3s1_winograd_int8_x86_tile(num_input, num_output);
+                            if (tile == 4) {
+                                return ConvBackend::Winograd43Int8X86_3x3s1;
+                            } else if (tile == 2) {
+                                return ConvBackend::Winograd23Int8X86_3x3s1;
+                            }
+                        }
+                        
                         if (elempack == 8 && out_elempack_int32 == 4) {
                             if (kernel_h == 1 && kernel_w == 1 && stride_h == 1 && stride_w == 1) {
                                 return ConvBackend::Sgemm2dInt8X86Pack8to4_1x1s1;
@@ -564,7 +613,7 @@ ConvBackend select_proper_conv_packed_backend(
                         } else if (elempack == 1 && out_elempack_int32 == 4) {
                             if (kernel_h == 1 && kernel_w == 1 && stride_h == 1 && stride_w == 1) {
                                 return ConvBackend::Sgemm2dInt8X86Pack1to4_1x1s1;
-                            } else if (kernel_h == 3 && kernel_w == 3 && stride_h == 2 && stride_w == 2) {
+                            } else if (kernel_h == 3 && kernel_w == 3 && stride_h == 2 && stride_w == 2 && !params.is_dilated()) {
                                 return ConvBackend::Sgemm2dInt8X86Pack1to4_3x3s2;
                             }
                             return ConvBackend::Sgemm2dInt8X86Pack1to4;
@@ -638,7 +687,7 @@ ConvBackend select_proper_conv_packed_backend(
                             } else if (num_input >= 8 && num_output >= 8) {
                                 return ConvBackend::Winograd43X86Pack8_3x3s1;
                             } else {
-                                return ConvBackend::Winograd43X86Pack8_3x3s1;
+                                return ConvBackend::Winograd23X86Pack8_3x3s1;
                             }
                         }
                         return ConvBackend::Sgemm2dX86Pack8;
@@ -732,7 +781,9 @@ Tensor convolution_packed(
     IntArrayRef output_padding,
     int64_t groups,
     const Tensor& input_int8_scales,
-    const Tensor& weight_int8_scales) {
+    const Tensor& weight_int8_scales,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto k = weight.dim();
     auto dim = k - 2;
@@ -745,15 +796,27 @@ Tensor convolution_packed(
     params.transposed = transposed;
     params.groups    = groups;
     
+    const bool int8_dilated_depthwise = params.is_int8(input, weight) && params.use_cpu_x86(input, weight) && params.is_dilated_depthwise(input, weight);
+    if (groups > 1 && !transposed && !params.is_depthwise(input, weight) && !int8_dilated_depthwise) {
+        Tensor output = convolution_group(input, weight, {}, bias, params.stride, params.padding, params.dilation, groups, true, input_int8_scales, weight_int8_scales);
+        activation_inplace(output, activation_type, activation_params);
+        
+        return output;
+    }
+    
     bool need_backward = false; // TODO: backward propogation
     ConvBackend backend = select_proper_conv_packed_backend(input, weight, bias, need_backward, params);
+    set_profile_backend(conv_backend_name(backend));
     
     auto kernel_size = weight.sizes().slice(2);
     Tensor output;
+    // The x86 packed sgemm and winograd kernels activate in register before the store,
+    // the other kernels leave it to a pass over the output
+    bool activation_fused = false;
     switch (backend) {
 #if __SSE2__
         case ConvBackend::Sgemm2dX86Pack4:
-            output = otter::sgemm_conv2d_pack4_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation); break;
+            output = otter::sgemm_conv2d_pack4_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack4to1:
             output = otter::sgemm_conv2d_pack4to1_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation); break;
         case ConvBackend::Sgemm2dX86Pack1to4:
@@ -761,9 +824,9 @@ Tensor convolution_packed(
         case ConvBackend::DepthwiseX86Pack4:
             output = otter::depthwise_conv2d_x86_pack4(input, weight, weight_o, bias, kernel_size, stride, padding, dilation); break;
         case ConvBackend::Sgemm2dX86Pack4_1x1s1:
-            output = otter::conv2d_1x1s1_sgemm_pack4_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_1x1s1_sgemm_pack4_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack4_1x1s2:
-            output = otter::conv2d_1x1s2_sgemm_pack4_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_1x1s2_sgemm_pack4_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack4to1_1x1s1:
             output = otter::conv2d_1x1s1_sgemm_pack4to1_x86(input, weight, weight_o, bias, padding); break;
         case ConvBackend::Sgemm2dX86Pack1to4_1x1s1:
@@ -777,11 +840,11 @@ Tensor convolution_packed(
         case ConvBackend::DepthwiseX86Pack4_5x5s2:
             output = otter::depthwise_conv2d_5x5s2_x86_pack4(input, weight, weight_o, bias, padding); break;
         case ConvBackend::Winograd63X86Pack4_3x3s1:
-            output = otter::conv2d_3x3s1_winograd63_pack4_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd63_pack4_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Winograd43X86Pack4_3x3s1:
-            output = otter::conv2d_3x3s1_winograd43_pack4_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd43_pack4_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Winograd23X86Pack4_3x3s1:
-            output = otter::conv2d_3x3s1_winograd23_pack4_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd23_pack4_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
             
         // Deconv
         case ConvBackend::DepthwiseTransposeX86Pack4:
@@ -799,11 +862,11 @@ Tensor convolution_packed(
         case ConvBackend::Sgemm2dX86Pack4to8_1x1s1:
             output = otter::conv2d_1x1s1_sgemm_pack4to8_x86(input, weight, weight_o, bias, padding); break;
         case ConvBackend::Sgemm2dX86Pack8:
-            output = otter::sgemm_conv2d_pack8_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation); break;
+            output = otter::sgemm_conv2d_pack8_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack8_1x1s1:
-            output = otter::conv2d_1x1s1_sgemm_pack8_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_1x1s1_sgemm_pack8_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack8_1x1s2:
-            output = otter::conv2d_1x1s2_sgemm_pack8_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_1x1s2_sgemm_pack8_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Sgemm2dX86Pack8to4:
             output = otter::sgemm_conv2d_pack8to4_x86(input, weight, weight_o, bias, kernel_size, stride, padding, dilation); break;
         case ConvBackend::Sgemm2dX86Pack8to4_1x1s1:
@@ -823,11 +886,11 @@ Tensor convolution_packed(
             output = otter::depthwise_conv2d_5x5s2_x86_pack8(input, weight, weight_o, bias, padding); break;
             
         case ConvBackend::Winograd63X86Pack8_3x3s1:
-            output = otter::conv2d_3x3s1_winograd63_pack8_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd63_pack8_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Winograd43X86Pack8_3x3s1:
-            output = otter::conv2d_3x3s1_winograd43_pack8_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd43_pack8_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
         case ConvBackend::Winograd23X86Pack8_3x3s1:
-            output = otter::conv2d_3x3s1_winograd23_pack8_x86(input, weight, weight_o, bias, padding); break;
+            output = otter::conv2d_3x3s1_winograd23_pack8_x86(input, weight, weight_o, bias, padding, activation_type, activation_params); activation_fused = true; break;
             
 #endif  // __AVX__
 #endif  // __SSE2__
@@ -883,6 +946,18 @@ Tensor convolution_packed(
             output = otter::depthwise_conv2d_int8_x86_pack8(input, weight, weight_o, kernel_size, stride, padding, dilation); break;
         case ConvBackend::DepthwiseInt8X86Pack1:
             output = otter::depthwise_conv2d_int8_x86_pack1(input, weight, weight_o, kernel_size, stride, padding, dilation); break;
+        case ConvBackend::DepthwiseInt8X86Pack8_3x3s1:
+            output = otter::depthwise_conv2d_3x3s1_int8_x86_pack8(input, weight, weight_o, padding); break;
+        case ConvBackend::DepthwiseInt8X86Pack8_3x3s2:
+            output = otter::depthwise_conv2d_3x3s2_int8_x86_pack8(input, weight, weight_o, padding); break;
+        case ConvBackend::DepthwiseInt8X86Pack8_5x5s1:
+            output = otter::depthwise_conv2d_5x5s1_int8_x86_pack8(input, weight, weight_o, padding); break;
+        case ConvBackend::DepthwiseInt8X86Pack8_5x5s2:
+            output = otter::depthwise_conv2d_5x5s2_int8_x86_pack8(input, weight, weight_o, padding); break;
+        case ConvBackend::Winograd23Int8X86_3x3s1:
+            output = otter::conv2d_3x3s1_winograd23_int8_x86(input, weight, weight_o, padding, weight.size(0) % 4 == 0 ? 4 : 1); break;
+        case ConvBackend::Winograd43Int8X86_3x3s1:
+            output = otter::conv2d_3x3s1_winograd43_int8_x86(input, weight, weight_o, padding, weight.size(0) % 4 == 0 ? 4 : 1); break;
 #endif
             
 #if __ARM_NEON__
@@ -908,7 +983,318 @@ Tensor convolution_packed(
             output = otter::depthwise_conv2d_3x3s2_int8_neon_pack8(input, weight, weight_o, padding); break;
 #endif
         default: {
-            output = convolution(input.packing(1), weight, weight_o, bias, stride, padding, dilation, transposed, output_padding, groups, false, input_int8_scales, weight_int8_scales);
+            output = convolution(input.packing(1), weight, weight_o, bias, stride, padding, dilation, transposed, output_padding, groups, false, input_int8_scales, weight_int8_scales, activation_type, activation_params);
+            activation_fused = true;
+        }
+    }
+    
+    if (!activation_fused)
+        activation_inplace(output, activation_type, activation_params);
+    
+    return output;
+}
+
+// Elempack a group runs with, the same rule ConvolutionLayer uses when it transforms the kernel of a group
+static int64_t conv_group_elempack(int64_t channels, bool is_int8) {
+    if (is_int8) {
+#if __SSE2__ || __ARM_NEON__
+        return channels % 8 == 0 ? 8 : 1;
+#endif
+    }
+#if __SSE2__
+#if __AVX__
+    return channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#else
+    return channels % 4 == 0 ? 4 : 1;
+#endif
+#elif __ARM_NEON__
+    return channels % 4 == 0 ? 4 : 1;
+#endif
+    return 1;
+}
+
+static int64_t conv_group_out_elempack(int64_t num_output, bool is_int8) {
+    if (is_int8) {
+#if __SSE2__ || __ARM_NEON__
+        return num_output % 4 == 0 ? 4 : 1;
+#endif
+    }
+    return conv_group_elempack(num_output, false);
+}
+
+static ScalarType conv_group_out_dtype(int64_t out_elempack, bool is_int8) {
+    if (is_int8) {
+        return out_elempack == 4 ? ScalarType::Int4 : ScalarType::Int;
+    }
+    return out_elempack == 8 ? ScalarType::Float8 : out_elempack == 4 ? ScalarType::Float4 : ScalarType::Float;
+}
+
+Tensor convolution_channel_slice(const Tensor& self, int64_t b, int64_t begin, int64_t length) {
+    OTTER_CHECK(self.dim() == 4 && self.is_contiguous(), "Expect contiguous 4D tensor for channel slice");
+    
+    const int64_t elempack = self.elempack();
+    OTTER_CHECK(begin % elempack == 0 && length % elempack == 0, "Channel slice [", begin, ", ", begin + length, ") is not aligned to elempack ", elempack);
+    
+    // narrow() counts the channels of packed tensor, keep the packs and the dtype with as_strided
+    const int64_t channel_step = self.stride(1);
+    const int64_t memory_offset = self.memory_offset() + b * self.stride(0) + (begin / elempack) * channel_step;
+    
+    return self.as_strided({1, length / elempack, self.size(2), self.size(3)}, {length / elempack * channel_step, channel_step, self.stride(2), self.stride(3)}, memory_offset);
+}
+
+Tensor& convolution_out(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    bool packed,
+    Tensor& output,
+    const Tensor& input_int8_scales,
+    const Tensor& weight_int8_scales) {
+    
+    auto dim = weight.dim() - 2;
+    
+    ConvParams params;
+    params.stride    = expand_param_if_needed(stride, "stride", dim);
+    params.padding   = expand_param_if_needed(padding, "padding", dim);
+    params.dilation  = expand_param_if_needed(dilation, "dilation", dim);
+    params.output_padding = expand_param_if_needed({0}, "output_padding", dim);
+    params.transposed = false;
+    params.groups    = 1;
+    
+    const bool is_int8 = params.is_int8(input, weight);
+    // pack1 to pack1 has no packed kernel, and the packed backends do not dilate
+    packed = packed && !params.is_dilated() && (input.elempack() > 1 || conv_group_out_elempack(weight.size(0), is_int8) > 1);
+    
+    auto kernel_size = weight.sizes().slice(2);
+    bool need_backward = false;
+    Tensor result = output;
+    
+    if (packed) {
+        ConvBackend backend = select_proper_conv_packed_backend(input, weight, bias, need_backward, params);
+        set_profile_backend(conv_backend_name(backend));
+        
+        switch (backend) {
+#if __SSE2__
+            case ConvBackend::Sgemm2dX86Pack4:
+                otter::sgemm_conv2d_pack4_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack4to1:
+                otter::sgemm_conv2d_pack4to1_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack1to4:
+                otter::sgemm_conv2d_pack1to4_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack4_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack4_1x1s2:
+                otter::conv2d_1x1s2_sgemm_pack4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack4to1_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack4to1_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack1to4_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack1to4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd63X86Pack4_3x3s1:
+                otter::conv2d_3x3s1_winograd63_pack4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd43X86Pack4_3x3s1:
+                otter::conv2d_3x3s1_winograd43_pack4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd23X86Pack4_3x3s1:
+                otter::conv2d_3x3s1_winograd23_pack4_x86_out(input, weight, weight_o, bias, padding, result); break;
+#if __AVX__
+            case ConvBackend::Sgemm2dX86Pack1to8:
+                otter::sgemm_conv2d_pack1to8_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack1to8_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack1to8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack4to8:
+                otter::sgemm_conv2d_pack4to8_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack4to8_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack4to8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack8:
+                otter::sgemm_conv2d_pack8_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack8_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack8_1x1s2:
+                otter::conv2d_1x1s2_sgemm_pack8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack8to4:
+                otter::sgemm_conv2d_pack8to4_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack8to4_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack8to4_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dX86Pack8to1:
+                otter::sgemm_conv2d_pack8to1_x86_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dX86Pack8to1_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack8to1_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd63X86Pack8_3x3s1:
+                otter::conv2d_3x3s1_winograd63_pack8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd43X86Pack8_3x3s1:
+                otter::conv2d_3x3s1_winograd43_pack8_x86_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Winograd23X86Pack8_3x3s1:
+                otter::conv2d_3x3s1_winograd23_pack8_x86_out(input, weight, weight_o, bias, padding, result); break;
+#endif  // __AVX__
+            case ConvBackend::Sgemm2dInt8X86Pack1to4:
+                otter::sgemm_conv2d_int8_pack1to4_x86_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack8to4:
+                otter::sgemm_conv2d_int8_pack8to4_x86_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack8to1:
+                otter::sgemm_conv2d_int8_pack8to1_x86_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack1to4_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack1to4_x86_out(input, weight, weight_o, padding, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack8to4_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack8to4_x86_out(input, weight, weight_o, padding, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack8to1_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack8to1_x86_out(input, weight, weight_o, padding, result); break;
+            case ConvBackend::Sgemm2dInt8X86Pack1to4_3x3s2:
+                otter::conv2d_3x3s2_int8_pack1to4_x86_out(input, weight, weight_o, padding, result); break;
+#endif  // __SSE2__
+#if __ARM_NEON__
+            case ConvBackend::Sgemm2dNeonPack4:
+                otter::sgemm_conv2d_pack4_neon_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dNeonPack4to1:
+                otter::sgemm_conv2d_pack4to1_neon_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dNeonPack1to4:
+                otter::sgemm_conv2d_pack1to4_neon_out(input, weight, weight_o, bias, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dNeonPack4_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack4_neon_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dNeonPack4to1_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack4to1_neon_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dNeonPack1to4_1x1s1:
+                otter::conv2d_1x1s1_sgemm_pack1to4_neon_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Conv2dNeonPack1to4_3x3s2:
+                otter::conv2d_3x3s2_pack1to4_neon_out(input, weight, weight_o, bias, padding, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack1to4:
+                otter::sgemm_conv2d_int8_pack1to4_neon_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack8to4:
+                otter::sgemm_conv2d_int8_pack8to4_neon_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack8to1:
+                otter::sgemm_conv2d_int8_pack8to1_neon_out(input, weight, weight_o, kernel_size, stride, padding, dilation, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack1to4_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack1to4_neon_out(input, weight, weight_o, padding, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack8to4_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack8to4_neon_out(input, weight, weight_o, padding, result); break;
+            case ConvBackend::Sgemm2dInt8NeonPack8to1_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_pack8to1_neon_out(input, weight, weight_o, padding, result); break;
+#endif  // __ARM_NEON__
+            default:
+                result = convolution_packed(input, weight, weight_o, bias, stride, padding, dilation, false, {0, 0}, 1, input_int8_scales, weight_int8_scales);
+        }
+    } else {
+        Tensor self = input.packing(1).contiguous();
+        ConvBackend backend = select_proper_conv_backend(self, weight, bias, need_backward, params);
+        set_profile_backend(conv_backend_name(backend));
+        
+        switch (backend) {
+            case ConvBackend::Sgemm2dX86:
+                otter::sgemm_conv2d_x86_out(self, weight, weight_o, bias, kernel_size, params.stride, params.padding, result); break;
+            case ConvBackend::Winograd23X86_3x3s1:
+                otter::conv2d_3x3s1_winograd23_x86_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::Winograd43X86_3x3s1:
+                otter::conv2d_3x3s1_winograd43_x86_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::Sgemm2dInt8X86:
+                otter::sgemm_conv2d_int8_x86_out(self, weight, weight_o, kernel_size, params.stride, params.padding, params.dilation, result); break;
+            case ConvBackend::Sgemm2dInt8X86_1x1s1:
+                otter::sgemm_conv2d_1x1s1_int8_x86_out(self, weight, weight_o, params.padding, result); break;
+            case ConvBackend::Sgemm2dNeon:
+                otter::sgemm_conv2d_neon_out(self, weight, weight_o, bias, kernel_size, params.stride, params.padding, result); break;
+            case ConvBackend::Sgemm2dNeon_1x1s1:
+                otter::sgemm_conv2d_1x1s1_neon_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::Sgemm2dNeon_1x1s2:
+                otter::sgemm_conv2d_1x1s2_neon_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::SlideWin2dNeon_1x1s1:
+                otter::conv2d_1x1s1_neon_out(self, weight, bias, params.padding, result); break;
+            case ConvBackend::SlideWin2dNeon_3x3s1:
+                otter::conv2d_3x3s1_neon_out(self, weight, bias, params.padding, result); break;
+            case ConvBackend::WinogradNeon_3x3s1:
+                otter::conv2d_3x3s1_winograd64_neon_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::Packed2DNeon_3x3s2:
+                otter::conv2d_3x3s2_packed_neon_out(self, weight, weight_o, bias, params.padding, result); break;
+            case ConvBackend::Sgemm2dInt8Neon:
+                otter::sgemm_conv2d_int8_neon_out(self, weight, weight_o, kernel_size, params.stride, params.padding, params.dilation, result); break;
+            default:
+                result = convolution_nogroup_backend(self, weight, weight_o, bias, backend, params, input_int8_scales, weight_int8_scales);
+        }
+    }
+    
+    // kernels without an out variant, or which reallocate their output
+    if (result.data_ptr() != output.data_ptr()) {
+        if (result.elempack() != output.elempack())
+            result = result.packing(output.elempack());
+        result = result.contiguous();
+        OTTER_CHECK(result.sizes() == output.sizes() && result.scalar_type() == output.scalar_type(), "Convolution output mismatch, expect ", output.sizes(), " ", output.scalar_type(), " but get ", result.sizes(), " ", result.scalar_type());
+        memcpy(output.data_ptr(), result.data_ptr(), result.numel() * result.itemsize());
+    }
+    
+    return output;
+}
+
+Tensor convolution_group(
+    const Tensor& input_r,
+    const Tensor& weight,
+    TensorList weight_o,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    int64_t groups,
+    bool packed,
+    const Tensor& input_int8_scales,
+    const Tensor& weight_int8_scales) {
+    
+    OTTER_CHECK(weight.dim() == 4, "Grouped convolution expect 4D weight but get ", weight.dim(), "D");
+    OTTER_CHECK(weight_o.empty() || (int64_t)weight_o.size() == groups, "Expect one prepacked kernel per group but get ", weight_o.size());
+    
+    const bool is_int8 = (weight.scalar_type() == ScalarType::Byte);
+    const int64_t batch = input_r.size(0);
+    const int64_t channels = input_r.size(1) * input_r.elempack();
+    const int64_t num_output = weight.size(0);
+    
+    OTTER_CHECK(channels % groups == 0 && num_output % groups == 0, "Given groups=", groups, ", expect ", channels, " input channels and ", num_output, " output channels to be divisible by groups");
+    OTTER_CHECK(weight.size(1) * groups == channels, "Given groups=", groups, ", weight of size ", weight.sizes(), ", expect input to have ", weight.size(1) * groups, " channels, but get ", channels, " channels instead");
+    
+    const int64_t channels_g = channels / groups;
+    const int64_t num_output_g = num_output / groups;
+    
+    auto stride_ = expand_param_if_needed(stride, "stride", 2);
+    auto padding_ = expand_param_if_needed(padding, "padding", 2);
+    auto dilation_ = expand_param_if_needed(dilation, "dilation", 2);
+    
+    int64_t elempack = 1;
+    int64_t out_elempack = 1;
+    if (packed) {
+        elempack = conv_group_elempack(channels_g, is_int8);
+        out_elempack = conv_group_out_elempack(num_output_g, is_int8);
+        // pack1 to pack1 runs on the unpacked kernels
+        if (elempack == 1 && out_elempack == 1)
+            packed = false;
+    }
+    
+    Tensor input = (input_r.elempack() == elempack) ? input_r.contiguous() : input_r.packing(elempack);
+    
+    auto output_size = otter::calculate_conv_output_size({batch, channels, input.size(2), input.size(3)}, weight.sizes(), stride_, padding_, dilation_);
+    Tensor output = otter::empty({batch, num_output / out_elempack, output_size[2], output_size[3]}, conv_group_out_dtype(out_elempack, is_int8));
+    
+    auto group_forward = [&](int64_t g) {
+        const Tensor weight_g = weight.narrow(0, g * num_output_g, num_output_g);
+        const Tensor weight_o_g = weight_o.empty() ? Tensor() : weight_o[g];
+        const Tensor bias_g = bias.defined() ? bias.narrow(0, g * num_output_g, num_output_g) : Tensor();
+        const Tensor input_int8_scales_g = (input_int8_scales.defined() && input_int8_scales.numel() == groups) ? input_int8_scales.narrow(0, g, 1) : input_int8_scales;
+        const Tensor weight_int8_scales_g = (weight_int8_scales.defined() && weight_int8_scales.numel() == num_output) ? weight_int8_scales.narrow(0, g * num_output_g, num_output_g) : weight_int8_scales;
+        
+        for (const auto b : otter::irange(batch)) {
+            Tensor input_g = convolution_channel_slice(input, b, g * channels_g, channels_g);
+            Tensor output_g = convolution_channel_slice(output, b, g * num_output_g, num_output_g);
+            
+            otter::convolution_out(input_g, weight_g, weight_o_g, bias_g, stride_, padding_, dilation_, packed, output_g, input_int8_scales_g, weight_int8_scales_g);
+        }
+    };
+    
+    // Narrow groups can not fill the threads with their own output tiles, spread the groups instead
+    if (num_output_g / out_elempack < otter::get_num_threads()) {
+        otter::parallel_for(0, groups, 1, [&](int64_t begin, int64_t end) {
+            for (const auto g : otter::irange(begin, end)) {
+                group_forward(g);
+            }
+        });
+    } else {
+        for (const auto g : otter::irange(groups)) {
+            group_forward(g);
         }
     }
     
@@ -27,10 +27,45 @@ Tensor convolution(
     int64_t groups_,
     bool packed_ = true,
     const Tensor& input_int8_scales = Tensor(),
-    const Tensor& weight_int8_scales = Tensor());
+    const Tensor& weight_int8_scales = Tensor(),
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor convolution_nogroup_backend(const Tensor& self, const Tensor& weight, const Tensor& weight_o, const Tensor& bias, ConvBackend backend, ConvParams& params, const Tensor& input_int8_scales = Tensor(), const Tensor& weight_int8_scales = Tensor());
 
+// Convolution with groups = 1 written into output, which can be a channel slice of a larger tensor.
+// Kernels without an out variant compute into a temporary which is copied over.
+Tensor& convolution_out(
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    bool packed,
+    Tensor& output,
+    const Tensor& input_int8_scales = Tensor(),
+    const Tensor& weight_int8_scales = Tensor());
+
+// Grouped convolution, every group writes its channel slice of one output without split and cat.
+// weight_o holds the prepacked kernel of each group or is empty to transform the kernels on the fly.
+Tensor convolution_group(
+    const Tensor& input,
+    const Tensor& weight,
+    TensorList weight_o,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    IntArrayRef dilation,
+    int64_t groups,
+    bool packed,
+    const Tensor& input_int8_scales = Tensor(),
+    const Tensor& weight_int8_scales = Tensor());
+
+// Sample b, channels [begin, begin + length) as a contiguous 1 x length view sharing the memory of self
+Tensor convolution_channel_slice(const Tensor& self, int64_t b, int64_t begin, int64_t length);
+
 Tensor convolution_packed(
     const Tensor& input_r,
     const Tensor& weight_r,
@@ -43,7 +78,9 @@ Tensor convolution_packed(
     IntArrayRef output_padding_,
     int64_t groups_,
     const Tensor& input_int8_scales = Tensor(),
-    const Tensor& weight_int8_scales = Tensor());
+    const Tensor& weight_int8_scales = Tensor(),
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor convolution_packed_nogroup_backend(const Tensor& self, const Tensor& weight, const Tensor& weight_o, const Tensor& bias, ConvBackend backend, ConvParams& params, const Tensor& input_int8_scales = Tensor(), const Tensor& weight_int8_scales = Tensor());
 
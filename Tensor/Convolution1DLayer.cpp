@@ -68,16 +68,7 @@ int Convolution1DLayer::parse_param(LayerOption& option, ParamDict& pd) {
     
     std::string activation = opt_find_string(option, "activation", "");
     
-    int activation_type = 0;
-    if (activation == "Relu") {
-        activation_type = 1;
-    } else if (activation == "LRelu") {
-        activation_type = 2;
-    } else if (activation == "Relu6") {
-        activation_type = 3;
-    } else if (activation == "Sigmoid") {
-        activation_type = 4;
-    }
+    int activation_type = activation_type_from_string(activation);
     
     Tensor activation_params;
     if (opt_check_string(option, "activation_params")) {
@@ -11,6 +11,9 @@
 
 #include "TensorFactory.hpp"
 #include "TensorMaker.hpp"
+#include "Parallel.hpp"
+#include "im2col.hpp"
+#include "TensorPacking.hpp"
 
 #include "ConvolutionMM2DNeon.hpp"
 #include "ConvolutionMM2DX86.hpp"
@@ -38,21 +41,41 @@ namespace otter {
 ConvolutionLayer::ConvolutionLayer() {
     one_blob_only = true;
     support_inplace = false;
+    support_tiling = true;
+    
+    residual_term = 0;
+    post_activation_type = 0;
     
 #if __SSE2__
     support_packing = true;
 #elif __ARM_NEON__
     support_packing = true;
 #endif
-    
-    activation = nullptr;
 }
 
 ConvolutionLayer::~ConvolutionLayer() {
-    if (activation) {
-        delete activation;
-        activation = nullptr;
+    for (auto op : group_ops) {
+        delete op;
     }
+    group_ops.clear();
+}
+
+static Tensor parse_activation_params(LayerOption& option, const char* key) {
+    Tensor activation_params;
+    if (opt_check_string(option, key)) {
+        int num_params = (int)std::count(option[key].begin(), option[key].end(), ',') + 1;
+        activation_params = otter::empty({num_params}, otter::ScalarType::Float);
+        auto activation_params_a = activation_params.accessor<float, 1>();
+        std::stringstream ss;
+        ss << option[key];
+        float n; char c;
+        for (const auto i : otter::irange(num_params)) {
+            ss >> n >> c;
+            activation_params_a[i] = n;
+        }
+    }
+    
+    return activation_params;
 }
 
 int ConvolutionLayer::parse_param(LayerOption& option, ParamDict& pd) {
@@ -106,30 +129,14 @@ int ConvolutionLayer::parse_param(LayerOption& option, ParamDict& pd) {
     
     std::string activation = opt_find_string(option, "activation", "");
     
-    int activation_type = 0;
-    if (activation == "Relu") {
-        activation_type = 1;
-    } else if (activation == "LRelu") {
-        activation_type = 2;
-    } else if (activation == "Relu6") {
-        activation_type = 3;
-    } else if (activation == "Sigmoid") {
-        activation_type = 4;
-    }
+    int activation_type = activation_type_from_string(activation);
     
-    Tensor activation_params;
-    if (opt_check_string(option, "activation_params")) {
-        int num_params = (int)std::count(option["activation_params"].begin(), option["activation_params"].end(), ',') + 1;
-        activation_params = otter::empty({num_params}, otter::ScalarType::Float);
-        auto activation_params_a = activation_params.accessor<float, 1>();
-        std::stringstream ss;
-        ss << option["activation_params"];
-        float n; char c;
-        for (const auto i : otter::irange(num_params)) {
-            ss >> n >> c;
-            activation_params_a[i] = n;
-        }
-    }
+    Tensor activation_params = parse_activation_params(option, "activation_params");
+    
+    int residual_term = opt_find_int(option, "residual_term", 0);
+    std::string post_activation = opt_find_string(option, "post_activation", "");
+    int post_activation_type = activation_type_from_string(post_activation);
+    Tensor post_activation_params = parse_activation_params(option, "post_activation_params");
     
     if (opt_find(option, "batchnorm"))
         activation_type = 0;
@@ -151,6 +158,9 @@ int ConvolutionLayer::parse_param(LayerOption& option, ParamDict& pd) {
     pd.set((int)ConvParam::Int8_scale_term, int8_scale_term);
     pd.set((int)ConvParam::Activation_type, activation_type);
     pd.set((int)ConvParam::Activation_params, activation_params);
+    pd.set((int)ConvParam::Residual_term, residual_term);
+    pd.set((int)ConvParam::Post_activation_type, post_activation_type);
+    pd.set((int)ConvParam::Post_activation_params, post_activation_params);
     
     return 0;
 }
@@ -175,6 +185,11 @@ int ConvolutionLayer::compute_output_shape(ParamDict &pd) {
     int out_height = (input_height + 2 * padding_height - dilation_height * (kernel_height - 1) - 1) / stride_height + 1;
     int weight_data_size = input_channels / groups * kernel_height * kernel_width * out_channels;
     
+    if (pd.get((int)ConvParam::Residual_term, 0) && bottom_shapes.size() > 1 && bottom_shapes[1].defined()) {
+        auto residual_a = bottom_shapes[1].accessor<int, 2>()[0];
+        OTTER_CHECK(residual_a[0] == input_batch && residual_a[1] == out_channels && residual_a[2] == out_height && residual_a[3] == out_width, "[Convolution] Residual shape should be the same as output (", input_batch, ", ", out_channels, ", ", out_height, ", ", out_width, ") but get (", residual_a[0], ", ", residual_a[1], ", ", residual_a[2], ", ", residual_a[3], ")");
+    }
+    
     pd.set((int)ConvParam::In_channels, input_channels);
     pd.set((int)ConvParam::Weight_data_size, weight_data_size);
     pd.set(OUTPUT_SHAPE_HINT, otter::tensor({input_batch, out_channels, out_height, out_width}, ScalarType::Int).view({1, -1}));
@@ -201,6 +216,11 @@ int ConvolutionLayer::load_param(const ParamDict &pd) {
     int8_scale_term = pd.get((int)ConvParam::Int8_scale_term, 0);
     activation_type = pd.get((int)ConvParam::Activation_type, 0);
     activation_params = pd.get((int)ConvParam::Activation_params, Tensor());
+    residual_term = pd.get((int)ConvParam::Residual_term, 0);
+    post_activation_type = pd.get((int)ConvParam::Post_activation_type, 0);
+    post_activation_params = pd.get((int)ConvParam::Post_activation_params, Tensor());
+    
+    one_blob_only = (residual_term == 0);
     
     return 0;
 }
@@ -297,12 +317,18 @@ int ConvolutionLayer::load_model(const Initializer& initializer) {
 
 int ConvolutionLayer::create_pipeline(const NetOption& opt) {
     
-    activation = create_activation_layer(activation_type, activation_params);
+    if (is_group_convolution()) {
+        return create_pipeline_group(opt);
+    }
     
     if (weight_data.scalar_type() == otter::ScalarType::Byte) {
         return create_pipeline_int8(opt);
     }
     
+    if (create_pipeline_sparse(opt)) {
+        return 0;
+    }
+    
     int elempack = 1;
     int out_elempack = 1;
     
@@ -504,12 +530,106 @@ int ConvolutionLayer::create_pipeline(const NetOption& opt) {
     return 0;
 }
 
+// The residual is converted by Net with the channel rule of the output, only the int8 output may differ
+static Tensor residual_layout_like(const Tensor& residual, const Tensor& top_blob) {
+    if (!residual.defined() || residual.elempack() == top_blob.elempack())
+        return residual;
+    
+    return residual.packing(top_blob.elempack());
+}
+
 int ConvolutionLayer::forward(const Tensor &bottom_blob, Tensor &top_blob, const NetOption& opt) const {
+    return forward_impl(bottom_blob, Tensor(), top_blob, opt);
+}
+
+int ConvolutionLayer::forward(const std::vector<Tensor>& bottom_blobs, std::vector<Tensor>& top_blobs, const NetOption& opt) const {
+    return forward_impl(bottom_blobs[0], bottom_blobs[1], top_blobs[0], opt);
+}
+
+int ConvolutionLayer::forward_impl(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const {
+    
+    if (is_group_convolution()) {
+        return forward_group(bottom_blob, residual, top_blob, opt);
+    }
     
     if (int8_scale_term) {
-        return forward_int8(bottom_blob, top_blob, opt);
+        return forward_int8(bottom_blob, residual, top_blob, opt);
+    }
+    
+    if (sparse_weight.defined()) {
+        return forward_sparse(bottom_blob, residual, top_blob, opt);
     }
     
+    Tensor optimize_kernel = select_optimize_kernel(bottom_blob, opt);
+    
+    // Without residual the activation goes into the kernel store, otherwise it stays in the single residual pass
+    const bool fuse_activation = !residual.defined();
+    
+    top_blob = otter::convolution(
+        bottom_blob, weight_data, optimize_kernel, bias_data,
+        {stride_height, stride_width},
+        {padding_height, padding_width},
+        {dilation_height, dilation_width},
+        false,      // transpose
+        {output_padding_height, output_padding_width},
+        groups,
+        opt.use_packing_layout,
+        Tensor(),   // bottom_blob_int8_scales
+        Tensor(),   // weight_data_int8_scales
+        fuse_activation ? activation_type : 0,
+        activation_params
+    );
+    
+    if (!fuse_activation)
+        residual_activation_inplace(top_blob, activation_type, activation_params, residual_layout_like(residual, top_blob), post_activation_type, post_activation_params);
+    
+    return 0;
+}
+
+// The int8, sparse, dilated and split group paths keep the whole blob, a fused residual is not a band
+bool ConvolutionLayer::tile_footprint(TileFootprint& footprint) const {
+    if (!one_blob_only || is_group_convolution() || int8_scale_term || sparse_weight.defined())
+        return false;
+    if (dilation_height != 1 || dilation_width != 1)
+        return false;
+    
+    footprint = TileFootprint();
+    footprint.kernel_height  = kernel_height;
+    footprint.kernel_width   = kernel_width;
+    footprint.stride_height  = stride_height;
+    footprint.stride_width   = stride_width;
+    footprint.padding_top    = padding_height;
+    footprint.padding_bottom = padding_height;
+    footprint.padding_left   = padding_width;
+    footprint.padding_right  = padding_width;
+    footprint.out_channels   = out_channels;
+    
+    return true;
+}
+
+int ConvolutionLayer::forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const {
+    Tensor optimize_kernel = select_optimize_kernel(bottom_blob, opt);
+    
+    top_blob = otter::convolution(
+        bottom_blob, weight_data, optimize_kernel, bias_data,
+        {stride_height, stride_width},
+        {0, padding_width},
+        {1, 1},
+        false,      // transpose
+        {output_padding_height, output_padding_width},
+        groups,
+        opt.use_packing_layout,
+        Tensor(),   // bottom_blob_int8_scales
+        Tensor(),   // weight_data_int8_scales
+        activation_type,
+        activation_params
+    );
+    
+    return 0;
+}
+
+Tensor ConvolutionLayer::select_optimize_kernel(const Tensor& bottom_blob, const NetOption& opt) const {
+    
     Tensor optimize_kernel;
     
     int64_t elempack = bottom_blob.elempack();
@@ -643,24 +763,7 @@ int ConvolutionLayer::forward(const Tensor &bottom_blob, Tensor &top_blob, const
 #endif
     }
     
-    top_blob = otter::convolution(
-        bottom_blob, weight_data, optimize_kernel, bias_data,
-        {stride_height, stride_width},
-        {padding_height, padding_width},
-        {dilation_height, dilation_width},
-        false,      // transpose
-        {output_padding_height, output_padding_width},
-        groups,
-        opt.use_packing_layout,
-        Tensor(),   // bottom_blob_int8_scales
-        Tensor()    // weight_data_int8_scales
-    );
-    
-    if (activation) {
-        activation->forward_inplace(top_blob, opt);
-    }
-    
-    return 0;
+    return optimize_kernel;
 }
 
 int ConvolutionLayer::create_pipeline_int8(const NetOption& opt) {
@@ -668,12 +771,14 @@ int ConvolutionLayer::create_pipeline_int8(const NetOption& opt) {
     auto scale_in_data_a = scale_in_data.accessor<float, 1>();
     auto input_int8_scales_a = bottom_blob_int8_scales.accessor<float, 1>();
     auto weight_data_int8_scales_a = weight_data_int8_scales.accessor<float, 1>();
+    // depthwise quantizes every channel with its own input scale
+    const bool per_channel_input_scale = bottom_blob_int8_scales.size(0) == out_channels && out_channels > 1;
     for (const auto p : otter::irange(0, out_channels)) {
         float scale_in;
         if (weight_data_int8_scales_a[p] == 0)
             scale_in = 0;
         else
-            scale_in = 1.f / (input_int8_scales_a[0] * weight_data_int8_scales_a[p]);
+            scale_in = 1.f / (input_int8_scales_a[per_channel_input_scale ? p : 0] * weight_data_int8_scales_a[p]);
 
         scale_in_data_a[p] = scale_in;
     }
@@ -697,6 +802,17 @@ int ConvolutionLayer::create_pipeline_int8(const NetOption& opt) {
         return 0;
     }
     
+    if (groups == 1 && kernel_width == 3 && kernel_height == 3 && stride_width == 1 && stride_height == 1 && dilation_width == 1 && dilation_height == 1) {
+        int tile = otter::conv3x3s1_winograd_int8_x86_tile(in_channels, out_channels);
+        if (tile == 4) {
+            otter::conv3x3s1_winograd43_transform_kernel_int8_sse(weight_data, weight_3x3_winograd43_data, in_channels, out_channels);
+            return 0;
+        } else if (tile == 2) {
+            otter::conv3x3s1_winograd23_transform_kernel_int8_sse(weight_data, weight_3x3_winograd23_data, in_channels, out_channels);
+            return 0;
+        }
+    }
+    
     if (elempack == 8 && out_elempack == 4) {
         otter::convolution_im2col_sgemm_transform_kernel_pack8to4_int8_x86(weight_data, weight_sgemm_int8_data, in_channels, out_channels, kernel_width, kernel_height);
     }
@@ -751,7 +867,7 @@ int ConvolutionLayer::create_pipeline_int8(const NetOption& opt) {
     return 0;
 }
 
-int ConvolutionLayer::forward_int8(const Tensor &bottom_blob, Tensor &top_blob, const NetOption &opt) const {
+int ConvolutionLayer::forward_int8(const Tensor &bottom_blob, const Tensor& residual, Tensor &top_blob, const NetOption &opt) const {
     
     Tensor optimize_kernel;
     
@@ -789,8 +905,17 @@ int ConvolutionLayer::forward_int8(const Tensor &bottom_blob, Tensor &top_blob,
     
     if (params.use_cpu_x86(bottom_blob, weight_data)) {
         // depthwise
-        if (params.is_depthwise(bottom_blob, weight_data)) {
+        int tile = 0;
+        if (groups == 1 && kernel_width == 3 && kernel_height == 3 && stride_width == 1 && stride_height == 1 && !params.is_dilated()) {
+            tile = otter::conv3x3s1_winograd_int8_x86_tile(in_channels, out_channels);
+        }
+        
+        if (params.is_depthwise(bottom_blob, weight_data) || params.is_dilated_depthwise(bottom_blob, weight_data)) {
             optimize_kernel = weight_data_tf;
+        } else if (tile == 4) {
+            optimize_kernel = weight_3x3_winograd43_data;
+        } else if (tile == 2) {
+            optimize_kernel = weight_3x3_winograd23_data;
         } else {
             if (elempack == 8 && out_elempack_int32 == 4) {
                 optimize_kernel = weight_sgemm_int8_data;
@@ -833,17 +958,249 @@ int ConvolutionLayer::forward_int8(const Tensor &bottom_blob, Tensor &top_blob,
     
     bool use_int8_requantize = int8_scale_term > 100;
     
+    OTTER_CHECK(!(use_int8_requantize && residual.defined()), "[Convolution] Residual can not be fused with int8 requantize output");
+    
     if (use_int8_requantize) {
         top_blob = requantize_from_int32_to_int8(top_blob_int32, scale_in_data, top_blob_int8_scales, bias_data, activation_type, activation_params, opt.use_packing_layout);
     } else {
         top_blob = dequantize_from_int32(top_blob_int32, scale_in_data, bias_data, opt.use_packing_layout);
 
-        if (activation) {
-            activation->forward_inplace(top_blob, opt);
+        residual_activation_inplace(top_blob, activation_type, activation_params, residual_layout_like(residual, top_blob), post_activation_type, post_activation_params);
+    }
+    
+    return 0;
+}
+
+bool ConvolutionLayer::create_pipeline_sparse(const NetOption& opt) {
+    sparse_weight = SparseWeight();
+    
+    if (!opt.use_sparse_weight || groups != 1) {
+        return false;
+    }
+    
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout) {
+#if __AVX__
+        out_elempack = out_channels % 8 == 0 ? 8 : out_channels % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = out_channels % 4 == 0 ? 4 : 1;
+#endif
+    }
+#elif __ARM_NEON__
+    if (opt.use_packing_layout) {
+        out_elempack = out_channels % 4 == 0 ? 4 : 1;
+    }
+#endif
+    
+    const bool pointwise = kernel_width == 1 && kernel_height == 1 && stride_width == 1 && stride_height == 1 && padding_width == 0 && padding_height == 0;
+    
+    // src = outch-inch-kh-kw, the columns follow the im2col order
+    Tensor weight_data_r2 = weight_data.view({out_channels, -1});
+    
+    float density = otter::sparse_block_density(weight_data_r2, out_elempack);
+    if (!otter::sparse_weight_preferred(density, out_elempack, !pointwise)) {
+        return false;
+    }
+    
+    sparse_weight = otter::make_sparse_weight(weight_data_r2, out_elempack);
+    
+    return true;
+}
+
+int ConvolutionLayer::forward_sparse(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& /*opt*/) const {
+    const int64_t out_elempack = sparse_weight.block_size;
+    const bool pointwise = kernel_width == 1 && kernel_height == 1 && stride_width == 1 && stride_height == 1 && padding_width == 0 && padding_height == 0;
+    
+    // a single output row gathers the packed input lanes one by one, unpack once instead
+    Tensor input = (pointwise && out_elempack > 1) ? bottom_blob.contiguous() : bottom_blob.packing(1).contiguous();
+    
+    const int64_t batch = input.size(0);
+    const int64_t h = input.size(2);
+    const int64_t w = input.size(3);
+    const int64_t outh = (h + 2 * padding_height - (dilation_height * (kernel_height - 1) + 1)) / stride_height + 1;
+    const int64_t outw = (w + 2 * padding_width - (dilation_width * (kernel_width - 1) + 1)) / stride_width + 1;
+    const int64_t size = outh * outw;
+    
+    Tensor columns;
+    if (pointwise) {
+        columns = input;
+    } else {
+        columns = otter::im2col_cpu(input, {kernel_height, kernel_width}, {stride_height, stride_width}, {padding_height, padding_width}, {dilation_height, dilation_width});
+    }
+    const int64_t elempack = pointwise ? input.elempack() : 1;
+    const int64_t batch_stride = in_channels * kernel_height * kernel_width * size;
+    
+    top_blob = otter::empty({batch, out_channels / out_elempack, outh, outw}, otter::get_update_scalarType(otter::ScalarType::Float, out_elempack));
+    
+    const float* columns_ptr = (const float*)columns.data_ptr();
+    const float* bias_data_ptr = bias_term ? (const float*)bias_data.data_ptr() : nullptr;
+    float* top_blob_ptr = (float*)top_blob.data_ptr();
+    
+    for (const auto b : otter::irange(0, batch)) {
+        otter::sparse_gemm(sparse_weight, columns_ptr + b * batch_stride, elempack, size, bias_data_ptr, top_blob_ptr + b * out_channels * size);
+    }
+    
+    residual_activation_inplace(top_blob, activation_type, activation_params, residual_layout_like(residual, top_blob), post_activation_type, post_activation_params);
+    
+    return 0;
+}
+
+bool ConvolutionLayer::is_group_convolution() const {
+    return groups > 1 && !(in_channels == groups && groups == out_channels);
+}
+
+int ConvolutionLayer::create_pipeline_group(const NetOption& opt) {
+    const int channels_g = in_channels / groups;
+    const int num_output_g = out_channels / groups;
+    
+    for (auto op : group_ops) {
+        delete op;
+    }
+    group_ops.resize(groups);
+    
+    // forward_group runs the prepacked dense kernels of every group, a sparse group would leave them empty
+    NetOption opt_g = opt;
+    opt_g.use_sparse_weight = false;
+    
+    for (const auto g : otter::irange(0, groups)) {
+        ConvolutionLayer* op = new ConvolutionLayer();
+        
+        op->in_channels = channels_g;
+        op->out_channels = num_output_g;
+        op->kernel_height = kernel_height;
+        op->kernel_width = kernel_width;
+        op->stride_height = stride_height;
+        op->stride_width = stride_width;
+        op->padding_height = padding_height;
+        op->padding_width = padding_width;
+        op->dilation_height = dilation_height;
+        op->dilation_width = dilation_width;
+        op->output_padding_height = output_padding_height;
+        op->output_padding_width = output_padding_width;
+        op->groups = 1;
+        op->bias_term = bias_term;
+        op->int8_scale_term = int8_scale_term;
+        op->weight_data_size = weight_data_size / groups;
+        op->activation_type = activation_type;
+        op->activation_params = activation_params;
+        
+        // views into the weights of this layer, the transforms below produce the per group packed kernels
+        op->weight_data = weight_data.narrow(0, g * num_output_g, num_output_g);
+        if (bias_term)
+            op->bias_data = bias_data.narrow(0, g * num_output_g, num_output_g);
+        
+        if (int8_scale_term) {
+            op->weight_data_int8_scales = weight_data_int8_scales.narrow(0, g * num_output_g, num_output_g);
+            op->bottom_blob_int8_scales = bottom_blob_int8_scales;
+            op->top_blob_int8_scales = top_blob_int8_scales;
         }
+        
+        op->create_pipeline(opt_g);
+        
+        group_ops[g] = op;
     }
     
     return 0;
 }
 
+int ConvolutionLayer::forward_group(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const {
+    const int channels_g = in_channels / groups;
+    const int num_output_g = out_channels / groups;
+    
+    if (int8_scale_term) {
+        // the quantize and requantize of every group stay in its own layer, gather the slices afterwards
+        Tensor bottom = bottom_blob.contiguous();
+        if (channels_g % bottom.elempack() != 0)
+            bottom = bottom.packing(1);
+        const int64_t elempack = bottom.elempack();
+        const int64_t batch = bottom.size(0);
+        
+        std::vector<Tensor> outputs(groups);
+        auto group_forward = [&](int64_t g) {
+            Tensor bottom_g;
+            if (batch == 1) {
+                bottom_g = otter::convolution_channel_slice(bottom, 0, g * channels_g, channels_g);
+            } else {
+                bottom_g = otter::empty({batch, channels_g / elempack, bottom.size(2), bottom.size(3)}, bottom.scalar_type());
+                for (const auto b : otter::irange(0, batch)) {
+                    Tensor src = otter::convolution_channel_slice(bottom, b, g * channels_g, channels_g);
+                    Tensor dst = otter::convolution_channel_slice(bottom_g, b, 0, channels_g);
+                    memcpy(dst.data_ptr(), src.data_ptr(), src.numel() * src.itemsize());
+                }
+            }
+            group_ops[g]->forward(bottom_g, outputs[g], opt);
+        };
+        
+        int out_elempack_int32 = 1;
+        if (opt.use_packing_layout) {
+            out_elempack_int32 = num_output_g % 4 == 0 ? 4 : 1;
+        }
+        if (num_output_g / out_elempack_int32 < otter::get_num_threads()) {
+            otter::parallel_for(0, groups, 1, [&](int64_t begin, int64_t end) {
+                for (const auto g : otter::irange(begin, end)) {
+                    group_forward(g);
+                }
+            });
+        } else {
+            for (const auto g : otter::irange(0, groups)) {
+                group_forward(g);
+            }
+        }
+        
+        const Tensor& top_0 = outputs[0];
+        const int64_t out_elempack = top_0.elempack();
+        
+        top_blob = otter::empty({batch, out_channels / out_elempack, top_0.size(2), top_0.size(3)}, top_0.scalar_type());
+        for (const auto b : otter::irange(0, batch)) {
+            for (const auto g : otter::irange(0, groups)) {
+                Tensor top_g = otter::convolution_channel_slice(top_blob, b, g * num_output_g, num_output_g);
+                const Tensor output_g = outputs[g].contiguous();
+                memcpy(top_g.data_ptr(), (const unsigned char*)output_g.data_ptr() + b * top_g.numel() * top_g.itemsize(), top_g.numel() * top_g.itemsize());
+            }
+        }
+        
+        // the activation already ran inside every group
+        if (residual.defined()) {
+            OTTER_CHECK(int8_scale_term <= 100, "[Convolution] Residual can not be fused with int8 requantize output");
+            residual_activation_inplace(top_blob, 0, Tensor(), residual_layout_like(residual, top_blob), post_activation_type, post_activation_params);
+        }
+        
+        return 0;
+    }
+    
+    Tensor bottom = bottom_blob;
+    int64_t elempack = 1;
+    if (opt.use_packing_layout) {
+#if __SSE2__
+#if __AVX__
+        elempack = channels_g % 8 == 0 ? 8 : channels_g % 4 == 0 ? 4 : 1;
+#else
+        elempack = channels_g % 4 == 0 ? 4 : 1;
+#endif  // __AVX__
+#elif __ARM_NEON__
+        elempack = channels_g % 4 == 0 ? 4 : 1;
+#endif  // __ARM_NEON__
+    }
+    if (bottom.elempack() != elempack)
+        bottom = bottom.packing(elempack);
+    
+    std::vector<Tensor> optimize_kernels(groups);
+    for (const auto g : otter::irange(0, groups)) {
+        optimize_kernels[g] = group_ops[g]->select_optimize_kernel(bottom, opt);
+    }
+    
+    top_blob = otter::convolution_group(
+        bottom, weight_data, optimize_kernels, bias_data,
+        {stride_height, stride_width},
+        {padding_height, padding_width},
+        {dilation_height, dilation_width},
+        groups,
+        opt.use_packing_layout);
+    
+    residual_activation_inplace(top_blob, activation_type, activation_params, residual_layout_like(residual, top_blob), post_activation_type, post_activation_params);
+    
+    return 0;
+}
+
 }   // end namespace otter
@@ -9,13 +9,14 @@
 #define ConvolutionLayer_hpp
 
 #include "Layer.hpp"
+#include "SparseGemm.hpp"
 
 namespace otter {
 
 class ConvolutionLayer : public Layer {
 public:
-    ~ConvolutionLayer();
     ConvolutionLayer();
+    ~ConvolutionLayer();
     
     virtual int parse_param(LayerOption& option, ParamDict& pd);
     
@@ -31,11 +32,34 @@ public:
     
     virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
     
+    // With residual_term, bottom_blobs[1] is added after the activation then post_activation is applied
+    virtual int forward(const std::vector<Tensor>& bottom_blobs, std::vector<Tensor>& top_blobs, const NetOption& opt) const;
+    
+    virtual bool tile_footprint(TileFootprint& footprint) const;
+    
+    virtual int forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
     virtual std::string type() const { return "Convolution"; }
 private:
+    int forward_impl(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const;
+    
     int create_pipeline_int8(const NetOption& opt);
     
-    int forward_int8(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    int forward_int8(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const;
+    
+    // Non depthwise grouped convolution, one groups = 1 convolution per group with its own prepacked kernel
+    int create_pipeline_group(const NetOption& opt);
+    
+    int forward_group(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const;
+    
+    // Pruned weight, 1x1 runs on the blob directly and the others on the im2col of the unpacked blob
+    bool create_pipeline_sparse(const NetOption& opt);
+    
+    int forward_sparse(const Tensor& bottom_blob, const Tensor& residual, Tensor& top_blob, const NetOption& opt) const;
+    
+    Tensor select_optimize_kernel(const Tensor& bottom_blob, const NetOption& opt) const;
+    
+    bool is_group_convolution() const;
 public:
     int in_channels;
     int out_channels;
@@ -58,9 +82,13 @@ public:
     int weight_data_size;
     
     int activation_type;
-    Layer* activation;
     Tensor activation_params;
     
+    // Fused residual add, set by the residual fusion pass of Net
+    int residual_term;
+    int post_activation_type;
+    Tensor post_activation_params;
+    
     Tensor weight_data;
     Tensor weight_data_tf;
     Tensor weight_sgemm_data;
@@ -75,6 +103,10 @@ public:
     Tensor top_blob_int8_scales;
     Tensor scale_in_data;
     Tensor weight_sgemm_int8_data;
+    
+    SparseWeight sparse_weight;
+    
+    std::vector<ConvolutionLayer*> group_ops;
 };
 
 enum class ConvParam : int {
@@ -95,7 +127,10 @@ enum class ConvParam : int {
     Weight_data_size,
     Int8_scale_term,
     Activation_type,
-    Activation_params
+    Activation_params,
+    Residual_term,
+    Post_activation_type,
+    Post_activation_params
 };
 
 }
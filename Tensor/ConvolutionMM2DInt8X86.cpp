@@ -16,6 +16,7 @@
 #include "Parallel.hpp"
 #include "VecIntrinsic.hpp"
 #include "Quantize.hpp"
+#include "TensorPacking.hpp"
 
 namespace otter {
 
@@ -1261,4 +1262,412 @@ Tensor sgemm_conv2d_1x1s1_int8_x86(
     return sgemm_conv2d_1x1s1_int8_x86_out(self, weight, weight_o, padding, output);
 }
 
+// Below 48 channels the transforms cost more than the saved multiplies and im2col sgemm is faster,
+// F(4,3) beats F(2,3) at every width measured so F(2,3) is only picked by explicit callers.
+int conv3x3s1_winograd_int8_x86_tile(int64_t inch, int64_t outch) {
+    if (inch >= 48 && outch >= 48)
+        return 4;
+    return 0;
+}
+
+// Winograd F(2,3) and F(4,3) on int16, the transform matrices are scaled to integers so that the
+// int32 result of the output transform is an exact multiple of the scale.
+// F(2,3) scales G by 2, the output is divided by 4. F(4,3) scales G by 24 except the last row by 6,
+// which is compensated by the last column of A, the output is divided by 576.
+static const short winograd23_int8_ktm[4][3] = {
+    {2, 0, 0},
+    {1, 1, 1},
+    {1, -1, 1},
+    {0, 0, 2}
+};
+
+static const short winograd23_int8_itm[4][4] = {
+    {1, 0, -1, 0},
+    {0, 1, 1, 0},
+    {0, -1, 1, 0},
+    {0, 1, 0, -1}
+};
+
+static const int winograd23_int8_otm[2][4] = {
+    {1, 1, 1, 0},
+    {0, 1, -1, -1}
+};
+
+static const short winograd43_int8_ktm[6][3] = {
+    {6, 0, 0},
+    {-4, -4, -4},
+    {-4, 4, -4},
+    {1, 2, 4},
+    {1, -2, 4},
+    {0, 0, 6}
+};
+
+static const short winograd43_int8_itm[6][6] = {
+    {4, 0, -5, 0, 1, 0},
+    {0, -4, -4, 1, 1, 0},
+    {0, 4, -4, -1, 1, 0},
+    {0, -2, -1, 2, 1, 0},
+    {0, 2, -1, -2, 1, 0},
+    {0, 4, 0, -5, 0, 1}
+};
+
+static const int winograd43_int8_otm[4][6] = {
+    {1, 1, 1, 1, 1, 0},
+    {0, 1, -1, 2, -2, 0},
+    {0, 1, 1, 4, 4, 0},
+    {0, 1, -1, 8, -8, 4}
+};
+
+template <int m>
+struct WinogradInt8Transform;
+
+template <>
+struct WinogradInt8Transform<2> {
+    static constexpr int scale = 4;
+    static const short (*ktm())[3] { return winograd23_int8_ktm; }
+    static const short (*itm())[4] { return winograd23_int8_itm; }
+    static const int (*otm())[4] { return winograd23_int8_otm; }
+};
+
+template <>
+struct WinogradInt8Transform<4> {
+    static constexpr int scale = 576;
+    static const short (*ktm())[3] { return winograd43_int8_ktm; }
+    static const short (*itm())[6] { return winograd43_int8_itm; }
+    static const int (*otm())[6] { return winograd43_int8_otm; }
+};
+
+// dst = (m + 2)^2-outch-inch/2*2, the odd input channel is zero padded for the pairwise madd
+template <int m>
+static void conv3x3s1_winograd_transform_kernel_int8(const Tensor& kernel, Tensor& kernel_tm, int inch, int outch) {
+    constexpr int n = m + 2;
+    const int inch2 = (inch + 1) / 2 * 2;
+    const auto ktm = WinogradInt8Transform<m>::ktm();
+    
+    kernel_tm = otter::zeros({n * n, outch, inch2}, otter::ScalarType::Short);
+    
+    const Tensor kernel_c = kernel.contiguous();
+    const signed char* kernel_ptr = (const signed char*)kernel_c.data_ptr();
+    short* kernel_tm_ptr = (short*)kernel_tm.data_ptr();
+    
+    otter::parallel_for(0, outch, 0, [&](int64_t begin, int64_t end) {
+        for (const auto p : otter::irange(begin, end)) {
+            for (int q = 0; q < inch; q++) {
+                const signed char* k0 = kernel_ptr + (p * inch + q) * 9;
+                
+                // h
+                short tmp[n][3];
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < 3; j++) {
+                        tmp[i][j] = k0[j * 3] * ktm[i][0] + k0[j * 3 + 1] * ktm[i][1] + k0[j * 3 + 2] * ktm[i][2];
+                    }
+                }
+                
+                // U
+                for (int j = 0; j < n; j++) {
+                    for (int i = 0; i < n; i++) {
+                        kernel_tm_ptr[((j * n + i) * outch + p) * inch2 + q] = tmp[i][0] * ktm[j][0] + tmp[i][1] * ktm[j][1] + tmp[i][2] * ktm[j][2];
+                    }
+                }
+            }
+        }
+    });
+}
+
+void conv3x3s1_winograd23_transform_kernel_int8_sse(const Tensor& kernel, Tensor& kernel_tm, int inch, int outch) {
+    conv3x3s1_winograd_transform_kernel_int8<2>(kernel, kernel_tm, inch, outch);
+}
+
+void conv3x3s1_winograd43_transform_kernel_int8_sse(const Tensor& kernel, Tensor& kernel_tm, int inch, int outch) {
+    conv3x3s1_winograd_transform_kernel_int8<4>(kernel, kernel_tm, inch, outch);
+}
+
+// dst = (m + 2)^2-tiles/8-inch/2-8-2, 8 tiles of a channel pair are one 256 bit madd operand
+template <int m, int elempack>
+static void conv3x3s1_winograd_transform_input_int8(const Tensor& input, Tensor& bottom_blob_tm, int inch, int w_tiles, int h_tiles) {
+    constexpr int n = m + 2;
+    const int tiles = w_tiles * h_tiles;
+    const int tiles8 = (tiles + 7) / 8;
+    const int inch2 = (inch + 1) / 2 * 2;
+    const int w = (int)input.size(3);
+    const int h = (int)input.size(2);
+    const auto itm = WinogradInt8Transform<m>::itm();
+    
+    bottom_blob_tm = otter::zeros({n * n, tiles8, inch2 / 2, 16}, otter::ScalarType::Short);
+    
+    const signed char* input_ptr = (const signed char*)input.data_ptr();
+    short* bottom_blob_tm_ptr = (short*)bottom_blob_tm.data_ptr();
+    
+    otter::parallel_for(0, inch, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const signed char* img = input_ptr + (q / elempack) * h * w * elempack + q % elempack;
+            
+            for (int t = 0; t < tiles; t++) {
+                const int ti = t / w_tiles;
+                const int tj = t % w_tiles;
+                const signed char* r0 = img + (ti * m * w + tj * m) * elempack;
+                
+                short tmp[n][n];
+                for (int i = 0; i < n; i++) {
+                    for (int x = 0; x < n; x++) {
+                        int sum = 0;
+                        for (int y = 0; y < n; y++) {
+                            sum += itm[i][y] * r0[(y * w + x) * elempack];
+                        }
+                        tmp[i][x] = (short)sum;
+                    }
+                }
+                
+                short* tm0 = bottom_blob_tm_ptr + (t / 8) * (inch2 / 2) * 16 + (q / 2) * 16 + (t % 8) * 2 + q % 2;
+                const int64_t pos_step = (int64_t)tiles8 * (inch2 / 2) * 16;
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < n; j++) {
+                        int sum = 0;
+                        for (int x = 0; x < n; x++) {
+                            sum += tmp[i][x] * itm[j][x];
+                        }
+                        tm0[(i * n + j) * pos_step] = (short)sum;
+                    }
+                }
+            }
+        }
+    });
+}
+
+// top_blob_tm = (m + 2)^2-outch-tiles/8*8 int32
+static void conv3x3s1_winograd_dot_int8(const Tensor& bottom_blob_tm, const Tensor& kernel_tm, Tensor& top_blob_tm, int outch) {
+    const int positions = (int)bottom_blob_tm.size(0);
+    const int tiles8 = (int)bottom_blob_tm.size(1);
+    const int inch_pairs = (int)bottom_blob_tm.size(2);
+    const int inch2 = inch_pairs * 2;
+    const int outch4 = (outch + 3) / 4;
+    
+    top_blob_tm = otter::empty({positions, outch, tiles8 * 8}, otter::ScalarType::Int);
+    
+    const short* bottom_blob_tm_ptr = (const short*)bottom_blob_tm.data_ptr();
+    const short* kernel_tm_ptr = (const short*)kernel_tm.data_ptr();
+    int* top_blob_tm_ptr = (int*)top_blob_tm.data_ptr();
+    
+    otter::parallel_for(0, positions * outch4, 0, [&](int64_t begin, int64_t end) {
+        for (const auto b : otter::irange(begin, end)) {
+            const int r = (int)b / outch4;
+            const int p = ((int)b % outch4) * 4;
+            const int nn = std::min(4, outch - p);
+            
+            const short* kptr = kernel_tm_ptr + ((int64_t)r * outch + p) * inch2;
+            
+            for (int t = 0; t < tiles8; t++) {
+                const short* vptr = bottom_blob_tm_ptr + ((int64_t)r * tiles8 + t) * inch_pairs * 16;
+                int* outptr = top_blob_tm_ptr + ((int64_t)r * outch + p) * tiles8 * 8 + t * 8;
+                
+#if __AVX2__
+                __m256i _sum[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+                if (nn == 4) {
+                    const short* k0 = kptr;
+                    const short* k1 = kptr + inch2;
+                    const short* k2 = kptr + inch2 * 2;
+                    const short* k3 = kptr + inch2 * 3;
+                    for (int q = 0; q < inch_pairs; q++) {
+                        __m256i _v = _mm256_loadu_si256((const __m256i*)(vptr + q * 16));
+                        _sum[0] = _mm256_add_epi32(_sum[0], _mm256_madd_epi16(_v, _mm256_set1_epi32(*(const int*)(k0 + q * 2))));
+                        _sum[1] = _mm256_add_epi32(_sum[1], _mm256_madd_epi16(_v, _mm256_set1_epi32(*(const int*)(k1 + q * 2))));
+                        _sum[2] = _mm256_add_epi32(_sum[2], _mm256_madd_epi16(_v, _mm256_set1_epi32(*(const int*)(k2 + q * 2))));
+                        _sum[3] = _mm256_add_epi32(_sum[3], _mm256_madd_epi16(_v, _mm256_set1_epi32(*(const int*)(k3 + q * 2))));
+                    }
+                } else {
+                    for (int q = 0; q < inch_pairs; q++) {
+                        __m256i _v = _mm256_loadu_si256((const __m256i*)(vptr + q * 16));
+                        for (int k = 0; k < nn; k++) {
+                            _sum[k] = _mm256_add_epi32(_sum[k], _mm256_madd_epi16(_v, _mm256_set1_epi32(*(const int*)(kptr + k * inch2 + q * 2))));
+                        }
+                    }
+                }
+                for (int k = 0; k < nn; k++) {
+                    _mm256_storeu_si256((__m256i*)(outptr + k * tiles8 * 8), _sum[k]);
+                }
+#elif __SSE2__
+                __m128i _sum0[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+                __m128i _sum1[4] = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+                for (int q = 0; q < inch_pairs; q++) {
+                    __m128i _v0 = _mm_loadu_si128((const __m128i*)(vptr + q * 16));
+                    __m128i _v1 = _mm_loadu_si128((const __m128i*)(vptr + q * 16 + 8));
+                    for (int k = 0; k < nn; k++) {
+                        __m128i _k = _mm_set1_epi32(*(const int*)(kptr + k * inch2 + q * 2));
+                        _sum0[k] = _mm_add_epi32(_sum0[k], _mm_madd_epi16(_v0, _k));
+                        _sum1[k] = _mm_add_epi32(_sum1[k], _mm_madd_epi16(_v1, _k));
+                    }
+                }
+                for (int k = 0; k < nn; k++) {
+                    _mm_storeu_si128((__m128i*)(outptr + k * tiles8 * 8), _sum0[k]);
+                    _mm_storeu_si128((__m128i*)(outptr + k * tiles8 * 8 + 4), _sum1[k]);
+                }
+#else
+                for (int k = 0; k < nn; k++) {
+                    for (int i = 0; i < 8; i++) {
+                        int sum = 0;
+                        for (int q = 0; q < inch_pairs; q++) {
+                            sum += vptr[q * 16 + i * 2] * kptr[k * inch2 + q * 2] + vptr[q * 16 + i * 2 + 1] * kptr[k * inch2 + q * 2 + 1];
+                        }
+                        outptr[k * tiles8 * 8 + i] = sum;
+                    }
+                }
+#endif
+            }
+        }
+    });
+}
+
+template <int m, int out_elempack>
+static void conv3x3s1_winograd_transform_output_int8(const Tensor& top_blob_tm, Tensor& top_blob, int outch, int w_tiles, int h_tiles) {
+    constexpr int n = m + 2;
+    constexpr int scale = WinogradInt8Transform<m>::scale;
+    const int outw = (int)top_blob.size(3);
+    const int outh = (int)top_blob.size(2);
+    const int64_t tiles_stride = top_blob_tm.size(2);
+    const int64_t pos_step = outch * tiles_stride;
+    const auto otm = WinogradInt8Transform<m>::otm();
+    
+    const int* top_blob_tm_ptr = (const int*)top_blob_tm.data_ptr();
+    int* top_blob_ptr = (int*)top_blob.data_ptr();
+    
+    otter::parallel_for(0, outch, 0, [&](int64_t begin, int64_t end) {
+        for (const auto p : otter::irange(begin, end)) {
+            int* outptr = top_blob_ptr + (p / out_elempack) * outh * outw * out_elempack + p % out_elempack;
+            
+            for (int ti = 0; ti < h_tiles; ti++) {
+                for (int tj = 0; tj < w_tiles; tj++) {
+                    const int* tm0 = top_blob_tm_ptr + p * tiles_stride + ti * w_tiles + tj;
+                    
+                    int tmp[m][n];
+                    for (int j = 0; j < n; j++) {
+                        for (int i = 0; i < m; i++) {
+                            int sum = 0;
+                            for (int x = 0; x < n; x++) {
+                                sum += otm[i][x] * tm0[(x * n + j) * pos_step];
+                            }
+                            tmp[i][j] = sum;
+                        }
+                    }
+                    
+                    for (int i = 0; i < m; i++) {
+                        const int y = ti * m + i;
+                        if (y >= outh)
+                            break;
+                        for (int j = 0; j < m; j++) {
+                            const int x = tj * m + j;
+                            if (x >= outw)
+                                break;
+                            int sum = 0;
+                            for (int k = 0; k < n; k++) {
+                                sum += tmp[i][k] * otm[j][k];
+                            }
+                            outptr[(y * outw + x) * out_elempack] = sum / scale;
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+template <int m>
+static Tensor& conv2d_3x3s1_winograd_int8_x86_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    const int elempack = (int)self.elempack();
+    const int out_elempack = (int)output.elempack();
+    OTTER_CHECK(elempack == 1 || elempack == 8, "[Winograd int8] Unsupported input elempack ", elempack);
+    OTTER_CHECK(out_elempack == 1 || out_elempack == 4, "[Winograd int8] Unsupported output elempack ", out_elempack);
+    
+    auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
+    output.resize_({output_shape[0], output_shape[1] / out_elempack, output_shape[2], output_shape[3]});
+    
+    const int inch = (int)self.size(1) * elempack;
+    const int outch = (int)output_shape[1];
+    const int outw = (int)output_shape[3];
+    const int outh = (int)output_shape[2];
+    
+    const int w_tiles = (outw + m - 1) / m;
+    const int h_tiles = (outh + m - 1) / m;
+    
+    const int origin_w = (int)self.size(3) + 2 * (int)padding[1];
+    const int origin_h = (int)self.size(2) + 2 * (int)padding[0];
+    const int w = w_tiles * m + 2;
+    const int h = h_tiles * m + 2;
+    
+    Tensor input = otter::constant_pad(self, {padding[1], padding[1] + std::max(0, w - origin_w), padding[0], padding[0] + std::max(0, h - origin_h)}, 0);
+    
+    Tensor kernel_tm;
+    if (weight_o.defined())
+        kernel_tm = weight_o;
+    else
+        otter::conv3x3s1_winograd_transform_kernel_int8<m>(weight, kernel_tm, inch, outch);
+    
+    Tensor bottom_blob_tm;
+    if (elempack == 8)
+        conv3x3s1_winograd_transform_input_int8<m, 8>(input, bottom_blob_tm, inch, w_tiles, h_tiles);
+    else
+        conv3x3s1_winograd_transform_input_int8<m, 1>(input, bottom_blob_tm, inch, w_tiles, h_tiles);
+    input.reset();
+    
+    Tensor top_blob_tm;
+    conv3x3s1_winograd_dot_int8(bottom_blob_tm, kernel_tm, top_blob_tm, outch);
+    bottom_blob_tm.reset();
+    
+    if (out_elempack == 4)
+        conv3x3s1_winograd_transform_output_int8<m, 4>(top_blob_tm, output, outch, w_tiles, h_tiles);
+    else
+        conv3x3s1_winograd_transform_output_int8<m, 1>(top_blob_tm, output, outch, w_tiles, h_tiles);
+    
+    return output;
+}
+
+Tensor& conv2d_3x3s1_winograd23_int8_x86_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return conv2d_3x3s1_winograd_int8_x86_out<2>(self, weight, weight_o, padding, output);
+}
+
+Tensor conv2d_3x3s1_winograd23_int8_x86(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    int64_t out_elempack) {
+    
+    auto output = otter::empty({}, otter::get_update_scalarType(otter::ScalarType::Int, out_elempack));
+    
+    return conv2d_3x3s1_winograd23_int8_x86_out(self, weight, weight_o, padding, output);
+}
+
+Tensor& conv2d_3x3s1_winograd43_int8_x86_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return conv2d_3x3s1_winograd_int8_x86_out<4>(self, weight, weight_o, padding, output);
+}
+
+Tensor conv2d_3x3s1_winograd43_int8_x86(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    int64_t out_elempack) {
+    
+    auto output = otter::empty({}, otter::get_update_scalarType(otter::ScalarType::Int, out_elempack));
+    
+    return conv2d_3x3s1_winograd43_int8_x86_out(self, weight, weight_o, padding, output);
+}
+
 }   // end namesapce otter
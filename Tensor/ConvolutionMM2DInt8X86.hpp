@@ -53,6 +53,43 @@ Tensor sgemm_conv2d_1x1s1_int8_x86(
     const Tensor& weight_o,
     IntArrayRef padding);
 
+// Output tile of the int8 winograd for a 3x3s1 convolution, 4 for F(4,3), 2 for F(2,3), 0 keeps im2col sgemm
+int conv3x3s1_winograd_int8_x86_tile(int64_t inch, int64_t outch);
+
+// dst = (3x3 transformed)-outch-inch int16, the input channels are padded to even
+void conv3x3s1_winograd23_transform_kernel_int8_sse(const Tensor& kernel, Tensor& kernel_tm, int inch, int outch);
+
+void conv3x3s1_winograd43_transform_kernel_int8_sse(const Tensor& kernel, Tensor& kernel_tm, int inch, int outch);
+
+// Input int8 of elempack 1 or 8, int32 output of the elempack of output (1 or 4)
+Tensor& conv2d_3x3s1_winograd23_int8_x86_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor conv2d_3x3s1_winograd23_int8_x86(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    int64_t out_elempack = 1);
+
+Tensor& conv2d_3x3s1_winograd43_int8_x86_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor conv2d_3x3s1_winograd43_int8_x86(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    int64_t out_elempack = 1);
+
 }   // end namespace otter
 
 #endif /* ConvolutionMM2DInt8X86_hpp */
@@ -17,12 +17,16 @@
 #include "Padding.hpp"
 #include "im2col.hpp"
 #include "TensorTransform.hpp"
+#include "QuantizeX86.hpp"
 
 namespace otter {
 
 #if __SSE2__
 
-void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, const Tensor& kernel, const Tensor& _bias) {
+void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, const Tensor& kernel, const Tensor& _bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int size = im2col.size(2);
     const int maxk = im2col.size(1);
     const int inch = im2col.size(0);
@@ -287,18 +291,18 @@ void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, c
                     kptr0 += 4;
                 }
 
-                _mm_store_ps(outptr0, _sum0);
-                _mm_store_ps(outptr0 + 4, _sum1);
-                _mm_store_ps(outptr0 + 4 * 2, _sum2);
-                _mm_store_ps(outptr0 + 4 * 3, _sum3);
-                _mm_store_ps(outptr0 + 4 * 4, _sum4);
-                _mm_store_ps(outptr0 + 4 * 5, _sum5);
-                _mm_store_ps(outptr0 + 4 * 6, _sum6);
-                _mm_store_ps(outptr0 + 4 * 7, _sum7);
-                _mm_store_ps(outptr0 + 4 * 8, _sum8);
-                _mm_store_ps(outptr0 + 4 * 9, _sum9);
-                _mm_store_ps(outptr0 + 4 * 10, _suma);
-                _mm_store_ps(outptr0 + 4 * 11, _sumb);
+                _mm_store_ps(outptr0, activation_sse(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4, activation_sse(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 2, activation_sse(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 3, activation_sse(_sum3, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 4, activation_sse(_sum4, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 5, activation_sse(_sum5, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 6, activation_sse(_sum6, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 7, activation_sse(_sum7, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 8, activation_sse(_sum8, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 9, activation_sse(_sum9, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 10, activation_sse(_suma, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 11, activation_sse(_sumb, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 4 * 12;
             }
@@ -342,14 +346,14 @@ void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, c
                     kptr0 += 4;
                 }
 
-                _mm_store_ps(outptr0, _sum0);
-                _mm_store_ps(outptr0 + 4, _sum1);
-                _mm_store_ps(outptr0 + 4 * 2, _sum2);
-                _mm_store_ps(outptr0 + 4 * 3, _sum3);
-                _mm_store_ps(outptr0 + 4 * 4, _sum4);
-                _mm_store_ps(outptr0 + 4 * 5, _sum5);
-                _mm_store_ps(outptr0 + 4 * 6, _sum6);
-                _mm_store_ps(outptr0 + 4 * 7, _sum7);
+                _mm_store_ps(outptr0, activation_sse(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4, activation_sse(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 2, activation_sse(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 3, activation_sse(_sum3, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 4, activation_sse(_sum4, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 5, activation_sse(_sum5, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 6, activation_sse(_sum6, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 7, activation_sse(_sum7, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 4 * 8;
             }
@@ -381,10 +385,10 @@ void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, c
                     kptr0 += 4;
                 }
 
-                _mm_store_ps(outptr0, _sum0);
-                _mm_store_ps(outptr0 + 4, _sum1);
-                _mm_store_ps(outptr0 + 4 * 2, _sum2);
-                _mm_store_ps(outptr0 + 4 * 3, _sum3);
+                _mm_store_ps(outptr0, activation_sse(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4, activation_sse(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 2, activation_sse(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4 * 3, activation_sse(_sum3, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 4 * 4;
             }
@@ -410,8 +414,8 @@ void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, c
                     kptr0 += 4;
                 }
 
-                _mm_store_ps(outptr0, _sum0);
-                _mm_store_ps(outptr0 + 4, _sum1);
+                _mm_store_ps(outptr0, activation_sse(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm_store_ps(outptr0 + 4, activation_sse(_sum1, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 4 * 2;
             }
@@ -432,7 +436,7 @@ void im2col_sgemm_conv2d_pack4_impl_x86(const Tensor& im2col, Tensor& output_, c
                     kptr0 += 4;
                 }
 
-                _mm_store_ps(outptr0, _sum);
+                _mm_store_ps(outptr0, activation_sse(_sum, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 4;
             }
@@ -1298,7 +1302,9 @@ Tensor& sgemm_conv2d_pack4_x86_out(
     IntArrayRef stride,
     IntArrayRef padding,
     IntArrayRef dilation,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), stride, padding);
     output.resize_({output_size[0], output_size[1] / 4, output_size[2], output_size[3]});
@@ -1364,7 +1370,7 @@ Tensor& sgemm_conv2d_pack4_x86_out(
         });
     }
     
-    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias);
+    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -1377,10 +1383,12 @@ Tensor sgemm_conv2d_pack4_x86(
     IntArrayRef kernel_size,
     IntArrayRef stride,
     IntArrayRef padding,
-    IntArrayRef dilation) {
+    IntArrayRef dilation,
+    int activation_type,
+    const Tensor& activation_params) {
     
     Tensor output = otter::empty({}, otter::ScalarType::Float4);
-    sgemm_conv2d_pack4_x86_out(self, weight, weight_o, bias, kernel_size, stride, padding, dilation, output);
+    sgemm_conv2d_pack4_x86_out(self, weight, weight_o, bias, kernel_size, stride, padding, dilation, output, activation_type, activation_params);
     
     return output;
 }
@@ -1544,7 +1552,9 @@ Tensor conv2d_1x1s1_sgemm_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_size[0], output_size[1] / 4, output_size[2], output_size[3]});
@@ -1566,7 +1576,7 @@ Tensor conv2d_1x1s1_sgemm_pack4_x86_out(
     
     Tensor im2col = input.view({-1, 1, size});
     
-    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias);
+    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -1576,11 +1586,13 @@ Tensor conv2d_1x1s1_sgemm_pack4_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
                
     auto output = otter::empty({}, otter::ScalarType::Float4);
     
-    return conv2d_1x1s1_sgemm_pack4_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_1x1s1_sgemm_pack4_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_1x1s2_sgemm_pack4_x86_out(
@@ -1589,7 +1601,9 @@ Tensor conv2d_1x1s2_sgemm_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {2, 2}, padding);
     output.resize_({output_size[0], output_size[1] / 4, output_size[2], output_size[3]});
@@ -1641,7 +1655,7 @@ Tensor conv2d_1x1s2_sgemm_pack4_x86_out(
     
     Tensor im2col = shrinked.view({-1, 1, size});
     
-    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias);
+    im2col_sgemm_conv2d_pack4_impl_x86(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -1651,11 +1665,13 @@ Tensor conv2d_1x1s2_sgemm_pack4_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float4);
     
-    return conv2d_1x1s2_sgemm_pack4_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_1x1s2_sgemm_pack4_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_1x1s1_sgemm_pack1to4_x86_out(
@@ -2171,7 +2187,10 @@ static void conv3x3s1_winograd23_transform_kernel_pack4_sse(const Tensor& kernel
     }
 }
 
-void conv3x3s1_winograd63_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd63_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -2305,16 +2324,16 @@ void conv3x3s1_winograd63_transform_output_pack4_sse(const Tensor& top_blob_tm,
                         __m128 _out00 = _mm_add_ps(_bias0, _mm_add_ps(_mm_add_ps(_tmp00, _tmp024a), _mm_comp_fmadd_ps(_v32, _tmp024c, _tmp024b)));
                         __m128 _out02 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v8, _tmp024c, _mm_comp_fmadd_ps(_v4, _tmp024b, _tmp024a)));
                         __m128 _out04 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v2, _tmp024c, _mm_comp_fmadd_ps(_v16, _tmp024b, _tmp024a)));
-                        _mm_store_ps(output0, _out00);
-                        _mm_store_ps(output0 + 4 * 2, _out02);
-                        _mm_store_ps(output0 + 4 * 4, _out04);
+                        _mm_store_ps(output0, activation_sse(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 2, activation_sse(_out02, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 4, activation_sse(_out04, activation_type, activation_alpha, activation_beta));
 
                         __m128 _out01 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v16, _tmp135c, _mm_comp_fmadd_ps(_v2, _tmp135b, _tmp135a)));
                         __m128 _out03 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v4, _tmp135c, _mm_comp_fmadd_ps(_v8, _tmp135b, _tmp135a)));
                         __m128 _out05 = _mm_add_ps(_bias0, _mm_add_ps(_mm_add_ps(_tmp07, _tmp135a), _mm_comp_fmadd_ps(_v32, _tmp135b, _tmp135c)));
-                        _mm_store_ps(output0 + 4, _out01);
-                        _mm_store_ps(output0 + 4 * 3, _out03);
-                        _mm_store_ps(output0 + 4 * 5, _out05);
+                        _mm_store_ps(output0 + 4, activation_sse(_out01, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 3, activation_sse(_out03, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 5, activation_sse(_out05, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 4;
                     }
@@ -2447,7 +2466,10 @@ void conv3x3s1_winograd43_transform_input_pack4_sse(const Tensor& bottom_blob, T
     });
 }
 
-void conv3x3s1_winograd43_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd43_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -2558,10 +2580,10 @@ void conv3x3s1_winograd43_transform_output_pack4_sse(const Tensor& top_blob_tm,
                         __m128 _out02 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v4, _tmp02b, _tmp02a));
                         __m128 _out03 = _mm_add_ps(_bias0, _mm_comp_fmadd_ps(_v8, _tmp13b, _mm_add_ps(_tmp05, _tmp13a)));
 
-                        _mm_store_ps(output0, _out00);
-                        _mm_store_ps(output0 + 4, _out01);
-                        _mm_store_ps(output0 + 4 * 2, _out02);
-                        _mm_store_ps(output0 + 4 * 3, _out03);
+                        _mm_store_ps(output0, activation_sse(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4, activation_sse(_out01, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 2, activation_sse(_out02, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4 * 3, activation_sse(_out03, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 4;
                     }
@@ -2667,7 +2689,10 @@ void conv3x3s1_winograd23_transform_input_pack4_sse(const Tensor& bottom_blob, T
     });
 }
 
-void conv3x3s1_winograd23_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd23_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -2744,8 +2769,8 @@ void conv3x3s1_winograd23_transform_output_pack4_sse(const Tensor& top_blob_tm,
                         __m128 _out00 = _mm_add_ps(_bias0, _mm_add_ps(_mm_add_ps(_tmp00, _tmp01), _tmp02));
                         __m128 _out01 = _mm_add_ps(_bias0, _mm_add_ps(_mm_sub_ps(_tmp01, _tmp02), _tmp03));
 
-                        _mm_store_ps(output0, _out00);
-                        _mm_store_ps(output0 + 4, _out01);
+                        _mm_store_ps(output0, activation_sse(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm_store_ps(output0 + 4, activation_sse(_out01, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 4;
                     }
@@ -3179,7 +3204,9 @@ Tensor conv2d_3x3s1_winograd63_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 4, output_shape[2], output_shape[3]});
@@ -3236,7 +3263,7 @@ Tensor conv2d_3x3s1_winograd63_pack4_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd63_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd63_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -3250,11 +3277,13 @@ Tensor conv2d_3x3s1_winograd63_pack4_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float4);
     
-    return conv2d_3x3s1_winograd63_pack4_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd63_pack4_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_3x3s1_winograd43_pack4_x86_out(
@@ -3263,7 +3292,9 @@ Tensor conv2d_3x3s1_winograd43_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 4, output_shape[2], output_shape[3]});
@@ -3320,7 +3351,7 @@ Tensor conv2d_3x3s1_winograd43_pack4_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd43_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd43_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -3334,11 +3365,13 @@ Tensor conv2d_3x3s1_winograd43_pack4_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float4);
     
-    return conv2d_3x3s1_winograd43_pack4_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd43_pack4_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_3x3s1_winograd23_pack4_x86_out(
@@ -3347,7 +3380,9 @@ Tensor conv2d_3x3s1_winograd23_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 4, output_shape[2], output_shape[3]});
@@ -3404,7 +3439,7 @@ Tensor conv2d_3x3s1_winograd23_pack4_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd23_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd23_transform_output_pack4_sse(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -3418,11 +3453,13 @@ Tensor conv2d_3x3s1_winograd23_pack4_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float4);
     
-    return conv2d_3x3s1_winograd23_pack4_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd23_pack4_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 #if __AVX__
@@ -3829,8 +3866,11 @@ void im2col_sgemm_pack4to8_avx(const Tensor& bottom_im2col, Tensor& top_blob, co
     });
 }
 
-void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const Tensor& kernel, const Tensor& _bias)
+void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const Tensor& kernel, const Tensor& _bias, int activation_type, const Tensor& activation_params)
 {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     // Tensor bottom_im2col(size, maxk, inch, 32u, 8, opt.workspace_allocator);
 
     const int size = bottom_im2col.size(2);
@@ -4175,18 +4215,18 @@ void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const
                     kptr0 += 8;
                 }
 
-                _mm256_store_ps(outptr0, _sum0);
-                _mm256_store_ps(outptr0 + 8, _sum1);
-                _mm256_store_ps(outptr0 + 8 * 2, _sum2);
-                _mm256_store_ps(outptr0 + 8 * 3, _sum3);
-                _mm256_store_ps(outptr0 + 8 * 4, _sum4);
-                _mm256_store_ps(outptr0 + 8 * 5, _sum5);
-                _mm256_store_ps(outptr0 + 8 * 6, _sum6);
-                _mm256_store_ps(outptr0 + 8 * 7, _sum7);
-                _mm256_store_ps(outptr0 + 8 * 8, _sum8);
-                _mm256_store_ps(outptr0 + 8 * 9, _sum9);
-                _mm256_store_ps(outptr0 + 8 * 10, _suma);
-                _mm256_store_ps(outptr0 + 8 * 11, _sumb);
+                _mm256_store_ps(outptr0, activation_avx(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8, activation_avx(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 2, activation_avx(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 3, activation_avx(_sum3, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 4, activation_avx(_sum4, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 5, activation_avx(_sum5, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 6, activation_avx(_sum6, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 7, activation_avx(_sum7, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 8, activation_avx(_sum8, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 9, activation_avx(_sum9, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 10, activation_avx(_suma, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 11, activation_avx(_sumb, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 8 * 12;
             }
@@ -4231,14 +4271,14 @@ void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const
                     kptr0 += 8;
                 }
 
-                _mm256_store_ps(outptr0, _sum0);
-                _mm256_store_ps(outptr0 + 8, _sum1);
-                _mm256_store_ps(outptr0 + 8 * 2, _sum2);
-                _mm256_store_ps(outptr0 + 8 * 3, _sum3);
-                _mm256_store_ps(outptr0 + 8 * 4, _sum4);
-                _mm256_store_ps(outptr0 + 8 * 5, _sum5);
-                _mm256_store_ps(outptr0 + 8 * 6, _sum6);
-                _mm256_store_ps(outptr0 + 8 * 7, _sum7);
+                _mm256_store_ps(outptr0, activation_avx(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8, activation_avx(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 2, activation_avx(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 3, activation_avx(_sum3, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 4, activation_avx(_sum4, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 5, activation_avx(_sum5, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 6, activation_avx(_sum6, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 7, activation_avx(_sum7, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 8 * 8;
             }
@@ -4271,10 +4311,10 @@ void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const
                     kptr0 += 8;
                 }
 
-                _mm256_store_ps(outptr0, _sum0);
-                _mm256_store_ps(outptr0 + 8, _sum1);
-                _mm256_store_ps(outptr0 + 8 * 2, _sum2);
-                _mm256_store_ps(outptr0 + 8 * 3, _sum3);
+                _mm256_store_ps(outptr0, activation_avx(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8, activation_avx(_sum1, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 2, activation_avx(_sum2, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8 * 3, activation_avx(_sum3, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 8 * 4;
             }
@@ -4301,8 +4341,8 @@ void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const
                     kptr0 += 8;
                 }
 
-                _mm256_store_ps(outptr0, _sum0);
-                _mm256_store_ps(outptr0 + 8, _sum1);
+                _mm256_store_ps(outptr0, activation_avx(_sum0, activation_type, activation_alpha, activation_beta));
+                _mm256_store_ps(outptr0 + 8, activation_avx(_sum1, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 8 * 2;
             }
@@ -4325,7 +4365,7 @@ void im2col_sgemm_pack8_avx(const Tensor& bottom_im2col, Tensor& top_blob, const
                     kptr0 += 8;
                 }
 
-                _mm256_store_ps(outptr0, _sum);
+                _mm256_store_ps(outptr0, activation_avx(_sum, activation_type, activation_alpha, activation_beta));
 
                 outptr0 += 8;
             }
@@ -5482,7 +5522,9 @@ Tensor& sgemm_conv2d_pack8_x86_out(
     IntArrayRef stride,
     IntArrayRef padding,
     IntArrayRef dilation,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), stride, padding);
     output.resize_({output_size[0], output_size[1] / 8, output_size[2], output_size[3]});
@@ -5555,7 +5597,7 @@ Tensor& sgemm_conv2d_pack8_x86_out(
 //    std::cout << im2col << std::endl;
 //    std::cout << otter::im2col_cpu(self.packing(1), kernel_size, stride, padding, dilation).view({inch * 8, maxk, size}).packing(8) << std::endl;
     
-    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias);
+    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -5568,10 +5610,12 @@ Tensor sgemm_conv2d_pack8_x86(
     IntArrayRef kernel_size,
     IntArrayRef stride,
     IntArrayRef padding,
-    IntArrayRef dilation) {
+    IntArrayRef dilation,
+    int activation_type,
+    const Tensor& activation_params) {
     
     Tensor output = otter::empty({}, otter::ScalarType::Float8);
-    sgemm_conv2d_pack8_x86_out(self, weight, weight_o, bias, kernel_size, stride, padding, dilation, output);
+    sgemm_conv2d_pack8_x86_out(self, weight, weight_o, bias, kernel_size, stride, padding, dilation, output, activation_type, activation_params);
     
     return output;
 }
@@ -5874,7 +5918,9 @@ Tensor conv2d_1x1s1_sgemm_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_size[0], output_size[1] / 8, output_size[2], output_size[3]});
@@ -5896,7 +5942,7 @@ Tensor conv2d_1x1s1_sgemm_pack8_x86_out(
     
     Tensor im2col = input.view({-1, 1, size});
     
-    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias);
+    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -5906,11 +5952,13 @@ Tensor conv2d_1x1s1_sgemm_pack8_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
                
     auto output = otter::empty({}, otter::ScalarType::Float8);
     
-    return conv2d_1x1s1_sgemm_pack8_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_1x1s1_sgemm_pack8_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_1x1s2_sgemm_pack8_x86_out(
@@ -5919,7 +5967,9 @@ Tensor conv2d_1x1s2_sgemm_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {2, 2}, padding);
     output.resize_({output_size[0], output_size[1] / 8, output_size[2], output_size[3]});
@@ -5972,7 +6022,7 @@ Tensor conv2d_1x1s2_sgemm_pack8_x86_out(
     
     Tensor im2col = shrinked.view({-1, 1, size});
     
-    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias);
+    im2col_sgemm_pack8_avx(im2col, output, kernel_tf, bias, activation_type, activation_params);
     
     return output;
 }
@@ -5982,11 +6032,13 @@ Tensor conv2d_1x1s2_sgemm_pack8_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
                
     auto output = otter::empty({}, otter::ScalarType::Float8);
     
-    return conv2d_1x1s2_sgemm_pack8_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_1x1s2_sgemm_pack8_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_1x1s1_sgemm_pack8to1_x86_out(
@@ -6755,7 +6807,10 @@ void conv3x3s1_winograd63_transform_input_pack8_avx(const Tensor& bottom_blob, T
     });
 }
 
-void conv3x3s1_winograd63_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd63_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -6909,12 +6964,12 @@ void conv3x3s1_winograd63_transform_output_pack8_avx(const Tensor& top_blob_tm,
                         __m256 _out03 = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_mm256_set1_ps(4.f), _tmp135c, _mm256_comp_fmadd_ps(_mm256_set1_ps(8.f), _tmp135b, _tmp135a)));
                         __m256 _out05 = _mm256_add_ps(_bias0, _mm256_add_ps(_mm256_add_ps(_tmp07, _tmp135a), _mm256_comp_fmadd_ps(_mm256_set1_ps(32.f), _tmp135b, _tmp135c)));
 
-                        _mm256_store_ps(output0, _out00);
-                        _mm256_store_ps(output0 + 8, _out01);
-                        _mm256_store_ps(output0 + 16, _out02);
-                        _mm256_store_ps(output0 + 24, _out03);
-                        _mm256_store_ps(output0 + 32, _out04);
-                        _mm256_store_ps(output0 + 40, _out05);
+                        _mm256_store_ps(output0, activation_avx(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 8, activation_avx(_out01, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 16, activation_avx(_out02, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 24, activation_avx(_out03, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 32, activation_avx(_out04, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 40, activation_avx(_out05, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 8;
                     }
@@ -7059,7 +7114,10 @@ void conv3x3s1_winograd43_transform_input_pack8_avx(const Tensor& bottom_blob, T
     });
 }
 
-void conv3x3s1_winograd43_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd43_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -7183,10 +7241,10 @@ void conv3x3s1_winograd43_transform_output_pack8_avx(const Tensor& top_blob_tm,
                         __m256 _out02 = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_mm256_set1_ps(4.f), _tmp02b, _tmp02a));
                         __m256 _out03 = _mm256_add_ps(_bias0, _mm256_comp_fmadd_ps(_mm256_set1_ps(8.f), _tmp13b, _mm256_add_ps(_tmp05, _tmp13a)));
 
-                        _mm256_store_ps(output0, _out00);
-                        _mm256_store_ps(output0 + 8, _out01);
-                        _mm256_store_ps(output0 + 8 * 2, _out02);
-                        _mm256_store_ps(output0 + 8 * 3, _out03);
+                        _mm256_store_ps(output0, activation_avx(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 8, activation_avx(_out01, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 8 * 2, activation_avx(_out02, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 8 * 3, activation_avx(_out03, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 8;
                     }
@@ -7307,7 +7365,10 @@ void conv3x3s1_winograd23_transform_input_pack8_avx(const Tensor& bottom_blob, T
     });
 }
 
-void conv3x3s1_winograd23_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias) {
+void conv3x3s1_winograd23_transform_output_pack8_avx(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type, const Tensor& activation_params) {
+    float activation_alpha, activation_beta;
+    activation_scalar_params(activation_type, activation_params, activation_alpha, activation_beta);
+
     const int outw = top_blob.size(2);
     const int outh = top_blob.size(1);
     const int outch = top_blob.size(0);
@@ -7397,8 +7458,8 @@ void conv3x3s1_winograd23_transform_output_pack8_avx(const Tensor& top_blob_tm,
                         __m256 _out00 = _mm256_add_ps(_bias0, _mm256_add_ps(_mm256_add_ps(_tmp00, _tmp01), _tmp02));
                         __m256 _out01 = _mm256_add_ps(_bias0, _mm256_add_ps(_mm256_sub_ps(_tmp01, _tmp02), _tmp03));
 
-                        _mm256_store_ps(output0, _out00);
-                        _mm256_store_ps(output0 + 8, _out01);
+                        _mm256_store_ps(output0, activation_avx(_out00, activation_type, activation_alpha, activation_beta));
+                        _mm256_store_ps(output0 + 8, activation_avx(_out01, activation_type, activation_alpha, activation_beta));
 
                         output0 += outw * 8;
                     }
@@ -7659,7 +7720,9 @@ Tensor conv2d_3x3s1_winograd63_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 8, output_shape[2], output_shape[3]});
@@ -7716,7 +7779,7 @@ Tensor conv2d_3x3s1_winograd63_pack8_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd63_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd63_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -7730,11 +7793,13 @@ Tensor conv2d_3x3s1_winograd63_pack8_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float8);
     
-    return conv2d_3x3s1_winograd63_pack8_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd63_pack8_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_3x3s1_winograd43_pack8_x86_out(
@@ -7743,7 +7808,9 @@ Tensor conv2d_3x3s1_winograd43_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 8, output_shape[2], output_shape[3]});
@@ -7800,7 +7867,7 @@ Tensor conv2d_3x3s1_winograd43_pack8_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd43_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd43_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -7814,11 +7881,13 @@ Tensor conv2d_3x3s1_winograd43_pack8_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float8);
     
-    return conv2d_3x3s1_winograd43_pack8_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd43_pack8_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 Tensor conv2d_3x3s1_winograd23_pack8_x86_out(
@@ -7827,7 +7896,9 @@ Tensor conv2d_3x3s1_winograd23_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output) {
+    Tensor& output,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output_shape = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {1, 1}, padding);
     output.resize_({output_shape[0], output_shape[1] / 8, output_shape[2], output_shape[3]});
@@ -7884,7 +7955,7 @@ Tensor conv2d_3x3s1_winograd23_pack8_x86_out(
     }
     {
         Tensor top_blob_bordered_t = top_blob_bordered[0];
-        conv3x3s1_winograd23_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias);
+        conv3x3s1_winograd23_transform_output_pack8_avx(top_blob_tm, top_blob_bordered_t, bias, activation_type, activation_params);
     }
     // END transform output
     
@@ -7898,11 +7969,13 @@ Tensor conv2d_3x3s1_winograd23_pack8_x86(
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding) {
+    IntArrayRef padding,
+    int activation_type,
+    const Tensor& activation_params) {
     
     auto output = otter::empty({}, otter::ScalarType::Float8);
     
-    return conv2d_3x3s1_winograd23_pack8_x86_out(self, weight, weight_o, bias, padding, output);
+    return conv2d_3x3s1_winograd23_pack8_x86_out(self, weight, weight_o, bias, padding, output, activation_type, activation_params);
 }
 
 #endif  // __AVX__
@@ -29,7 +29,9 @@ Tensor& sgemm_conv2d_pack4_x86_out(
     IntArrayRef stride,
     IntArrayRef padding,
     IntArrayRef dilation,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
     
 Tensor sgemm_conv2d_pack4_x86(
     const Tensor& self,
@@ -39,7 +41,9 @@ Tensor sgemm_conv2d_pack4_x86(
     IntArrayRef kernel_size,
     IntArrayRef stride,
     IntArrayRef padding,
-    IntArrayRef dilation);
+    IntArrayRef dilation,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor& sgemm_conv2d_pack4to1_x86_out(
     const Tensor& self,
@@ -89,14 +93,18 @@ Tensor conv2d_1x1s1_sgemm_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s1_sgemm_pack4_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s2_sgemm_pack4_x86_out(
     const Tensor& self,
@@ -104,14 +112,18 @@ Tensor conv2d_1x1s2_sgemm_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s2_sgemm_pack4_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s1_sgemm_pack1to4_x86_out(
     const Tensor& self,
@@ -145,15 +157,15 @@ Tensor conv2d_1x1s1_sgemm_pack4to1_x86(
 
 void conv3x3s1_winograd63_transform_input_pack4_sse(const Tensor& bottom_blob, Tensor& bottom_blob_tm);
 
-void conv3x3s1_winograd63_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias);
+void conv3x3s1_winograd63_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type = 0, const Tensor& activation_params = Tensor());
 
 void conv3x3s1_winograd43_transform_input_pack4_sse(const Tensor& bottom_blob, Tensor& bottom_blob_tm);
 
-void conv3x3s1_winograd43_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias);
+void conv3x3s1_winograd43_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type = 0, const Tensor& activation_params = Tensor());
 
 void conv3x3s1_winograd23_transform_input_pack4_sse(const Tensor& bottom_blob, Tensor& bottom_blob_tm);
 
-void conv3x3s1_winograd23_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias);
+void conv3x3s1_winograd23_transform_output_pack4_sse(const Tensor& top_blob_tm, Tensor& top_blob, const Tensor& bias, int activation_type = 0, const Tensor& activation_params = Tensor());
 
 void convolution_winograd_dot_pack4_sse(Tensor& bottom_blob_tm, int outch, const Tensor& kernel_tm, Tensor& top_blob_tm);
 
@@ -163,14 +175,18 @@ Tensor conv2d_3x3s1_winograd63_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd63_pack4_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd43_pack4_x86_out(
     const Tensor& self,
@@ -178,14 +194,18 @@ Tensor conv2d_3x3s1_winograd43_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd43_pack4_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd23_pack4_x86_out(
     const Tensor& self,
@@ -193,14 +213,18 @@ Tensor conv2d_3x3s1_winograd23_pack4_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd23_pack4_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 #if __AVX__
 
@@ -265,7 +289,9 @@ Tensor& sgemm_conv2d_pack8_x86_out(
     IntArrayRef stride,
     IntArrayRef padding,
     IntArrayRef dilation,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
     
 Tensor sgemm_conv2d_pack8_x86(
     const Tensor& self,
@@ -275,7 +301,9 @@ Tensor sgemm_conv2d_pack8_x86(
     IntArrayRef kernel_size,
     IntArrayRef stride,
     IntArrayRef padding,
-    IntArrayRef dilation);
+    IntArrayRef dilation,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor& sgemm_conv2d_pack8to1_x86_out(
     const Tensor& self,
@@ -355,14 +383,18 @@ Tensor conv2d_1x1s1_sgemm_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s1_sgemm_pack8_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s2_sgemm_pack8_x86_out(
     const Tensor& self,
@@ -370,14 +402,18 @@ Tensor conv2d_1x1s2_sgemm_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s2_sgemm_pack8_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_1x1s1_sgemm_pack8to1_x86_out(
     const Tensor& self,
@@ -421,14 +457,18 @@ Tensor conv2d_3x3s1_winograd63_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd63_pack8_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd43_pack8_x86_out(
     const Tensor& self,
@@ -436,14 +476,18 @@ Tensor conv2d_3x3s1_winograd43_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd43_pack8_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd23_pack8_x86_out(
     const Tensor& self,
@@ -451,14 +495,18 @@ Tensor conv2d_3x3s1_winograd23_pack8_x86_out(
     const Tensor& weight_o,
     const Tensor& bias,
     IntArrayRef padding,
-    Tensor& output);
+    Tensor& output,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 Tensor conv2d_3x3s1_winograd23_pack8_x86(
     const Tensor& self,
     const Tensor& weight,
     const Tensor& weight_o,
     const Tensor& bias,
-    IntArrayRef padding);
+    IntArrayRef padding,
+    int activation_type = 0,
+    const Tensor& activation_params = Tensor());
 
 #endif  // __AVX__
 #endif  // __SSE2__
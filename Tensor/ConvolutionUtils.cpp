@@ -94,6 +94,18 @@ bool ConvParams::is_transpose_depthwise(const Tensor& input, const Tensor& weigh
     !is_dilated();
 }
 
+bool ConvParams::is_dilated_depthwise(const Tensor& input, const Tensor& weight) const {
+    return (input.dim() == 4) &&
+    (input.size(1) * input.elempack() == groups) &&
+    (weight.dim() == 4) &&
+    (weight.size(0) == groups) &&
+    (weight.size(1) == 1) &&
+    (input.device() == Device::CPU) &&
+    (weight.device() == Device::CPU) &&
+    is_dilated() &&
+    !transposed;
+}
+
 bool ConvParams::use_cpu_depthwise3x3_winograd(const Tensor& input, const Tensor& weight) const {
 #if defined(__ARM_NEON__)
     // Currently only 3x3 depthwise convolutions on tensors of float are supported.
@@ -140,4 +152,118 @@ bool ConvParams::use_cpu_x86(const Tensor& input, const Tensor& weight) const {
 #endif
 }
 
+const char* conv_backend_name(ConvBackend backend) {
+#define CONV_BACKEND_CASE(name) case ConvBackend::name: return #name;
+    switch (backend) {
+        CONV_BACKEND_CASE(Winograd3x3Depthwise)
+        CONV_BACKEND_CASE(SlowDilated2d)
+        CONV_BACKEND_CASE(SlowDilated3d)
+        CONV_BACKEND_CASE(Slow2d)
+        CONV_BACKEND_CASE(SlowTranspose2d)
+        CONV_BACKEND_CASE(SlideWinTranspose2d)
+        CONV_BACKEND_CASE(SlideWin2d)
+        CONV_BACKEND_CASE(SlideWin2dInt8)
+        CONV_BACKEND_CASE(Slow3d)
+        CONV_BACKEND_CASE(Sgemm2dX86)
+        CONV_BACKEND_CASE(Winograd23X86_3x3s1)
+        CONV_BACKEND_CASE(Winograd43X86_3x3s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4_1x1s2)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack1to4)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack1to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4to1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4to1_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack1to8)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack1to8_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4to8)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack4to8_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8_1x1s2)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8to1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8to1_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8to4)
+        CONV_BACKEND_CASE(Sgemm2dX86Pack8to4_1x1s1)
+        CONV_BACKEND_CASE(Winograd63X86Pack4_3x3s1)
+        CONV_BACKEND_CASE(Winograd43X86Pack4_3x3s1)
+        CONV_BACKEND_CASE(Winograd23X86Pack4_3x3s1)
+        CONV_BACKEND_CASE(Winograd63X86Pack8_3x3s1)
+        CONV_BACKEND_CASE(Winograd43X86Pack8_3x3s1)
+        CONV_BACKEND_CASE(Winograd23X86Pack8_3x3s1)
+        CONV_BACKEND_CASE(Sgemm2dNeon)
+        CONV_BACKEND_CASE(Sgemm2dNeon_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dNeon_1x1s2)
+        CONV_BACKEND_CASE(WinogradNeon_3x3s1)
+        CONV_BACKEND_CASE(Packed2DNeon_3x3s2)
+        CONV_BACKEND_CASE(SlideWin2dNeon_1x1s1)
+        CONV_BACKEND_CASE(SlideWin2dNeon_3x3s1)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack4)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack1to4)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack1to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack4to1)
+        CONV_BACKEND_CASE(Sgemm2dNeonPack4to1_1x1s1)
+        CONV_BACKEND_CASE(Conv2dNeonPack1to4_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseX86_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseX86_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseX86Pack4)
+        CONV_BACKEND_CASE(DepthwiseX86Pack4_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseX86Pack4_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseX86Pack4_5x5s1)
+        CONV_BACKEND_CASE(DepthwiseX86Pack4_5x5s2)
+        CONV_BACKEND_CASE(DepthwiseX86Pack8_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseX86Pack8_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseX86Pack8_5x5s1)
+        CONV_BACKEND_CASE(DepthwiseX86Pack8_5x5s2)
+        CONV_BACKEND_CASE(DepthwiseNeon_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseNeon_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseNeon_5x5s1)
+        CONV_BACKEND_CASE(DepthwiseNeon_5x5s2)
+        CONV_BACKEND_CASE(DepthwiseNeonPack4)
+        CONV_BACKEND_CASE(DepthwiseNeonPack4_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseNeonPack4_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseNeonPack4_5x5s1)
+        CONV_BACKEND_CASE(DepthwiseNeonPack4_5x5s2)
+        CONV_BACKEND_CASE(DepthwiseTransposeX86Pack1)
+        CONV_BACKEND_CASE(DepthwiseTransposeX86Pack4)
+        CONV_BACKEND_CASE(Transpose2dNeon_4x4s2)
+        CONV_BACKEND_CASE(DepthwiseTransposeNeon)
+        CONV_BACKEND_CASE(DepthwiseTransposeNeonPack1)
+        CONV_BACKEND_CASE(DepthwiseTransposeNeonPack4)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack8to4)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack8to1)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack1to4)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack8to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack8to1_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack1to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8X86Pack1to4_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack8)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack1)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack8_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack8_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack8_5x5s1)
+        CONV_BACKEND_CASE(DepthwiseInt8X86Pack8_5x5s2)
+        CONV_BACKEND_CASE(Winograd23Int8X86_3x3s1)
+        CONV_BACKEND_CASE(Winograd43Int8X86_3x3s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8Neon)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack8to4)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack8to1)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack1to4)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack8to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack8to1_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack1to4_1x1s1)
+        CONV_BACKEND_CASE(Sgemm2dInt8NeonPack1to4_3x3s2)
+        CONV_BACKEND_CASE(DepthwiseInt8NeonPack8)
+        CONV_BACKEND_CASE(DepthwiseInt8NeonPack1)
+        CONV_BACKEND_CASE(DepthwiseInt8NeonPack8_3x3s1)
+        CONV_BACKEND_CASE(DepthwiseInt8NeonPack8_3x3s2)
+        CONV_BACKEND_CASE(Overrideable)
+    }
+#undef CONV_BACKEND_CASE
+    return "Unknown";
+}
+
 }   // end namespace otter
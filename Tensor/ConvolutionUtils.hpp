@@ -35,6 +35,8 @@ struct ConvParams {
     bool is_int8(const Tensor& input, const Tensor& weight) const;
     bool is_depthwise(const Tensor& input, const Tensor& weight) const;
     bool is_transpose_depthwise(const Tensor& input, const Tensor& weight) const;
+    // Depthwise shape with dilation, only the generic depthwise kernels dilate
+    bool is_dilated_depthwise(const Tensor& input, const Tensor& weight) const;
     bool use_cpu_depthwise3x3_winograd(const Tensor& input, const Tensor& weight) const;
     bool use_cpu_neon(const Tensor& input, const Tensor& weight) const;
     bool use_cpu_x86(const Tensor& input, const Tensor& weight) const;
@@ -142,6 +144,12 @@ enum class ConvBackend {
     Sgemm2dInt8X86Pack1to4_3x3s2,
     DepthwiseInt8X86Pack8,
     DepthwiseInt8X86Pack1,
+    DepthwiseInt8X86Pack8_3x3s1,
+    DepthwiseInt8X86Pack8_3x3s2,
+    DepthwiseInt8X86Pack8_5x5s1,
+    DepthwiseInt8X86Pack8_5x5s2,
+    Winograd23Int8X86_3x3s1,
+    Winograd43Int8X86_3x3s1,
     
     // int8 neon
     Sgemm2dInt8Neon,
@@ -161,6 +169,8 @@ enum class ConvBackend {
     Overrideable
 };
 
+const char* conv_backend_name(ConvBackend backend);
+
 inline std::vector<int64_t> expand_param_if_needed(IntArrayRef list_param, const char* /*param_name*/, int64_t expected_dim) {
     if (list_param.size() == 1) {
         return std::vector<int64_t>(expected_dim, list_param[0]);
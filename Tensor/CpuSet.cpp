@@ -0,0 +1,232 @@
+//
+//  CpuSet.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "CpuSet.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace otter {
+
+CpuSet::CpuSet() {
+    disable_all();
+}
+
+void CpuSet::enable(int cpu) {
+    if (cpu < 0 || cpu >= kMaxCpuCount)
+        return;
+    bits_[cpu / 64] |= uint64_t(1) << (cpu % 64);
+}
+
+void CpuSet::disable(int cpu) {
+    if (cpu < 0 || cpu >= kMaxCpuCount)
+        return;
+    bits_[cpu / 64] &= ~(uint64_t(1) << (cpu % 64));
+}
+
+void CpuSet::disable_all() {
+    memset(bits_, 0, sizeof(bits_));
+}
+
+bool CpuSet::is_enabled(int cpu) const {
+    if (cpu < 0 || cpu >= kMaxCpuCount)
+        return false;
+    return (bits_[cpu / 64] >> (cpu % 64)) & 1;
+}
+
+int CpuSet::num_enabled() const {
+    int count = 0;
+    for (uint64_t word : bits_) {
+        for (; word; word &= word - 1)
+            count++;
+    }
+    return count;
+}
+
+bool CpuSet::operator==(const CpuSet& other) const {
+    return memcmp(bits_, other.bits_, sizeof(bits_)) == 0;
+}
+
+namespace {
+
+struct CpuInfo {
+    int count = 0;
+    CpuSet all;
+    CpuSet fast;
+    CpuSet slow;
+};
+
+int read_max_freq_khz(int cpu) {
+    char path[256];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return 0;
+    
+    int max_freq_khz = 0;
+    if (fscanf(fp, "%d", &max_freq_khz) != 1)
+        max_freq_khz = 0;
+    fclose(fp);
+    
+    return max_freq_khz;
+}
+
+CpuInfo detect_cpu_info() {
+    CpuInfo info;
+    
+#if defined(__linux__)
+    info.count = (int)sysconf(_SC_NPROCESSORS_CONF);
+#else
+    info.count = (int)std::thread::hardware_concurrency();
+#endif
+    if (info.count <= 0)
+        info.count = 1;
+    if (info.count > CpuSet::kMaxCpuCount)
+        info.count = CpuSet::kMaxCpuCount;
+    
+    // Only the cpus the process is allowed on, a container may restrict them
+#if defined(__linux__)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool has_allowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    for (int cpu = 0; cpu < info.count; ++cpu) {
+        if (!has_allowed || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)))
+            info.all.enable(cpu);
+    }
+#else
+    for (int cpu = 0; cpu < info.count; ++cpu)
+        info.all.enable(cpu);
+#endif
+
+    std::vector<int> max_freq_khz(info.count, 0);
+    int min_freq = 0, max_freq = 0;
+    for (int cpu = 0; cpu < info.count; ++cpu) {
+        if (!info.all.is_enabled(cpu))
+            continue;
+        
+        max_freq_khz[cpu] = read_max_freq_khz(cpu);
+        if (max_freq_khz[cpu] <= 0)
+            continue;
+        
+        min_freq = min_freq ? std::min(min_freq, max_freq_khz[cpu]) : max_freq_khz[cpu];
+        max_freq = std::max(max_freq, max_freq_khz[cpu]);
+    }
+    
+    // Symmetric cores or no cpufreq
+    if (min_freq == max_freq) {
+        info.fast = info.all;
+        info.slow = info.all;
+        return info;
+    }
+    
+    // Split at the middle frequency, so the prime and big clusters are both fast on a three cluster soc
+    const int middle_freq = (min_freq + max_freq) / 2;
+    for (int cpu = 0; cpu < info.count; ++cpu) {
+        if (!info.all.is_enabled(cpu) || max_freq_khz[cpu] <= 0)
+            continue;
+        
+        if (max_freq_khz[cpu] >= middle_freq)
+            info.fast.enable(cpu);
+        else
+            info.slow.enable(cpu);
+    }
+    if (info.slow.empty())
+        info.slow = info.fast;
+    
+    return info;
+}
+
+const CpuInfo& cpu_info() {
+    static CpuInfo info = detect_cpu_info();
+    return info;
+}
+
+int set_sched_affinity(const CpuSet& thread_affinity_mask) {
+#if defined(__linux__)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    for (int cpu = 0; cpu < CpuSet::kMaxCpuCount && cpu < CPU_SETSIZE; ++cpu) {
+        if (thread_affinity_mask.is_enabled(cpu))
+            CPU_SET(cpu, &mask);
+    }
+    
+    // pid 0 is the calling thread
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+        fprintf(stderr, "[CpuSet] sched_setaffinity failed\n");
+        return -1;
+    }
+    
+    return 0;
+#else
+    (void)thread_affinity_mask;
+    return -1;
+#endif
+}
+
+}   // end namespace
+
+int get_cpu_count() {
+    return cpu_info().count;
+}
+
+const CpuSet& get_cpu_affinity_mask(CpuPolicy policy) {
+    const CpuInfo& info = cpu_info();
+    
+    switch (policy) {
+        case CpuPolicy::Fast: return info.fast;
+        case CpuPolicy::Slow: return info.slow;
+        default: return info.all;
+    }
+}
+
+int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask) {
+    if (thread_affinity_mask.empty())
+        return -1;
+        
+#ifdef _OPENMP
+    // Every worker of the team runs one iteration and binds itself
+    const int num_threads = get_num_threads();
+    std::vector<int> status(num_threads, 0);
+#pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+    for (int i = 0; i < num_threads; ++i) {
+        status[i] = set_sched_affinity(thread_affinity_mask);
+    }
+    
+    for (int ret : status) {
+        if (ret != 0)
+            return ret;
+    }
+    
+    return 0;
+#else
+    return set_sched_affinity(thread_affinity_mask);
+#endif
+}
+
+int set_cpu_policy(CpuPolicy policy) {
+    const CpuSet& thread_affinity_mask = get_cpu_affinity_mask(policy);
+    
+    set_num_threads(thread_affinity_mask.num_enabled());
+    
+    return set_cpu_thread_affinity(thread_affinity_mask);
+}
+
+}   // end namespace otter
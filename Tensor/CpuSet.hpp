@@ -0,0 +1,55 @@
+//
+//  CpuSet.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef CpuSet_hpp
+#define CpuSet_hpp
+
+#include <cstdint>
+
+namespace otter {
+
+// Set of logical cpus, the same role as a sched_setaffinity mask
+class CpuSet {
+public:
+    static constexpr int kMaxCpuCount = 1024;
+    
+    CpuSet();
+    
+    void enable(int cpu);
+    void disable(int cpu);
+    void disable_all();
+    
+    bool is_enabled(int cpu) const;
+    int num_enabled() const;
+    bool empty() const { return num_enabled() == 0; }
+    
+    bool operator==(const CpuSet& other) const;
+    bool operator!=(const CpuSet& other) const { return !(*this == other); }
+private:
+    uint64_t bits_[kMaxCpuCount / 64];
+};
+
+enum class CpuPolicy {
+    All,    // Every cpu the process may run on
+    Fast,   // The big cores, by the max frequency under /sys/devices/system/cpu
+    Slow    // The little cores
+};
+
+int get_cpu_count();
+
+// All, Fast and Slow are the same set when the cores do not differ or the frequencies are unknown
+const CpuSet& get_cpu_affinity_mask(CpuPolicy policy);
+
+// Bind the calling thread and its OpenMP workers to the mask, return -1 where affinity is unsupported
+int set_cpu_thread_affinity(const CpuSet& thread_affinity_mask);
+
+// Bind to the cpus of the policy and use one intra-op thread per cpu
+int set_cpu_policy(CpuPolicy policy);
+
+}   // end namespace otter
+
+#endif /* CpuSet_hpp */
@@ -84,16 +84,7 @@ int DeconvolutionLayer::parse_param(LayerOption& option, ParamDict& pd) {
     
     std::string activation = opt_find_string(option, "activation", "");
     
-    int activation_type = 0;
-    if (activation == "Relu") {
-        activation_type = 1;
-    } else if (activation == "LRelu") {
-        activation_type = 2;
-    } else if (activation == "Relu6") {
-        activation_type = 3;
-    } else if (activation == "Sigmoid") {
-        activation_type = 4;
-    }
+    int activation_type = activation_type_from_string(activation);
     
     Tensor activation_params;
     if (opt_check_string(option, "activation_params")) {
@@ -210,8 +201,6 @@ int DeconvolutionLayer::load_model(const Initializer& initializer) {
 
 int DeconvolutionLayer::create_pipeline(const NetOption& opt) {
     
-    activation = create_activation_layer(activation_type, activation_params);
-    
     int out_elempack = 1;
 #if __SSE2__
     if (opt.use_packing_layout) {
@@ -300,9 +289,7 @@ int DeconvolutionLayer::forward(const Tensor &bottom_blob, Tensor &top_blob, con
         opt.use_packing_layout
     );
     
-    if (activation) {
-        activation->forward_inplace(top_blob, opt);
-    }
+    activation_inplace(top_blob, activation_type, activation_params);
     
     return 0;
 }
@@ -53,7 +53,6 @@ public:
     int weight_data_size;
     
     int activation_type;
-    Layer* activation;
     Tensor activation_params;
     
     Tensor weight_data;
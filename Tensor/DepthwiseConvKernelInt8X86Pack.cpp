@@ -132,6 +132,193 @@ Tensor depthwise_conv2d_int8_x86_pack8(
     return depthwise_conv2d_int8_x86_pack8_out(self, weight, weight_o, kernel_size, stride, padding, dilation, output);
 }
 
+// Two taps share one madd, the int8 of tap k and tap k + 1 are interleaved so that
+// madd_epi16 yields the sums of both taps for the 8 packed channels at once
+template <int kernel, int stride>
+static Tensor& depthwise_conv2d_kxk_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    constexpr int maxk = kernel * kernel;
+    constexpr int npair = (maxk + 1) / 2;
+    
+    auto input = otter::constant_pad(self, {padding[1], padding[1], padding[0], padding[0]}, 0);
+    auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), {stride, stride}, padding);
+    output.resize_({output_size[0], output_size[1] / 8, output_size[2], output_size[3]});
+    
+    const int channels = int(input.size(1));
+    const int w = int(input.size(3));
+    const int outw = int(output.size(3));
+    const int outh = int(output.size(2));
+    const int group = int(self.size(1) * self.elempack());
+    
+    Tensor weight_data_packed;
+    if (weight_o.defined())
+        weight_data_packed = weight_o;
+    else
+        weight_data_packed = weight.view({group, maxk}).packing(8);
+    
+    int space_ofs[npair * 2];
+    for (int k = 0; k < npair * 2; ++k) {
+        // the padding tap of odd maxk reads a valid pixel and meets a zero weight
+        const int kk = (k < maxk) ? k : 0;
+        space_ofs[k] = ((kk / kernel) * w + kk % kernel) * 8;
+    }
+    
+    auto input_a = input.accessor<signed char, 4, 8>()[0];
+    auto output_ra = output.raw_accessor<int, 4>()[0];
+    const signed char* weight_data_tm_ptr = (const signed char*)weight_data_packed.data_ptr();
+    
+    otter::parallel_for(0, channels, 0, [&](int64_t begin, int64_t end) {
+        for (const auto g : otter::irange(begin, end)) {
+            int* outptr = output_ra[g].data();
+            const signed char* kptr = weight_data_tm_ptr + maxk * g * 8;
+            const signed char* img = input_a[g].data();
+            
+#if __AVX2__
+            __m256i _w[npair];
+            for (int p = 0; p < npair; ++p) {
+                __m128i _w0 = _mm_loadl_epi64((const __m128i*)(kptr + p * 2 * 8));
+                __m128i _w1 = (p * 2 + 1 < maxk) ? _mm_loadl_epi64((const __m128i*)(kptr + (p * 2 + 1) * 8)) : _mm_setzero_si128();
+                _w[p] = _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_w0, _w1));
+            }
+#else
+            __m128i _wl[npair];
+            __m128i _wh[npair];
+            for (int p = 0; p < npair; ++p) {
+                __m128i _w0 = _mm_loadl_epi64((const __m128i*)(kptr + p * 2 * 8));
+                __m128i _w1 = (p * 2 + 1 < maxk) ? _mm_loadl_epi64((const __m128i*)(kptr + (p * 2 + 1) * 8)) : _mm_setzero_si128();
+                _w0 = _mm_unpacklo_epi8(_w0, _mm_cmpgt_epi8(_mm_setzero_si128(), _w0));
+                _w1 = _mm_unpacklo_epi8(_w1, _mm_cmpgt_epi8(_mm_setzero_si128(), _w1));
+                _wl[p] = _mm_unpacklo_epi16(_w0, _w1);
+                _wh[p] = _mm_unpackhi_epi16(_w0, _w1);
+            }
+#endif
+            
+            for (int i = 0; i < outh; i++) {
+                const signed char* sptr = img + i * stride * w * 8;
+                
+                for (int j = 0; j < outw; j++) {
+#if __AVX2__
+                    __m256i _sum = _mm256_setzero_si256();
+                    for (int p = 0; p < npair; ++p) {
+                        __m128i _v0 = _mm_loadl_epi64((const __m128i*)(sptr + space_ofs[p * 2]));
+                        __m128i _v1 = _mm_loadl_epi64((const __m128i*)(sptr + space_ofs[p * 2 + 1]));
+                        __m256i _v = _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(_v0, _v1));
+                        _sum = _mm256_add_epi32(_sum, _mm256_madd_epi16(_v, _w[p]));
+                    }
+                    _mm256_storeu_si256((__m256i*)outptr, _sum);
+#else
+                    __m128i _sum0 = _mm_setzero_si128();
+                    __m128i _sum1 = _mm_setzero_si128();
+                    for (int p = 0; p < npair; ++p) {
+                        __m128i _v0 = _mm_loadl_epi64((const __m128i*)(sptr + space_ofs[p * 2]));
+                        __m128i _v1 = _mm_loadl_epi64((const __m128i*)(sptr + space_ofs[p * 2 + 1]));
+                        _v0 = _mm_unpacklo_epi8(_v0, _mm_cmpgt_epi8(_mm_setzero_si128(), _v0));
+                        _v1 = _mm_unpacklo_epi8(_v1, _mm_cmpgt_epi8(_mm_setzero_si128(), _v1));
+                        _sum0 = _mm_add_epi32(_sum0, _mm_madd_epi16(_mm_unpacklo_epi16(_v0, _v1), _wl[p]));
+                        _sum1 = _mm_add_epi32(_sum1, _mm_madd_epi16(_mm_unpackhi_epi16(_v0, _v1), _wh[p]));
+                    }
+                    _mm_storeu_si128((__m128i*)outptr, _sum0);
+                    _mm_storeu_si128((__m128i*)(outptr + 4), _sum1);
+#endif
+                    sptr += stride * 8;
+                    outptr += 8;
+                }
+            }
+        }
+    });
+    
+    return output;
+}
+
+Tensor& depthwise_conv2d_3x3s1_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return depthwise_conv2d_kxk_int8_x86_pack8_out<3, 1>(self, weight, weight_o, padding, output);
+}
+
+Tensor depthwise_conv2d_3x3s1_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding) {
+    
+    auto output = otter::empty({}, otter::ScalarType::Int8);
+    
+    return depthwise_conv2d_3x3s1_int8_x86_pack8_out(self, weight, weight_o, padding, output);
+}
+
+Tensor& depthwise_conv2d_3x3s2_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return depthwise_conv2d_kxk_int8_x86_pack8_out<3, 2>(self, weight, weight_o, padding, output);
+}
+
+Tensor depthwise_conv2d_3x3s2_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding) {
+    
+    auto output = otter::empty({}, otter::ScalarType::Int8);
+    
+    return depthwise_conv2d_3x3s2_int8_x86_pack8_out(self, weight, weight_o, padding, output);
+}
+
+Tensor& depthwise_conv2d_5x5s1_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return depthwise_conv2d_kxk_int8_x86_pack8_out<5, 1>(self, weight, weight_o, padding, output);
+}
+
+Tensor depthwise_conv2d_5x5s1_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding) {
+    
+    auto output = otter::empty({}, otter::ScalarType::Int8);
+    
+    return depthwise_conv2d_5x5s1_int8_x86_pack8_out(self, weight, weight_o, padding, output);
+}
+
+Tensor& depthwise_conv2d_5x5s2_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output) {
+    
+    return depthwise_conv2d_kxk_int8_x86_pack8_out<5, 2>(self, weight, weight_o, padding, output);
+}
+
+Tensor depthwise_conv2d_5x5s2_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding) {
+    
+    auto output = otter::empty({}, otter::ScalarType::Int8);
+    
+    return depthwise_conv2d_5x5s2_int8_x86_pack8_out(self, weight, weight_o, padding, output);
+}
+
 Tensor& depthwise_conv2d_int8_x86_pack1_out(
     const Tensor& self,
     const Tensor& weight,
@@ -144,7 +331,7 @@ Tensor& depthwise_conv2d_int8_x86_pack1_out(
     
     auto input = otter::constant_pad(self, {padding[1], padding[1], padding[0], padding[0]}, 0);
     auto output_size = otter::calculate_conv_output_size(self.sizes(), weight.sizes(), stride, padding, dilation);
-    output.resize_({output_size[0], output_size[1] / 8, output_size[2], output_size[3]});
+    output.resize_({output_size[0], output_size[1], output_size[2], output_size[3]});
     
     const int kernel_h = kernel_size[0];
     const int kernel_w = kernel_size[1];
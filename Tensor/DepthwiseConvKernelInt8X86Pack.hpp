@@ -40,6 +40,7 @@ Tensor& depthwise_conv2d_int8_x86_pack1_out(
     IntArrayRef kernel_size,
     IntArrayRef stride,
     IntArrayRef padding,
+    IntArrayRef dilation,
     Tensor& output);
 
 Tensor depthwise_conv2d_int8_x86_pack1(
@@ -51,6 +52,58 @@ Tensor depthwise_conv2d_int8_x86_pack1(
     IntArrayRef padding,
     IntArrayRef dilation);
 
+Tensor& depthwise_conv2d_3x3s1_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor depthwise_conv2d_3x3s1_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding);
+
+Tensor& depthwise_conv2d_3x3s2_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor depthwise_conv2d_3x3s2_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding);
+
+Tensor& depthwise_conv2d_5x5s1_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor depthwise_conv2d_5x5s1_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding);
+
+Tensor& depthwise_conv2d_5x5s2_int8_x86_pack8_out(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding,
+    Tensor& output);
+
+Tensor depthwise_conv2d_5x5s2_int8_x86_pack8(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& weight_o,
+    IntArrayRef padding);
+
 #endif
 
 }   // end namespace otter
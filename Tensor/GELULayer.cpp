@@ -0,0 +1,35 @@
+//
+//  GELULayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "GELULayer.hpp"
+#include "ActivationLayer.hpp"
+
+namespace otter {
+
+GELULayer::GELULayer() {
+    one_blob_only = true;
+    support_inplace = true;
+    support_tiling = true;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int GELULayer::load_param(const ParamDict& /*pd*/) {
+    return 0;
+}
+
+int GELULayer::forward_inplace(Tensor& bottom_blob, const NetOption& /*opt*/) const {
+    activation_inplace(bottom_blob, 9, Tensor());
+    
+    return 0;
+}
+
+}   // end namespace otter
@@ -0,0 +1,28 @@
+//
+//  GELULayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef GELULayer_hpp
+#define GELULayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class GELULayer : public Layer {
+public:
+    GELULayer();
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "GELU"; }
+};
+
+}   // end namespace otter
+
+#endif /* GELULayer_hpp */
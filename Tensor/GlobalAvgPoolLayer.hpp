@@ -0,0 +1,28 @@
+//
+//  GlobalAvgPoolLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef GlobalAvgPoolLayer_hpp
+#define GlobalAvgPoolLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class GlobalAvgPoolLayer : public Layer {
+public:
+    GlobalAvgPoolLayer();
+    
+    virtual int compute_output_shape(ParamDict &pd);
+    
+    virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "GlobalAvgPool"; }
+};
+
+}   // end namespace otter
+
+#endif /* GlobalAvgPoolLayer_hpp */
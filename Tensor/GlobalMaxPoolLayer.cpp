@@ -0,0 +1,42 @@
+//
+//  GlobalMaxPoolLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "GlobalMaxPoolLayer.hpp"
+#include "Pool.hpp"
+
+#include "TensorMaker.hpp"
+
+namespace otter {
+
+GlobalMaxPoolLayer::GlobalMaxPoolLayer() {
+    one_blob_only = true;
+    support_inplace = false;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int GlobalMaxPoolLayer::compute_output_shape(ParamDict &pd) {
+    auto shape_a = bottom_shapes[0].accessor<int, 2>()[0];
+    int input_batch = shape_a[0];
+    int input_channels = shape_a[1];
+    
+    pd.set(OUTPUT_SHAPE_HINT, otter::tensor({input_batch, input_channels, 1, 1}, ScalarType::Int).view({1, -1}));
+    
+    return 0;
+}
+
+int GlobalMaxPoolLayer::forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& /*opt*/) const {
+    top_blob = otter::global_max_pool2d(bottom_blob);
+    
+    return 0;
+}
+
+}   // end namespace otter
@@ -0,0 +1,28 @@
+//
+//  GlobalMaxPoolLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef GlobalMaxPoolLayer_hpp
+#define GlobalMaxPoolLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class GlobalMaxPoolLayer : public Layer {
+public:
+    GlobalMaxPoolLayer();
+    
+    virtual int compute_output_shape(ParamDict &pd);
+    
+    virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "GlobalMaxPool"; }
+};
+
+}   // end namespace otter
+
+#endif /* GlobalMaxPoolLayer_hpp */
@@ -331,6 +331,14 @@ public:
         val[1] = val_2;
     }
     
+    Vec_(scalar_t val_1, scalar_t val_2, scalar_t val_3, scalar_t val_4) {
+        static_assert(l >= 4, "Vec_ is too short");
+        val[0] = val_1;
+        val[1] = val_2;
+        val[2] = val_3;
+        val[3] = val_4;
+    }
+    
     scalar_t operator[](int index) {
         return val[index];
     }
@@ -340,6 +348,7 @@ private:
 
 typedef Vec_<int, 2> Vec2i;
 typedef Vec_<float, 2> Vec2f;
+typedef Vec_<int, 4> Vec4i;
 
 template <typename scalar_t, int l>
 inline std::ostream& operator<<(std::ostream& o, Vec_<scalar_t, l>& vec) {
@@ -0,0 +1,53 @@
+//
+//  HardSigmoidLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "HardSigmoidLayer.hpp"
+#include "ActivationLayer.hpp"
+#include "TensorMaker.hpp"
+
+namespace otter {
+
+HardSigmoidLayer::HardSigmoidLayer() {
+    one_blob_only = true;
+    support_inplace = true;
+    support_tiling = true;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int HardSigmoidLayer::parse_param(LayerOption& option, ParamDict& pd) {
+    pd.clear();
+    
+    float alpha = opt_find_float(option, "alpha", 1.f / 6);
+    float beta = opt_find_float(option, "beta", 0.5f);
+    
+    pd.set((int)HardSigmoidParam::Alpha, alpha);
+    pd.set((int)HardSigmoidParam::Beta, beta);
+    
+    return 0;
+}
+
+int HardSigmoidLayer::load_param(const ParamDict& pd) {
+    alpha = pd.get((int)HardSigmoidParam::Alpha, 1.f / 6);
+    beta = pd.get((int)HardSigmoidParam::Beta, 0.5f);
+    
+    activation_params = otter::tensor({alpha, beta}, otter::ScalarType::Float);
+    
+    return 0;
+}
+
+int HardSigmoidLayer::forward_inplace(Tensor& bottom_blob, const NetOption& /*opt*/) const {
+    activation_inplace(bottom_blob, 7, activation_params);
+    
+    return 0;
+}
+
+}   // end namespace otter
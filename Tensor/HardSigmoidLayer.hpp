@@ -0,0 +1,39 @@
+//
+//  HardSigmoidLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef HardSigmoidLayer_hpp
+#define HardSigmoidLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class HardSigmoidLayer : public Layer {
+public:
+    HardSigmoidLayer();
+    
+    virtual int parse_param(LayerOption& option, ParamDict& pd);
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "HardSigmoid"; }
+private:
+    float alpha;
+    float beta;
+    Tensor activation_params;
+};
+
+enum class HardSigmoidParam {
+    Alpha = 0,
+    Beta
+};
+
+}   // end namespace otter
+
+#endif /* HardSigmoidLayer_hpp */
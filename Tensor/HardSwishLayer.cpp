@@ -0,0 +1,53 @@
+//
+//  HardSwishLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "HardSwishLayer.hpp"
+#include "ActivationLayer.hpp"
+#include "TensorMaker.hpp"
+
+namespace otter {
+
+HardSwishLayer::HardSwishLayer() {
+    one_blob_only = true;
+    support_inplace = true;
+    support_tiling = true;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int HardSwishLayer::parse_param(LayerOption& option, ParamDict& pd) {
+    pd.clear();
+    
+    float alpha = opt_find_float(option, "alpha", 1.f / 6);
+    float beta = opt_find_float(option, "beta", 0.5f);
+    
+    pd.set((int)HardSwishParam::Alpha, alpha);
+    pd.set((int)HardSwishParam::Beta, beta);
+    
+    return 0;
+}
+
+int HardSwishLayer::load_param(const ParamDict& pd) {
+    alpha = pd.get((int)HardSwishParam::Alpha, 1.f / 6);
+    beta = pd.get((int)HardSwishParam::Beta, 0.5f);
+    
+    activation_params = otter::tensor({alpha, beta}, otter::ScalarType::Float);
+    
+    return 0;
+}
+
+int HardSwishLayer::forward_inplace(Tensor& bottom_blob, const NetOption& /*opt*/) const {
+    activation_inplace(bottom_blob, 6, activation_params);
+    
+    return 0;
+}
+
+}   // end namespace otter
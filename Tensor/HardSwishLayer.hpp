@@ -0,0 +1,39 @@
+//
+//  HardSwishLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef HardSwishLayer_hpp
+#define HardSwishLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class HardSwishLayer : public Layer {
+public:
+    HardSwishLayer();
+    
+    virtual int parse_param(LayerOption& option, ParamDict& pd);
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "HardSwish"; }
+private:
+    float alpha;
+    float beta;
+    Tensor activation_params;
+};
+
+enum class HardSwishParam {
+    Alpha = 0,
+    Beta
+};
+
+}   // end namespace otter
+
+#endif /* HardSwishLayer_hpp */
@@ -8,6 +8,8 @@
 // Both this code and the orignal code are published under the BSD license.
 // by Cong Ma, 2016
 //
+// The Munkres steps are replaced by otter::cv::LinearAssignment, the interface is kept for compatibility.
+//
 
 #ifndef Hungarian_hpp
 #define Hungarian_hpp
@@ -16,6 +18,8 @@
 #include <vector>
 #include <float.h>
 
+#include "LinearAssignment.hpp"
+
 using namespace std;
 
 
@@ -27,14 +31,8 @@ public:
     double Solve(vector<vector<double>>& DistMatrix, vector<int>& Assignment);
 
 private:
-    void assignmentoptimal(int *assignment, double *cost, double *distMatrix, int nOfRows, int nOfColumns);
-    void buildassignmentvector(int *assignment, bool *starMatrix, int nOfRows, int nOfColumns);
-    void computeassignmentcost(int *assignment, double *cost, double *distMatrix, int nOfRows);
-    void step2a(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-    void step2b(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-    void step3(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-    void step4(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim, int row, int col);
-    void step5(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
+    otter::cv::LinearAssignment solver;
+    vector<float> distMatrix;
 };
 
 #endif
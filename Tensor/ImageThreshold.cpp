@@ -9,71 +9,495 @@
 
 #include "Tensor.hpp"
 #include "Dispatch.hpp"
+#include "Parallel.hpp"
+#include "TensorIterator.hpp"
+#include "VecIntrinsic.hpp"
 
 #include "TensorFactory.hpp"
-#include "TensorFunction.hpp"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
 
 namespace otter {
 namespace cv {
 
-Tensor threshold_binary(const Tensor& self, double threshold, double true_value, double false_value);
-
-Tensor threshold(const Tensor& self, double threshold, double maxval, int type) {
-    switch (type) {
-        case THRESH_BINARY:
-            return threshold_binary(self, threshold, maxval, 0);
-            break;
-        case THRESH_TRUNC:
-            return otter::native::threshold(self, threshold, maxval);
-            break;
-            
-        default:
-            break;
-    }
-    OTTER_CHECK(false, "Invalid threshold mode!");
-    return Tensor();
+static inline unsigned char saturate_byte(double v) {
+    int iv = (int)std::round(v);
+    return (unsigned char)std::min(std::max(iv, 0), 255);
 }
 
-Tensor threshold_binary(const Tensor& self, double threshold, double true_value, double false_value) {
-    auto out = otter::zeros_like(self, self.scalar_type());
-    
-    int num_pixels = (int)(self.size(0) * self.size(1));
-    
-    if (self.scalar_type() == otter::ScalarType::Byte) {
-        unsigned char *src = self.data_ptr<unsigned char>();
-        unsigned char *ptr = out.data_ptr<unsigned char>();
-        
+// thresh must lie in [0, 254], the out of range case is resolved by the caller
+template <int Mode>
+static void threshold_byte_kernel(const unsigned char* src, unsigned char* dst, int64_t size, unsigned char thresh, unsigned char maxval) {
+    int64_t i = 0;
 #if __ARM_NEON
-        int remain = num_pixels;
-#else
-        int remain = num_pixels;
-#endif  // __ARM_NEON
-        
-        if (true_value == 255 && false_value == 0) {
+    uint8x16_t _thresh = vdupq_n_u8(thresh);
+    uint8x16_t _maxval = vdupq_n_u8(maxval);
+    for (; i + 15 < size; i += 16) {
+        uint8x16_t _s = vld1q_u8(src + i);
+        uint8x16_t _mask = vcgtq_u8(_s, _thresh);
+        uint8x16_t _d;
+        if (Mode == THRESH_BINARY)
+            _d = vandq_u8(_mask, _maxval);
+        else if (Mode == THRESH_BINARY_INV)
+            _d = vbicq_u8(_maxval, _mask);
+        else if (Mode == THRESH_TRUNC)
+            _d = vminq_u8(_s, _thresh);
+        else if (Mode == THRESH_TOZERO)
+            _d = vandq_u8(_mask, _s);
+        else
+            _d = vbicq_u8(_s, _mask);
+        vst1q_u8(dst + i, _d);
+    }
+#elif __SSE2__
+    // unsigned compare through the signed one by flipping the sign bit
+#if __AVX2__
+    __m256i _sign_avx = _mm256_set1_epi8((char)0x80);
+    __m256i _thresh_avx = _mm256_set1_epi8((char)thresh);
+    __m256i _thresh_s_avx = _mm256_set1_epi8((char)(thresh ^ 0x80));
+    __m256i _maxval_avx = _mm256_set1_epi8((char)maxval);
+    for (; i + 31 < size; i += 32) {
+        __m256i _s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i _mask = _mm256_cmpgt_epi8(_mm256_xor_si256(_s, _sign_avx), _thresh_s_avx);
+        __m256i _d;
+        if (Mode == THRESH_BINARY)
+            _d = _mm256_and_si256(_mask, _maxval_avx);
+        else if (Mode == THRESH_BINARY_INV)
+            _d = _mm256_andnot_si256(_mask, _maxval_avx);
+        else if (Mode == THRESH_TRUNC)
+            _d = _mm256_min_epu8(_s, _thresh_avx);
+        else if (Mode == THRESH_TOZERO)
+            _d = _mm256_and_si256(_mask, _s);
+        else
+            _d = _mm256_andnot_si256(_mask, _s);
+        _mm256_storeu_si256((__m256i*)(dst + i), _d);
+    }
+#endif // __AVX2__
+    __m128i _sign = _mm_set1_epi8((char)0x80);
+    __m128i _thresh = _mm_set1_epi8((char)thresh);
+    __m128i _thresh_s = _mm_set1_epi8((char)(thresh ^ 0x80));
+    __m128i _maxval = _mm_set1_epi8((char)maxval);
+    for (; i + 15 < size; i += 16) {
+        __m128i _s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i _mask = _mm_cmpgt_epi8(_mm_xor_si128(_s, _sign), _thresh_s);
+        __m128i _d;
+        if (Mode == THRESH_BINARY)
+            _d = _mm_and_si128(_mask, _maxval);
+        else if (Mode == THRESH_BINARY_INV)
+            _d = _mm_andnot_si128(_mask, _maxval);
+        else if (Mode == THRESH_TRUNC)
+            _d = _mm_min_epu8(_s, _thresh);
+        else if (Mode == THRESH_TOZERO)
+            _d = _mm_and_si128(_mask, _s);
+        else
+            _d = _mm_andnot_si128(_mask, _s);
+        _mm_storeu_si128((__m128i*)(dst + i), _d);
+    }
+#endif // __SSE2__
+    for (; i < size; i++) {
+        unsigned char s = src[i];
+        bool above = s > thresh;
+        if (Mode == THRESH_BINARY)
+            dst[i] = above ? maxval : 0;
+        else if (Mode == THRESH_BINARY_INV)
+            dst[i] = above ? 0 : maxval;
+        else if (Mode == THRESH_TRUNC)
+            dst[i] = above ? thresh : s;
+        else if (Mode == THRESH_TOZERO)
+            dst[i] = above ? s : 0;
+        else
+            dst[i] = above ? 0 : s;
+    }
+}
+
+template <int Mode>
+static void threshold_float_kernel(const float* src, float* dst, int64_t size, float thresh, float maxval) {
+    int64_t i = 0;
 #if __ARM_NEON
-            
-#endif
-            for ( ; remain > 0; --remain) {
-                *ptr = (*src > threshold) ? 255 : 0;
-                
-                ++src;
-                ++ptr;
-            }
+    float32x4_t _thresh = vdupq_n_f32(thresh);
+    uint32x4_t _maxval = vreinterpretq_u32_f32(vdupq_n_f32(maxval));
+    for (; i + 3 < size; i += 4) {
+        float32x4_t _s = vld1q_f32(src + i);
+        uint32x4_t _mask = vcgtq_f32(_s, _thresh);
+        float32x4_t _d;
+        if (Mode == THRESH_BINARY)
+            _d = vreinterpretq_f32_u32(vandq_u32(_mask, _maxval));
+        else if (Mode == THRESH_BINARY_INV)
+            _d = vreinterpretq_f32_u32(vbicq_u32(_maxval, _mask));
+        else if (Mode == THRESH_TRUNC)
+            _d = vminq_f32(_s, _thresh);
+        else if (Mode == THRESH_TOZERO)
+            _d = vreinterpretq_f32_u32(vandq_u32(_mask, vreinterpretq_u32_f32(_s)));
+        else
+            _d = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(_s), _mask));
+        vst1q_f32(dst + i, _d);
+    }
+#elif __SSE2__
+#if __AVX__
+    __m256 _thresh_avx = _mm256_set1_ps(thresh);
+    __m256 _maxval_avx = _mm256_set1_ps(maxval);
+    for (; i + 7 < size; i += 8) {
+        __m256 _s = _mm256_loadu_ps(src + i);
+        __m256 _mask = _mm256_cmp_ps(_s, _thresh_avx, _CMP_GT_OQ);
+        __m256 _d;
+        if (Mode == THRESH_BINARY)
+            _d = _mm256_and_ps(_mask, _maxval_avx);
+        else if (Mode == THRESH_BINARY_INV)
+            _d = _mm256_andnot_ps(_mask, _maxval_avx);
+        else if (Mode == THRESH_TRUNC)
+            _d = _mm256_min_ps(_s, _thresh_avx);
+        else if (Mode == THRESH_TOZERO)
+            _d = _mm256_and_ps(_mask, _s);
+        else
+            _d = _mm256_andnot_ps(_mask, _s);
+        _mm256_storeu_ps(dst + i, _d);
+    }
+#endif // __AVX__
+    __m128 _thresh = _mm_set1_ps(thresh);
+    __m128 _maxval = _mm_set1_ps(maxval);
+    for (; i + 3 < size; i += 4) {
+        __m128 _s = _mm_loadu_ps(src + i);
+        __m128 _mask = _mm_cmpgt_ps(_s, _thresh);
+        __m128 _d;
+        if (Mode == THRESH_BINARY)
+            _d = _mm_and_ps(_mask, _maxval);
+        else if (Mode == THRESH_BINARY_INV)
+            _d = _mm_andnot_ps(_mask, _maxval);
+        else if (Mode == THRESH_TRUNC)
+            _d = _mm_min_ps(_s, _thresh);
+        else if (Mode == THRESH_TOZERO)
+            _d = _mm_and_ps(_mask, _s);
+        else
+            _d = _mm_andnot_ps(_mask, _s);
+        _mm_storeu_ps(dst + i, _d);
+    }
+#endif // __SSE2__
+    for (; i < size; i++) {
+        float s = src[i];
+        bool above = s > thresh;
+        if (Mode == THRESH_BINARY)
+            dst[i] = above ? maxval : 0.f;
+        else if (Mode == THRESH_BINARY_INV)
+            dst[i] = above ? 0.f : maxval;
+        else if (Mode == THRESH_TRUNC)
+            dst[i] = above ? thresh : s;
+        else if (Mode == THRESH_TOZERO)
+            dst[i] = above ? s : 0.f;
+        else
+            dst[i] = above ? 0.f : s;
+    }
+}
+
+static void threshold_byte(const unsigned char* src, unsigned char* dst, int64_t size, double thresh, double maxval, int mode) {
+    int ithresh = (int)std::floor(thresh);
+    unsigned char imaxval = saturate_byte(maxval);
+
+    // every pixel falls on the same side of the threshold
+    if (ithresh < 0 || ithresh >= 255) {
+        bool above = ithresh < 0;
+        if (mode == THRESH_BINARY || mode == THRESH_BINARY_INV || ((mode == THRESH_TRUNC || mode == THRESH_TOZERO_INV) && above) || (mode == THRESH_TOZERO && !above)) {
+            unsigned char v = (mode == THRESH_BINARY) ? (above ? imaxval : 0) : (mode == THRESH_BINARY_INV) ? (above ? 0 : imaxval) : 0;
+            std::fill(dst, dst + size, v);
         } else {
-#if __ARM_NEON
-            
-#endif
-            for ( ; remain > 0; --remain) {
-                *ptr = (*src > threshold) ? true_value : false_value;
-                
-                ++src;
-                ++ptr;
-            }
+            std::copy(src, src + size, dst);
         }
+        return;
+    }
+
+    unsigned char t = (unsigned char)ithresh;
+
+    otter::parallel_for(0, size, otter::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        const unsigned char* s = src + begin;
+        unsigned char* d = dst + begin;
+        int64_t n = end - begin;
+        switch (mode) {
+            case THRESH_BINARY: threshold_byte_kernel<THRESH_BINARY>(s, d, n, t, imaxval); break;
+            case THRESH_BINARY_INV: threshold_byte_kernel<THRESH_BINARY_INV>(s, d, n, t, imaxval); break;
+            case THRESH_TRUNC: threshold_byte_kernel<THRESH_TRUNC>(s, d, n, t, imaxval); break;
+            case THRESH_TOZERO: threshold_byte_kernel<THRESH_TOZERO>(s, d, n, t, imaxval); break;
+            default: threshold_byte_kernel<THRESH_TOZERO_INV>(s, d, n, t, imaxval); break;
+        }
+    });
+}
+
+static void threshold_float(const float* src, float* dst, int64_t size, double thresh, double maxval, int mode) {
+    float t = (float)thresh;
+    float v = (float)maxval;
+
+    otter::parallel_for(0, size, otter::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        const float* s = src + begin;
+        float* d = dst + begin;
+        int64_t n = end - begin;
+        switch (mode) {
+            case THRESH_BINARY: threshold_float_kernel<THRESH_BINARY>(s, d, n, t, v); break;
+            case THRESH_BINARY_INV: threshold_float_kernel<THRESH_BINARY_INV>(s, d, n, t, v); break;
+            case THRESH_TRUNC: threshold_float_kernel<THRESH_TRUNC>(s, d, n, t, v); break;
+            case THRESH_TOZERO: threshold_float_kernel<THRESH_TOZERO>(s, d, n, t, v); break;
+            default: threshold_float_kernel<THRESH_TOZERO_INV>(s, d, n, t, v); break;
+        }
+    });
+}
+
+Tensor threshold(const Tensor& self, double threshold, double maxval, int type) {
+    int mode = type & THRESH_MASK;
+    OTTER_CHECK(mode <= THRESH_TOZERO_INV, "Invalid threshold mode!");
+    OTTER_CHECK(self.scalar_type() == otter::ScalarType::Byte || self.scalar_type() == otter::ScalarType::Float, "Threshold only support Byte and Float but get ", self.scalar_type());
+
+    if (type & THRESH_OTSU)
+        threshold = otsuThreshold(self);
+
+    auto input = self.contiguous();
+    auto out = otter::empty_like(input);
+
+    if (input.scalar_type() == otter::ScalarType::Byte) {
+        threshold_byte(input.data_ptr<unsigned char>(), out.data_ptr<unsigned char>(), input.numel(), threshold, maxval, mode);
     } else {
-        
+        threshold_float(input.data_ptr<float>(), out.data_ptr<float>(), input.numel(), threshold, maxval, mode);
+    }
+
+    return out;
+}
+
+double otsuThreshold(const Tensor& self) {
+    OTTER_CHECK(self.scalar_type() == otter::ScalarType::Byte, "Otsu threshold only support Byte but get ", self.scalar_type());
+
+    auto input = self.contiguous();
+    const unsigned char* src = input.data_ptr<unsigned char>();
+    const int64_t size = input.numel();
+
+    if (size == 0)
+        return 0;
+
+    // one histogram per chunk, summed afterwards
+    const int num_chunk = (int)std::max<int64_t>(1, std::min<int64_t>(otter::get_num_threads(), size / otter::GRAIN_SIZE));
+    std::vector<int64_t> chunk_hist(num_chunk * 256, 0);
+
+    otter::parallel_for(0, num_chunk, 0, [&](int64_t begin, int64_t end) {
+        for (const auto c : otter::irange(begin, end)) {
+            int64_t* hist = chunk_hist.data() + c * 256;
+            int64_t b = size * c / num_chunk;
+            int64_t e = size * (c + 1) / num_chunk;
+            for (int64_t i = b; i < e; i++) {
+                hist[src[i]]++;
+            }
+        }
+    });
+
+    int64_t hist[256] = {0};
+    for (int c = 0; c < num_chunk; c++) {
+        for (int i = 0; i < 256; i++) {
+            hist[i] += chunk_hist[c * 256 + i];
+        }
+    }
+
+    const double scale = 1.0 / size;
+    double mu = 0;
+    for (int i = 0; i < 256; i++) {
+        mu += i * (double)hist[i];
     }
-    
+    mu *= scale;
+
+    double mu1 = 0, q1 = 0;
+    double max_sigma = 0, max_val = 0;
+    for (int i = 0; i < 256; i++) {
+        double p_i = hist[i] * scale;
+        mu1 *= q1;
+        q1 += p_i;
+        double q2 = 1. - q1;
+
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON)
+            continue;
+
+        mu1 = (mu1 + i * p_i) / q1;
+        double mu2 = (mu - q1 * mu1) / q2;
+        double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > max_sigma) {
+            max_sigma = sigma;
+            max_val = i;
+        }
+    }
+
+    return max_val;
+}
+
+static inline int clamp_index(int i, int n) {
+    return std::min(std::max(i, 0), n - 1);
+}
+
+// Normalized box filter with replicated border. Every strip of columns keeps the running column
+// sums only, the horizontal sums of the rows entering and leaving the window slide along the strip.
+static void box_mean_byte(const unsigned char* src, unsigned char* mean, int width, int height, int block_size) {
+    const int radius = block_size / 2;
+    const float scale = 1.f / (block_size * block_size);
+
+    otter::parallel_for(0, width, 64, [&](int64_t begin, int64_t end) {
+        const int x0 = (int)begin;
+        const int strip = (int)(end - begin);
+        std::vector<int> col_sum(strip, 0);
+
+        // horizontal window sum of the row centered at x0
+        auto window_sum = [&](const unsigned char* s) {
+            int sum = 0;
+            for (int k = x0 - radius; k <= x0 + radius; k++) {
+                sum += s[clamp_index(k, width)];
+            }
+            return sum;
+        };
+
+        for (int k = -radius; k <= radius; k++) {
+            const unsigned char* s = src + clamp_index(k, height) * width;
+            int sum = window_sum(s);
+            for (int x = 0; x < strip; x++) {
+                col_sum[x] += sum;
+                sum += s[clamp_index(x0 + x + radius + 1, width)] - s[clamp_index(x0 + x - radius, width)];
+            }
+        }
+
+        for (int y = 0; y < height; y++) {
+            unsigned char* m = mean + y * width + x0;
+            const unsigned char* a = src + clamp_index(y + radius + 1, height) * width;
+            const unsigned char* s = src + clamp_index(y - radius, height) * width;
+            int add = window_sum(a);
+            int sub = window_sum(s);
+            for (int x = 0; x < strip; x++) {
+                m[x] = (unsigned char)(col_sum[x] * scale + 0.5f);
+                col_sum[x] += add - sub;
+
+                const int in = clamp_index(x0 + x + radius + 1, width);
+                const int out = clamp_index(x0 + x - radius, width);
+                add += a[in] - a[out];
+                sub += s[in] - s[out];
+            }
+        }
+    });
+}
+
+static void gaussian_kernel(int block_size, std::vector<float>& kernel) {
+    // same as the fixed small kernels used by OpenCV when sigma is derived from the size
+    static const float small_kernel[4][7] = {
+        {1.f},
+        {0.25f, 0.5f, 0.25f},
+        {0.0625f, 0.25f, 0.375f, 0.25f, 0.0625f},
+        {0.03125f, 0.109375f, 0.21875f, 0.28125f, 0.21875f, 0.109375f, 0.03125f}
+    };
+
+    kernel.resize(block_size);
+
+    if (block_size <= 7) {
+        std::copy(small_kernel[block_size / 2], small_kernel[block_size / 2] + block_size, kernel.begin());
+        return;
+    }
+
+    const double sigma = 0.3 * ((block_size - 1) * 0.5 - 1) + 0.8;
+    const double scale = -0.5 / (sigma * sigma);
+    double sum = 0;
+    for (int i = 0; i < block_size; i++) {
+        double x = i - (block_size - 1) * 0.5;
+        kernel[i] = (float)std::exp(scale * x * x);
+        sum += kernel[i];
+    }
+    for (int i = 0; i < block_size; i++) {
+        kernel[i] = (float)(kernel[i] / sum);
+    }
+}
+
+// Separable gaussian filter with replicated border, both passes run in parallel over rows.
+static void gaussian_mean_byte(const unsigned char* src, unsigned char* mean, int width, int height, int block_size) {
+    const int radius = block_size / 2;
+    std::vector<float> kernel;
+    gaussian_kernel(block_size, kernel);
+    const float* w = kernel.data();
+
+    std::vector<float> tmp(width * height);
+
+    otter::parallel_for(0, height, 0, [&](int64_t begin, int64_t end) {
+        std::vector<float> padded(width + 2 * radius);
+        for (const auto y : otter::irange(begin, end)) {
+            const unsigned char* s = src + y * width;
+            for (int x = -radius; x < width + radius; x++) {
+                padded[x + radius] = s[clamp_index(x, width)];
+            }
+
+            float* t = tmp.data() + y * width;
+            const float* p = padded.data();
+            for (int x = 0; x < width; x++) {
+                float sum = 0;
+                for (int k = 0; k < block_size; k++) {
+                    sum += w[k] * p[x + k];
+                }
+                t[x] = sum;
+            }
+        }
+    });
+
+    otter::parallel_for(0, height, 0, [&](int64_t begin, int64_t end) {
+        std::vector<float> acc(width);
+        for (const auto y : otter::irange(begin, end)) {
+            std::fill(acc.begin(), acc.end(), 0.f);
+            for (int k = 0; k < block_size; k++) {
+                const float* t = tmp.data() + clamp_index((int)y - radius + k, height) * width;
+                const float wk = w[k];
+                for (int x = 0; x < width; x++) {
+                    acc[x] += wk * t[x];
+                }
+            }
+
+            unsigned char* m = mean + y * width;
+            for (int x = 0; x < width; x++) {
+                m[x] = (unsigned char)std::min(acc[x] + 0.5f, 255.f);
+            }
+        }
+    });
+}
+
+Tensor adaptiveThreshold(const Tensor& self, double maxval, int method, int type, int block_size, double C) {
+    OTTER_CHECK(self.scalar_type() == otter::ScalarType::Byte, "Adaptive threshold only support Byte but get ", self.scalar_type());
+    OTTER_CHECK(self.dim() == 2 || (self.dim() == 3 && self.size(2) == 1), "Adaptive threshold expect single channel image");
+    OTTER_CHECK(block_size % 2 == 1 && block_size > 1, "block_size must be odd and larger than 1");
+    OTTER_CHECK(method == ADAPTIVE_THRESH_MEAN_C || method == ADAPTIVE_THRESH_GAUSSIAN_C, "Invalid adaptive method!");
+    OTTER_CHECK(type == THRESH_BINARY || type == THRESH_BINARY_INV, "Invalid threshold mode!");
+
+    auto input = self.contiguous();
+    auto out = otter::empty_like(input);
+
+    const int height = (int)input.size(0);
+    const int width = (int)input.size(1);
+    const unsigned char* src = input.data_ptr<unsigned char>();
+    unsigned char* dst = out.data_ptr<unsigned char>();
+
+    unsigned char imaxval = saturate_byte(maxval);
+    if (maxval < 0 || width == 0 || height == 0) {
+        std::fill(dst, dst + out.numel(), 0);
+        return out;
+    }
+
+    std::vector<unsigned char> mean(width * height);
+    if (method == ADAPTIVE_THRESH_MEAN_C)
+        box_mean_byte(src, mean.data(), width, height, block_size);
+    else
+        gaussian_mean_byte(src, mean.data(), width, height, block_size);
+
+    const int idelta = (type == THRESH_BINARY) ? (int)std::ceil(C) : (int)std::floor(C);
+    const int64_t size = input.numel();
+    const unsigned char* m = mean.data();
+
+    otter::parallel_for(0, size, otter::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        if (type == THRESH_BINARY) {
+            for (int64_t i = begin; i < end; i++) {
+                dst[i] = ((int)src[i] - (int)m[i] > -idelta) ? imaxval : 0;
+            }
+        } else {
+            for (int64_t i = begin; i < end; i++) {
+                dst[i] = ((int)src[i] - (int)m[i] <= -idelta) ? imaxval : 0;
+            }
+        }
+    });
+
     return out;
 }
 
@@ -15,11 +15,30 @@ class Tensor;
 namespace cv {
 
 enum {
-    THRESH_BINARY = 0,
-    THRESH_TRUNC = 1
+    THRESH_BINARY = 0,      // maxval if src > threshold else 0
+    THRESH_TRUNC = 1,       // threshold if src > threshold else src
+    THRESH_BINARY_INV = 2,  // 0 if src > threshold else maxval
+    THRESH_TOZERO = 3,      // src if src > threshold else 0
+    THRESH_TOZERO_INV = 4,  // 0 if src > threshold else src
+    THRESH_MASK = 7,
+    THRESH_OTSU = 8         // flag, compute the threshold by Otsu's method (Byte only)
 };
 
-Tensor threshold(const Tensor& self, double threshold, double maxval, int type = 0);
+enum {
+    ADAPTIVE_THRESH_MEAN_C = 0,
+    ADAPTIVE_THRESH_GAUSSIAN_C = 1
+};
+
+// Support Byte and Float tensors of any layout, the threshold is applied element wise.
+Tensor threshold(const Tensor& self, double threshold, double maxval, int type = THRESH_BINARY);
+
+// Return the threshold which maximizes the between class variance of a Byte tensor.
+double otsuThreshold(const Tensor& self);
+
+// Support Byte tensor with shape (H, W) or (H, W, 1). The threshold of every pixel is
+// the mean or the gaussian weighted sum of its block_size x block_size neighborhood
+// minus C, the border is replicated. type is THRESH_BINARY or THRESH_BINARY_INV.
+Tensor adaptiveThreshold(const Tensor& self, double maxval, int method, int type, int block_size, double C);
 
 }   // end namespace cv
 }   // end namespace otter
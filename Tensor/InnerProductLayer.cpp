@@ -44,16 +44,7 @@ int InnerProductLayer::parse_param(LayerOption& option, ParamDict& pd) {
     
     std::string activation = opt_find_string(option, "activation", "");
     
-    int activation_type = 0;
-    if (activation == "Relu") {
-        activation_type = 1;
-    } else if (activation == "LRelu") {
-        activation_type = 2;
-    } else if (activation == "Relu6") {
-        activation_type = 3;
-    } else if (activation == "Sigmoid") {
-        activation_type = 4;
-    }
+    int activation_type = activation_type_from_string(activation);
     
     Tensor activation_params;
     if (opt_check_string(option, "activation_params")) {
@@ -145,6 +136,18 @@ int InnerProductLayer::create_pipeline(const NetOption& opt) {
     }
 #endif // __SSE2__
 
+    // the sparse output rows are in order whatever the block is, so the block is free of out_elempack
+    sparse_weight = SparseWeight();
+    if (opt.use_sparse_weight) {
+        int64_t block_size = otter::select_sparse_block_size(weight_data);
+        if (block_size > 0) {
+            sparse_weight = otter::make_sparse_weight(weight_data, block_size);
+            weight_data_tm = Tensor();
+            
+            return 0;
+        }
+    }
+
     if (out_elempack != 1) {
         // src = inch-outch
         // dst = pb-inch-outch/pb
@@ -175,6 +178,10 @@ int InnerProductLayer::create_pipeline(const NetOption& opt) {
 
 int InnerProductLayer::forward(const Tensor &bottom_blob, Tensor &top_blob, const NetOption &opt) const {
     
+    if (sparse_weight.defined()) {
+        return forward_sparse(bottom_blob, top_blob, opt);
+    }
+    
     if (bottom_blob.dim() == 2 && bottom_blob.size(1) == in_features && bottom_blob.size(0) * bottom_blob.elempack() > 1) {
         // gemm
         int h = bottom_blob.size(0);
@@ -1334,6 +1341,49 @@ int InnerProductLayer::forward(const Tensor &bottom_blob, Tensor &top_blob, cons
     return 0;
 }
 
+int InnerProductLayer::forward_sparse(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const {
+    
+    const float* bias_data_ptr = bias_term ? (const float*)bias_data.data_ptr() : nullptr;
+    
+    if (bottom_blob.dim() == 2 && bottom_blob.size(1) == in_features && bottom_blob.size(0) * bottom_blob.elempack() > 1) {
+        // gemm, one sparse gemv per row of the unpacked input
+        int elempack = bottom_blob.elempack();
+        Tensor bottom_blob_unpacked = bottom_blob.packing(1).contiguous();
+        int h = bottom_blob_unpacked.size(0);
+        
+        Tensor top_blob_unpacked = otter::empty({h, out_features}, otter::ScalarType::Float);
+        otter::sparse_gemv_rows(sparse_weight, (const float*)bottom_blob_unpacked.data_ptr(), h, bias_data_ptr, (float*)top_blob_unpacked.data_ptr());
+        
+        activation_inplace(top_blob_unpacked, activation_type, activation_params);
+        
+        top_blob = (elempack == 1) ? top_blob_unpacked : top_blob_unpacked.packing(elempack);
+        
+        return 0;
+    }
+    
+    // flatten
+    Tensor bottom_blob_flattened = bottom_blob.flatten(0).contiguous();
+    
+    int out_elempack = 1;
+#if __SSE2__
+    if (opt.use_packing_layout) {
+#if __AVX__
+        out_elempack = out_features % 8 == 0 ? 8 : out_features % 4 == 0 ? 4 : 1;
+#else
+        out_elempack = out_features % 4 == 0 ? 4 : 1;
+#endif
+    }
+#endif // __SSE2__
+    
+    top_blob = otter::empty({out_features / out_elempack}, otter::get_update_scalarType(otter::ScalarType::Float, out_elempack));
+    
+    otter::sparse_gemv_rows(sparse_weight, (const float*)bottom_blob_flattened.data_ptr(), 1, bias_data_ptr, (float*)top_blob.data_ptr());
+    
+    activation_inplace(top_blob, activation_type, activation_params);
+    
+    return 0;
+}
+
 //int InnerProductLayer::forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const {
 //
 //    top_blob = otter::empty({out_features}, otter::ScalarType::Float);
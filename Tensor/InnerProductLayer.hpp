@@ -9,6 +9,7 @@
 #define InnerProductLayer_hpp
 
 #include "Layer.hpp"
+#include "SparseGemm.hpp"
 
 namespace otter {
 
@@ -32,7 +33,13 @@ public:
     virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
     
     virtual std::string type() const { return "InnerProduct"; }
+    
+    // Read by the profiler
+    int input_features() const { return in_features; }
+    const Tensor& weight() const { return weight_data; }
 private:
+    int forward_sparse(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
     int out_features;
     int in_features;
     int bias_term;
@@ -45,6 +52,9 @@ private:
     Tensor bias_data;
     
     Tensor weight_data_tm;
+    
+    // Set instead of weight_data_tm when the pruned weight is sparse enough
+    SparseWeight sparse_weight;
 };
 
 enum class InnerProductParam : int {
@@ -18,6 +18,7 @@ namespace otter {
 LReluLayer::LReluLayer() {
     one_blob_only = true;
     support_inplace = true;
+    support_tiling = true;
     
 #if __SSE2__
     support_packing = true;
@@ -13,6 +13,7 @@ Layer::Layer() {
     one_blob_only = false;
     support_inplace = false;
     support_packing = false;
+    support_tiling = false;
 }
 
 Layer::~Layer() {
@@ -80,6 +81,16 @@ int Layer::forward_inplace(std::vector<Tensor>& /*bottom_blobs*/, const NetOptio
     return -1;
 }
 
+bool Layer::tile_footprint(TileFootprint& footprint) const {
+    footprint = TileFootprint();
+    
+    return support_tiling;
+}
+
+int Layer::forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const {
+    return forward(bottom_blob, top_blob, opt);
+}
+
 
 
 }   // end namespace otter
@@ -20,6 +20,22 @@ namespace otter {
 
 using LayerOption = std::unordered_map<std::string, std::string>;
 
+// Window of an output row and column of a spatially local layer, kernel is the dilated extent
+struct TileFootprint {
+    int kernel_height = 1;
+    int kernel_width = 1;
+    int stride_height = 1;
+    int stride_width = 1;
+    int padding_top = 0;
+    int padding_bottom = 0;
+    int padding_left = 0;
+    int padding_right = 0;
+    // 0 keeps the input channels
+    int out_channels = 0;
+    // Value of the padding rows, the layer pads the width itself
+    float pad_value = 0.f;
+};
+
 class Layer {
 public:
     // Initialization
@@ -48,10 +64,18 @@ public:
     virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
     virtual int forward_inplace(std::vector<Tensor>& bottom_blobs, const NetOption& opt) const;
     
+    // Depth-first tiled execution, false when the layer can not run on a band of rows.
+    // The default is the elementwise footprint when support_tiling is set
+    virtual bool tile_footprint(TileFootprint& footprint) const;
+    
+    // Forward a band of rows which already carries the vertical padding of the layer
+    virtual int forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
 public:
     bool support_inplace;
     bool one_blob_only;
     bool support_packing;
+    bool support_tiling;
     
 public:
     std::vector<int> bottoms;
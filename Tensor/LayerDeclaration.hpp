@@ -36,6 +36,16 @@
 #include "FlattenLayer.hpp"
 #include "Convolution1DLayer.hpp"
 #include "SimpleROIAlignLayer.hpp"
+#include "AvgPoolLayer.hpp"
+#include "GlobalAvgPoolLayer.hpp"
+#include "GlobalMaxPoolLayer.hpp"
+#include "AdaptiveAvgPoolLayer.hpp"
+#include "MishLayer.hpp"
+#include "HardSwishLayer.hpp"
+#include "HardSigmoidLayer.hpp"
+#include "SwishLayer.hpp"
+#include "GELULayer.hpp"
+#include "SqueezeExcitationLayer.hpp"
 
 namespace otter {
 
@@ -66,6 +76,16 @@ REGISTER_LAYER_CLASS(InnerProduct);
 REGISTER_LAYER_CLASS(Flatten);
 REGISTER_LAYER_CLASS(Convolution1D);
 REGISTER_LAYER_CLASS(SimpleROIAlign);
+REGISTER_LAYER_CLASS(AvgPool);
+REGISTER_LAYER_CLASS(GlobalAvgPool);
+REGISTER_LAYER_CLASS(GlobalMaxPool);
+REGISTER_LAYER_CLASS(AdaptiveAvgPool);
+REGISTER_LAYER_CLASS(Mish);
+REGISTER_LAYER_CLASS(HardSwish);
+REGISTER_LAYER_CLASS(HardSigmoid);
+REGISTER_LAYER_CLASS(Swish);
+REGISTER_LAYER_CLASS(GELU);
+REGISTER_LAYER_CLASS(SqueezeExcitation);
 
 }   // end namespace otter
 
@@ -10,8 +10,14 @@
 #include "TensorFactory.hpp"
 #include "TensorOperator.hpp"
 #include "Parallel.hpp"
+#include "VecIntrinsic.hpp"
+#include "MT19937.hpp"
 #include <cmath>
 
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+
 namespace otter {
 namespace cv {
 
@@ -41,6 +47,108 @@ void findLocalMaximums(int numrho, int numangle, int threshold, const int *accum
     }
 }
 
+// Round half away from zero as std::round for the rho of every point at one angle,
+// then increment the accumulator row of this angle.
+static void hough_accumulate_row(const float* xs, const float* ys, int count, float cos_n, float sin_n, int offset, int* accum_row) {
+    int k = 0;
+#if __ARM_NEON
+    float32x4_t _cos = vdupq_n_f32(cos_n);
+    float32x4_t _sin = vdupq_n_f32(sin_n);
+    float32x4_t _half = vdupq_n_f32(0.5f);
+    int32x4_t _offset = vdupq_n_s32(offset);
+    int rs[4];
+    for (; k + 3 < count; k += 4) {
+        float32x4_t _v = vmlaq_f32(vmulq_f32(vld1q_f32(xs + k), _cos), vld1q_f32(ys + k), _sin);
+        int32x4_t _t = vcvtq_s32_f32(vaddq_f32(vabsq_f32(_v), _half));
+        int32x4_t _sign = vshrq_n_s32(vreinterpretq_s32_f32(_v), 31);
+        _t = vsubq_s32(veorq_s32(_t, _sign), _sign);
+        vst1q_s32(rs, vaddq_s32(_t, _offset));
+        accum_row[rs[0]]++;
+        accum_row[rs[1]]++;
+        accum_row[rs[2]]++;
+        accum_row[rs[3]]++;
+    }
+#elif __SSE2__
+    const __m128 _abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+#if __AVX__
+    __m256 _cos_avx = _mm256_set1_ps(cos_n);
+    __m256 _sin_avx = _mm256_set1_ps(sin_n);
+    __m256 _half_avx = _mm256_set1_ps(0.5f);
+    __m256 _abs_mask_avx = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    alignas(32) int rs8[8];
+    for (; k + 7 < count; k += 8) {
+        __m256 _v = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(xs + k), _cos_avx), _mm256_mul_ps(_mm256_loadu_ps(ys + k), _sin_avx));
+        // copy the sign back onto |v| + 0.5, truncation then rounds half away from zero
+        __m256 _t = _mm256_add_ps(_mm256_and_ps(_v, _abs_mask_avx), _half_avx);
+        _t = _mm256_or_ps(_t, _mm256_andnot_ps(_abs_mask_avx, _v));
+        _mm256_store_si256((__m256i*)rs8, _mm256_cvttps_epi32(_t));
+        for (int l = 0; l < 8; l++) {
+            accum_row[rs8[l] + offset]++;
+        }
+    }
+#endif // __AVX__
+    __m128 _cos = _mm_set1_ps(cos_n);
+    __m128 _sin = _mm_set1_ps(sin_n);
+    __m128 _half = _mm_set1_ps(0.5f);
+    __m128i _offset = _mm_set1_epi32(offset);
+    alignas(16) int rs[4];
+    for (; k + 3 < count; k += 4) {
+        __m128 _v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(xs + k), _cos), _mm_mul_ps(_mm_loadu_ps(ys + k), _sin));
+        __m128i _t = _mm_cvttps_epi32(_mm_add_ps(_mm_and_ps(_v, _abs_mask), _half));
+        __m128i _sign = _mm_srai_epi32(_mm_castps_si128(_v), 31);
+        _t = _mm_sub_epi32(_mm_xor_si128(_t, _sign), _sign);
+        _mm_store_si128((__m128i*)rs, _mm_add_epi32(_t, _offset));
+        accum_row[rs[0]]++;
+        accum_row[rs[1]]++;
+        accum_row[rs[2]]++;
+        accum_row[rs[3]]++;
+    }
+#endif // __SSE2__
+    for (; k < count; k++) {
+        int r = (int)std::round(xs[k] * cos_n + ys[k] * sin_n);
+        accum_row[r + offset]++;
+    }
+}
+
+// Collect the coordinates of all non zero pixels, rows are scanned in parallel and
+// the result keeps the raster order.
+static void collect_edge_points(const unsigned char* image, int step, int width, int height, std::vector<float>& xs, std::vector<float>& ys) {
+    const int num_chunk = std::max(1, std::min(height, otter::get_num_threads() * 4));
+    std::vector<std::vector<int>> chunk_points(num_chunk);
+    
+    otter::parallel_for(0, num_chunk, 0, [&](int64_t begin, int64_t end) {
+        for (const auto c : otter::irange(begin, end)) {
+            std::vector<int>& points = chunk_points[c];
+            int row_begin = (int)(height * c / num_chunk);
+            int row_end = (int)(height * (c + 1) / num_chunk);
+            
+            for (int i = row_begin; i < row_end; i++) {
+                const unsigned char* image_row = image + i * step;
+                for (int j = 0; j < width; j++) {
+                    if (image_row[j] != 0)
+                        points.push_back(i * width + j);
+                }
+            }
+        }
+    });
+    
+    size_t total = 0;
+    for (const auto& points : chunk_points)
+        total += points.size();
+    
+    xs.resize(total);
+    ys.resize(total);
+    
+    size_t k = 0;
+    for (const auto& points : chunk_points) {
+        for (int p : points) {
+            xs[k] = (float)(p % width);
+            ys[k] = (float)(p / width);
+            k++;
+        }
+    }
+}
+
 void HoughLinesStandard(const otter::Tensor& img, std::vector<Vec2f>& lines, float rho, float theta, int threshold, int linesMax, float min_theta, float max_theta) {
     float irho = 1 / rho;
     
@@ -58,28 +166,26 @@ void HoughLinesStandard(const otter::Tensor& img, std::vector<Vec2f>& lines, flo
     std::vector<int> _sort_buf;
     int *accum = _accum.data_ptr<int>();
     
-    auto ang = otter::linspace(static_cast<float>(min_theta), static_cast<float>(max_theta), numangle, otter::ScalarType::Float);
-    auto _sinTab = otter::sin(ang) * irho;
-    auto _cosTab = otter::cos(ang) * irho;
-    ang.reset();
-    float *tabSin = _sinTab.data_ptr<float>(), *tabCos = _cosTab.data_ptr<float>();
-    
-    // Fix i for parallel since accum
-    for (int i = 0; i < height; i++) {
-        const unsigned char *image_row = image + i * step;
-        otter::parallel_for(0, width, 0, [&](int64_t begin, int64_t end) {
-            for (const auto j : otter::irange(begin, end)) {
-                if (image_row[j] != 0) {
-                    for (int n = 0; n < numangle; n++) {
-                        int r = std::round(j * tabCos[n] + i * tabSin[n]);
-                        r += (numrho - 1) / 2;
-                        accum[(n + 1) * (numrho + 2) + r + 1]++;
-                    }
-                }
-            }
-        });
+    // the table follows the reported angle min_theta + n * theta
+    std::vector<float> tabSin(numangle), tabCos(numangle);
+    for (int n = 0; n < numangle; n++) {
+        float ang = static_cast<float>(min_theta) + n * theta;
+        tabSin[n] = std::sin(ang) * irho;
+        tabCos[n] = std::cos(ang) * irho;
     }
     
+    // partition the edge image once, then every angle owns its accumulator row
+    std::vector<float> xs, ys;
+    collect_edge_points(image, step, width, height, xs, ys);
+    
+    const int count = (int)xs.size();
+    otter::parallel_for(0, numangle, 0, [&](int64_t begin, int64_t end) {
+        for (const auto n : otter::irange(begin, end)) {
+            int* accum_row = accum + (n + 1) * (numrho + 2);
+            hough_accumulate_row(xs.data(), ys.data(), count, tabCos[n], tabSin[n], (numrho - 1) / 2 + 1, accum_row);
+        }
+    });
+    
     findLocalMaximums(numrho, numangle, threshold, accum, _sort_buf);
     
     std::sort(_sort_buf.begin(), _sort_buf.end(), hough_cmp_gt(accum));
@@ -99,6 +205,165 @@ void HoughLinesStandard(const otter::Tensor& img, std::vector<Vec2f>& lines, flo
     
 }
 
+// Reference: J. Matas, C. Galambos, J. Kittler, "Robust Detection of Lines Using the
+// Progressive Probabilistic Hough Transform", 2000. Follows the OpenCV implementation.
+void HoughLinesProbabilistic(const otter::Tensor& img, std::vector<Vec4i>& lines, float rho, float theta, int threshold, int lineLength, int lineGap, int linesMax) {
+    const int shift = 16;
+    float irho = 1 / rho;
+    
+    const unsigned char* image = img.data_ptr<unsigned char>();
+    int step = (int)(img.size(1) * img.size(2) * img.itemsize());
+    int width = img.size(1);
+    int height = img.size(0);
+    
+    int numangle = std::round(M_PI / theta);
+    int numrho = std::round(((width + height) * 2 + 1) / rho);
+    const int offset = (numrho - 1) / 2;
+    
+    std::vector<int> accum(numangle * numrho, 0);
+    std::vector<unsigned char> mask(width * height, 0);
+    
+    std::vector<float> tabSin(numangle), tabCos(numangle);
+    for (int n = 0; n < numangle; n++) {
+        tabSin[n] = std::sin(n * theta) * irho;
+        tabCos[n] = std::cos(n * theta) * irho;
+    }
+    
+    std::vector<float> xs, ys;
+    collect_edge_points(image, step, width, height, xs, ys);
+    
+    std::vector<int> points(xs.size());
+    for (size_t k = 0; k < xs.size(); k++) {
+        int x = (int)xs[k];
+        int y = (int)ys[k];
+        points[k] = y * width + x;
+        mask[y * width + x] = 1;
+    }
+    
+    otter::mt19937 generator(0x1234);
+    
+    // process the points in random order, the accumulator is updated one point at a time
+    for (int count = (int)points.size(); count > 0; count--) {
+        int idx = (int)(generator() % count);
+        int point = points[idx];
+        points[idx] = points[count - 1];
+        
+        int i = point / width;
+        int j = point % width;
+        
+        // the point may have been removed by a previously found line
+        if (!mask[point])
+            continue;
+        
+        int max_val = threshold - 1;
+        int max_n = 0;
+        for (int n = 0; n < numangle; n++) {
+            int r = (int)std::round(j * tabCos[n] + i * tabSin[n]) + offset;
+            int val = ++accum[n * numrho + r];
+            if (max_val < val) {
+                max_val = val;
+                max_n = n;
+            }
+        }
+        
+        if (max_val < threshold)
+            continue;
+        
+        // walk along the line from the point in both directions
+        float a = -tabSin[max_n];
+        float b = tabCos[max_n];
+        int x0 = j;
+        int y0 = i;
+        int dx0, dy0;
+        bool xflag;
+        if (std::fabs(a) > std::fabs(b)) {
+            xflag = true;
+            dx0 = a > 0 ? 1 : -1;
+            dy0 = (int)std::round(b * (1 << shift) / std::fabs(a));
+            y0 = (y0 << shift) + (1 << (shift - 1));
+        } else {
+            xflag = false;
+            dy0 = b > 0 ? 1 : -1;
+            dx0 = (int)std::round(a * (1 << shift) / std::fabs(b));
+            x0 = (x0 << shift) + (1 << (shift - 1));
+        }
+        
+        Point line_end[2];
+        for (int k = 0; k < 2; k++) {
+            int gap = 0;
+            int x = x0, y = y0, dx = dx0, dy = dy0;
+            if (k > 0) {
+                dx = -dx;
+                dy = -dy;
+            }
+            
+            for (;; x += dx, y += dy) {
+                int i1, j1;
+                if (xflag) {
+                    j1 = x;
+                    i1 = y >> shift;
+                } else {
+                    j1 = x >> shift;
+                    i1 = y;
+                }
+                
+                if (j1 < 0 || j1 >= width || i1 < 0 || i1 >= height)
+                    break;
+                
+                if (mask[i1 * width + j1]) {
+                    gap = 0;
+                    line_end[k].y = i1;
+                    line_end[k].x = j1;
+                } else if (++gap > lineGap) {
+                    break;
+                }
+            }
+        }
+        
+        bool good_line = std::abs(line_end[1].x - line_end[0].x) >= lineLength || std::abs(line_end[1].y - line_end[0].y) >= lineLength;
+        
+        // remove the points of the segment, and their votes if the segment is accepted
+        for (int k = 0; k < 2; k++) {
+            int x = x0, y = y0, dx = dx0, dy = dy0;
+            if (k > 0) {
+                dx = -dx;
+                dy = -dy;
+            }
+            
+            for (;; x += dx, y += dy) {
+                int i1, j1;
+                if (xflag) {
+                    j1 = x;
+                    i1 = y >> shift;
+                } else {
+                    j1 = x >> shift;
+                    i1 = y;
+                }
+                
+                unsigned char& m = mask[i1 * width + j1];
+                if (m) {
+                    if (good_line) {
+                        for (int n = 0; n < numangle; n++) {
+                            int r = (int)std::round(j1 * tabCos[n] + i1 * tabSin[n]) + offset;
+                            accum[n * numrho + r]--;
+                        }
+                    }
+                    m = 0;
+                }
+                
+                if (i1 == line_end[k].y && j1 == line_end[k].x)
+                    break;
+            }
+        }
+        
+        if (good_line) {
+            lines.push_back(Vec4i(line_end[0].x, line_end[0].y, line_end[1].x, line_end[1].y));
+            if ((int)lines.size() >= linesMax)
+                return;
+        }
+    }
+}
+
 void draw_alllines(otter::Tensor& cdst, std::vector<Vec2f>& lines) {
 #if OTTER_OPENCV_DRAW
     for (size_t i = 0; i < lines.size(); i++) {
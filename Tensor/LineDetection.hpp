@@ -21,6 +21,9 @@ struct most_param {
 };
 
 void HoughLinesStandard(const otter::Tensor& img, std::vector<Vec2f>& lines, float rho, float theta, int threshold, int linesMax, float min_theta, float max_theta);
+// Progressive probabilistic Hough transform, every line is returned as (x0, y0, x1, y1).
+// The points are visited in a fixed pseudo random order so that the result is reproducible.
+void HoughLinesProbabilistic(const otter::Tensor& img, std::vector<Vec4i>& lines, float rho, float theta, int threshold, int lineLength, int lineGap, int linesMax);
 most_param mostline(std::vector<Vec2f>& lines);
 void draw_alllines(otter::Tensor& cdst, std::vector<Vec2f>& lines);
 void draw_mostline(otter::Tensor& cdst, std::vector<Vec2f>& lines, float theta);
@@ -0,0 +1,268 @@
+//
+//  LinearAssignment.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#include "LinearAssignment.hpp"
+
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+namespace otter {
+namespace cv {
+
+// Reference: D. F. Crouse, "On implementing 2D rectangular assignment algorithms", 2016.
+// Requires rows <= cols, the result is written into col4row, -1 for a row with no finite cost left.
+void LinearAssignment::shortest_augmenting_path(const float* cost, int rows, int cols) {
+    const float inf = std::numeric_limits<float>::infinity();
+
+    u.assign(rows, 0.f);
+    v.assign(cols, 0.f);
+    shortest_path_costs.resize(cols);
+    path.assign(cols, -1);
+    col4row.assign(rows, -1);
+    row4col.assign(cols, -1);
+    remaining.resize(cols);
+    SR.resize(rows);
+    SC.resize(cols);
+
+    for (int cur_row = 0; cur_row < rows; ++cur_row) {
+        float min_val = 0;
+        int i = cur_row;
+        int num_remaining = cols;
+
+        for (int it = 0; it < cols; ++it) {
+            // reverse order gives a better chance to hit an unassigned column first
+            remaining[it] = cols - it - 1;
+        }
+        std::fill(SR.begin(), SR.end(), 0);
+        std::fill(SC.begin(), SC.end(), 0);
+        std::fill(shortest_path_costs.begin(), shortest_path_costs.end(), inf);
+
+        int sink = -1;
+        while (sink == -1) {
+            int index = -1;
+            float lowest = inf;
+            SR[i] = 1;
+
+            const float* cost_row = cost + i * cols;
+            const float ui = u[i];
+            for (int it = 0; it < num_remaining; ++it) {
+                int j = remaining[it];
+
+                float r = min_val + cost_row[j] - ui - v[j];
+                if (r < shortest_path_costs[j]) {
+                    path[j] = i;
+                    shortest_path_costs[j] = r;
+                }
+
+                if (shortest_path_costs[j] < lowest || (shortest_path_costs[j] == lowest && row4col[j] == -1)) {
+                    lowest = shortest_path_costs[j];
+                    index = it;
+                }
+            }
+
+            // no finite path from this row, leave it unmatched and keep the duals
+            if (lowest == inf)
+                break;
+
+            min_val = lowest;
+            int j = remaining[index];
+            if (row4col[j] == -1) {
+                sink = j;
+            } else {
+                i = row4col[j];
+            }
+
+            SC[j] = 1;
+            remaining[index] = remaining[--num_remaining];
+        }
+
+        if (sink == -1)
+            continue;
+
+        // update dual variables
+        u[cur_row] += min_val;
+        for (int r = 0; r < rows; ++r) {
+            if (SR[r] && r != cur_row) {
+                u[r] += min_val - shortest_path_costs[col4row[r]];
+            }
+        }
+        for (int c = 0; c < cols; ++c) {
+            if (SC[c]) {
+                v[c] -= min_val - shortest_path_costs[c];
+            }
+        }
+
+        // augment previous solution
+        int j = sink;
+        while (true) {
+            int r = path[j];
+            row4col[j] = r;
+            std::swap(col4row[r], j);
+            if (r == cur_row)
+                break;
+        }
+    }
+}
+
+float LinearAssignment::solve_dense(const float* cost, int rows, int cols, int* assignment) {
+    float total = 0;
+
+    if (rows <= cols) {
+        shortest_augmenting_path(cost, rows, cols);
+
+        for (int r = 0; r < rows; ++r) {
+            assignment[r] = col4row[r];
+            if (col4row[r] != -1)
+                total += cost[r * cols + col4row[r]];
+        }
+    } else {
+        transposed.resize(rows * cols);
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                transposed[c * rows + r] = cost[r * cols + c];
+            }
+        }
+
+        shortest_augmenting_path(transposed.data(), cols, rows);
+
+        std::fill(assignment, assignment + rows, -1);
+        for (int c = 0; c < cols; ++c) {
+            if (col4row[c] == -1)
+                continue;
+            assignment[col4row[c]] = c;
+            total += cost[col4row[c] * cols + c];
+        }
+    }
+
+    return total;
+}
+
+float LinearAssignment::solve(const float* cost, int rows, int cols, int* assignment) {
+    if (rows == 0 || cols == 0) {
+        std::fill(assignment, assignment + rows, -1);
+        return 0;
+    }
+
+    return solve_dense(cost, rows, cols, assignment);
+}
+
+int LinearAssignment::find_root(int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+
+    return x;
+}
+
+float LinearAssignment::solve(const float* cost, int rows, int cols, float gate, int* assignment) {
+    std::fill(assignment, assignment + rows, -1);
+
+    if (rows == 0 || cols == 0)
+        return 0;
+
+    // union rows (0 ~ rows - 1) and columns (rows ~ rows + cols - 1) connected by a gated edge
+    const int nodes = rows + cols;
+    parent.resize(nodes);
+    std::iota(parent.begin(), parent.end(), 0);
+
+    for (int r = 0; r < rows; ++r) {
+        const float* cost_row = cost + r * cols;
+        for (int c = 0; c < cols; ++c) {
+            if (cost_row[c] < gate) {
+                int a = find_root(r);
+                int b = find_root(rows + c);
+                if (a != b)
+                    parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+    }
+
+    // label components and bucket their rows and columns
+    comp_id.assign(nodes, -1);
+    int num_comps = 0;
+    for (int n = 0; n < nodes; ++n) {
+        int root = find_root(n);
+        if (comp_id[root] == -1)
+            comp_id[root] = num_comps++;
+        comp_id[n] = comp_id[root];
+    }
+
+    row_offset.assign(num_comps + 1, 0);
+    col_offset.assign(num_comps + 1, 0);
+    for (int r = 0; r < rows; ++r)
+        row_offset[comp_id[r] + 1]++;
+    for (int c = 0; c < cols; ++c)
+        col_offset[comp_id[rows + c] + 1]++;
+    for (int k = 0; k < num_comps; ++k) {
+        row_offset[k + 1] += row_offset[k];
+        col_offset[k + 1] += col_offset[k];
+    }
+
+    comp_rows.resize(rows);
+    comp_cols.resize(cols);
+    comp_assignment.resize(rows);
+
+    cursor.assign(row_offset.begin(), row_offset.begin() + num_comps);
+    for (int r = 0; r < rows; ++r)
+        comp_rows[cursor[comp_id[r]]++] = r;
+
+    cursor.assign(col_offset.begin(), col_offset.begin() + num_comps);
+    for (int c = 0; c < cols; ++c)
+        comp_cols[cursor[comp_id[rows + c]]++] = c;
+
+    float total = 0;
+    for (int k = 0; k < num_comps; ++k) {
+        const int nr = row_offset[k + 1] - row_offset[k];
+        const int nc = col_offset[k + 1] - col_offset[k];
+
+        // isolated row or column
+        if (nr == 0 || nc == 0)
+            continue;
+
+        const int* crows = comp_rows.data() + row_offset[k];
+        const int* ccols = comp_cols.data() + col_offset[k];
+
+        if (nr == 1 && nc == 1) {
+            assignment[crows[0]] = ccols[0];
+            total += cost[crows[0] * cols + ccols[0]];
+            continue;
+        }
+
+        sub_cost.resize(nr * nc);
+        for (int i = 0; i < nr; ++i) {
+            const float* cost_row = cost + crows[i] * cols;
+            float* sub_row = sub_cost.data() + i * nc;
+            for (int j = 0; j < nc; ++j) {
+                sub_row[j] = cost_row[ccols[j]];
+            }
+        }
+
+        int* sub_assignment = comp_assignment.data();
+        solve_dense(sub_cost.data(), nr, nc, sub_assignment);
+
+        for (int i = 0; i < nr; ++i) {
+            if (sub_assignment[i] == -1)
+                continue;
+
+            const int r = crows[i];
+            const int c = ccols[sub_assignment[i]];
+
+            // the component may still be forced to pick a non-edge pair
+            if (cost[r * cols + c] < gate) {
+                assignment[r] = c;
+                total += cost[r * cols + c];
+            }
+        }
+    }
+
+    return total;
+}
+
+}   // end namespace cv
+}   // end namespace otter
@@ -0,0 +1,68 @@
+//
+//  LinearAssignment.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#ifndef LinearAssignment_hpp
+#define LinearAssignment_hpp
+
+#include <vector>
+
+namespace otter {
+namespace cv {
+
+// Rectangular linear assignment solver (Jonker-Volgenant shortest augmenting path).
+// The cost matrix is a flat row-major float array of rows x cols. On return
+// assignment[r] holds the matched column of row r or -1 if it stays unmatched.
+// All the workspaces are kept inside the solver, reuse one instance across frames
+// to avoid per call allocation.
+class LinearAssignment {
+public:
+    LinearAssignment() {}
+
+    // Solve the full problem, min(rows, cols) pairs are assigned except the rows (or columns)
+    // left with only infinite costs, which stay unmatched.
+    float solve(const float* cost, int rows, int cols, int* assignment);
+
+    // Only entries with cost < gate are considered as edges, the problem is split into
+    // the connected components of the gated bipartite graph and each one is solved
+    // independently. Rows and columns without any edge are left unmatched, and pairs
+    // with cost >= gate are never returned.
+    float solve(const float* cost, int rows, int cols, float gate, int* assignment);
+
+private:
+    float solve_dense(const float* cost, int rows, int cols, int* assignment);
+    void shortest_augmenting_path(const float* cost, int rows, int cols);
+
+    int find_root(int x);
+
+    // shortest augmenting path workspace
+    std::vector<float> u;
+    std::vector<float> v;
+    std::vector<float> shortest_path_costs;
+    std::vector<int> path;
+    std::vector<int> col4row;
+    std::vector<int> row4col;
+    std::vector<int> remaining;
+    std::vector<char> SR;
+    std::vector<char> SC;
+
+    // gating workspace
+    std::vector<int> parent;
+    std::vector<int> comp_id;
+    std::vector<int> row_offset;
+    std::vector<int> col_offset;
+    std::vector<int> cursor;
+    std::vector<int> comp_rows;
+    std::vector<int> comp_cols;
+    std::vector<int> comp_assignment;
+    std::vector<float> sub_cost;
+    std::vector<float> transposed;
+};
+
+}   // end namespace cv
+}   // end namespace otter
+
+#endif /* LinearAssignment_hpp */
@@ -16,6 +16,7 @@ namespace otter {
 MaxPoolLayer::MaxPoolLayer() {
     one_blob_only = true;
     support_inplace = false;
+    support_tiling = true;
     
 #if __SSE2__
     support_packing = true;
@@ -133,4 +134,45 @@ int MaxPoolLayer::forward(const Tensor& bottom_blob, Tensor& top_blob, const Net
     return 0;
 }
 
+// The ceil mode adds a partial window at the bottom which depends on the height of the blob
+bool MaxPoolLayer::tile_footprint(TileFootprint& footprint) const {
+    if (ceil_mode)
+        return false;
+    
+    footprint = TileFootprint();
+    footprint.stride_height = stride_height;
+    footprint.stride_width  = stride_width;
+    footprint.pad_value     = -10000000;
+    
+    if (darknet_mode) {
+        footprint.kernel_height  = kernel_height;
+        footprint.kernel_width   = kernel_width;
+        footprint.padding_top    = (kernel_height - 1) / 2;
+        footprint.padding_bottom = kernel_height - footprint.padding_top - 1;
+        footprint.padding_left   = (kernel_width - 1) / 2;
+        footprint.padding_right  = kernel_width - footprint.padding_left - 1;
+    } else {
+        footprint.kernel_height  = dilation_height * (kernel_height - 1) + 1;
+        footprint.kernel_width   = dilation_width * (kernel_width - 1) + 1;
+        footprint.padding_top    = padding_height;
+        footprint.padding_bottom = padding_height;
+        footprint.padding_left   = padding_width;
+        footprint.padding_right  = padding_width;
+    }
+    
+    return true;
+}
+
+int MaxPoolLayer::forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& /*opt*/) const {
+    if (darknet_mode) {
+        int width_offset = (kernel_width - 1) / 2;
+        
+        auto bottom_blob_pad = otter::constant_pad(bottom_blob, {width_offset, kernel_width - width_offset - 1, 0, 0}, -10000000);
+        top_blob = otter::max_pool2d(bottom_blob_pad, {kernel_height, kernel_width}, {stride_height, stride_width}, {0, 0}, {1, 1}, false);
+    } else {
+        top_blob = otter::max_pool2d(bottom_blob, {kernel_height, kernel_width}, {stride_height, stride_width}, {0, padding_width}, {dilation_height, dilation_width}, false);
+    }
+    return 0;
+}
+
 }   // end namespace otter
@@ -24,6 +24,10 @@ public:
     
     virtual int forward(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
     
+    virtual bool tile_footprint(TileFootprint& footprint) const;
+    
+    virtual int forward_tile(const Tensor& bottom_blob, Tensor& top_blob, const NetOption& opt) const;
+    
     virtual std::string type() const { return "MaxPool"; }
 private:
     int kernel_height;
@@ -0,0 +1,35 @@
+//
+//  MishLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "MishLayer.hpp"
+#include "ActivationLayer.hpp"
+
+namespace otter {
+
+MishLayer::MishLayer() {
+    one_blob_only = true;
+    support_inplace = true;
+    support_tiling = true;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int MishLayer::load_param(const ParamDict& /*pd*/) {
+    return 0;
+}
+
+int MishLayer::forward_inplace(Tensor& bottom_blob, const NetOption& /*opt*/) const {
+    activation_inplace(bottom_blob, 5, Tensor());
+    
+    return 0;
+}
+
+}   // end namespace otter
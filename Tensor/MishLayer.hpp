@@ -0,0 +1,28 @@
+//
+//  MishLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef MishLayer_hpp
+#define MishLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class MishLayer : public Layer {
+public:
+    MishLayer();
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "Mish"; }
+};
+
+}   // end namespace otter
+
+#endif /* MishLayer_hpp */
@@ -10,6 +10,8 @@
 #include "TensorMaker.hpp"
 #include "TensorInterpolation.hpp"
 #include "Padding.hpp"
+#include "Parallel.hpp"
+#include "ProposalDecode.hpp"
 #include <float.h>
 
 namespace otter {
@@ -22,6 +24,7 @@ NanodetPlusDetectionOutputLayer::NanodetPlusDetectionOutputLayer() {
 int NanodetPlusDetectionOutputLayer::parse_param(LayerOption& option, ParamDict& pd) {
     float prob_threshold = opt_find_float(option, "prob_threshold", 0.4f);
     float nms_threshold = opt_find_float(option, "nms_threshold", 0.5f);
+    int nms_top_k = opt_find_int(option, "nms_top_k", -1);
     
     Tensor stride;
     
@@ -44,6 +47,7 @@ int NanodetPlusDetectionOutputLayer::parse_param(LayerOption& option, ParamDict&
     pd.set((int)NanodetPlusParam::Prob_threshold, prob_threshold);
     pd.set((int)NanodetPlusParam::Nms_threshold, nms_threshold);
     pd.set((int)NanodetPlusParam::Stride, stride);
+    pd.set((int)NanodetPlusParam::Nms_top_k, nms_top_k);
     
     return 0;
 }
@@ -58,28 +62,64 @@ int NanodetPlusDetectionOutputLayer::load_param(const ParamDict &pd) {
     prob_threshold = pd.get((int)NanodetPlusParam::Prob_threshold, 0.45f);
     nms_threshold = pd.get((int)NanodetPlusParam::Nms_threshold, 0.5f);
     stride = pd.get((int)NanodetPlusParam::Stride, otter::tensor({8, 16, 32, 64}, otter::ScalarType::Int));
+    nms_top_k = pd.get((int)NanodetPlusParam::Nms_top_k, -1);
     
     return 0;
 }
 
 int NanodetPlusDetectionOutputLayer::forward(const std::vector<Tensor>& bottom_blobs, std::vector<Tensor>& top_blobs, const NetOption& /*opt*/) const {
     
-    std::vector<Object> proposals;
+    const int num_level = (int)bottom_blobs.size();
+    
+    // flatten the rows of all levels, every chunk decodes a contiguous range of rows
+    std::vector<Tensor> bottoms(num_level);
+    std::vector<int> level_row(num_level + 1, 0);
+    for (const auto i : otter::irange(num_level)) {
+        bottoms[i] = bottom_blobs[i].contiguous();
+        level_row[i + 1] = level_row[i] + (int)bottoms[i].size(2);
+    }
+    const int total_row = level_row[num_level];
+    const int num_chunk = std::max(1, std::min(total_row, otter::get_num_threads() * 4));
+    
+    // kept per calling thread across frames, the workers reach it through this reference
+    static thread_local ProposalDecodeScratch thread_scratch;
+    ProposalDecodeScratch& scratch = thread_scratch;
+    scratch.ensure(num_chunk);
     
     auto stride_a = stride.accessor<int, 1>();
-    for (const auto i : otter::irange(bottom_blobs.size())) {
-        std::vector<Object> objects;
-        
-        generate_proposals(bottom_blobs[i], stride_a[i], prob_threshold, objects);
-        proposals.insert(proposals.end(), objects.begin(), objects.end());
+    otter::parallel_for(0, num_chunk, 0, [&](int64_t begin, int64_t end) {
+        for (const auto c : otter::irange(begin, end)) {
+            BoxArray& objects = scratch.chunk_proposals[c];
+            objects.clear();
+            
+            int row = (int)(total_row * c / num_chunk);
+            int row_end = (int)(total_row * (c + 1) / num_chunk);
+            
+            for (int level = 0; level < num_level && row < row_end; level++) {
+                if (row >= level_row[level + 1])
+                    continue;
+                
+                int level_end = std::min(row_end, level_row[level + 1]);
+                generate_proposals(bottoms[level], stride_a[level], row - level_row[level], level_end - level_row[level], prob_threshold, scratch.chunk_rows[c], objects);
+                row = level_end;
+            }
+        }
+    });
+    
+    // merge in chunk order, the result does not depend on the number of threads
+    BoxArray& proposals = scratch.proposals;
+    proposals.clear();
+    for (const auto c : otter::irange(num_chunk)) {
+        proposals.append(scratch.chunk_proposals[c]);
     }
     
-    // sort all proposals by score from highest to lowest
-    qsort_descent_inplace(proposals);
-
-    // apply nms with nms_threshold
-    std::vector<int> picked;
-    nms_sorted_bboxes(proposals, picked, nms_threshold);
+    // apply nms with nms_threshold, picked is sorted by score from highest to lowest
+    NmsOption nms_opt;
+    nms_opt.iou_threshold = nms_threshold;
+    nms_opt.top_k = nms_top_k;
+    
+    std::vector<int>& picked = scratch.picked;
+    non_max_suppression(proposals, picked, nms_opt);
 
     int count = (int)picked.size();
     
@@ -91,208 +131,89 @@ int NanodetPlusDetectionOutputLayer::forward(const std::vector<Tensor>& bottom_b
     auto top_blob_a = top_blob.accessor<float, 2>();
     
     for (const auto i : otter::irange(count)) {
-        const Object& r = proposals[picked[i]];
-        float score = r.prob;
+        const int k = picked[i];
         float* outptr = top_blob_a[i].data();
         
-        outptr[0] = static_cast<float>(r.label + 1); // +1 for prepend background class
-        outptr[1] = score;
-        outptr[2] = r.x;
-        outptr[3] = r.y;
-        outptr[4] = r.width;
-        outptr[5] = r.height;
+        outptr[0] = static_cast<float>(proposals.label[k] + 1); // +1 for prepend background class
+        outptr[1] = proposals.score[k];
+        outptr[2] = proposals.x0[k];
+        outptr[3] = proposals.y0[k];
+        outptr[4] = proposals.x1[k] - proposals.x0[k];
+        outptr[5] = proposals.y1[k] - proposals.y0[k];
     }
     
     return 0;
 }
 
-using Object = NanodetPlusDetectionOutputLayer::Object;
-
 static inline float sigmoid(float x) {
     return 1.0f / (1.0f + exp(-x));
 }
 
-void NanodetPlusDetectionOutputLayer::generate_proposals(const otter::Tensor& pred, int stride, float prob_threshold, std::vector<Object>& objects) const {
-//    const int num_grid = pred.size(2);
-    
+void NanodetPlusDetectionOutputLayer::generate_proposals(const otter::Tensor& pred, int stride, int row_begin, int row_end, float prob_threshold, ProposalRowScratch& rows, BoxArray& objects) const {
     int num_grid_x = (int)pred.size(3);
     int num_grid_y = (int)pred.size(2);
     
     const int num_class = 80; // number of classes. 80 for COCO
     const int reg_max_1 = ((int)pred.size(1) - num_class) / 4;
     
-    auto pred_a = pred.accessor<float, 4>()[0];
+    const int64_t cstep = (int64_t)num_grid_x * num_grid_y;
+    const float* ptr = pred.data_ptr<float>();
     
-    for (int i = 0; i < num_grid_y; i++) {
-        for (int j = 0; j < num_grid_x; j++) {
-            // find label with max score
-            int label = -1;
-            float score = -FLT_MAX;
-            for (int k = 0; k < num_class; k++) {
-                float s = pred_a[k][i][j];
-                if (s > score) {
-                    label = k;
-                    score = s;
-                }
-            }
+    const float logit_threshold = sigmoid_threshold_logit(prob_threshold);
+    
+    rows.ensure(num_grid_x);
+    float* max_score = rows.max_score.data();
+    int* max_label = rows.max_label.data();
+    int* candidates = rows.candidates.data();
+    
+    for (int i = row_begin; i < row_end; i++) {
+        const float* row_ptr = ptr + (int64_t)i * num_grid_x;
+        
+        // find label with max score and drop the low score positions before decoding
+        class_argmax_row(row_ptr, cstep, num_class, num_grid_x, max_score, max_label);
+        int num_candidate = select_candidates(max_score, num_grid_x, logit_threshold, candidates);
+        
+        for (int c = 0; c < num_candidate; c++) {
+            const int j = candidates[c];
             
-            score = sigmoid(score);
+            float score = sigmoid(max_score[j]);
+            if (score < prob_threshold)
+                continue;
             
-            if (score >= prob_threshold) {
-                otter::Tensor bbox_pred = otter::empty({4, reg_max_1}, otter::ScalarType::Float);
-                auto bbox_pred_a = bbox_pred.accessor<float, 2>();
-                float* ptr = bbox_pred.data_ptr<float>();
-                for (int k = 0; k < reg_max_1 * 4; k++) {
-                    ptr[k] = pred_a[num_class + k][i][j];
-                }
-                // TODO: Softmax
-                {
-                    int w = reg_max_1;
-                    int h = 4;
-                    
-                    for (int i = 0; i < h; i++) {
-                        float* ptr = bbox_pred_a[i].data();
-                        float m = -FLT_MAX;
-                        for (int j = 0; j < w; j++) {
-                            m = std::max(m, ptr[j]);
-                        }
-                        
-                        float s = 0.f;
-                        for (int j = 0; j < w; j++) {
-                            ptr[j] = static_cast<float>(exp(ptr[j] - m));
-                            s += ptr[j];
-                        }
-                        
-                        for (int j = 0; j < w; j++) {
-                            ptr[j] /= s;
-                        }
-                    }
-                }
+            // distribution focal loss integral, softmax over reg_max_1 bins
+            float pred_ltrb[4];
+            for (int k = 0; k < 4; k++) {
+                const float* dis_ptr = row_ptr + (num_class + k * reg_max_1) * cstep + j;
                 
-                float pred_ltrb[4];
-                for (int k = 0; k < 4; k++) {
-                    float dis = 0.f;
-                    const float* dis_after_sm = bbox_pred_a[k].data();
-                    for (int l = 0; l < reg_max_1; l++) {
-                        dis += l * dis_after_sm[l];
-                    }
-                    
-                    pred_ltrb[k] = dis * stride;
+                float m = -FLT_MAX;
+                for (int l = 0; l < reg_max_1; l++) {
+                    m = std::max(m, dis_ptr[l * cstep]);
                 }
                 
-                float pb_cx = j * stride;
-                float pb_cy = i * stride;
-                
-                float x0 = pb_cx - pred_ltrb[0];
-                float y0 = pb_cy - pred_ltrb[1];
-                float x1 = pb_cx + pred_ltrb[2];
-                float y1 = pb_cy + pred_ltrb[3];
-                
-                Object obj;
-                obj.x = x0;
-                obj.y = y0;
-                obj.width = x1 - x0;
-                obj.height = y1 - y0;
-                obj.label = label;
-                obj.prob = score;
+                float s = 0.f;
+                float dis = 0.f;
+                for (int l = 0; l < reg_max_1; l++) {
+                    float e = static_cast<float>(exp(dis_ptr[l * cstep] - m));
+                    s += e;
+                    dis += l * e;
+                }
                 
-                objects.push_back(obj);
+                pred_ltrb[k] = dis / s * stride;
             }
-        }
-    }
-}
-
-static inline float intersection_area(const Object& a, const Object& b) {
-    float axmin = a.x, axmax = a.x + a.width;
-    float aymin = a.y, aymax = a.y + a.height;
-    float bxmin = b.x, bxmax = b.x + b.width;
-    float bymin = b.y, bymax = b.y + b.height;
-    
-    if (axmin > bxmax || axmax < bxmin || aymin > bymax || aymax < bymin) {
-        // no intersection
-        return 0.f;
-    }
-    
-    float inter_width = std::min(axmax, bxmax) - std::max(axmin, bxmin);
-    float inter_height = std::min(aymax, bymax) - std::max(aymin, bymin);
-    
-    return inter_width * inter_height;
-}
-
-void NanodetPlusDetectionOutputLayer::nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold) const {
-    picked.clear();
-    
-    const int n = (int)faceobjects.size();
-    
-    std::vector<float> areas(n);
-    for (int i = 0; i < n; i++)
-    {
-        areas[i] = faceobjects[i].width * faceobjects[i].height;
-    }
-    
-    for (int i = 0; i < n; i++)
-    {
-        const Object& a = faceobjects[i];
-        
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++)
-        {
-            const Object& b = faceobjects[picked[j]];
             
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = areas[i] + areas[picked[j]] - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area / union_area > nms_threshold)
-                keep = 0;
-        }
-        
-        if (keep)
-            picked.push_back(i);
-    }
-}
-
-void NanodetPlusDetectionOutputLayer::qsort_descent_inplace(std::vector<Object>& faceobjects, int left, int right) const {
-    int i = left;
-    int j = right;
-    float p = faceobjects[(left + right) / 2].prob;
-    
-    while (i <= j) {
-        while (faceobjects[i].prob > p)
-            i++;
-        
-        while (faceobjects[j].prob < p)
-            j--;
-        
-        if (i <= j) {
-            // swap
-            std::swap(faceobjects[i], faceobjects[j]);
+            float pb_cx = j * stride;
+            float pb_cy = i * stride;
             
-            i++;
-            j--;
-        }
-    }
-    
-#pragma omp parallel sections
-    {
-#pragma omp section
-        {
-            if (left < j) qsort_descent_inplace(faceobjects, left, j);
-        }
-#pragma omp section
-        {
-            if (i < right) qsort_descent_inplace(faceobjects, i, right);
+            float x0 = pb_cx - pred_ltrb[0];
+            float y0 = pb_cy - pred_ltrb[1];
+            float x1 = pb_cx + pred_ltrb[2];
+            float y1 = pb_cy + pred_ltrb[3];
+            
+            objects.push_back(x0, y0, x1, y1, score, max_label[j]);
         }
     }
 }
 
-void NanodetPlusDetectionOutputLayer::qsort_descent_inplace(std::vector<Object>& faceobjects) const {
-    if (faceobjects.empty())
-        return;
-    
-    qsort_descent_inplace(faceobjects, 0, (int)faceobjects.size() - 1);
-}
-
 Tensor nanodet_pre_process(const Tensor& img, int target_size, float& scale, int& wpad, int& hpad) {
     int width  = (int)img.size(3);
     int height = (int)img.size(2);
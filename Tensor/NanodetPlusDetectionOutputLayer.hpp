@@ -9,6 +9,7 @@
 #define NanodetPlusDetectionOutputLayer_hpp
 
 #include "Layer.hpp"
+#include "ProposalDecode.hpp"
 
 namespace otter {
 
@@ -29,25 +30,19 @@ public:
 public:
     float prob_threshold;
     float nms_threshold;
+    int nms_top_k;
     otter::Tensor stride;
     
 public:
-    struct Object {
-        float x, y, width, height;
-        int label;
-        float prob;
-    };
-    
-    void qsort_descent_inplace(std::vector<Object>& faceobjects, int left, int right) const;
-    void qsort_descent_inplace(std::vector<Object>& faceobjects) const;
-    void nms_sorted_bboxes(const std::vector<Object>& faceobjects, std::vector<int>& picked, float nms_threshold) const;
-    void generate_proposals(const otter::Tensor& pred, int stride, float prob_threshold, std::vector<Object>& objects) const;
+    // decode the proposals of rows [row_begin, row_end) of one level, pred has to be contiguous
+    void generate_proposals(const otter::Tensor& pred, int stride, int row_begin, int row_end, float prob_threshold, ProposalRowScratch& rows, BoxArray& objects) const;
 };
 
 enum class NanodetPlusParam {
     Prob_threshold,
     Nms_threshold,
-    Stride
+    Stride,
+    Nms_top_k
 };
 
 Tensor nanodet_pre_process(const Tensor& img, int target_size, float& scale, int& wpad, int& hpad);
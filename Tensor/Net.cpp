@@ -13,13 +13,10 @@
 #include "Otter.hpp"
 #include "Parallel.hpp"
 #include "Formatting.hpp"
-
-#if OTTER_BENCHMARK
 #include "Benchmark.hpp"
 #include "TensorFactory.hpp"
-#endif
+#include "ActivationLayer.hpp"
 
-#include <regex>
 
 namespace otter {
 
@@ -79,91 +76,106 @@ void Net::addLayer(LayerOption option) {
     }
 }
 
-void Net::graph_construct() {
-    size_t layer_count = layer_options.size();
-    size_t additional_layer_count = 0;
-    std::unordered_map<std::string, int> layer_map;
-    
-    // construct layer_map
-#define MAP_UPDATE  \
-    for (const auto i : otter::irange(layer_options.size())) {      \
-        std::stringstream top_list(layer_options[i]["output"]);     \
-        int top_count = (int)std::count(layer_options[i]["output"].begin(), layer_options[i]["output"].end(), ',') + 1; \
-        std::string top_name;                           \
-        for (int j = 0; j < top_count; ++j) {           \
-            std::getline(top_list, top_name, ',');      \
-            EARSE_SPACE(top_name);                      \
-            layer_map[top_name] = (int)i;               \
-        }                                               \
+static std::vector<std::string> split_blob_names(const std::string& list) {
+    std::vector<std::string> names;
+    std::stringstream name_list(list);
+    std::string name;
+    while (std::getline(name_list, name, ',')) {
+        EARSE_SPACE(name);
+        if (!name.empty())
+            names.push_back(name);
     }
+    return names;
+}
+
+static std::string join_blob_names(const std::vector<std::string>& names) {
+    std::string list;
+    for (const auto i : otter::irange(names.size())) {
+        if (i > 0)
+            list += ",";
+        list += names[i];
+    }
+    return list;
+}
+
+// Linear in the number of layers and blob references, the blobs are resolved through hash maps
+void Net::graph_construct() {
+    const size_t layer_count = layer_options.size();
     
-    MAP_UPDATE;
+    std::vector<std::vector<std::string>> inputs(layer_count);
+    std::vector<std::vector<std::string>> outputs(layer_count);
+    std::unordered_map<std::string, int> producer_map;
     
     for (const auto i : otter::irange(layer_count)) {
         LayerOption& layer = layer_options[i];
         
-        if (i > 0) {
-            if (!opt_check_string(layer, "input")) {
-                std::stringstream bottom_list(layer_options[i - 1]["output"]);
-                std::string bottom_name;
-                std::getline(bottom_list, bottom_name, ',');
-                EARSE_SPACE(bottom_name);
-                layer["input"] = bottom_name;
-            }
+        outputs[i] = split_blob_names(layer["output"]);
+        if (i > 0 && !opt_check_string(layer, "input") && !outputs[i - 1].empty()) {
+            layer["input"] = outputs[i - 1][0];
+        }
+        if (layer["type"] != "Input") {
+            inputs[i] = split_blob_names(layer["input"]);
         }
         
-        int input_count = (layer["type"] == "Input") ? 0 : (int)std::count(layer["input"].begin(), layer["input"].end(), ',') + 1;
-        std::stringstream input_list(layer["input"]);
-        for (const auto j : otter::irange(input_count)) {
-            (void)j;
-            std::string input_name;
-            std::getline(input_list, input_name, ',');
-            EARSE_SPACE(input_name);
-//            printf("layer name: %s consume: %s\n", layer["name"].c_str(), input_name.c_str());
-            layer_options[layer_map[input_name]]["consume_name"] += (layer["name"] + ",");
+        for (const auto& top_name : outputs[i]) {
+            producer_map[top_name] = (int)i;
         }
     }
     
-    for (size_t i = 0; i < layer_options.size(); ++i) {
-//        printf("process name: %s\n", layer_options[i]["name"].c_str());
-        int consume_count = (int)std::count(layer_options[i]["consume_name"].begin(), layer_options[i]["consume_name"].end(), ',');
-        int output_count = (int)std::count(layer_options[i]["output"].begin(), layer_options[i]["output"].end(), ',') + 1;
-//        printf("consume_count: %d -> name: %s\n", consume_count, layer_options[i]["consume_name"].c_str());
-        if (consume_count > output_count) {
+    // Every reference of a blob as (layer, input slot) in layer order
+    std::unordered_map<std::string, std::vector<std::pair<int, int>>> consumer_map;
+    for (const auto i : otter::irange(layer_count)) {
+        for (const auto j : otter::irange(inputs[i].size())) {
+            if (producer_map.find(inputs[i][j]) != producer_map.end()) {
+                consumer_map[inputs[i][j]].emplace_back((int)i, (int)j);
+            }
+        }
+    }
+    
+    // A blob consumed more than once is fed to a Split inserted right after its producer
+    std::vector<LayerOption> constructed;
+    constructed.reserve(layer_count);
+    size_t additional_layer_count = 0;
+    
+    for (const auto i : otter::irange(layer_count)) {
+        LayerOption& layer = layer_options[i];
+        if (layer["type"] != "Input") {
+            layer["input"] = join_blob_names(inputs[i]);
+        }
+        constructed.push_back(std::move(layer));
+        const size_t position = constructed.size() - 1;
+        
+        for (const auto j : otter::irange(outputs[i].size())) {
+            auto consumers = consumer_map.find(outputs[i][j]);
+            if (consumers == consumer_map.end() || consumers->second.size() <= 1)
+                continue;
+            
             ++additional_layer_count;
             LayerOption auto_opt;
             auto_opt["type"] = "Split";
             auto_opt["name"] = "auto_sp_" + std::to_string(additional_layer_count);
-            std::stringstream bottom_list(layer_options[i]["output"]);
-            std::string bottom_name;
-            std::getline(bottom_list, bottom_name, ',');
-            EARSE_SPACE(bottom_name);
-            auto_opt["input"] = bottom_name;
-            std::stringstream consume_list(layer_options[i]["consume_name"]);
-            for (const auto k : otter::irange(consume_count)) {
-                std::string split_name ="asp_" + std::to_string(i) + "_" + std::to_string(k);
-                auto_opt["output"] += split_name;
-                if (k < consume_count - 1)
-                    auto_opt["output"] += ", ";
-                std::string consume_name;
-                std::getline(consume_list, consume_name, ',');
-                EARSE_SPACE(consume_name);
-//                printf("change %d %s input to %s\n", layer_map[consume_name], layer_options[layer_map[consume_name]]["name"].c_str(), split_name.c_str());
-                LayerOption& target_change_layer = layer_options[layer_map[consume_name]];
-                std::string target_name = layer_options[i]["name"];
-                EARSE_SPACE(target_name);
+            auto_opt["input"] = outputs[i][j];
+            
+            std::vector<std::string> split_names;
+            for (const auto k : otter::irange(consumers->second.size())) {
+                std::string split_name = "asp_" + std::to_string(position) + ((j > 0) ? "_" + std::to_string(j) : "") + "_" + std::to_string(k);
                 
-                size_t target_index = target_change_layer["input"].find(target_name);
-                if (target_index == std::string::npos)
-                    target_index = 0;
-//                printf("before replace %s index: %d length: %d\n", target_change_layer["input"].c_str(), target_index, std::max(split_name.length(), target_name.length()));
-                target_change_layer["input"] = std::regex_replace(target_change_layer["input"], std::regex(target_name), split_name);
-//                printf("after replace %s\n", target_change_layer["input"].c_str());
+                const auto& consumer = consumers->second[k];
+                inputs[consumer.first][consumer.second] = split_name;
+                split_names.push_back(split_name);
             }
-            layer_options.insert(layer_options.begin() + i + 1, auto_opt);
-            MAP_UPDATE;
+            auto_opt["output"] = join_blob_names(split_names);
+            
+            constructed.push_back(std::move(auto_opt));
         }
     }
+    
+    layer_options = std::move(constructed);
+    
+    if (option.use_residual_fusion) {
+        fuse_convolution_residual();
+    }
+    
     blob_count_ = 0;
     for (const auto i : otter::irange(layer_options.size())) {
         LayerOption& option = layer_options[i];
@@ -171,16 +183,190 @@ void Net::graph_construct() {
     }
 }
 
+std::unordered_map<std::string, Tensor> Net::infer_blob_shapes() const {
+    std::unordered_map<std::string, Tensor> blob_shapes;
+    
+    ParamDict pd;
+    for (const auto& layer_option : layer_options) {
+        LayerOption option = layer_option;
+        
+        Layer* layer = LayerRegistry::CreateLayer(option["type"]);
+        layer->name = option["name"];
+        
+        std::vector<std::string> bottom_names;
+        if (option["type"] != "Input")
+            bottom_names = split_blob_names(option["input"]);
+        std::vector<std::string> top_names = split_blob_names(option["output"]);
+        
+        int pd_state = layer->parse_param(option, pd);
+        OTTER_CHECK(pd_state == 0, "ParamDict load ", layer->name, " failed or undefined");
+        
+        layer->bottom_shapes.resize(bottom_names.size());
+        for (const auto j : otter::irange(bottom_names.size())) {
+            auto blob_shape = blob_shapes.find(bottom_names[j]);
+            if (blob_shape != blob_shapes.end())
+                layer->bottom_shapes[j] = blob_shape->second;
+        }
+        layer->top_shapes.resize(top_names.size());
+        
+        int output_shape_state = layer->compute_output_shape(pd);
+        OTTER_CHECK(output_shape_state == 0, "Layer ", layer->name, " output_shape use default or undefined");
+        
+        Tensor shape_hints = pd.get(OUTPUT_SHAPE_HINT, Tensor());
+        for (const auto j : otter::irange(top_names.size())) {
+            Tensor& blob_shape = blob_shapes[top_names[j]];
+            if (shape_hints.defined()) {
+                int index = (shape_hints.size(0) > 1) ? (int)j : 0;
+                blob_shape = shape_hints[index].view({1, -1}).clone();
+            }
+        }
+        
+        delete layer;
+    }
+    
+    return blob_shapes;
+}
+
+static bool same_blob_shape(const Tensor& a, const Tensor& b) {
+    if (!a.defined() || !b.defined() || a.numel() != b.numel())
+        return false;
+    
+    const Tensor a_ = a.to(ScalarType::Int).contiguous();
+    const Tensor b_ = b.to(ScalarType::Int).contiguous();
+    
+    return std::equal(a_.data_ptr<int>(), a_.data_ptr<int>() + a_.numel(), b_.data_ptr<int>());
+}
+
+void Net::fuse_convolution_residual() {
+    const size_t layer_count = layer_options.size();
+    
+    // A Darknet ShortCut also adds blobs of different channels, only a residual of the output shape is fused
+    const std::unordered_map<std::string, Tensor> blob_shapes = infer_blob_shapes();
+    auto blob_shape = [&blob_shapes](const std::string& name) {
+        auto shape = blob_shapes.find(name);
+        return (shape == blob_shapes.end()) ? Tensor() : shape->second;
+    };
+    
+    // Blob -> producer and blob -> first consumer, kept up to date while layers are folded
+    std::unordered_map<std::string, int> producer_map;
+    std::unordered_map<std::string, int> consumer_map;
+    for (const auto i : otter::irange(layer_count)) {
+        for (const auto& top_name : split_blob_names(layer_options[i]["output"])) {
+            producer_map[top_name] = (int)i;
+        }
+        for (const auto& bottom_name : split_blob_names(layer_options[i]["input"])) {
+            consumer_map.emplace(bottom_name, (int)i);
+        }
+    }
+    
+    // Folded layers are dropped at the end so that the indices stay valid
+    std::vector<char> removed(layer_count, 0);
+    
+    for (const auto i : otter::irange(layer_count)) {
+        if (removed[i])
+            continue;
+        
+        LayerOption& shortcut = layer_options[i];
+        // The operation of Eltwise shares the "type" key with the layer type, so it is always Sum
+        if (shortcut["type"] != "ShortCut" && shortcut["type"] != "Eltwise")
+            continue;
+        
+        std::vector<std::string> inputs = split_blob_names(shortcut["input"]);
+        std::vector<std::string> outputs = split_blob_names(shortcut["output"]);
+        if (inputs.size() != 2 || outputs.size() != 1)
+            continue;
+        
+        int producers[2] = {-1, -1};
+        for (const auto k : otter::irange(2)) {
+            auto producer = producer_map.find(inputs[k]);
+            if (producer != producer_map.end() && producer->second < (int)i)
+                producers[k] = producer->second;
+        }
+        
+        // The residual must be produced before the convolution, layers are never reordered since
+        // the weights are loaded in layer order
+        int conv_index = -1;
+        int residual_slot = -1;
+        for (const auto k : otter::irange(2)) {
+            int producer = producers[k];
+            int other = producers[1 - k];
+            if (producer < 0 || other < 0 || other >= producer)
+                continue;
+            
+            LayerOption& conv = layer_options[producer];
+            if (conv["type"] != "Convolution" || opt_check_string(conv, "residual_term"))
+                continue;
+            if (opt_find_int(conv, "int8_scale_term", 0))
+                continue;
+            if (split_blob_names(conv["output"]).size() != 1)
+                continue;
+            if (!same_blob_shape(blob_shape(conv["output"]), blob_shape(inputs[1 - k])))
+                continue;
+            
+            if (producer > conv_index) {
+                conv_index = producer;
+                residual_slot = 1 - k;
+            }
+        }
+        if (conv_index < 0)
+            continue;
+        
+        LayerOption& conv = layer_options[conv_index];
+        conv["input"] = split_blob_names(conv["input"])[0] + "," + inputs[residual_slot];
+        conv["residual_term"] = "1";
+        conv["output"] = outputs[0];
+        producer_map[outputs[0]] = conv_index;
+        
+        // The sum has a single consumer after graph_construct, fold it when it is an activation
+        auto consumer = consumer_map.find(outputs[0]);
+        if (consumer != consumer_map.end() && consumer->second > (int)i && !removed[consumer->second]) {
+            LayerOption& activation = layer_options[consumer->second];
+            std::vector<std::string> activation_inputs = split_blob_names(activation["input"]);
+            std::vector<std::string> activation_outputs = split_blob_names(activation["output"]);
+            std::string type = activation["type"];
+            if (activation_inputs.size() == 1 && activation_outputs.size() == 1 && activation_type_from_string(type) != 0) {
+                conv["post_activation"] = type;
+                if (type == "LRelu") {
+                    conv["post_activation_params"] = opt_check_string(activation, "alpha") ? activation["alpha"] : "0.1";
+                } else if ((type == "HardSwish" || type == "HardSigmoid") && opt_check_string(activation, "alpha") && opt_check_string(activation, "beta")) {
+                    conv["post_activation_params"] = activation["alpha"] + "," + activation["beta"];
+                }
+                conv["output"] = activation_outputs[0];
+                producer_map[activation_outputs[0]] = conv_index;
+                removed[consumer->second] = 1;
+            }
+        }
+        
+        removed[i] = 1;
+    }
+    
+    size_t kept = 0;
+    for (const auto i : otter::irange(layer_count)) {
+        if (removed[i])
+            continue;
+        if (kept != i)
+            layer_options[kept] = std::move(layer_options[i]);
+        ++kept;
+    }
+    layer_options.resize(kept);
+}
+
 void Net::compile(CompileMode comopile_mode) {
     
     graph_construct();
     
+    compile_layers(comopile_mode);
+}
+
+void Net::compile_layers(CompileMode comopile_mode) {
     size_t layer_count = layer_options.size();
     size_t blob_count  = blob_count_;
     
     OTTER_CHECK(!(layer_count <= 0 || blob_count <= 0), "Invalid network\n");
     
     this->init_blobs_and_layers(blob_count, layer_count);
+    blob_index_map.clear();
+    blob_index_map.reserve(blob_count);
     
     ParamDict pd;
     
@@ -210,6 +396,7 @@ void Net::compile(CompileMode comopile_mode) {
                 Blob& blob = blobs[blob_index];
                 bottom_blob_index = blob_index;
                 blob.name = std::string(bottom_name);
+                blob_index_map.emplace(blob.name, blob_index);
                 
                 blob_index++;
             }
@@ -231,6 +418,7 @@ void Net::compile(CompileMode comopile_mode) {
             
             Blob& blob = blobs[blob_index];
             blob.name = blob_name;
+            blob_index_map.emplace(blob.name, blob_index);
 
             blob.producer = (int)i;
             layer->tops[j] = blob_index;
@@ -277,16 +465,22 @@ void Net::compile(CompileMode comopile_mode) {
     
     this->update_input_output_indexes();
     this->update_input_output_names();
+    this->build_execution_plan();
 }
 
 int Net::find_blob_index_by_name(std::string name) const {
-    for (const auto i : otter::irange(blobs.size())) {
-        const Blob& blob = blobs[i];
-        if (blob.name == name) {
-            return static_cast<int>(i);
-        }
-    }
-    return -1;
+    auto blob = blob_index_map.find(name);
+    if (blob == blob_index_map.end())
+        return -1;
+    
+    return blob->second;
+}
+
+BlobHandle Net::blob_handle(const std::string& name) const {
+    BlobHandle handle;
+    handle.index = find_blob_index_by_name(name);
+    
+    return handle;
 }
 
 void Net::update_input_output_indexes() {
@@ -347,37 +541,100 @@ void Net::summary() {
     printf("=============================================================\n");
 }
 
-int Net::forward_layer(int layer_index, std::vector<Tensor>& blob_tensors, const NetOption& opt) const {
-    const Layer* layer = layers[layer_index];
+void Net::build_execution_plan() {
+    build_tiled_segments();
     
-    if (layer->one_blob_only) {
-        int bottom_blob_index = layer->bottoms[0];
+    // Layers are stored in topological order, a bottom blob always refers to an earlier producer
+    execution_plan.resize(layers.size());
+    for (const auto i : otter::irange(layers.size())) {
+        ExecutionStep& step = execution_plan[i];
+        step.layer = layers[i];
+        step.tiled_segment = tiled_segment_of_tail[i];
+    }
+}
+
+int Net::forward_blobs(ArrayRef<int> blob_indexes, std::vector<Tensor>& blob_tensors, ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler) const {
+    // Walk the plan backward to find the steps producing the missing blobs
+    scratch.blob_needed.assign(blobs.size(), 0);
+    scratch.step_needed.assign(execution_plan.size(), 0);
+    for (int blob_index : blob_indexes) {
+        scratch.blob_needed[blob_index] = 2;
+    }
+    
+    for (size_t i = execution_plan.size(); i-- > 0;) {
+        const ExecutionStep& step = execution_plan[i];
         
-        if (!blob_tensors[bottom_blob_index].defined()) {
-            int ret = forward_layer(blobs[bottom_blob_index].producer, blob_tensors, opt);
-            if (ret != 0)
-                return ret;
+        bool needed = false;
+        for (int top_blob_index : step.layer->tops) {
+            needed |= scratch.blob_needed[top_blob_index] && !blob_tensors[top_blob_index].defined();
         }
-    } else {
-        for (const auto i : otter::irange(layer->bottoms.size())) {
-            int bottom_blob_index = layer->bottoms[i];
-
-            if (!blob_tensors[bottom_blob_index].defined()) {
-                int ret = forward_layer(blobs[bottom_blob_index].producer, blob_tensors, opt);
+        if (!needed)
+            continue;
+        
+        // The blobs of Input are given by Extractor::input, in light mode they are released once consumed
+        if (step.layer->bottoms.empty()) {
+            fprintf(stderr, "[Net] Input of layer %s is not given\n", step.layer->name.c_str());
+            return -1;
+        }
+        
+        scratch.step_needed[i] = 1;
+        
+        // A tiled segment only needs the input of its first layer, unless a blob inside it is requested
+        const Layer* head = step.layer;
+        if (opt.use_tiled_execution && step.tiled_segment >= 0) {
+            const TiledSegment& segment = tiled_segments[step.tiled_segment];
+            
+            bool inner_requested = false;
+            for (size_t j = 0; j + 1 < segment.layers.size(); ++j) {
+                inner_requested |= scratch.blob_needed[layers[segment.layers[j]]->tops[0]] == 2;
+            }
+            
+            if (!inner_requested) {
+                scratch.step_needed[i] = 2;
+                head = layers[segment.layers.front()];
+            }
+        }
+        
+        for (int bottom_blob_index : head->bottoms) {
+            if (!scratch.blob_needed[bottom_blob_index])
+                scratch.blob_needed[bottom_blob_index] = 1;
+        }
+    }
+    
+    for (const auto i : otter::irange(execution_plan.size())) {
+        if (!scratch.step_needed[i])
+            continue;
+        
+        const ExecutionStep& step = execution_plan[i];
+        
+        if (scratch.step_needed[i] == 2) {
+            const TiledSegment& segment = tiled_segments[step.tiled_segment];
+            
+            int ret = 0;
+            if (forward_tiled_segment(segment, blob_tensors, scratch, opt, profiler, ret)) {
                 if (ret != 0)
                     return ret;
+                continue;
             }
+            
+            // Not worth tiling for this input, run the whole segment layer by layer
+            for (int layer_index : segment.layers) {
+                ret = do_forward_layer(layers[layer_index], blob_tensors, scratch, opt, profiler);
+                if (ret != 0)
+                    return ret;
+            }
+            continue;
         }
+        
+        int ret = do_forward_layer(step.layer, blob_tensors, scratch, opt, profiler);
+        if (ret != 0)
+            return ret;
     }
     
-    int ret = do_forward_layer(layer, blob_tensors, opt);
-    if (ret != 0)
-        return ret;
-    
     return 0;
 }
 
-void Net::convert_layout(Tensor &bottom_blob, const Layer *layer, const NetOption &opt) const {
+void Net::convert_layout(Tensor &bottom_blob, const Layer *layer, const NetOption &opt, Profiler* profiler) const {
     if (opt.use_packing_layout) {
         int dst_elempack = 1;
         int elemcount = 0;
@@ -405,12 +662,254 @@ void Net::convert_layout(Tensor &bottom_blob, const Layer *layer, const NetOptio
         }
         
         if (bottom_blob.elempack() != dst_elempack) {
-            bottom_blob = bottom_blob.packing(dst_elempack);
+            if (profiler) {
+                double start = get_current_time();
+                Tensor packed = bottom_blob.packing(dst_elempack);
+                profiler->record_packing(layer, start, get_current_time(), bottom_blob, packed);
+                bottom_blob = packed;
+            } else {
+                bottom_blob = bottom_blob.packing(dst_elempack);
+            }
+        }
+    }
+}
+
+// A segment is cut when the halo of its band, in rows of the segment input, grows past this
+static constexpr int64_t kMaxTileHalo = 32;
+// Bands are not shrunk below the size where the recomputed halo rows add half of the work
+static constexpr double kMaxTileOverhead = 1.5;
+
+void Net::build_tiled_segments() {
+    tiled_segments.clear();
+    tiled_segment_of_tail.assign(layers.size(), -1);
+    
+    std::vector<int> chain;
+    bool has_convolution = false;
+    int64_t halo = 0;
+    int64_t scale = 1;
+    
+    auto flush = [&]() {
+        if (chain.size() >= 2 && has_convolution) {
+            tiled_segment_of_tail[chain.back()] = (int)tiled_segments.size();
+            tiled_segments.push_back({chain});
+        }
+        chain.clear();
+        has_convolution = false;
+        halo = 0;
+        scale = 1;
+    };
+    
+    for (const auto i : otter::irange(layers.size())) {
+        const Layer* layer = layers[i];
+        
+        TileFootprint footprint;
+        if (!layer->one_blob_only || layer->tops.size() != 1 || !layer->tile_footprint(footprint)) {
+            flush();
+            continue;
+        }
+        
+        if (!chain.empty()) {
+            const Blob& blob = blobs[layer->bottoms[0]];
+            if (blob.producer != chain.back() || blob.consumer != (int)i || halo + (footprint.kernel_height - footprint.stride_height) * scale > kMaxTileHalo)
+                flush();
+        }
+        
+        chain.push_back((int)i);
+        has_convolution |= (layer->type() == "Convolution");
+        halo += (footprint.kernel_height - footprint.stride_height) * scale;
+        scale *= footprint.stride_height;
+    }
+    flush();
+}
+
+// Rows [begin, end) of a 4-D blob with pad_top and pad_bottom rows of pad_value around them
+static Tensor tile_band(const Tensor& blob, int64_t begin, int64_t end, int64_t pad_top, int64_t pad_bottom, float pad_value) {
+    const Tensor blob_c = blob.contiguous();
+    const int64_t planes = blob_c.size(0) * blob_c.size(1);
+    const int64_t height = blob_c.size(2);
+    const int64_t rows = pad_top + (end - begin) + pad_bottom;
+    const int64_t row_size = blob_c.size(3) * blob_c.elempack();
+    
+    Tensor band = otter::empty({blob_c.size(0), blob_c.size(1), rows, blob_c.size(3)}, blob_c.scalar_type());
+    
+    const float* src = (const float*)blob_c.data_ptr();
+    float* dst = (float*)band.data_ptr();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t p_begin, int64_t p_end) {
+        for (const auto p : otter::irange(p_begin, p_end)) {
+            float* outptr = dst + p * rows * row_size;
+            std::fill(outptr, outptr + pad_top * row_size, pad_value);
+            outptr += pad_top * row_size;
+            
+            memcpy(outptr, src + (p * height + begin) * row_size, (end - begin) * row_size * sizeof(float));
+            outptr += (end - begin) * row_size;
+            
+            std::fill(outptr, outptr + pad_bottom * row_size, pad_value);
+        }
+    });
+    
+    return band;
+}
+
+// Write the band to the rows starting at row of blob
+static void store_band(Tensor& blob, int64_t row, const Tensor& band) {
+    const Tensor band_c = band.contiguous();
+    const int64_t planes = blob.size(0) * blob.size(1);
+    const int64_t height = blob.size(2);
+    const int64_t rows = band_c.size(2);
+    const int64_t row_size = blob.size(3) * blob.elempack();
+    
+    const float* src = (const float*)band_c.data_ptr();
+    float* dst = (float*)blob.data_ptr();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto p : otter::irange(begin, end)) {
+            memcpy(dst + (p * height + row) * row_size, src + p * rows * row_size, rows * row_size * sizeof(float));
+        }
+    });
+}
+
+bool Net::forward_tiled_segment(const TiledSegment& segment, std::vector<Tensor>& blob_tensors, const ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler, int& ret) const {
+    ret = 0;
+    
+    const int bottom_blob_index = layers[segment.layers.front()]->bottoms[0];
+    const int top_blob_index = layers[segment.layers.back()]->tops[0];
+    
+    Tensor bottom_blob = blob_tensors[bottom_blob_index];
+    const ScalarType dtype = bottom_blob.scalar_type();
+    if (bottom_blob.dim() != 4 || !(dtype == ScalarType::Float || dtype == ScalarType::Float4 || dtype == ScalarType::Float8))
+        return false;
+    
+    // Shape of every blob of the segment
+    const size_t count = segment.layers.size();
+    std::vector<TileFootprint> footprints(count);
+    std::vector<int64_t> heights(count + 1);
+    std::vector<int64_t> widths(count + 1);
+    std::vector<int64_t> channels(count + 1);
+    heights[0]  = bottom_blob.size(2);
+    widths[0]   = bottom_blob.size(3);
+    channels[0] = bottom_blob.size(1) * bottom_blob.elempack();
+    for (const auto i : otter::irange(count)) {
+        TileFootprint& footprint = footprints[i];
+        if (!layers[segment.layers[i]]->tile_footprint(footprint))
+            return false;
+        
+        heights[i + 1]  = (heights[i] + footprint.padding_top + footprint.padding_bottom - footprint.kernel_height) / footprint.stride_height + 1;
+        widths[i + 1]   = (widths[i] + footprint.padding_left + footprint.padding_right - footprint.kernel_width) / footprint.stride_width + 1;
+        channels[i + 1] = footprint.out_channels ? footprint.out_channels : channels[i];
+        if (heights[i + 1] <= 0 || widths[i + 1] <= 0)
+            return false;
+    }
+    
+    // Rows of every blob of the segment computed for rows of the output
+    auto band_rows = [&](int64_t rows, std::vector<int64_t>& band) {
+        band.resize(count + 1);
+        band[count] = rows;
+        for (size_t i = count; i-- > 0;) {
+            const TileFootprint& footprint = footprints[i];
+            band[i] = std::min((band[i + 1] - 1) * footprint.stride_height + footprint.kernel_height, heights[i] + footprint.padding_top + footprint.padding_bottom);
+        }
+    };
+    
+    const int64_t out_height = heights[count];
+    std::vector<int64_t> band;
+    auto band_bytes = [&](int64_t rows) {
+        band_rows(rows, band);
+        int64_t bytes = 0;
+        for (const auto i : otter::irange(count + 1)) {
+            bytes += band[i] * widths[i] * channels[i];
+        }
+        return bytes * bottom_blob.size(0) * (int64_t)sizeof(float);
+    };
+    auto band_overhead = [&](int64_t rows) {
+        band_rows(rows, band);
+        const int64_t tiles = (out_height + rows - 1) / rows;
+        double overhead = 1;
+        for (const auto i : otter::irange(1, count + 1)) {
+            overhead = std::max(overhead, (double)(tiles * band[i]) / (double)heights[i]);
+        }
+        return overhead;
+    };
+    
+    int64_t tile_rows = out_height;
+    while (tile_rows > 1 && band_bytes(tile_rows) > opt.tiled_execution_cache_size)
+        tile_rows--;
+    while (tile_rows < out_height && band_overhead(tile_rows) > kMaxTileOverhead)
+        tile_rows++;
+    if (tile_rows >= out_height)
+        return false;
+    
+    convert_layout(bottom_blob, layers[segment.layers.front()], opt, profiler);
+    
+    Tensor top_blob;
+    std::vector<int64_t> begins(count + 1);
+    std::vector<int64_t> ends(count + 1);
+    
+    for (int64_t row = 0; row < out_height; row += tile_rows) {
+        // Rows of every blob needed by the band, the padding rows are added before each layer
+        begins[count] = row;
+        ends[count] = std::min(row + tile_rows, out_height);
+        for (size_t i = count; i-- > 0;) {
+            const TileFootprint& footprint = footprints[i];
+            begins[i] = std::max(begins[i + 1] * footprint.stride_height - footprint.padding_top, (int64_t)0);
+            ends[i] = std::min((ends[i + 1] - 1) * footprint.stride_height - footprint.padding_top + footprint.kernel_height, heights[i]);
+        }
+        
+        Tensor blob = bottom_blob;
+        for (const auto i : otter::irange(count)) {
+            const Layer* layer = layers[segment.layers[i]];
+            const TileFootprint& footprint = footprints[i];
+            
+            const int64_t pad_top = std::max(footprint.padding_top - begins[i + 1] * footprint.stride_height, (int64_t)0);
+            const int64_t pad_bottom = std::max((ends[i + 1] - 1) * footprint.stride_height - footprint.padding_top + footprint.kernel_height - heights[i], (int64_t)0);
+            
+            // The first band is always copied since inplace layers write to it
+            if (i == 0) {
+                blob = tile_band(blob, begins[0], ends[0], pad_top, pad_bottom, footprint.pad_value);
+            } else if (pad_top || pad_bottom) {
+                blob = tile_band(blob, 0, blob.size(2), pad_top, pad_bottom, footprint.pad_value);
+            }
+            
+            convert_layout(blob, layer, opt, profiler);
+            
+            double start = 0;
+            if (profiler) {
+                set_profile_backend(nullptr);
+                start = get_current_time();
+            }
+            
+            Tensor bottom_band = blob;
+            if (layer->support_inplace) {
+                ret = layer->forward_inplace(blob, opt);
+            } else {
+                Tensor top_band;
+                ret = layer->forward_tile(bottom_band, top_band, opt);
+                blob = top_band;
+            }
+            if (ret != 0)
+                return true;
+            
+            if (profiler) {
+                profiler->record_layer(layer, start, get_current_time(), {bottom_band}, {blob});
+            }
         }
+        
+        if (!top_blob.defined()) {
+            top_blob = otter::empty({blob.size(0), blob.size(1), out_height, blob.size(3)}, blob.scalar_type());
+        }
+        store_band(top_blob, row, blob);
+    }
+    
+    blob_tensors[top_blob_index] = top_blob;
+    
+    if (opt.lightmode && scratch.blob_needed[bottom_blob_index] != 2) {
+        blob_tensors[bottom_blob_index].reset();
     }
+    
+    return true;
 }
 
-int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors, const NetOption& opt) const {
+int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors, ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler) const {
     if (layer->one_blob_only) {
         int bottom_blob_index = layer->bottoms[0];
         int top_blob_index = layer->tops[0];
@@ -418,8 +917,11 @@ int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors,
         Tensor& bottom_blob_ref = blob_tensors[bottom_blob_index];
         Tensor bottom_blob;
         
+        // The requested blobs are kept for the caller
+        const bool keep_bottom = scratch.blob_needed[bottom_blob_index] == 2;
+        
         if (opt.lightmode) {
-            if (layer->support_inplace && bottom_blob_ref.use_count() != 1) {
+            if (layer->support_inplace && (bottom_blob_ref.use_count() != 1 || keep_bottom)) {
                 bottom_blob = bottom_blob_ref.clone();
             }
         }
@@ -427,7 +929,13 @@ int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors,
             bottom_blob = bottom_blob_ref;
         }
         
-        convert_layout(bottom_blob, layer, opt);
+        convert_layout(bottom_blob, layer, opt, profiler);
+        
+        double start = 0;
+        if (profiler) {
+            set_profile_backend(nullptr);
+            start = get_current_time();
+        }
         
         if (opt.lightmode && layer->support_inplace) {
             Tensor& bottom_top_blob = bottom_blob;
@@ -446,18 +954,23 @@ int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors,
             blob_tensors[top_blob_index] = top_blob;
         }
         
-        if (opt.lightmode) {
+        if (profiler) {
+            profiler->record_layer(layer, start, get_current_time(), {bottom_blob}, {blob_tensors[top_blob_index]});
+        }
+        
+        if (opt.lightmode && !keep_bottom) {
             blob_tensors[bottom_blob_index].reset();
         }
     } else {
-        std::vector<Tensor> bottom_blobs(layer->bottoms.size());
+        std::vector<Tensor>& bottom_blobs = scratch.bottom_blobs;
+        bottom_blobs.resize(layer->bottoms.size());
         for (const auto i : otter::irange(layer->bottoms.size())) {
             int bottom_blob_index = layer->bottoms[i];
             Tensor& bottom_blob_ref = blob_tensors[bottom_blob_index];
             bottom_blobs[i].reset();
             
             if (opt.lightmode) {
-                if (layer->support_inplace && bottom_blob_ref.use_count() != 1) {
+                if (layer->support_inplace && (bottom_blob_ref.use_count() != 1 || scratch.blob_needed[bottom_blob_index] == 2)) {
                     bottom_blobs[i] = bottom_blob_ref.clone();
                 }
             }
@@ -465,38 +978,56 @@ int Net::do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors,
                 bottom_blobs[i] = bottom_blob_ref;
             }
             
-             convert_layout(bottom_blobs[i], layer, opt);
+            convert_layout(bottom_blobs[i], layer, opt, profiler);
+        }
+        
+        double start = 0;
+        if (profiler) {
+            set_profile_backend(nullptr);
+            start = get_current_time();
         }
         
+        std::vector<Tensor>& top_blobs = scratch.top_blobs;
         if (opt.lightmode && layer->support_inplace) {
-            std::vector<Tensor>& bottom_top_blobs = bottom_blobs;
-            int ret = layer->forward_inplace(bottom_top_blobs, opt);
+            int ret = layer->forward_inplace(bottom_blobs, opt);
             if (ret != 0)
                 return ret;
             
+            top_blobs.resize(layer->tops.size());
             for (const auto i : otter::irange(layer->tops.size())) {
-                int top_blob_index = layer->tops[i];
-                
-                blob_tensors[top_blob_index] = bottom_top_blobs[i];
+                top_blobs[i] = bottom_blobs[i];
             }
         } else {
-            std::vector<Tensor> top_blobs(layer->tops.size());
+            top_blobs.resize(layer->tops.size());
+            for (auto& top_blob : top_blobs)
+                top_blob.reset();
+            
             int ret = layer->forward(bottom_blobs, top_blobs, opt);
             if (ret != 0)
                 return ret;
+        }
+        
+        for (const auto i : otter::irange(layer->tops.size())) {
+            int top_blob_index = layer->tops[i];
             
-            for (const auto i : otter::irange(layer->tops.size())) {
-                int top_blob_index = layer->tops[i];
-                
-                blob_tensors[top_blob_index] = top_blobs[i];
-            }
-            
+            blob_tensors[top_blob_index] = top_blobs[i];
         }
         
+        if (profiler) {
+            profiler->record_layer(layer, start, get_current_time(), bottom_blobs, top_blobs);
+        }
+        
+        // The buffers are kept for the next layer, drop the references so that the blobs can be released
+        for (auto& bottom_blob : bottom_blobs)
+            bottom_blob.reset();
+        for (auto& top_blob : top_blobs)
+            top_blob.reset();
+        
         if (opt.lightmode) {
             for (const auto i : otter::irange(layer->bottoms.size())) {
                 int bottom_blob_index = layer->bottoms[i];
-                blob_tensors[bottom_blob_index].reset();
+                if (scratch.blob_needed[bottom_blob_index] != 2)
+                    blob_tensors[bottom_blob_index].reset();
             }
         }
     }
@@ -535,6 +1066,118 @@ int Net::load_otter(const char *model_structure, CompileMode comopile_mode) {
     return 0;
 }
 
+static const int kGraphMagic = 0x5247544f;   // "OTGR"
+static const int kGraphVersion = 1;
+
+static void write_graph_string(FILE* fp, const std::string& str) {
+    uint32_t length = (uint32_t)str.size();
+    fwrite(&length, sizeof(uint32_t), 1, fp);
+    fwrite(str.data(), 1, length, fp);
+}
+
+static bool read_graph_string(const DataReader& dr, std::string& str) {
+    uint32_t length = 0;
+    if (dr.read(&length, sizeof(uint32_t)) != sizeof(uint32_t))
+        return false;
+    str.resize(length);
+    return length == 0 || dr.read(&str[0], length) == length;
+}
+
+int Net::save_graph(const char *graph_path) const {
+    if (layer_options.empty()) {
+        fprintf(stderr, "[Net] Empty graph!\n");
+        return -1;
+    }
+    
+    FILE* fp = fopen(graph_path, "wb");
+    if (!fp) {
+        fprintf(stderr, "Open graph file fail!\n");
+        return -1;
+    }
+    
+    uint32_t blob_count  = (uint32_t)blob_count_;
+    uint32_t layer_count = (uint32_t)layer_options.size();
+    fwrite(&kGraphMagic, sizeof(int), 1, fp);
+    fwrite(&kGraphVersion, sizeof(int), 1, fp);
+    fwrite(&blob_count, sizeof(uint32_t), 1, fp);
+    fwrite(&layer_count, sizeof(uint32_t), 1, fp);
+    
+    // Sorted so that the same graph always gives the same file
+    std::vector<std::pair<std::string, std::string>> params;
+    for (const LayerOption& option : layer_options) {
+        params.assign(option.begin(), option.end());
+        std::sort(params.begin(), params.end());
+        
+        uint32_t param_count = (uint32_t)params.size();
+        fwrite(&param_count, sizeof(uint32_t), 1, fp);
+        for (const auto& param : params) {
+            write_graph_string(fp, param.first);
+            write_graph_string(fp, param.second);
+        }
+    }
+    
+    int status = ferror(fp) ? -1 : 0;
+    fclose(fp);
+    return status;
+}
+
+int Net::load_graph(const char *graph_path, CompileMode comopile_mode) {
+    FILE* fp = fopen(graph_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Open graph file fail!\n");
+        return -1;
+    }
+    
+    int status = load_graph(fp, comopile_mode);
+    fclose(fp);
+    return status;
+}
+
+int Net::load_graph(FILE *f, CompileMode comopile_mode) {
+    DataReaderFromStdio dr(f);
+    return load_graph(dr, comopile_mode);
+}
+
+int Net::load_graph(const DataReader& dr, CompileMode comopile_mode) {
+    int magic = 0, version = 0;
+    dr.read(&magic, sizeof(int));
+    dr.read(&version, sizeof(int));
+    if (magic != kGraphMagic || version != kGraphVersion) {
+        fprintf(stderr, "[Net] Invalid graph file!\n");
+        return -1;
+    }
+    
+    uint32_t blob_count = 0, layer_count = 0;
+    dr.read(&blob_count, sizeof(uint32_t));
+    dr.read(&layer_count, sizeof(uint32_t));
+    
+    std::vector<LayerOption> options(layer_count);
+    for (LayerOption& option : options) {
+        uint32_t param_count = 0;
+        if (dr.read(&param_count, sizeof(uint32_t)) != sizeof(uint32_t)) {
+            fprintf(stderr, "[Net] Truncated graph file!\n");
+            return -1;
+        }
+        
+        option.reserve(param_count);
+        for (uint32_t j = 0; j < param_count; ++j) {
+            std::string key, value;
+            if (!read_graph_string(dr, key) || !read_graph_string(dr, value)) {
+                fprintf(stderr, "[Net] Truncated graph file!\n");
+                return -1;
+            }
+            option.emplace(std::move(key), std::move(value));
+        }
+    }
+    
+    // The file holds the constructed graph, Split and fused layers included
+    layer_options = std::move(options);
+    blob_count_ = blob_count;
+    this->compile_layers(comopile_mode);
+    
+    return 0;
+}
+
 int Net::load_weight(const char *weight_path, WeightType type) {
     FILE* fp = fopen(weight_path, "rb");
     if (!fp) {
@@ -607,55 +1250,10 @@ int Net::load_weight(const Initializer& initializer) {
         layer->create_pipeline(option);
     }
     
-    return 0;
-}
-
-#if OTTER_BENCHMARK
-int Net::forward_layer_benchmark(int layer_index, std::vector<Tensor>& blob_tensors, const NetOption& opt) const {
-    const Layer* layer = layers[layer_index];
-    
-    if (layer->one_blob_only) {
-        int bottom_blob_index = layer->bottoms[0];
-        
-        if (!blob_tensors[bottom_blob_index].defined()) {
-            int ret = forward_layer_benchmark(blobs[bottom_blob_index].producer, blob_tensors, opt);
-            if (ret != 0)
-                return ret;
-        }
-    } else {
-        for (const auto i : otter::irange(layer->bottoms.size())) {
-            int bottom_blob_index = layer->bottoms[i];
-
-            if (!blob_tensors[bottom_blob_index].defined()) {
-                int ret = forward_layer_benchmark(blobs[bottom_blob_index].producer, blob_tensors, opt);
-                if (ret != 0)
-                    return ret;
-            }
-        }
-    }
-    double start = get_current_time();
-    Tensor bottom_blob;
-    if (layer->one_blob_only) {
-        int bottom_blob_index = layer->bottoms[0];
-        bottom_blob = blob_tensors[bottom_blob_index];
-    }
-
-    int ret = do_forward_layer(layer, blob_tensors, opt);
-
-    double end = get_current_time();
-    if (layer->one_blob_only) {
-        int top_blob_index = layer->tops[0];
-        benchmark(layer, bottom_blob, blob_tensors[top_blob_index], start, end);
-    } else {
-        benchmark(layer, start, end);
-    }
-
-    if (ret != 0)
-        return ret;
+    build_execution_plan();
     
     return 0;
 }
-#endif
 
 const std::vector<const char*>& Net::input_names() const {
     return input_blob_names;
@@ -673,6 +1271,7 @@ Extractor::Extractor(const Net* net, size_t blob_count) {
     net_ = net;
     option = net->option;
     blob_tensors_.resize(blob_count);
+    profiling_ = false;
 }
 
 void Extractor::clear() {
@@ -683,6 +1282,21 @@ void Extractor::set_lightmode(bool lightmode) {
     option.lightmode = lightmode;
 }
 
+void Extractor::set_cpu_affinity(const CpuSet& thread_affinity_mask) {
+    option.cpu_affinity = thread_affinity_mask;
+}
+
+void Extractor::set_profiling(bool enable) {
+    profiling_ = enable;
+}
+
+Profiler& Extractor::profiler() {
+    if (!profiler_)
+        profiler_ = std::make_shared<Profiler>();
+    
+    return *profiler_;
+}
+
 int Extractor::input(std::string blob_name, const Tensor &in) {
     int blob_index = net_->find_blob_index_by_name(blob_name);
     if (blob_index == -1) {
@@ -701,6 +1315,10 @@ int Extractor::input(int blob_index, const Tensor &in) {
     return 0;
 }
 
+int Extractor::input(BlobHandle blob, const Tensor &in) {
+    return input(blob.index, in);
+}
+
 int Extractor::extract(std::string blob_name, Tensor &feat, int type) {
     int blob_index = net_->find_blob_index_by_name(blob_name);
     if (blob_index == -1) {
@@ -714,28 +1332,102 @@ int Extractor::extract(int blob_index, Tensor &feat, int type) {
     if (blob_index < 0 ||  blob_index >= (int)blob_tensors_.size())
         return -1;
     
-    int old_blocktime = get_kmp_blocktime();
-    set_kmp_blocktime(option.openmp_blocktime);
-    
     int ret = 0;
     
     if (!blob_tensors_[blob_index].defined()) {
-        int layer_index = net_->blobs[blob_index].producer;
-        ret = net_->forward_layer(layer_index, blob_tensors_, option);
+        ret = forward(blob_index);
     }
     
+    if (ret != 0)
+        return ret;
+    
     feat = blob_tensors_[blob_index];
     
     if (option.use_packing_layout && (type == 0)) {
         feat = feat.packing(1);
     }
     
+    return ret;
+}
+
+int Extractor::extract(BlobHandle blob, Tensor &feat, int type) {
+    return extract(blob.index, feat, type);
+}
+
+int Extractor::extract(const std::vector<BlobHandle>& blobs, std::vector<Tensor>& feats, int type) {
+    std::vector<int>& targets = scratch_.targets;
+    targets.clear();
+    for (const BlobHandle& blob : blobs) {
+        if (blob.index < 0 || blob.index >= (int)blob_tensors_.size())
+            return -1;
+        
+        if (!blob_tensors_[blob.index].defined())
+            targets.push_back(blob.index);
+    }
+    
+    int ret = 0;
+    
+    if (!targets.empty()) {
+        ret = forward(targets);
+    }
+    
+    if (ret != 0)
+        return ret;
+    
+    feats.resize(blobs.size());
+    for (const auto i : otter::irange(blobs.size())) {
+        feats[i] = blob_tensors_[blobs[i].index];
+        
+        if (option.use_packing_layout && (type == 0)) {
+            feats[i] = feats[i].packing(1);
+        }
+    }
+    
+    return ret;
+}
+
+int Extractor::extract(const std::vector<std::string>& blob_names, std::vector<Tensor>& feats, int type) {
+    std::vector<BlobHandle> blobs(blob_names.size());
+    for (const auto i : otter::irange(blob_names.size())) {
+        blobs[i] = net_->blob_handle(blob_names[i]);
+        if (!blobs[i].valid()) {
+            fprintf(stderr, "Extract failed!\n");
+        }
+    }
+    
+    return extract(blobs, feats, type);
+}
+
+namespace {
+// Cpus and team size the OpenMP workers of this thread were last bound to by an Extractor
+thread_local CpuSet bound_cpu_affinity;
+thread_local int bound_num_threads = 0;
+}   // end namespace
+
+int Extractor::forward(ArrayRef<int> blob_indexes) {
+    // The binding stays with the thread, so it is only redone when the mask or the team changes
+    if (!option.cpu_affinity.empty() && (option.cpu_affinity != bound_cpu_affinity || get_num_threads() != bound_num_threads)) {
+        set_cpu_thread_affinity(option.cpu_affinity);
+        bound_cpu_affinity = option.cpu_affinity;
+        bound_num_threads = get_num_threads();
+    }
+    
+    int old_blocktime = get_kmp_blocktime();
+    set_kmp_blocktime(option.openmp_blocktime);
+    
+    Profiler* run_profiler = nullptr;
+    if (profiling_) {
+        run_profiler = &profiler();
+        run_profiler->begin_run();
+    }
+    
+    int ret = net_->forward_blobs(blob_indexes, blob_tensors_, scratch_, option, run_profiler);
+    
     set_kmp_blocktime(old_blocktime);
     
     return ret;
 }
 
-#if OTTER_BENCHMARK
 int Extractor::benchmark(std::string start_name, std::string end_name, IntArrayRef input_shape, int loop_count) {
     Tensor input = otter::rand(input_shape, otter::ScalarType::Float);
     Tensor output;
@@ -819,8 +1511,12 @@ int Extractor::benchmark_info(std::string start_name, std::string end_name, IntA
     int ret = 0;
     
     if (!blob_tensors_[blob_index].defined()) {
-        int layer_index = net_->blobs[blob_index].producer;
-        ret = net_->forward_layer_benchmark(layer_index, blob_tensors_, option);
+        Profiler run_profiler;
+        run_profiler.begin_run();
+        
+        ret = net_->forward_blobs(blob_index, blob_tensors_, scratch_, option, &run_profiler);
+        
+        run_profiler.print_summary();
     }
     
     return ret;
@@ -834,6 +1530,9 @@ int Extractor::benchmark_info(std::vector<std::string> start_name, std::vector<s
         this->input(start_name[i], input);
     }
     
+    Profiler run_profiler;
+    run_profiler.begin_run();
+    
     int ret = 0;
     for (const auto i : otter::irange(0, end_name.size())) {
         int blob_index = net_->find_blob_index_by_name(end_name[i]);
@@ -841,13 +1540,13 @@ int Extractor::benchmark_info(std::vector<std::string> start_name, std::vector<s
         OTTER_CHECK(blob_index >= -1 && blob_index < int(blob_tensors_.size()), "Extract failed!\n");
         
         if (!blob_tensors_[blob_index].defined()) {
-            int layer_index = net_->blobs[blob_index].producer;
-            ret |= net_->forward_layer_benchmark(layer_index, blob_tensors_, option);
+            ret |= net_->forward_blobs(blob_index, blob_tensors_, scratch_, option, &run_profiler);
         }
     }
     
+    run_profiler.print_summary();
+    
     return ret;
 }
-#endif
 
 }   // end namespace otter
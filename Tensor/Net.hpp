@@ -14,11 +14,32 @@
 #include "Blob.hpp"
 #include "NetOption.hpp"
 #include "DataReader.hpp"
+#include "Profiler.hpp"
+
+#include <memory>
 
 namespace otter {
 
 class Extractor;
 
+// Blob resolved once through Net::blob_handle, then used by Extractor without any name lookup
+struct BlobHandle {
+    int index = -1;
+    
+    bool valid() const { return index >= 0; }
+};
+
+// Buffers of an Extractor reused by every extract, nothing is allocated per layer once they are warm
+struct ExecutionScratch {
+    // 1 for the blobs the requested ones depend on, 2 for the requested ones which light mode keeps
+    std::vector<char> blob_needed;
+    // 1 to run the layer, 2 to run the tiled segment ending at it
+    std::vector<char> step_needed;
+    std::vector<int> targets;
+    std::vector<Tensor> bottom_blobs;
+    std::vector<Tensor> top_blobs;
+};
+
 class Net {
     friend Extractor;
 public:
@@ -37,6 +58,12 @@ public:
     int checkVerison(const DataReader& dr);
     int load_otter(const char *model_structure, CompileMode comopile_mode);
     
+    // Binary graph of the constructed layers, loads without text parsing nor graph construction
+    int save_graph(const char *graph_path) const;
+    int load_graph(const char *graph_path, CompileMode comopile_mode = CompileMode::Initial);
+    int load_graph(FILE *f, CompileMode comopile_mode = CompileMode::Initial);
+    int load_graph(const DataReader& dr, CompileMode comopile_mode = CompileMode::Initial);
+    
     enum class WeightType {
         Otter,
         Ncnn
@@ -48,6 +75,7 @@ public:
     int load_weight(const Initializer& initializer);
     
     int find_blob_index_by_name(std::string name) const;
+    BlobHandle blob_handle(const std::string& name) const;
     void update_input_output_indexes();
     void update_input_output_names();
     
@@ -58,14 +86,34 @@ public:
     NetOption option;
     
 private:
-    void convert_layout(Tensor& bottom_blob, const Layer* layer, const NetOption& opt) const;
+    // Rewrite Convolution -> ShortCut / Eltwise -> activation into a Convolution with residual epilogue
+    void fuse_convolution_residual();
+    
+    // Shapes of the blobs of layer_options by name, computed the same way as compile_layers
+    std::unordered_map<std::string, Tensor> infer_blob_shapes() const;
+    
+    // Create the layers and blobs of the constructed layer_options
+    void compile_layers(CompileMode comopile_mode);
+    
+    void convert_layout(Tensor& bottom_blob, const Layer* layer, const NetOption& opt, Profiler* profiler) const;
+    
+    // A chain of layers with a tile footprint where every intermediate blob has a single consumer
+    struct TiledSegment {
+        std::vector<int> layers;
+    };
+    
+    void build_tiled_segments();
+    
+    // Return false when the segment is not worth tiling for this input, it then runs layer by layer
+    bool forward_tiled_segment(const TiledSegment& segment, std::vector<Tensor>& blob_tensors, const ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler, int& ret) const;
     
-    int forward_layer(int layer_index, std::vector<Tensor>& blob_tensors, const NetOption& opt) const;
-    int do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_mats, const NetOption& opt) const;
+    // Flatten the graph into execution_plan, called once the pipelines are created
+    void build_execution_plan();
     
-#if OTTER_BENCHMARK
-    int forward_layer_benchmark(int layer_index, std::vector<Tensor>& blob_tensors, const NetOption& opt) const;
-#endif
+    // Run the steps of the plan producing the missing blobs the blobs depend on in one traversal,
+    // profiler is nullptr when profiling is disabled
+    int forward_blobs(ArrayRef<int> blob_indexes, std::vector<Tensor>& blob_tensors, ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler) const;
+    int do_forward_layer(const Layer* layer, std::vector<Tensor>& blob_tensors, ExecutionScratch& scratch, const NetOption& opt, Profiler* profiler) const;
     
 private:
     std::vector<Layer*> layers;
@@ -73,11 +121,25 @@ private:
     
     std::vector<LayerOption> layer_options;
     size_t blob_count_ = 0;
+    std::unordered_map<std::string, int> blob_index_map;
     
     std::vector<int> input_blob_indexes;
     std::vector<int> output_blob_indexes;
     std::vector<const char*> input_blob_names;
     std::vector<const char*> output_blob_names;
+    
+    std::vector<TiledSegment> tiled_segments;
+    // Segment ending at the layer, -1 otherwise
+    std::vector<int> tiled_segment_of_tail;
+    
+    struct ExecutionStep {
+        const Layer* layer;
+        // Tiled segment ending at this step, -1 otherwise
+        int tiled_segment;
+    };
+    
+    // Every layer in topological order
+    std::vector<ExecutionStep> execution_plan;
 };
 
 class Extractor {
@@ -89,28 +151,52 @@ public:
     // Intermeidate tensor will be recycled immediately after calculation
     void set_lightmode(bool lightmode);
     
+    // Run on the cpus of the mask, see NetOption::cpu_affinity
+    void set_cpu_affinity(const CpuSet& thread_affinity_mask);
+    
     int input(int blob_index, const Tensor& in);
     
     int input(std::string blob_name, const Tensor& in);
     
+    int input(BlobHandle blob, const Tensor& in);
+    
     int extract(int blob_index, Tensor& feat, int type);
     
     int extract(std::string blob_name, Tensor& feat, int type);
     
-#if OTTER_BENCHMARK
+    int extract(BlobHandle blob, Tensor& feat, int type);
+    
+    // Run the graph once for all the blobs, feats follows the order of blobs
+    int extract(const std::vector<BlobHandle>& blobs, std::vector<Tensor>& feats, int type);
+    int extract(const std::vector<std::string>& blob_names, std::vector<Tensor>& feats, int type);
+    
+    // Record the timing of every layer and layout conversion in the following extract calls,
+    // the records are kept when profiling is turned off
+    void set_profiling(bool enable);
+    
+    Profiler& profiler();
+    
     int benchmark(std::string start_name, std::string end_name, IntArrayRef input_shape, int loop_count = 8);
     int benchmark(std::vector<std::string> start_name, std::vector<std::string> end_name, std::vector<IntArrayRef> input_shape, int loop_count = 8);
+    
+    // Run once and print the per layer profile
     int benchmark_info(std::string start_name, std::string end_name, IntArrayRef input_shape);
     int benchmark_info(std::vector<std::string> start_name, std::vector<std::string> end_name, std::vector<IntArrayRef> input_shape);
-#endif
     
 protected:
     Extractor(const Net* net, size_t blob_count);
 private:
+    // Compute the missing blobs of blob_indexes
+    int forward(ArrayRef<int> blob_indexes);
+    
     const Net* net_;
     std::vector<Tensor> blob_tensors_;
+    ExecutionScratch scratch_;
     
     NetOption option;
+    
+    bool profiling_;
+    std::shared_ptr<Profiler> profiler_;
 };
 
 #define EARSE_CHARACTER(str, c) str.erase(std::remove_if(str.begin(), str.end(), [](unsigned char x) { return x == c; }), str.end());
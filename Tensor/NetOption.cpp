@@ -15,6 +15,10 @@ NetOption::NetOption() {
     use_non_lib_optimize = true;
     use_packing_layout = true;
     use_fp16_storage = true;
+    use_residual_fusion = false;
+    use_sparse_weight = true;
+    use_tiled_execution = false;
+    tiled_execution_cache_size = 1024 * 1024;
     openmp_blocktime = 20;
 }
 
@@ -8,6 +8,8 @@
 #ifndef NetOption_hpp
 #define NetOption_hpp
 
+#include "CpuSet.hpp"
+
 namespace otter {
 
 class NetOption {
@@ -20,7 +22,18 @@ public:
     bool use_non_lib_optimize;
     bool use_packing_layout;
     bool use_fp16_storage;
+    // Fold ShortCut / Eltwise sum and the activation after it into the preceding Convolution,
+    // the folded blobs are gone afterwards so only enable it when they are not extracted
+    bool use_residual_fusion;
+    // Run Convolution and InnerProduct with sparse kernels when the pruned weight is sparse enough
+    bool use_sparse_weight;
+    // Run chains of Convolution / MaxPool / activation band by band so that the intermediate blobs
+    // of a band stay in cache, tiled_execution_cache_size is the byte budget of a band
+    bool use_tiled_execution;
+    int tiled_execution_cache_size;
     int openmp_blocktime;
+    // Bind the extracting thread and its OpenMP workers to these cpus, empty leaves the placement to the OS
+    CpuSet cpu_affinity;
 };
 
 enum class CompileMode {
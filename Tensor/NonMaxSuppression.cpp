@@ -0,0 +1,365 @@
+//
+//  NonMaxSuppression.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#include "NonMaxSuppression.hpp"
+#include "Parallel.hpp"
+#include "Utils.hpp"
+#include "VecIntrinsic.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+
+namespace otter {
+
+void BoxArray::clear() {
+    x0.clear();
+    y0.clear();
+    x1.clear();
+    y1.clear();
+    score.clear();
+    label.clear();
+}
+
+void BoxArray::reserve(size_t n) {
+    x0.reserve(n);
+    y0.reserve(n);
+    x1.reserve(n);
+    y1.reserve(n);
+    score.reserve(n);
+    label.reserve(n);
+}
+
+void BoxArray::resize(size_t n) {
+    x0.resize(n);
+    y0.resize(n);
+    x1.resize(n);
+    y1.resize(n);
+    score.resize(n);
+    label.resize(n);
+}
+
+void BoxArray::push_back(float x0_, float y0_, float x1_, float y1_, float score_, int label_) {
+    x0.push_back(x0_);
+    y0.push_back(y0_);
+    x1.push_back(x1_);
+    y1.push_back(y1_);
+    score.push_back(score_);
+    label.push_back(label_);
+}
+
+void BoxArray::append(const BoxArray& other) {
+    x0.insert(x0.end(), other.x0.begin(), other.x0.end());
+    y0.insert(y0.end(), other.y0.begin(), other.y0.end());
+    x1.insert(x1.end(), other.x1.begin(), other.x1.end());
+    y1.insert(y1.end(), other.y1.begin(), other.y1.end());
+    score.insert(score.end(), other.score.begin(), other.score.end());
+    label.insert(label.end(), other.label.begin(), other.label.end());
+}
+
+// Candidates gathered in processing order
+struct NmsCandidates {
+    void gather(const BoxArray& boxes, const int* order, int n, float label_offset) {
+        index.assign(order, order + n);
+        x0.resize(n);
+        y0.resize(n);
+        x1.resize(n);
+        y1.resize(n);
+        area.resize(n);
+        score.resize(n);
+
+        for (int i = 0; i < n; ++i) {
+            const int k = order[i];
+            const float offset = boxes.label[k] * label_offset;
+            x0[i] = boxes.x0[k] + offset;
+            y0[i] = boxes.y0[k] + offset;
+            x1[i] = boxes.x1[k] + offset;
+            y1[i] = boxes.y1[k] + offset;
+            area[i] = (boxes.x1[k] - boxes.x0[k]) * (boxes.y1[k] - boxes.y0[k]);
+            score[i] = boxes.score[k];
+        }
+    }
+
+    void swap(int a, int b) {
+        std::swap(index[a], index[b]);
+        std::swap(x0[a], x0[b]);
+        std::swap(y0[a], y0[b]);
+        std::swap(x1[a], x1[b]);
+        std::swap(y1[a], y1[b]);
+        std::swap(area[a], area[b]);
+        std::swap(score[a], score[b]);
+    }
+
+    std::vector<int> index;
+    std::vector<float> x0;
+    std::vector<float> y0;
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> area;
+    std::vector<float> score;
+};
+
+static inline float box_iou(float ax0, float ay0, float ax1, float ay1, float aarea, float bx0, float by0, float bx1, float by1, float barea) {
+    float w = std::max(std::min(ax1, bx1) - std::max(ax0, bx0), 0.f);
+    float h = std::max(std::min(ay1, by1) - std::max(ay0, by0), 0.f);
+    float inter = w * h;
+    float uni = aarea + barea - inter;
+
+    return uni > 0.f ? inter / uni : 0.f;
+}
+
+// Whether box a overlaps any of the nk kept boxes with IoU > threshold
+static bool overlap_any(float ax0, float ay0, float ax1, float ay1, float aarea, const float* kx0, const float* ky0, const float* kx1, const float* ky1, const float* karea, int nk, float threshold) {
+    int j = 0;
+#if __ARM_NEON
+    float32x4_t _ax0 = vdupq_n_f32(ax0);
+    float32x4_t _ay0 = vdupq_n_f32(ay0);
+    float32x4_t _ax1 = vdupq_n_f32(ax1);
+    float32x4_t _ay1 = vdupq_n_f32(ay1);
+    float32x4_t _aarea = vdupq_n_f32(aarea);
+    float32x4_t _thr = vdupq_n_f32(threshold);
+    float32x4_t _zero = vdupq_n_f32(0.f);
+    for (; j + 3 < nk; j += 4) {
+        float32x4_t _w = vsubq_f32(vminq_f32(_ax1, vld1q_f32(kx1 + j)), vmaxq_f32(_ax0, vld1q_f32(kx0 + j)));
+        float32x4_t _h = vsubq_f32(vminq_f32(_ay1, vld1q_f32(ky1 + j)), vmaxq_f32(_ay0, vld1q_f32(ky0 + j)));
+        _w = vmaxq_f32(_w, _zero);
+        _h = vmaxq_f32(_h, _zero);
+        float32x4_t _inter = vmulq_f32(_w, _h);
+        float32x4_t _union = vsubq_f32(vaddq_f32(_aarea, vld1q_f32(karea + j)), _inter);
+        uint32x4_t _mask = vcgtq_f32(_inter, vmulq_f32(_thr, _union));
+#if __aarch64__
+        if (vmaxvq_u32(_mask))
+            return true;
+#else
+        uint32x2_t _m = vorr_u32(vget_low_u32(_mask), vget_high_u32(_mask));
+        if (vget_lane_u32(vpmax_u32(_m, _m), 0))
+            return true;
+#endif
+    }
+#elif __SSE2__
+#if __AVX__
+    __m256 _ax0_avx = _mm256_set1_ps(ax0);
+    __m256 _ay0_avx = _mm256_set1_ps(ay0);
+    __m256 _ax1_avx = _mm256_set1_ps(ax1);
+    __m256 _ay1_avx = _mm256_set1_ps(ay1);
+    __m256 _aarea_avx = _mm256_set1_ps(aarea);
+    __m256 _thr_avx = _mm256_set1_ps(threshold);
+    __m256 _zero_avx = _mm256_setzero_ps();
+    for (; j + 7 < nk; j += 8) {
+        __m256 _w = _mm256_sub_ps(_mm256_min_ps(_ax1_avx, _mm256_loadu_ps(kx1 + j)), _mm256_max_ps(_ax0_avx, _mm256_loadu_ps(kx0 + j)));
+        __m256 _h = _mm256_sub_ps(_mm256_min_ps(_ay1_avx, _mm256_loadu_ps(ky1 + j)), _mm256_max_ps(_ay0_avx, _mm256_loadu_ps(ky0 + j)));
+        _w = _mm256_max_ps(_w, _zero_avx);
+        _h = _mm256_max_ps(_h, _zero_avx);
+        __m256 _inter = _mm256_mul_ps(_w, _h);
+        __m256 _union = _mm256_sub_ps(_mm256_add_ps(_aarea_avx, _mm256_loadu_ps(karea + j)), _inter);
+        __m256 _mask = _mm256_cmp_ps(_inter, _mm256_mul_ps(_thr_avx, _union), _CMP_GT_OQ);
+        if (_mm256_movemask_ps(_mask))
+            return true;
+    }
+#endif // __AVX__
+    __m128 _ax0 = _mm_set1_ps(ax0);
+    __m128 _ay0 = _mm_set1_ps(ay0);
+    __m128 _ax1 = _mm_set1_ps(ax1);
+    __m128 _ay1 = _mm_set1_ps(ay1);
+    __m128 _aarea = _mm_set1_ps(aarea);
+    __m128 _thr = _mm_set1_ps(threshold);
+    __m128 _zero = _mm_setzero_ps();
+    for (; j + 3 < nk; j += 4) {
+        __m128 _w = _mm_sub_ps(_mm_min_ps(_ax1, _mm_loadu_ps(kx1 + j)), _mm_max_ps(_ax0, _mm_loadu_ps(kx0 + j)));
+        __m128 _h = _mm_sub_ps(_mm_min_ps(_ay1, _mm_loadu_ps(ky1 + j)), _mm_max_ps(_ay0, _mm_loadu_ps(ky0 + j)));
+        _w = _mm_max_ps(_w, _zero);
+        _h = _mm_max_ps(_h, _zero);
+        __m128 _inter = _mm_mul_ps(_w, _h);
+        __m128 _union = _mm_sub_ps(_mm_add_ps(_aarea, _mm_loadu_ps(karea + j)), _inter);
+        __m128 _mask = _mm_cmpgt_ps(_inter, _mm_mul_ps(_thr, _union));
+        if (_mm_movemask_ps(_mask))
+            return true;
+    }
+#endif // __SSE2__
+    for (; j < nk; ++j) {
+        float w = std::max(std::min(ax1, kx1[j]) - std::max(ax0, kx0[j]), 0.f);
+        float h = std::max(std::min(ay1, ky1[j]) - std::max(ay0, ky0[j]), 0.f);
+        float inter = w * h;
+        float uni = aarea + karea[j] - inter;
+
+        if (inter > threshold * uni)
+            return true;
+    }
+
+    return false;
+}
+
+static void nms_hard(NmsCandidates& c, const NmsOption& opt, std::vector<int>& picked, std::vector<float>& picked_scores) {
+    const int n = (int)c.index.size();
+    const int limit = (opt.keep_top_k > 0) ? opt.keep_top_k : n;
+
+    // the kept boxes are compacted to the front of the candidate arrays
+    int nk = 0;
+    for (int i = 0; i < n && nk < limit; ++i) {
+        if (overlap_any(c.x0[i], c.y0[i], c.x1[i], c.y1[i], c.area[i], c.x0.data(), c.y0.data(), c.x1.data(), c.y1.data(), c.area.data(), nk, opt.iou_threshold))
+            continue;
+
+        c.x0[nk] = c.x0[i];
+        c.y0[nk] = c.y0[i];
+        c.x1[nk] = c.x1[i];
+        c.y1[nk] = c.y1[i];
+        c.area[nk] = c.area[i];
+
+        picked.push_back(c.index[i]);
+        picked_scores.push_back(c.score[i]);
+        nk++;
+    }
+}
+
+static void nms_soft(NmsCandidates& c, const NmsOption& opt, std::vector<int>& picked, std::vector<float>& picked_scores) {
+    const int n = (int)c.index.size();
+    const int limit = (opt.keep_top_k > 0) ? opt.keep_top_k : n;
+    const float inv_sigma = 1.f / opt.soft_sigma;
+
+    for (int i = 0; i < n && (int)picked.size() < limit; ++i) {
+        int m = i;
+        for (int j = i + 1; j < n; ++j) {
+            if (c.score[j] > c.score[m])
+                m = j;
+        }
+
+        if (c.score[m] < opt.score_threshold)
+            break;
+
+        c.swap(i, m);
+
+        picked.push_back(c.index[i]);
+        picked_scores.push_back(c.score[i]);
+
+        for (int j = i + 1; j < n; ++j) {
+            float iou = box_iou(c.x0[i], c.y0[i], c.x1[i], c.y1[i], c.area[i], c.x0[j], c.y0[j], c.x1[j], c.y1[j], c.area[j]);
+
+            if (opt.method == NmsMethod::SoftLinear) {
+                if (iou > opt.iou_threshold)
+                    c.score[j] *= 1.f - iou;
+            } else {
+                c.score[j] *= std::exp(-iou * iou * inv_sigma);
+            }
+        }
+    }
+}
+
+static void nms_sorted(const BoxArray& boxes, const int* order, int n, float label_offset, const NmsOption& opt, std::vector<int>& picked, std::vector<float>& picked_scores) {
+    NmsCandidates candidates;
+    candidates.gather(boxes, order, n, label_offset);
+
+    if (opt.method == NmsMethod::Hard) {
+        nms_hard(candidates, opt, picked, picked_scores);
+    } else {
+        nms_soft(candidates, opt, picked, picked_scores);
+    }
+}
+
+void non_max_suppression(const BoxArray& boxes, std::vector<int>& picked, std::vector<float>& picked_scores, const NmsOption& opt) {
+    picked.clear();
+    picked_scores.clear();
+
+    const int n = (int)boxes.size();
+    if (n == 0)
+        return;
+
+    const float* score = boxes.score.data();
+    auto descent = [score](int a, int b) {
+        return score[a] > score[b] || (score[a] == score[b] && a < b);
+    };
+
+    // pre-select and sort the candidates by score
+    std::vector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    if (opt.top_k > 0 && opt.top_k < n) {
+        std::partial_sort(order.begin(), order.begin() + opt.top_k, order.end(), descent);
+        order.resize(opt.top_k);
+    } else {
+        std::sort(order.begin(), order.end(), descent);
+    }
+
+    const int num_candidate = (int)order.size();
+
+    if (!opt.class_aware) {
+        nms_sorted(boxes, order.data(), num_candidate, 0.f, opt, picked, picked_scores);
+        return;
+    }
+
+    int max_label = 0;
+    for (int i = 0; i < num_candidate; ++i) {
+        max_label = std::max(max_label, boxes.label[order[i]]);
+    }
+
+    if (!opt.parallel_class || max_label == 0) {
+        // shift every class into its own disjoint region so that one pass never
+        // suppresses across classes
+        float coord_min = boxes.x0[order[0]];
+        float coord_max = boxes.x1[order[0]];
+        for (int i = 0; i < num_candidate; ++i) {
+            const int k = order[i];
+            coord_min = std::min(coord_min, std::min(boxes.x0[k], boxes.y0[k]));
+            coord_max = std::max(coord_max, std::max(boxes.x1[k], boxes.y1[k]));
+        }
+
+        nms_sorted(boxes, order.data(), num_candidate, coord_max - coord_min + 1.f, opt, picked, picked_scores);
+        return;
+    }
+
+    // bucket the sorted candidates by label, each bucket stays sorted
+    std::vector<std::vector<int>> class_order(max_label + 1);
+    for (int i = 0; i < num_candidate; ++i) {
+        class_order[boxes.label[order[i]]].push_back(order[i]);
+    }
+
+    std::vector<std::vector<int>> class_picked(max_label + 1);
+    std::vector<std::vector<float>> class_scores(max_label + 1);
+
+    otter::parallel_for(0, max_label + 1, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            if (class_order[q].empty())
+                continue;
+
+            nms_sorted(boxes, class_order[q].data(), (int)class_order[q].size(), 0.f, opt, class_picked[q], class_scores[q]);
+        }
+    });
+
+    std::vector<int> merged;
+    std::vector<float> merged_scores;
+    for (int q = 0; q <= max_label; ++q) {
+        merged.insert(merged.end(), class_picked[q].begin(), class_picked[q].end());
+        merged_scores.insert(merged_scores.end(), class_scores[q].begin(), class_scores[q].end());
+    }
+
+    std::vector<int> merged_order(merged.size());
+    std::iota(merged_order.begin(), merged_order.end(), 0);
+    std::sort(merged_order.begin(), merged_order.end(), [&](int a, int b) {
+        return merged_scores[a] > merged_scores[b] || (merged_scores[a] == merged_scores[b] && merged[a] < merged[b]);
+    });
+
+    int num_keep = (int)merged_order.size();
+    if (opt.keep_top_k > 0)
+        num_keep = std::min(num_keep, opt.keep_top_k);
+
+    picked.resize(num_keep);
+    picked_scores.resize(num_keep);
+    for (int i = 0; i < num_keep; ++i) {
+        picked[i] = merged[merged_order[i]];
+        picked_scores[i] = merged_scores[merged_order[i]];
+    }
+}
+
+void non_max_suppression(const BoxArray& boxes, std::vector<int>& picked, const NmsOption& opt) {
+    std::vector<float> picked_scores;
+
+    non_max_suppression(boxes, picked, picked_scores, opt);
+}
+
+}   // end namespace otter
@@ -0,0 +1,66 @@
+//
+//  NonMaxSuppression.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#ifndef NonMaxSuppression_hpp
+#define NonMaxSuppression_hpp
+
+#include <cstddef>
+#include <vector>
+
+namespace otter {
+
+// Boxes stored as structure of arrays (x0, y0, x1, y1) so that the IoU against the
+// kept set can be computed several boxes at a time.
+struct BoxArray {
+    void clear();
+    void reserve(size_t n);
+    void resize(size_t n);
+    size_t size() const { return score.size(); }
+    bool empty() const { return score.empty(); }
+
+    void push_back(float x0, float y0, float x1, float y1, float score, int label);
+    void append(const BoxArray& other);
+
+    std::vector<float> x0;
+    std::vector<float> y0;
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> score;
+    std::vector<int> label;
+};
+
+enum class NmsMethod {
+    Hard,
+    SoftLinear,
+    SoftGaussian
+};
+
+struct NmsOption {
+    NmsMethod method = NmsMethod::Hard;
+    float iou_threshold = 0.45f;
+    // only the top_k highest scored boxes take part in the suppression, -1 for all
+    int top_k = -1;
+    // maximum number of boxes to keep, -1 for all
+    int keep_top_k = -1;
+    // suppress only between boxes with the same label
+    bool class_aware = false;
+    // class aware suppression runs per class on multiple threads instead of the offset trick
+    bool parallel_class = false;
+    // soft nms parameters, boxes decayed below score_threshold are dropped
+    float soft_sigma = 0.5f;
+    float score_threshold = 0.001f;
+};
+
+// picked holds indices into boxes ordered by descending score. For soft nms the
+// decayed scores are returned in picked_scores, otherwise they are the original ones.
+void non_max_suppression(const BoxArray& boxes, std::vector<int>& picked, std::vector<float>& picked_scores, const NmsOption& opt);
+
+void non_max_suppression(const BoxArray& boxes, std::vector<int>& picked, const NmsOption& opt);
+
+}   // end namespace otter
+
+#endif /* NonMaxSuppression_hpp */
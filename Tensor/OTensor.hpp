@@ -26,6 +26,8 @@
 #include "Allocator.hpp"
 #include "CPUAllocator.hpp"
 #include "CPUCachingAllocator.hpp"
+#include "CPUSizeClassAllocator.hpp"
+#include "CpuSet.hpp"
 #include "CPUProfilingAllocator.hpp"
 #include "Memory.hpp"
 #include "MemoryFormat.hpp"
@@ -86,6 +88,7 @@
 #include "NetOption.hpp"
 #include "Net.hpp"
 #include "Benchmark.hpp"
+#include "Profiler.hpp"
 #include "Blob.hpp"
 #include "DataReader.hpp"
 
@@ -0,0 +1,123 @@
+//
+//  Philox.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/20.
+//
+
+#ifndef Philox_hpp
+#define Philox_hpp
+
+#include <cstdint>
+
+#if __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace otter {
+
+/**
+ * Note [Philox4x32 counter based engine]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * Philox4x32-10 from "Parallel Random Numbers: As Easy as 1, 2, 3" (Salmon et al.)
+ * maps a 128 bit counter and a 64 bit key to four 32 bit random words. The output of
+ * a counter does not depend on any other counter, so any range of the stream can be
+ * produced by any thread without sharing state, the only shared state is the offset
+ * reserved by the generator for each call.
+ *
+ * The stream is consumed in groups of 8 counters, the group starting at counter c
+ * produces 32 words laid out as out[w * 8 + j] = word w of counter c + j. This is the
+ * natural layout of the AVX2 implementation, the scalar one follows it so that results
+ * are the same with and without SIMD.
+ */
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+constexpr int PHILOX_GROUP_COUNTERS = 8;
+constexpr int PHILOX_GROUP_WORDS = 4 * PHILOX_GROUP_COUNTERS;
+
+inline void philox4x32_10(uint32_t counter[4], uint64_t key) {
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+    for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+        const uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * counter[0];
+        const uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * counter[2];
+
+        const uint32_t x0 = static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ k0;
+        const uint32_t x1 = static_cast<uint32_t>(p1);
+        const uint32_t x2 = static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ k1;
+        const uint32_t x3 = static_cast<uint32_t>(p0);
+
+        counter[0] = x0;
+        counter[1] = x1;
+        counter[2] = x2;
+        counter[3] = x3;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+}
+
+#if __AVX2__
+static inline __m256i philox_mulhi_avx2(__m256i a, __m256i m) {
+    const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, m), 32);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+#endif
+
+// Produce the 32 words of the group starting at counter, see Note [Philox4x32 counter based engine]
+inline void philox_group(uint32_t* out, uint64_t counter, uint64_t key) {
+#if __AVX2__
+    const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PHILOX_M0));
+    const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PHILOX_M1));
+
+    // the low words of the 8 counters never wrap inside a group when counter is a multiple of 8
+    __m256i x0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(counter))), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i x1 = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(counter >> 32)));
+    __m256i x2 = _mm256_setzero_si256();
+    __m256i x3 = _mm256_setzero_si256();
+
+    uint32_t k0 = static_cast<uint32_t>(key);
+    uint32_t k1 = static_cast<uint32_t>(key >> 32);
+
+    for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+        const __m256i lo0 = _mm256_mullo_epi32(x0, m0);
+        const __m256i hi0 = philox_mulhi_avx2(x0, m0);
+        const __m256i lo1 = _mm256_mullo_epi32(x2, m1);
+        const __m256i hi1 = philox_mulhi_avx2(x2, m1);
+
+        x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32(static_cast<int>(k0)));
+        x1 = lo1;
+        x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32(static_cast<int>(k1)));
+        x3 = lo0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    _mm256_storeu_si256((__m256i*)(out + 0), x0);
+    _mm256_storeu_si256((__m256i*)(out + 8), x1);
+    _mm256_storeu_si256((__m256i*)(out + 16), x2);
+    _mm256_storeu_si256((__m256i*)(out + 24), x3);
+#else
+    for (int j = 0; j < PHILOX_GROUP_COUNTERS; ++j) {
+        const uint64_t c = counter + j;
+        uint32_t words[4] = {static_cast<uint32_t>(c), static_cast<uint32_t>(c >> 32), 0, 0};
+        philox4x32_10(words, key);
+
+        out[0 * PHILOX_GROUP_COUNTERS + j] = words[0];
+        out[1 * PHILOX_GROUP_COUNTERS + j] = words[1];
+        out[2 * PHILOX_GROUP_COUNTERS + j] = words[2];
+        out[3 * PHILOX_GROUP_COUNTERS + j] = words[3];
+    }
+#endif
+}
+
+}   // end namespace otter
+
+#endif /* Philox_hpp */
@@ -13,6 +13,8 @@
 #include "Parallel.hpp"
 #include "VecIntrinsic.hpp"
 
+#include <cfloat>
+
 namespace otter {
 
 DEFINE_DISPATCH(max_pool2d_stub);
@@ -1213,4 +1215,489 @@ Tensor max_pool2d(const Tensor& self, IntArrayRef kernel_size, IntArrayRef strid
     return output;
 }
 
+// Input positions covered by every output along one axis, see avg_pool2d and adaptive_avg_pool2d
+struct PoolWindows {
+    std::vector<int64_t> start;
+    std::vector<int64_t> end;
+    std::vector<int64_t> divisor;
+    
+    explicit PoolWindows(int64_t size) : start(size), end(size), divisor(size) {}
+};
+
+static PoolWindows avg_pool_windows(int64_t input_size, int64_t output_size, int64_t kernel, int64_t stride, int64_t pad, bool count_include_pad) {
+    PoolWindows windows(output_size);
+    
+    for (const auto o : otter::irange(output_size)) {
+        int64_t start = o * stride - pad;
+        int64_t end = std::min(start + kernel, input_size + pad);
+        const int64_t padded = end - start;
+        start = std::max<int64_t>(start, 0);
+        end = std::min(end, input_size);
+        
+        windows.start[o] = start;
+        windows.end[o] = end;
+        windows.divisor[o] = std::max<int64_t>(count_include_pad ? padded : end - start, 1);
+    }
+    
+    return windows;
+}
+
+static PoolWindows adaptive_pool_windows(int64_t input_size, int64_t output_size) {
+    PoolWindows windows(output_size);
+    
+    for (const auto o : otter::irange(output_size)) {
+        windows.start[o] = (o * input_size) / output_size;
+        windows.end[o] = ((o + 1) * input_size + output_size - 1) / output_size;
+        windows.divisor[o] = windows.end[o] - windows.start[o];
+    }
+    
+    return windows;
+}
+
+static void avg_pool2d_pack1(const float* input, float* output, int64_t planes, int64_t h, int64_t w, const PoolWindows& hw, const PoolWindows& ww) {
+    const int64_t outh = hw.start.size();
+    const int64_t outw = ww.start.size();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * h * w;
+            float* outptr = output + q * outh * outw;
+            
+            for (int64_t i = 0; i < outh; i++) {
+                for (int64_t j = 0; j < outw; j++) {
+                    float sum = 0.f;
+                    for (int64_t y = hw.start[i]; y < hw.end[i]; y++) {
+                        const float* r = ptr + y * w;
+                        for (int64_t x = ww.start[j]; x < ww.end[j]; x++) {
+                            sum += r[x];
+                        }
+                    }
+                    
+                    *outptr++ = sum / (hw.divisor[i] * ww.divisor[j]);
+                }
+            }
+        }
+    });
+}
+
+template <bool is_max>
+static void global_pool2d_pack1(const float* input, float* output, int64_t planes, int64_t size) {
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * size;
+            
+            int64_t i = 0;
+            float result = is_max ? -FLT_MAX : 0.f;
+#if __AVX__
+            __m256 _r0 = _mm256_set1_ps(result);
+            __m256 _r1 = _r0;
+            __m256 _r2 = _r0;
+            __m256 _r3 = _r0;
+            for (; i + 31 < size; i += 32) {
+                __m256 _p0 = _mm256_loadu_ps(ptr + i);
+                __m256 _p1 = _mm256_loadu_ps(ptr + i + 8);
+                __m256 _p2 = _mm256_loadu_ps(ptr + i + 16);
+                __m256 _p3 = _mm256_loadu_ps(ptr + i + 24);
+                _r0 = is_max ? _mm256_max_ps(_r0, _p0) : _mm256_add_ps(_r0, _p0);
+                _r1 = is_max ? _mm256_max_ps(_r1, _p1) : _mm256_add_ps(_r1, _p1);
+                _r2 = is_max ? _mm256_max_ps(_r2, _p2) : _mm256_add_ps(_r2, _p2);
+                _r3 = is_max ? _mm256_max_ps(_r3, _p3) : _mm256_add_ps(_r3, _p3);
+            }
+            for (; i + 7 < size; i += 8) {
+                __m256 _p = _mm256_loadu_ps(ptr + i);
+                _r0 = is_max ? _mm256_max_ps(_r0, _p) : _mm256_add_ps(_r0, _p);
+            }
+            if (is_max) {
+                result = _mm256_reduce_max_ps(_mm256_max_ps(_mm256_max_ps(_r0, _r1), _mm256_max_ps(_r2, _r3)));
+            } else {
+                result = _mm256_reduce_add_ps(_mm256_add_ps(_mm256_add_ps(_r0, _r1), _mm256_add_ps(_r2, _r3)));
+            }
+#elif __SSE2__
+            __m128 _r0 = _mm_set1_ps(result);
+            __m128 _r1 = _r0;
+            for (; i + 7 < size; i += 8) {
+                __m128 _p0 = _mm_loadu_ps(ptr + i);
+                __m128 _p1 = _mm_loadu_ps(ptr + i + 4);
+                _r0 = is_max ? _mm_max_ps(_r0, _p0) : _mm_add_ps(_r0, _p0);
+                _r1 = is_max ? _mm_max_ps(_r1, _p1) : _mm_add_ps(_r1, _p1);
+            }
+            result = is_max ? _mm_reduce_max_ps(_mm_max_ps(_r0, _r1)) : _mm_reduce_add_ps(_mm_add_ps(_r0, _r1));
+#elif __ARM_NEON__
+            float32x4_t _r0 = vdupq_n_f32(result);
+            float32x4_t _r1 = _r0;
+            for (; i + 7 < size; i += 8) {
+                float32x4_t _p0 = vld1q_f32(ptr + i);
+                float32x4_t _p1 = vld1q_f32(ptr + i + 4);
+                _r0 = is_max ? vmaxq_f32(_r0, _p0) : vaddq_f32(_r0, _p0);
+                _r1 = is_max ? vmaxq_f32(_r1, _p1) : vaddq_f32(_r1, _p1);
+            }
+            float tmp[4];
+            vst1q_f32(tmp, is_max ? vmaxq_f32(_r0, _r1) : vaddq_f32(_r0, _r1));
+            result = is_max ? std::max(std::max(tmp[0], tmp[1]), std::max(tmp[2], tmp[3])) : tmp[0] + tmp[1] + tmp[2] + tmp[3];
+#endif
+            for (; i < size; i++) {
+                result = is_max ? std::max(result, ptr[i]) : result + ptr[i];
+            }
+            
+            output[q] = is_max ? result : result / size;
+        }
+    });
+}
+
+#if __SSE2__
+static void avg_pool2d_pack4_x86(const float* input, float* output, int64_t planes, int64_t h, int64_t w, const PoolWindows& hw, const PoolWindows& ww) {
+    const int64_t outh = hw.start.size();
+    const int64_t outw = ww.start.size();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * h * w * 4;
+            float* outptr = output + q * outh * outw * 4;
+            
+            for (int64_t i = 0; i < outh; i++) {
+                for (int64_t j = 0; j < outw; j++) {
+                    __m128 _sum0 = _mm_setzero_ps();
+                    __m128 _sum1 = _mm_setzero_ps();
+                    for (int64_t y = hw.start[i]; y < hw.end[i]; y++) {
+                        const float* r = ptr + (y * w + ww.start[j]) * 4;
+                        int64_t x = ww.start[j];
+                        for (; x + 1 < ww.end[j]; x += 2) {
+                            _sum0 = _mm_add_ps(_sum0, _mm_loadu_ps(r));
+                            _sum1 = _mm_add_ps(_sum1, _mm_loadu_ps(r + 4));
+                            r += 8;
+                        }
+                        for (; x < ww.end[j]; x++) {
+                            _sum0 = _mm_add_ps(_sum0, _mm_loadu_ps(r));
+                            r += 4;
+                        }
+                    }
+                    
+                    __m128 _scale = _mm_set1_ps(1.f / (hw.divisor[i] * ww.divisor[j]));
+                    _mm_storeu_ps(outptr, _mm_mul_ps(_mm_add_ps(_sum0, _sum1), _scale));
+                    outptr += 4;
+                }
+            }
+        }
+    });
+}
+
+template <bool is_max>
+static void global_pool2d_pack4_x86(const float* input, float* output, int64_t planes, int64_t size) {
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * size * 4;
+            
+            __m128 _r0 = _mm_set1_ps(is_max ? -FLT_MAX : 0.f);
+            __m128 _r1 = _r0;
+            __m128 _r2 = _r0;
+            __m128 _r3 = _r0;
+            int64_t i = 0;
+            for (; i + 3 < size; i += 4) {
+                __m128 _p0 = _mm_loadu_ps(ptr);
+                __m128 _p1 = _mm_loadu_ps(ptr + 4);
+                __m128 _p2 = _mm_loadu_ps(ptr + 8);
+                __m128 _p3 = _mm_loadu_ps(ptr + 12);
+                _r0 = is_max ? _mm_max_ps(_r0, _p0) : _mm_add_ps(_r0, _p0);
+                _r1 = is_max ? _mm_max_ps(_r1, _p1) : _mm_add_ps(_r1, _p1);
+                _r2 = is_max ? _mm_max_ps(_r2, _p2) : _mm_add_ps(_r2, _p2);
+                _r3 = is_max ? _mm_max_ps(_r3, _p3) : _mm_add_ps(_r3, _p3);
+                ptr += 16;
+            }
+            for (; i < size; i++) {
+                __m128 _p = _mm_loadu_ps(ptr);
+                _r0 = is_max ? _mm_max_ps(_r0, _p) : _mm_add_ps(_r0, _p);
+                ptr += 4;
+            }
+            
+            if (is_max) {
+                _mm_storeu_ps(output + q * 4, _mm_max_ps(_mm_max_ps(_r0, _r1), _mm_max_ps(_r2, _r3)));
+            } else {
+                __m128 _sum = _mm_add_ps(_mm_add_ps(_r0, _r1), _mm_add_ps(_r2, _r3));
+                _mm_storeu_ps(output + q * 4, _mm_mul_ps(_sum, _mm_set1_ps(1.f / size)));
+            }
+        }
+    });
+}
+
+#if __AVX__
+static void avg_pool2d_pack8_avx(const float* input, float* output, int64_t planes, int64_t h, int64_t w, const PoolWindows& hw, const PoolWindows& ww) {
+    const int64_t outh = hw.start.size();
+    const int64_t outw = ww.start.size();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * h * w * 8;
+            float* outptr = output + q * outh * outw * 8;
+            
+            for (int64_t i = 0; i < outh; i++) {
+                for (int64_t j = 0; j < outw; j++) {
+                    __m256 _sum0 = _mm256_setzero_ps();
+                    __m256 _sum1 = _mm256_setzero_ps();
+                    for (int64_t y = hw.start[i]; y < hw.end[i]; y++) {
+                        const float* r = ptr + (y * w + ww.start[j]) * 8;
+                        int64_t x = ww.start[j];
+                        for (; x + 1 < ww.end[j]; x += 2) {
+                            _sum0 = _mm256_add_ps(_sum0, _mm256_loadu_ps(r));
+                            _sum1 = _mm256_add_ps(_sum1, _mm256_loadu_ps(r + 8));
+                            r += 16;
+                        }
+                        for (; x < ww.end[j]; x++) {
+                            _sum0 = _mm256_add_ps(_sum0, _mm256_loadu_ps(r));
+                            r += 8;
+                        }
+                    }
+                    
+                    __m256 _scale = _mm256_set1_ps(1.f / (hw.divisor[i] * ww.divisor[j]));
+                    _mm256_storeu_ps(outptr, _mm256_mul_ps(_mm256_add_ps(_sum0, _sum1), _scale));
+                    outptr += 8;
+                }
+            }
+        }
+    });
+}
+
+template <bool is_max>
+static void global_pool2d_pack8_avx(const float* input, float* output, int64_t planes, int64_t size) {
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * size * 8;
+            
+            __m256 _r0 = _mm256_set1_ps(is_max ? -FLT_MAX : 0.f);
+            __m256 _r1 = _r0;
+            __m256 _r2 = _r0;
+            __m256 _r3 = _r0;
+            int64_t i = 0;
+            for (; i + 3 < size; i += 4) {
+                __m256 _p0 = _mm256_loadu_ps(ptr);
+                __m256 _p1 = _mm256_loadu_ps(ptr + 8);
+                __m256 _p2 = _mm256_loadu_ps(ptr + 16);
+                __m256 _p3 = _mm256_loadu_ps(ptr + 24);
+                _r0 = is_max ? _mm256_max_ps(_r0, _p0) : _mm256_add_ps(_r0, _p0);
+                _r1 = is_max ? _mm256_max_ps(_r1, _p1) : _mm256_add_ps(_r1, _p1);
+                _r2 = is_max ? _mm256_max_ps(_r2, _p2) : _mm256_add_ps(_r2, _p2);
+                _r3 = is_max ? _mm256_max_ps(_r3, _p3) : _mm256_add_ps(_r3, _p3);
+                ptr += 32;
+            }
+            for (; i < size; i++) {
+                __m256 _p = _mm256_loadu_ps(ptr);
+                _r0 = is_max ? _mm256_max_ps(_r0, _p) : _mm256_add_ps(_r0, _p);
+                ptr += 8;
+            }
+            
+            if (is_max) {
+                _mm256_storeu_ps(output + q * 8, _mm256_max_ps(_mm256_max_ps(_r0, _r1), _mm256_max_ps(_r2, _r3)));
+            } else {
+                __m256 _sum = _mm256_add_ps(_mm256_add_ps(_r0, _r1), _mm256_add_ps(_r2, _r3));
+                _mm256_storeu_ps(output + q * 8, _mm256_mul_ps(_sum, _mm256_set1_ps(1.f / size)));
+            }
+        }
+    });
+}
+#endif  // __AVX__
+#endif  // __SSE2__
+
+#if __ARM_NEON__
+static void avg_pool2d_pack4_neon(const float* input, float* output, int64_t planes, int64_t h, int64_t w, const PoolWindows& hw, const PoolWindows& ww) {
+    const int64_t outh = hw.start.size();
+    const int64_t outw = ww.start.size();
+    
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * h * w * 4;
+            float* outptr = output + q * outh * outw * 4;
+            
+            for (int64_t i = 0; i < outh; i++) {
+                for (int64_t j = 0; j < outw; j++) {
+                    float32x4_t _sum0 = vdupq_n_f32(0.f);
+                    float32x4_t _sum1 = vdupq_n_f32(0.f);
+                    for (int64_t y = hw.start[i]; y < hw.end[i]; y++) {
+                        const float* r = ptr + (y * w + ww.start[j]) * 4;
+                        int64_t x = ww.start[j];
+                        for (; x + 1 < ww.end[j]; x += 2) {
+                            _sum0 = vaddq_f32(_sum0, vld1q_f32(r));
+                            _sum1 = vaddq_f32(_sum1, vld1q_f32(r + 4));
+                            r += 8;
+                        }
+                        for (; x < ww.end[j]; x++) {
+                            _sum0 = vaddq_f32(_sum0, vld1q_f32(r));
+                            r += 4;
+                        }
+                    }
+                    
+                    vst1q_f32(outptr, vmulq_n_f32(vaddq_f32(_sum0, _sum1), 1.f / (hw.divisor[i] * ww.divisor[j])));
+                    outptr += 4;
+                }
+            }
+        }
+    });
+}
+
+template <bool is_max>
+static void global_pool2d_pack4_neon(const float* input, float* output, int64_t planes, int64_t size) {
+    otter::parallel_for(0, planes, 0, [&](int64_t begin, int64_t end) {
+        for (const auto q : otter::irange(begin, end)) {
+            const float* ptr = input + q * size * 4;
+            
+            float32x4_t _r0 = vdupq_n_f32(is_max ? -FLT_MAX : 0.f);
+            float32x4_t _r1 = _r0;
+            float32x4_t _r2 = _r0;
+            float32x4_t _r3 = _r0;
+            int64_t i = 0;
+            for (; i + 3 < size; i += 4) {
+                float32x4_t _p0 = vld1q_f32(ptr);
+                float32x4_t _p1 = vld1q_f32(ptr + 4);
+                float32x4_t _p2 = vld1q_f32(ptr + 8);
+                float32x4_t _p3 = vld1q_f32(ptr + 12);
+                _r0 = is_max ? vmaxq_f32(_r0, _p0) : vaddq_f32(_r0, _p0);
+                _r1 = is_max ? vmaxq_f32(_r1, _p1) : vaddq_f32(_r1, _p1);
+                _r2 = is_max ? vmaxq_f32(_r2, _p2) : vaddq_f32(_r2, _p2);
+                _r3 = is_max ? vmaxq_f32(_r3, _p3) : vaddq_f32(_r3, _p3);
+                ptr += 16;
+            }
+            for (; i < size; i++) {
+                float32x4_t _p = vld1q_f32(ptr);
+                _r0 = is_max ? vmaxq_f32(_r0, _p) : vaddq_f32(_r0, _p);
+                ptr += 4;
+            }
+            
+            if (is_max) {
+                vst1q_f32(output + q * 4, vmaxq_f32(vmaxq_f32(_r0, _r1), vmaxq_f32(_r2, _r3)));
+            } else {
+                float32x4_t _sum = vaddq_f32(vaddq_f32(_r0, _r1), vaddq_f32(_r2, _r3));
+                vst1q_f32(output + q * 4, vmulq_n_f32(_sum, 1.f / size));
+            }
+        }
+    });
+}
+#endif  // __ARM_NEON__
+
+static Tensor pool2d_output(const Tensor& input, int64_t outh, int64_t outw) {
+    OTTER_CHECK(input.dim() >= 2, "pool2d: expect input with at least 2 dims but get ", input.dim());
+    auto dtype = input.scalar_type();
+    OTTER_CHECK(dtype == ScalarType::Float || dtype == ScalarType::Float4 || dtype == ScalarType::Float8, "pool2d: unsupported dtype ", dtype);
+    
+    auto sizes = input.sizes().vec();
+    sizes[sizes.size() - 2] = outh;
+    sizes[sizes.size() - 1] = outw;
+    
+    return otter::empty(sizes, dtype);
+}
+
+static void avg_pool2d_windows(const Tensor& input, const Tensor& output, const PoolWindows& hw, const PoolWindows& ww) {
+    const int64_t h = input.size(-2);
+    const int64_t w = input.size(-1);
+    const int64_t planes = (h * w == 0) ? 0 : input.numel() / (h * w);
+    const float* ptr = (const float*)input.data_ptr();
+    float* outptr = (float*)output.data_ptr();
+    const int64_t elempack = input.elempack();
+    
+#if __SSE2__
+#if __AVX__
+    if (elempack == 8) {
+        avg_pool2d_pack8_avx(ptr, outptr, planes, h, w, hw, ww);
+        return;
+    }
+#endif
+    if (elempack == 4) {
+        avg_pool2d_pack4_x86(ptr, outptr, planes, h, w, hw, ww);
+        return;
+    }
+#elif __ARM_NEON__
+    if (elempack == 4) {
+        avg_pool2d_pack4_neon(ptr, outptr, planes, h, w, hw, ww);
+        return;
+    }
+#endif
+    OTTER_CHECK(elempack == 1, "pool2d: unsupported elempack ", elempack);
+    avg_pool2d_pack1(ptr, outptr, planes, h, w, hw, ww);
+}
+
+template <bool is_max>
+static Tensor global_pool2d(const Tensor& self) {
+    Tensor input = self.contiguous();
+    Tensor output = pool2d_output(input, 1, 1);
+    
+    const int64_t size = input.size(-2) * input.size(-1);
+    const int64_t planes = (size == 0) ? 0 : input.numel() / size;
+    const float* ptr = (const float*)input.data_ptr();
+    float* outptr = (float*)output.data_ptr();
+    const int64_t elempack = input.elempack();
+    
+#if __SSE2__
+#if __AVX__
+    if (elempack == 8) {
+        global_pool2d_pack8_avx<is_max>(ptr, outptr, planes, size);
+        return output;
+    }
+#endif
+    if (elempack == 4) {
+        global_pool2d_pack4_x86<is_max>(ptr, outptr, planes, size);
+        return output;
+    }
+#elif __ARM_NEON__
+    if (elempack == 4) {
+        global_pool2d_pack4_neon<is_max>(ptr, outptr, planes, size);
+        return output;
+    }
+#endif
+    OTTER_CHECK(elempack == 1, "pool2d: unsupported elempack ", elempack);
+    global_pool2d_pack1<is_max>(ptr, outptr, planes, size);
+    
+    return output;
+}
+
+Tensor avg_pool2d(const Tensor& self, IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, bool ceil_mode, bool count_include_pad) {
+    OTTER_CHECK(kernel_size.size() == 1 || kernel_size.size() == 2, "avg_pool2d: kernel_size must either be a single int, or a tuple of two ints");
+    const int64_t kH = kernel_size[0];
+    const int64_t kW = kernel_size.size() == 1 ? kH : kernel_size[1];
+    
+    OTTER_CHECK(stride.size() == 0 || stride.size() == 1 || stride.size() == 2, "avg_pool2d: stride must either be omitted, a single int, or a tuple of two ints");
+    const int64_t dH = stride.empty() ? kH : stride[0];
+    const int64_t dW = stride.empty() ? kW : stride.size() == 1 ? dH : stride[1];
+    
+    OTTER_CHECK(padding.size() == 1 || padding.size() == 2, "avg_pool2d: padding must either be a single int, or a tuple of two ints");
+    const int64_t padH = padding[0];
+    const int64_t padW = padding.size() == 1 ? padH : padding[1];
+    
+    OTTER_CHECK(kH > 0 && kW > 0 && dH > 0 && dW > 0, "avg_pool2d: kernel size and stride should be greater than zero");
+    OTTER_CHECK(kW / 2 >= padW && kH / 2 >= padH, "avg_pool2d: pad should be smaller than or equal to half of kernel size, but got ", "padW = ", padW, ", padH = ", padH, ", kW = ", kW, ", kH = ", kH);
+    
+    Tensor input = self.contiguous();
+    const int64_t h = input.size(-2);
+    const int64_t w = input.size(-1);
+    const int64_t outh = pooling_output_shape<int64_t>(h, kH, padH, dH, 1, ceil_mode);
+    const int64_t outw = pooling_output_shape<int64_t>(w, kW, padW, dW, 1, ceil_mode);
+    OTTER_CHECK(outh >= 1 && outw >= 1, "avg_pool2d: output size is too small");
+    
+    Tensor output = pool2d_output(input, outh, outw);
+    avg_pool2d_windows(input, output, avg_pool_windows(h, outh, kH, dH, padH, count_include_pad), avg_pool_windows(w, outw, kW, dW, padW, count_include_pad));
+    
+    return output;
+}
+
+Tensor adaptive_avg_pool2d(const Tensor& self, IntArrayRef output_size) {
+    OTTER_CHECK(output_size.size() == 1 || output_size.size() == 2, "adaptive_avg_pool2d: output_size must either be a single int, or a tuple of two ints");
+    const int64_t outh = output_size[0];
+    const int64_t outw = output_size.size() == 1 ? outh : output_size[1];
+    OTTER_CHECK(outh > 0 && outw > 0, "adaptive_avg_pool2d: output size should be greater than zero");
+    
+    if (outh == 1 && outw == 1) {
+        return global_avg_pool2d(self);
+    }
+    
+    Tensor input = self.contiguous();
+    Tensor output = pool2d_output(input, outh, outw);
+    avg_pool2d_windows(input, output, adaptive_pool_windows(input.size(-2), outh), adaptive_pool_windows(input.size(-1), outw));
+    
+    return output;
+}
+
+Tensor global_avg_pool2d(const Tensor& self) {
+    return global_pool2d<false>(self);
+}
+
+Tensor global_max_pool2d(const Tensor& self) {
+    return global_pool2d<true>(self);
+}
+
 }   // end namespace otter
@@ -22,6 +22,20 @@ DECLARE_DISPATCH(avg_pool2d_fn, avg_pool2d_kernel);
 
 Tensor max_pool2d(const Tensor& self, IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, bool ceil_mode);
 
+// The pooling below works on (..., H, W) Float tensors and on packed Float4 / Float8 blobs,
+// the output keeps the elempack of the input.
+
+// Padded positions are part of the divisor when count_include_pad is true, like PyTorch
+Tensor avg_pool2d(const Tensor& self, IntArrayRef kernel_size, IntArrayRef stride, IntArrayRef padding, bool ceil_mode, bool count_include_pad);
+
+// Output (i, j) averages rows [floor(i * H / out_h), ceil((i + 1) * H / out_h)) and the same for columns
+Tensor adaptive_avg_pool2d(const Tensor& self, IntArrayRef output_size);
+
+// Reduce every plane to 1x1
+Tensor global_avg_pool2d(const Tensor& self);
+
+Tensor global_max_pool2d(const Tensor& self);
+
 template <typename dest_t, typename src_t>
 static inline dest_t
 safe_downcast(src_t v) {
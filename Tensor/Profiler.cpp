@@ -0,0 +1,321 @@
+//
+//  Profiler.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/19.
+//
+
+#include "Profiler.hpp"
+
+#include "Tensor.hpp"
+#include "Layer.hpp"
+#include "ConvolutionLayer.hpp"
+#include "DeconvolutionLayer.hpp"
+#include "InnerProductLayer.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+namespace otter {
+
+static thread_local const char* profile_backend = nullptr;
+
+void set_profile_backend(const char* backend) {
+    profile_backend = backend;
+}
+
+const char* get_profile_backend() {
+    return profile_backend;
+}
+
+static int64_t element_count(const Tensor& t) {
+    return t.defined() ? t.numel() * t.elempack() : 0;
+}
+
+static int64_t byte_count(const Tensor& t) {
+    return t.defined() ? t.numel() * (int64_t)t.itemsize() : 0;
+}
+
+static std::string shape_string(const std::vector<Tensor>& blobs) {
+    std::string str;
+    for (const Tensor& t : blobs) {
+        if (!str.empty())
+            str += " ";
+        str += "[";
+        if (t.defined()) {
+            for (int64_t i = 0; i < t.dim(); i++) {
+                if (i)
+                    str += ",";
+                str += std::to_string(t.size(i));
+            }
+            if (t.elempack() != 1)
+                str += " *" + std::to_string(t.elempack());
+        }
+        str += "]";
+    }
+    return str;
+}
+
+// Multiply-add counts as two operations, layers without a model count one per output element.
+static int64_t estimate_flops(const Layer* layer, const std::vector<Tensor>& bottom_blobs, const std::vector<Tensor>& top_blobs) {
+    const std::string type = layer->type();
+    const int64_t out_elements = top_blobs.empty() ? 0 : element_count(top_blobs[0]);
+
+    if (type == "Convolution") {
+        const ConvolutionLayer* conv = (const ConvolutionLayer*)layer;
+        return 2 * out_elements * (conv->in_channels / std::max(conv->groups, 1)) * conv->kernel_height * conv->kernel_width;
+    } else if (type == "Deconvolution") {
+        const DeconvolutionLayer* deconv = (const DeconvolutionLayer*)layer;
+        const int64_t in_elements = bottom_blobs.empty() ? 0 : element_count(bottom_blobs[0]);
+        return 2 * in_elements * (deconv->out_channels / std::max(deconv->groups, 1)) * deconv->kernel_height * deconv->kernel_width;
+    } else if (type == "InnerProduct") {
+        const InnerProductLayer* fc = (const InnerProductLayer*)layer;
+        return 2 * out_elements * fc->input_features();
+    }
+
+    return out_elements;
+}
+
+static int64_t weight_bytes(const Layer* layer) {
+    const std::string type = layer->type();
+
+    if (type == "Convolution")
+        return byte_count(((const ConvolutionLayer*)layer)->weight_data);
+    if (type == "Deconvolution")
+        return byte_count(((const DeconvolutionLayer*)layer)->weight_data);
+    if (type == "InnerProduct")
+        return byte_count(((const InnerProductLayer*)layer)->weight());
+
+    return 0;
+}
+
+Profiler::Profiler() : run_count(0), origin(-1) {}
+
+void Profiler::clear() {
+    run_count = 0;
+    origin = -1;
+    event_list.clear();
+    layer_infos.clear();
+    layer_ids.clear();
+}
+
+void Profiler::begin_run() {
+    run_count++;
+}
+
+double Profiler::relative_time(double t) {
+    if (origin < 0)
+        origin = t;
+    return t - origin;
+}
+
+int Profiler::layer_id(const Layer* layer, const std::vector<Tensor>& bottom_blobs, const std::vector<Tensor>& top_blobs) {
+    auto it = layer_ids.find(layer);
+    if (it != layer_ids.end()) {
+        // the packing event of a layer comes before its output is known
+        ProfileLayerInfo& info = layer_infos[it->second];
+        if (info.output_shape.empty() && !top_blobs.empty())
+            info.output_shape = shape_string(top_blobs);
+        return it->second;
+    }
+
+    ProfileLayerInfo info;
+    info.name = layer->name;
+    info.type = layer->type();
+    info.input_shape = shape_string(bottom_blobs);
+    info.output_shape = shape_string(top_blobs);
+
+    int id = (int)layer_infos.size();
+    layer_infos.push_back(info);
+    layer_ids[layer] = id;
+
+    return id;
+}
+
+void Profiler::record_layer(const Layer* layer, double start, double end, const std::vector<Tensor>& bottom_blobs, const std::vector<Tensor>& top_blobs) {
+    ProfileEvent event;
+    event.type = ProfileEventType::Layer;
+    event.layer_id = layer_id(layer, bottom_blobs, top_blobs);
+    event.run = std::max(run_count - 1, 0);
+    event.start = relative_time(start);
+    event.duration = end - start;
+    event.flops = estimate_flops(layer, bottom_blobs, top_blobs);
+    event.alloc_bytes = 0;
+    for (const Tensor& t : top_blobs)
+        event.alloc_bytes += byte_count(t);
+    event.bytes = event.alloc_bytes + weight_bytes(layer);
+    for (const Tensor& t : bottom_blobs)
+        event.bytes += byte_count(t);
+    event.backend = get_profile_backend();
+
+    event_list.push_back(event);
+}
+
+void Profiler::record_packing(const Layer* layer, double start, double end, const Tensor& src, const Tensor& dst) {
+    ProfileEvent event;
+    event.type = ProfileEventType::Packing;
+    event.layer_id = layer_id(layer, {src}, {});
+    event.run = std::max(run_count - 1, 0);
+    event.start = relative_time(start);
+    event.duration = end - start;
+    event.flops = 0;
+    event.alloc_bytes = byte_count(dst);
+    event.bytes = byte_count(src) + event.alloc_bytes;
+    event.backend = nullptr;
+
+    event_list.push_back(event);
+}
+
+std::vector<ProfileStat> Profiler::summary() const {
+    // key = layer_id * 2 + type, the durations of a layer inside one run are summed
+    std::vector<int> slot_of_key(layer_infos.size() * 2, -1);
+    std::vector<ProfileStat> stats;
+    std::vector<std::vector<double>> durations;
+    std::vector<int> last_run;
+
+    for (const ProfileEvent& event : event_list) {
+        int key = event.layer_id * 2 + (event.type == ProfileEventType::Packing);
+        int slot = slot_of_key[key];
+        if (slot == -1) {
+            slot = (int)stats.size();
+            slot_of_key[key] = slot;
+
+            ProfileStat stat;
+            stat.layer_id = event.layer_id;
+            stat.type = event.type;
+            stat.backend = event.backend;
+            stat.flops = event.flops;
+            stat.bytes = event.bytes;
+            stat.alloc_bytes = event.alloc_bytes;
+            stats.push_back(stat);
+            durations.push_back({});
+            last_run.push_back(-1);
+        }
+
+        if (last_run[slot] == event.run) {
+            durations[slot].back() += event.duration;
+        } else {
+            durations[slot].push_back(event.duration);
+            last_run[slot] = event.run;
+        }
+        if (event.backend)
+            stats[slot].backend = event.backend;
+    }
+
+    for (size_t i = 0; i < stats.size(); i++) {
+        std::vector<double>& d = durations[i];
+        std::sort(d.begin(), d.end());
+
+        const size_t n = d.size();
+        double total = 0;
+        for (double v : d)
+            total += v;
+
+        stats[i].count = (int)n;
+        stats[i].min = d[0];
+        stats[i].median = (n % 2) ? d[n / 2] : (d[n / 2 - 1] + d[n / 2]) * 0.5;
+        stats[i].p99 = d[std::min(n - 1, (size_t)std::ceil(n * 0.99) - 1)];
+        stats[i].mean = total / n;
+    }
+
+    return stats;
+}
+
+void Profiler::print_summary(FILE* out) const {
+    std::vector<ProfileStat> stats = summary();
+
+    double total = 0;
+    for (const ProfileStat& stat : stats)
+        total += stat.median;
+
+    fprintf(out, "%-24s %-30s %9s %9s %9s %8s %6s  %s\n", "type", "name", "min", "median", "p99", "GFLOP/s", "%", "backend");
+    for (const ProfileStat& stat : stats) {
+        const ProfileLayerInfo& info = layer_infos[stat.layer_id];
+        const bool packing = stat.type == ProfileEventType::Packing;
+        const double gflops = (stat.median > 0) ? stat.flops / (stat.median * 1e6) : 0;
+
+        fprintf(out, "%-24s %-30s %7.3lfms %7.3lfms %7.3lfms %8.2lf %5.1lf%%  %s\n",
+                packing ? "Packing" : info.type.c_str(),
+                info.name.c_str(),
+                stat.min, stat.median, stat.p99, gflops,
+                total > 0 ? stat.median * 100 / total : 0,
+                stat.backend ? stat.backend : "");
+    }
+    fprintf(out, "runs: %d  total median: %.3lfms\n", run_count, total);
+}
+
+static std::string json_escape(const std::string& str) {
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+int Profiler::save_json(const char* path) const {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "[Profiler] Open %s fail!\n", path);
+        return -1;
+    }
+
+    std::vector<ProfileStat> stats = summary();
+
+    fprintf(fp, "{\n  \"runs\": %d,\n  \"layers\": [\n", run_count);
+    for (size_t i = 0; i < stats.size(); i++) {
+        const ProfileStat& stat = stats[i];
+        const ProfileLayerInfo& info = layer_infos[stat.layer_id];
+
+        fprintf(fp, "    {\"name\": \"%s\", \"type\": \"%s\", \"event\": \"%s\", \"backend\": \"%s\", "
+                    "\"input\": \"%s\", \"output\": \"%s\", \"count\": %d, "
+                    "\"min_ms\": %.4lf, \"median_ms\": %.4lf, \"p99_ms\": %.4lf, \"mean_ms\": %.4lf, "
+                    "\"flops\": %lld, \"bytes\": %lld, \"alloc_bytes\": %lld}%s\n",
+                json_escape(info.name).c_str(), json_escape(info.type).c_str(),
+                stat.type == ProfileEventType::Packing ? "packing" : "layer",
+                stat.backend ? stat.backend : "",
+                info.input_shape.c_str(), info.output_shape.c_str(), stat.count,
+                stat.min, stat.median, stat.p99, stat.mean,
+                (long long)stat.flops, (long long)stat.bytes, (long long)stat.alloc_bytes,
+                (i + 1 < stats.size()) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+
+int Profiler::save_chrome_trace(const char* path) const {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "[Profiler] Open %s fail!\n", path);
+        return -1;
+    }
+
+    fprintf(fp, "{\"traceEvents\": [\n");
+    for (size_t i = 0; i < event_list.size(); i++) {
+        const ProfileEvent& event = event_list[i];
+        const ProfileLayerInfo& info = layer_infos[event.layer_id];
+        const bool packing = event.type == ProfileEventType::Packing;
+
+        // trace_event timestamps are in microseconds
+        fprintf(fp, "  {\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3lf, \"dur\": %.3lf, \"pid\": 0, \"tid\": 0, "
+                    "\"args\": {\"type\": \"%s\", \"run\": %d, \"backend\": \"%s\", \"flops\": %lld, \"bytes\": %lld}}%s\n",
+                json_escape(packing ? "packing " + info.name : info.name).c_str(),
+                packing ? "packing" : "layer",
+                event.start * 1000, event.duration * 1000,
+                json_escape(info.type).c_str(), event.run,
+                event.backend ? event.backend : "",
+                (long long)event.flops, (long long)event.bytes,
+                (i + 1 < event_list.size()) ? "," : "");
+    }
+    fprintf(fp, "], \"displayTimeUnit\": \"ms\"}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+
+}   // end namespace otter
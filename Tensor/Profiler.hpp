@@ -0,0 +1,103 @@
+//
+//  Profiler.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/19.
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace otter {
+
+class Layer;
+class Tensor;
+
+enum class ProfileEventType {
+    Layer,
+    Packing
+};
+
+struct ProfileEvent {
+    ProfileEventType type;
+    int layer_id;           // index into Profiler::layers()
+    int run;
+    double start;           // ms, relative to the first event
+    double duration;        // ms
+    int64_t flops;
+    int64_t bytes;          // bytes read and written, weights included
+    int64_t alloc_bytes;    // bytes of the produced blobs
+    const char* backend;    // kernel chosen by the layer, nullptr if unknown
+};
+
+struct ProfileLayerInfo {
+    std::string name;
+    std::string type;
+    std::string input_shape;
+    std::string output_shape;
+};
+
+struct ProfileStat {
+    int layer_id;
+    ProfileEventType type;
+    const char* backend;
+    int count;
+    double min;
+    double median;
+    double p99;
+    double mean;
+    int64_t flops;
+    int64_t bytes;
+    int64_t alloc_bytes;
+};
+
+// Collect the per layer events of Extractor::extract. The profiler is filled by the
+// calling thread only, it is not meant to be shared between extractors running in parallel.
+class Profiler {
+public:
+    Profiler();
+
+    void clear();
+
+    // Mark the beginning of a new inference, events are grouped by run when aggregating.
+    void begin_run();
+
+    void record_layer(const Layer* layer, double start, double end, const std::vector<Tensor>& bottom_blobs, const std::vector<Tensor>& top_blobs);
+    void record_packing(const Layer* layer, double start, double end, const Tensor& src, const Tensor& dst);
+
+    int runs() const { return run_count; }
+    const std::vector<ProfileEvent>& events() const { return event_list; }
+    const std::vector<ProfileLayerInfo>& layers() const { return layer_infos; }
+
+    // Aggregate the events per layer and type across runs, ordered by first appearance.
+    std::vector<ProfileStat> summary() const;
+
+    void print_summary(FILE* out = stderr) const;
+    int save_json(const char* path) const;
+    // Chrome trace_event format, open with chrome://tracing or Perfetto.
+    int save_chrome_trace(const char* path) const;
+
+private:
+    int layer_id(const Layer* layer, const std::vector<Tensor>& bottom_blobs, const std::vector<Tensor>& top_blobs);
+    double relative_time(double t);
+
+    int run_count;
+    double origin;
+    std::vector<ProfileEvent> event_list;
+    std::vector<ProfileLayerInfo> layer_infos;
+    std::unordered_map<const Layer*, int> layer_ids;
+};
+
+// The convolution backend chosen on the calling thread is reported to the profiler
+// through this annotation, it is reset before every layer.
+void set_profile_backend(const char* backend);
+const char* get_profile_backend();
+
+}   // end namespace otter
+
+#endif /* Profiler_hpp */
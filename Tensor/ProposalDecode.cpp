@@ -0,0 +1,133 @@
+//
+//  ProposalDecode.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#include "ProposalDecode.hpp"
+#include "VecIntrinsic.hpp"
+
+#include <cmath>
+#include <float.h>
+
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif // __ARM_NEON
+
+namespace otter {
+
+void class_argmax_row(const float* score, int64_t cstep, int num_class, int width, float* max_score, int* max_label) {
+    int x = 0;
+#if __ARM_NEON
+    for (; x + 3 < width; x += 4) {
+        float32x4_t _max = vld1q_f32(score + x);
+        uint32x4_t _label = vdupq_n_u32(0);
+        for (int k = 1; k < num_class; k++) {
+            float32x4_t _s = vld1q_f32(score + k * cstep + x);
+            uint32x4_t _mask = vcgtq_f32(_s, _max);
+            _max = vbslq_f32(_mask, _s, _max);
+            _label = vbslq_u32(_mask, vdupq_n_u32(k), _label);
+        }
+        vst1q_f32(max_score + x, _max);
+        vst1q_s32(max_label + x, vreinterpretq_s32_u32(_label));
+    }
+#elif __SSE2__
+#if __AVX__
+    for (; x + 7 < width; x += 8) {
+        __m256 _max = _mm256_loadu_ps(score + x);
+        __m256 _label = _mm256_setzero_ps();
+        for (int k = 1; k < num_class; k++) {
+            __m256 _s = _mm256_loadu_ps(score + k * cstep + x);
+            __m256 _mask = _mm256_cmp_ps(_s, _max, _CMP_GT_OQ);
+            _max = _mm256_blendv_ps(_max, _s, _mask);
+            _label = _mm256_blendv_ps(_label, _mm256_set1_ps((float)k), _mask);
+        }
+        _mm256_storeu_ps(max_score + x, _max);
+        _mm256_storeu_si256((__m256i*)(max_label + x), _mm256_cvttps_epi32(_label));
+    }
+#endif // __AVX__
+    for (; x + 3 < width; x += 4) {
+        __m128 _max = _mm_loadu_ps(score + x);
+        __m128 _label = _mm_setzero_ps();
+        for (int k = 1; k < num_class; k++) {
+            __m128 _s = _mm_loadu_ps(score + k * cstep + x);
+            __m128 _mask = _mm_cmpgt_ps(_s, _max);
+            _max = _mm_or_ps(_mm_and_ps(_mask, _s), _mm_andnot_ps(_mask, _max));
+            _label = _mm_or_ps(_mm_and_ps(_mask, _mm_set1_ps((float)k)), _mm_andnot_ps(_mask, _label));
+        }
+        _mm_storeu_ps(max_score + x, _max);
+        _mm_storeu_si128((__m128i*)(max_label + x), _mm_cvttps_epi32(_label));
+    }
+#endif // __SSE2__
+    for (; x < width; x++) {
+        int label = 0;
+        float s = score[x];
+        for (int k = 1; k < num_class; k++) {
+            float v = score[k * cstep + x];
+            if (v > s) {
+                label = k;
+                s = v;
+            }
+        }
+        max_score[x] = s;
+        max_label[x] = label;
+    }
+}
+
+int select_candidates(const float* value, int width, float threshold, int* index) {
+    int count = 0;
+    int x = 0;
+#if __SSE2__
+#if __AVX__
+    __m256 _thr_avx = _mm256_set1_ps(threshold);
+    for (; x + 7 < width; x += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(value + x), _thr_avx, _CMP_GE_OQ));
+        for (int bit = 0; mask; bit++, mask >>= 1) {
+            if (mask & 1)
+                index[count++] = x + bit;
+        }
+    }
+#endif // __AVX__
+    __m128 _thr = _mm_set1_ps(threshold);
+    for (; x + 3 < width; x += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(value + x), _thr));
+        for (int bit = 0; mask; bit++, mask >>= 1) {
+            if (mask & 1)
+                index[count++] = x + bit;
+        }
+    }
+#endif // __SSE2__
+    for (; x < width; x++) {
+        if (value[x] >= threshold)
+            index[count++] = x;
+    }
+
+    return count;
+}
+
+float sigmoid_threshold_logit(float prob_threshold) {
+    if (prob_threshold <= 0.f || prob_threshold >= 1.f)
+        return -FLT_MAX;
+
+    // slightly relaxed, the exact test is done on the survivors
+    return std::log(prob_threshold / (1.f - prob_threshold)) - 1e-3f;
+}
+
+void ProposalRowScratch::ensure(int width) {
+    if ((int)max_score.size() >= width)
+        return;
+    
+    max_score.resize(width);
+    max_label.resize(width);
+    candidates.resize(width);
+}
+
+void ProposalDecodeScratch::ensure(int num_chunk) {
+    if ((int)chunk_proposals.size() < num_chunk)
+        chunk_proposals.resize(num_chunk);
+    if ((int)chunk_rows.size() < num_chunk)
+        chunk_rows.resize(num_chunk);
+}
+
+}   // end namespace otter
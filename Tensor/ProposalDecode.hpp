@@ -0,0 +1,52 @@
+//
+//  ProposalDecode.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/18.
+//
+
+#ifndef ProposalDecode_hpp
+#define ProposalDecode_hpp
+
+#include <cstdint>
+#include <vector>
+
+#include "NonMaxSuppression.hpp"
+
+namespace otter {
+
+// For every position x in [0, width), find the class with maximum score where the
+// score of class k is score[k * cstep + x]. Ties keep the lowest class index.
+void class_argmax_row(const float* score, int64_t cstep, int num_class, int width, float* max_score, int* max_label);
+
+// Write the positions with value[x] >= threshold into index and return the count.
+int select_candidates(const float* value, int width, float threshold, int* index);
+
+// Inverse of sigmoid, used to threshold the logits without evaluating exp.
+// A threshold outside (0, 1) returns -FLT_MAX so that nothing is filtered.
+float sigmoid_threshold_logit(float prob_threshold);
+
+// Row buffers of one decoding chunk, sized to the widest feature row
+struct ProposalRowScratch {
+    std::vector<float> max_score;
+    std::vector<int> max_label;
+    std::vector<int> candidates;
+    
+    void ensure(int width);
+};
+
+// Decoding buffers of the detection output layers, kept per calling thread and reused across frames.
+// Every chunk of the parallel decoding owns one slot, the workers reach it through a captured reference.
+struct ProposalDecodeScratch {
+    std::vector<BoxArray> chunk_proposals;
+    std::vector<ProposalRowScratch> chunk_rows;
+    BoxArray proposals;
+    std::vector<int> picked;
+    
+    // Grow to num_chunk slots, the slots beyond it are kept but unused
+    void ensure(int num_chunk);
+};
+
+}   // end namespace otter
+
+#endif /* ProposalDecode_hpp */
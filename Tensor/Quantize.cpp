@@ -9,6 +9,7 @@
 #include "TensorFactory.hpp"
 #include "Parallel.hpp"
 #include "VecIntrinsic.hpp"
+#include "ActivationLayer.hpp"
 
 #if __SSE2__
 #include "QuantizeX86.hpp"
@@ -27,28 +28,6 @@ static inline signed char float2int8(float v) {
     return (signed char)int32;
 }
 
-static inline float activation_ss(float v, int activation_type, const Tensor& activation_params) {
-    if (activation_type == 1) {
-        v = fmax(v, 0.f);
-    } else if (activation_type == 2) {
-        float slope = activation_params.item().toFloat();
-        v = v > 0.f ? v : v * slope;
-    } else if (activation_type == 3) {
-        float min = 0;
-        float max = 6;
-        if (v < min)
-            v = min;
-        if (v > max)
-            v = max;
-    } else if (activation_type == 4) {
-        v = 1.f / (1.f + exp(-v));
-    } else if (activation_type == 5) {
-        v = v * tanh(log(exp(v) + 1.f));
-    }
-
-    return v;
-}
-
 Tensor quantize_to_int8(const Tensor& src, const Tensor& scale_data, bool pack) {
     
 #if __SSE2__
@@ -15,28 +15,6 @@
 
 namespace otter {
 
-static inline float activation_ss(float v, int activation_type, const Tensor& activation_params) {
-    if (activation_type == 1) {
-        v = fmax(v, 0.f);
-    } else if (activation_type == 2) {
-        float slope = activation_params.data_ptr<float>()[0];
-        v = v > 0.f ? v : v * slope;
-    } else if (activation_type == 3) {
-        float min = 0;
-        float max = 6;
-        if (v < min)
-            v = min;
-        if (v > max)
-            v = max;
-    } else if (activation_type == 4) {
-        v = 1.f / (1.f + exp(-v));
-    } else if (activation_type == 5) {
-        v = v * tanh(log(exp(v) + 1.f));
-    }
-
-    return v;
-}
-
 Tensor quantize_to_int8_neon(const Tensor& src, const Tensor& scale_data, bool pack) {
     int dims = src.dim();
     int elempack = src.elempack();
@@ -9,6 +9,7 @@
 #define QuantizeNeon_hpp
 
 #include "Tensor.hpp"
+#include "ActivationLayer.hpp"
 
 #if __ARM_NEON__
 #include <arm_neon.h>
@@ -109,7 +110,7 @@ static inline int8x8_t float2int8leakyrelu(float32x4_t _vlow, float32x4_t _vhigh
     return vmax_s8(_v8, _v8_leaky);
 }
 
-static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, const otter::Tensor& activation_params) {
+static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, float alpha, float beta) {
     if (activation_type == 1)
     {
         const float32x4_t _zero = vdupq_n_f32(0.f);
@@ -118,7 +119,7 @@ static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, con
     else if (activation_type == 2)
     {
         const float32x4_t _zero = vdupq_n_f32(0.f);
-        const float32x4_t _slope = vdupq_n_f32(activation_params.data_ptr<float>()[0]);
+        const float32x4_t _slope = vdupq_n_f32(alpha);
         const uint32x4_t _lemask = vcleq_f32(_v, _zero);
         float32x4_t _ps = vmulq_f32(_v, _slope);
         _v = vbslq_f32(_lemask, _ps, _v);
@@ -140,8 +141,6 @@ static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, con
     }
     else if (activation_type == 6)
     {
-        const float alpha = activation_params.data_ptr<float>()[0];
-        const float beta = activation_params.data_ptr<float>()[1];
         const float32x4_t _zero = vdupq_n_f32(0.f);
         const float32x4_t _one = vdupq_n_f32(1.f);
         float32x4_t _ans = vdupq_n_f32(beta);
@@ -150,10 +149,33 @@ static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, con
         _ans = vminq_f32(_ans, _one);
         _v = vmulq_f32(_ans, _v);
     }
+    else if (activation_type == 7)
+    {
+        float32x4_t _ans = vdupq_n_f32(beta);
+        _ans = vmlaq_n_f32(_ans, _v, alpha);
+        _ans = vmaxq_f32(_ans, vdupq_n_f32(0.f));
+        _v = vminq_f32(_ans, vdupq_n_f32(1.f));
+    }
+    else if (activation_type == 8)
+    {
+        _v = vmulq_f32(_v, sigmoid_ps(_v));
+    }
+    else if (activation_type == 9)
+    {
+        float32x4_t _cube = vmulq_f32(vmulq_f32(_v, _v), _v);
+        float32x4_t _t = vmlaq_n_f32(_v, _cube, otter::GELU_CUBIC_COEFF);
+        _v = vmulq_f32(_v, sigmoid_ps(vmulq_n_f32(_t, otter::GELU_SIGMOID_SCALE)));
+    }
 
     return _v;
 }
 
+static inline float32x4_t activation_ps(float32x4_t _v, int activation_type, const otter::Tensor& activation_params) {
+    float alpha, beta;
+    otter::activation_scalar_params(activation_type, activation_params, alpha, beta);
+    return activation_ps(_v, activation_type, alpha, beta);
+}
+
 namespace otter {
 
 Tensor quantize_to_int8_neon(const Tensor& src, const Tensor& scale_data, bool pack);
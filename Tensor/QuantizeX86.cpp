@@ -22,28 +22,6 @@ static inline signed char float2int8(float v) {
     return (signed char)int32;
 }
 
-static inline float activation_ss(float v, int activation_type, const Tensor& activation_params) {
-    if (activation_type == 1) {
-        v = fmax(v, 0.f);
-    } else if (activation_type == 2) {
-        float slope = activation_params.item().toFloat();
-        v = v > 0.f ? v : v * slope;
-    } else if (activation_type == 3) {
-        float min = 0;
-        float max = 6;
-        if (v < min)
-            v = min;
-        if (v > max)
-            v = max;
-    } else if (activation_type == 4) {
-        v = 1.f / (1.f + exp(-v));
-    } else if (activation_type == 5) {
-        v = v * tanh(log(exp(v) + 1.f));
-    }
-
-    return v;
-}
-
 Tensor quantize_to_int8_x86(const Tensor& src, const Tensor& scale_data, bool pack) {
     int dims = src.dim();
     int elempack = src.elempack();
@@ -1054,7 +1032,7 @@ Tensor dequantize_from_int32_x86(const Tensor& src, const Tensor& scale_data, co
                     }
 #endif  // __SSE2__
                     for (; i < size; i++) {
-                        ptr[i] = intptr[i] * scale;
+                        *ptr++ = *intptr++ * scale;
                     }
                 }
             });
@@ -1082,7 +1060,7 @@ Tensor dequantize_from_int32_x86(const Tensor& src, const Tensor& scale_data, co
                     }
 #endif  // __SSE2__
                     for (; i < size; i++) {
-                        ptr[i] = intptr[i] * scale + bias;
+                        *ptr++ = *intptr++ * scale + bias;
                     }
                 }
             });
@@ -1120,7 +1098,7 @@ Tensor dequantize_from_int32_x86(const Tensor& src, const Tensor& scale_data, co
 #endif // __SSE2__
 
                         for (; i < size; i++) {
-                            ptr[i] = intptr[i] * scale;
+                            *ptr++ = *intptr++ * scale;
                         }
                     }
                 });
@@ -1149,7 +1127,7 @@ Tensor dequantize_from_int32_x86(const Tensor& src, const Tensor& scale_data, co
 #endif // __SSE2__
                         
                         for (; i < size; i++) {
-                            ptr[i] = intptr[i] * scale + bias;
+                            *ptr++ = *intptr++ * scale + bias;
                         }
                     }
                 });
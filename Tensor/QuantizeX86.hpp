@@ -12,6 +12,7 @@
 #include "VecIntrinsic.hpp"
 #include "Avx_Math.hpp"
 #include "Tensor.hpp"
+#include "ActivationLayer.hpp"
 
 #include "sse_mathfun.hpp"
 static OTTER_ALWAYS_INLINE __m128 sigmoid_sse(__m128 inputs)
@@ -46,6 +47,20 @@ static OTTER_ALWAYS_INLINE __m128 hardswish_sse(__m128 inputs, __m128 a, __m128
     return _mm_mul_ps(b, inputs);
 }
 
+static OTTER_ALWAYS_INLINE __m128 hardsigmoid_sse(__m128 inputs, __m128 a, __m128 b)
+{
+    b = _mm_add_ps(_mm_mul_ps(inputs, a), b);
+    b = _mm_max_ps(b, _mm_setzero_ps());
+    return _mm_min_ps(b, _mm_set1_ps(1.0f));
+}
+
+static OTTER_ALWAYS_INLINE __m128 gelu_sse(__m128 inputs)
+{
+    __m128 cube = _mm_mul_ps(_mm_mul_ps(inputs, inputs), inputs);
+    __m128 t = _mm_add_ps(inputs, _mm_mul_ps(cube, _mm_set1_ps(otter::GELU_CUBIC_COEFF)));
+    return _mm_mul_ps(inputs, sigmoid_sse(_mm_mul_ps(t, _mm_set1_ps(otter::GELU_SIGMOID_SCALE))));
+}
+
 static OTTER_ALWAYS_INLINE __m128 abs_sse(__m128 inputs)
 {
     // Use negative zero as the sign bit mask.
@@ -69,7 +84,7 @@ static OTTER_ALWAYS_INLINE __m128 prelu_sse(__m128 inputs, __m128 alphas)
     return _mm_add_ps(pos, _mm_mul_ps(alphas, neg));
 }
 
-static OTTER_ALWAYS_INLINE __m128 activation_sse(__m128 _v, int activation_type, const otter::Tensor& activation_params)
+static OTTER_ALWAYS_INLINE __m128 activation_sse(__m128 _v, int activation_type, float alpha, float beta)
 {
     // Process fused activations
     switch (activation_type)
@@ -82,7 +97,7 @@ static OTTER_ALWAYS_INLINE __m128 activation_sse(__m128 _v, int activation_type,
     case 2:
     {
         // Leaky relu
-        return lrelu_sse(_v, activation_params.data_ptr<float>()[0]);
+        return lrelu_sse(_v, alpha);
     }
     case 3:
     {
@@ -100,11 +115,34 @@ static OTTER_ALWAYS_INLINE __m128 activation_sse(__m128 _v, int activation_type,
     {
         return mish_sse(_v);
     }
+    case 6:
+    {
+        return hardswish_sse(_v, _mm_set1_ps(alpha), _mm_set1_ps(beta));
+    }
+    case 7:
+    {
+        return hardsigmoid_sse(_v, _mm_set1_ps(alpha), _mm_set1_ps(beta));
+    }
+    case 8:
+    {
+        return swish_sse(_v);
+    }
+    case 9:
+    {
+        return gelu_sse(_v);
+    }
     }
 
     return _v;
 }
 
+static OTTER_ALWAYS_INLINE __m128 activation_sse(__m128 _v, int activation_type, const otter::Tensor& activation_params)
+{
+    float alpha, beta;
+    otter::activation_scalar_params(activation_type, activation_params, alpha, beta);
+    return activation_sse(_v, activation_type, alpha, beta);
+}
+
 #if __AVX__
 #include <immintrin.h>
 
@@ -144,6 +182,20 @@ static OTTER_ALWAYS_INLINE __m256 hardswish_avx(__m256 inputs, __m256 a, __m256
     return _mm256_mul_ps(b, inputs);
 }
 
+static OTTER_ALWAYS_INLINE __m256 hardsigmoid_avx(__m256 inputs, __m256 a, __m256 b)
+{
+    b = _mm256_comp_fmadd_ps(inputs, a, b);
+    b = _mm256_max_ps(b, _mm256_setzero_ps());
+    return _mm256_min_ps(b, _mm256_set1_ps(1.0f));
+}
+
+static OTTER_ALWAYS_INLINE __m256 gelu_avx(__m256 inputs)
+{
+    __m256 cube = _mm256_mul_ps(_mm256_mul_ps(inputs, inputs), inputs);
+    __m256 t = _mm256_comp_fmadd_ps(cube, _mm256_set1_ps(otter::GELU_CUBIC_COEFF), inputs);
+    return _mm256_mul_ps(inputs, sigmoid_avx(_mm256_mul_ps(t, _mm256_set1_ps(otter::GELU_SIGMOID_SCALE))));
+}
+
 static OTTER_ALWAYS_INLINE __m256 abs_avx(__m256 inputs)
 {
     return _mm256_max_ps(_mm256_sub_ps(_mm256_setzero_ps(), inputs), inputs);
@@ -163,7 +215,7 @@ static OTTER_ALWAYS_INLINE __m256 prelu_avx(__m256 inputs, __m256 alphas)
     return _mm256_add_ps(pos, _mm256_mul_ps(alphas, neg));
 }
 
-static OTTER_ALWAYS_INLINE __m256 activation_avx(__m256 _v, int activation_type, const otter::Tensor& activation_params)
+static OTTER_ALWAYS_INLINE __m256 activation_avx(__m256 _v, int activation_type, float alpha, float beta)
 {
     // Process fused activations
     switch (activation_type)
@@ -176,7 +228,7 @@ static OTTER_ALWAYS_INLINE __m256 activation_avx(__m256 _v, int activation_type,
     case 2:
     {
         // Leaky relu
-        return lrelu_avx(_v, activation_params.item().toFloat());
+        return lrelu_avx(_v, alpha);
     }
     case 3:
     {
@@ -194,11 +246,34 @@ static OTTER_ALWAYS_INLINE __m256 activation_avx(__m256 _v, int activation_type,
     {
         return mish_avx(_v);
     }
+    case 6:
+    {
+        return hardswish_avx(_v, _mm256_set1_ps(alpha), _mm256_set1_ps(beta));
+    }
+    case 7:
+    {
+        return hardsigmoid_avx(_v, _mm256_set1_ps(alpha), _mm256_set1_ps(beta));
+    }
+    case 8:
+    {
+        return swish_avx(_v);
+    }
+    case 9:
+    {
+        return gelu_avx(_v);
+    }
     }
 
     return _v;
 }
 
+static OTTER_ALWAYS_INLINE __m256 activation_avx(__m256 _v, int activation_type, const otter::Tensor& activation_params)
+{
+    float alpha, beta;
+    otter::activation_scalar_params(activation_type, activation_params, alpha, beta);
+    return activation_avx(_v, activation_type, alpha, beta);
+}
+
 #endif // __AVX__
 
 namespace otter {
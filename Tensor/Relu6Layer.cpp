@@ -18,6 +18,7 @@ namespace otter {
 Relu6Layer::Relu6Layer() {
     one_blob_only = true;
     support_inplace = true;
+    support_tiling = true;
     
 #if __SSE2__
     support_packing = true;
@@ -13,6 +13,7 @@ namespace otter {
 SigmoidLayer::SigmoidLayer() {
     one_blob_only = true;
     support_inplace = true;
+    support_tiling = true;
 }
 
 int SigmoidLayer::load_param(const ParamDict& /*pd*/) {
@@ -0,0 +1,328 @@
+//
+//  SparseGemm.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "SparseGemm.hpp"
+#include "TensorFactory.hpp"
+#include "Parallel.hpp"
+#include "VecIntrinsic.hpp"
+
+#include <vector>
+
+namespace otter {
+
+float sparse_block_density(const Tensor& weight, int64_t block_size) {
+    const Tensor weight_c = weight.contiguous();
+    const int64_t rows = weight_c.size(0);
+    const int64_t cols = weight_c.numel() / rows;
+    const float* ptr = (const float*)weight_c.data_ptr();
+
+    int64_t nonzero_blocks = 0;
+    for (int64_t b = 0; b < rows / block_size; b++) {
+        for (int64_t k = 0; k < cols; k++) {
+            for (int64_t i = 0; i < block_size; i++) {
+                if (ptr[(b * block_size + i) * cols + k] != 0.f) {
+                    nonzero_blocks++;
+                    break;
+                }
+            }
+        }
+    }
+
+    return (float)nonzero_blocks / (float)(rows / block_size * cols);
+}
+
+// Measured against the dense kernels on 64-128 channels pointwise convolutions and a 1024x1000 InnerProduct,
+// a 1x1 block pays a weight load and an input gather for every nonzero, a wider block amortizes them.
+// The im2col of a kxk convolution is paid by the sparse path only, it needs about half the density.
+bool sparse_weight_preferred(float density, int64_t block_size, bool im2col) {
+    float threshold = block_size >= 8 ? 0.45f : block_size >= 4 ? 0.4f : 0.3f;
+    if (im2col)
+        threshold *= 0.5f;
+    
+    return density <= threshold;
+}
+
+int64_t select_sparse_block_size(const Tensor& weight) {
+    const int64_t rows = weight.size(0);
+    
+#if __AVX__
+    if (rows % 8 == 0 && sparse_weight_preferred(sparse_block_density(weight, 8), 8))
+        return 8;
+#endif
+#if __SSE2__
+    if (rows % 4 == 0 && sparse_weight_preferred(sparse_block_density(weight, 4), 4))
+        return 4;
+#endif
+    // a 1x1 block gemv gathers one input per weight, it only wins on very sparse weights
+    if (sparse_block_density(weight, 1) <= 0.1f)
+        return 1;
+    
+    return 0;
+}
+
+SparseWeight make_sparse_weight(const Tensor& weight, int64_t block_size) {
+    const Tensor weight_c = weight.contiguous();
+
+    SparseWeight sparse;
+    sparse.rows = weight_c.size(0);
+    sparse.cols = weight_c.numel() / sparse.rows;
+    sparse.block_size = block_size;
+
+    OTTER_CHECK(sparse.rows % block_size == 0, "Sparse weight expect rows divisible by the block size but get ", sparse.rows, " and ", block_size);
+
+    const int64_t rows = sparse.rows;
+    const int64_t cols = sparse.cols;
+    const int64_t num_blocks = rows / block_size;
+    const float* ptr = (const float*)weight_c.data_ptr();
+
+    std::vector<float> values;
+    std::vector<int> col_index;
+    std::vector<int> block_offset(num_blocks + 1, 0);
+
+    for (int64_t b = 0; b < num_blocks; b++) {
+        for (int64_t k = 0; k < cols; k++) {
+            bool nonzero = false;
+            for (int64_t i = 0; i < block_size; i++) {
+                nonzero |= ptr[(b * block_size + i) * cols + k] != 0.f;
+            }
+            if (!nonzero)
+                continue;
+
+            for (int64_t i = 0; i < block_size; i++) {
+                values.push_back(ptr[(b * block_size + i) * cols + k]);
+            }
+            col_index.push_back((int)k);
+        }
+        block_offset[b + 1] = (int)col_index.size();
+    }
+
+    // one trailing entry so that empty weights still allocate
+    const int64_t nnz = (int64_t)col_index.size();
+    sparse.values = otter::zeros({nnz + 1, block_size}, ScalarType::Float);
+    sparse.col_index = otter::zeros({nnz + 1}, ScalarType::Int);
+    sparse.block_offset = otter::empty({num_blocks + 1}, ScalarType::Int);
+
+    std::copy(values.begin(), values.end(), (float*)sparse.values.data_ptr());
+    std::copy(col_index.begin(), col_index.end(), (int*)sparse.col_index.data_ptr());
+    std::copy(block_offset.begin(), block_offset.end(), (int*)sparse.block_offset.data_ptr());
+
+    return sparse;
+}
+
+// One block of rows over size outputs. input(k, n) = input[input_offset[k] + n * input_step],
+// the block_size lanes of output n start at output[n * output_step].
+template <int block_size>
+static void sparse_gemm_block(const float* kptr0, const int* col_index, int64_t nnz, const float* input, const int64_t* input_offset, int64_t input_step, int64_t size, const float* bias, float* output, int64_t output_step) {
+    int64_t n = 0;
+#if __SSE2__
+#if __AVX__
+    if (block_size == 8) {
+        const __m256 _bias = bias ? _mm256_loadu_ps(bias) : _mm256_setzero_ps();
+        for (; n + 3 < size; n += 4) {
+            __m256 _sum0 = _bias;
+            __m256 _sum1 = _bias;
+            __m256 _sum2 = _bias;
+            __m256 _sum3 = _bias;
+
+            const float* kptr = kptr0;
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n * input_step;
+                __m256 _w = _mm256_loadu_ps(kptr);
+                _sum0 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x), _sum0);
+                _sum1 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x + input_step), _sum1);
+                _sum2 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x + input_step * 2), _sum2);
+                _sum3 = _mm256_comp_fmadd_ps(_w, _mm256_broadcast_ss(x + input_step * 3), _sum3);
+                kptr += 8;
+            }
+
+            float* outptr = output + n * output_step;
+            _mm256_storeu_ps(outptr, _sum0);
+            _mm256_storeu_ps(outptr + output_step, _sum1);
+            _mm256_storeu_ps(outptr + output_step * 2, _sum2);
+            _mm256_storeu_ps(outptr + output_step * 3, _sum3);
+        }
+        for (; n < size; n++) {
+            __m256 _sum = _bias;
+
+            const float* kptr = kptr0;
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n * input_step;
+                _sum = _mm256_comp_fmadd_ps(_mm256_loadu_ps(kptr), _mm256_broadcast_ss(x), _sum);
+                kptr += 8;
+            }
+
+            _mm256_storeu_ps(output + n * output_step, _sum);
+        }
+        return;
+    }
+#endif  // __AVX__
+    if (block_size == 4) {
+        const __m128 _bias = bias ? _mm_loadu_ps(bias) : _mm_setzero_ps();
+        for (; n + 3 < size; n += 4) {
+            __m128 _sum0 = _bias;
+            __m128 _sum1 = _bias;
+            __m128 _sum2 = _bias;
+            __m128 _sum3 = _bias;
+
+            const float* kptr = kptr0;
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n * input_step;
+                __m128 _w = _mm_loadu_ps(kptr);
+                _sum0 = _mm_comp_fmadd_ps(_w, _mm_load1_ps(x), _sum0);
+                _sum1 = _mm_comp_fmadd_ps(_w, _mm_load1_ps(x + input_step), _sum1);
+                _sum2 = _mm_comp_fmadd_ps(_w, _mm_load1_ps(x + input_step * 2), _sum2);
+                _sum3 = _mm_comp_fmadd_ps(_w, _mm_load1_ps(x + input_step * 3), _sum3);
+                kptr += 4;
+            }
+
+            float* outptr = output + n * output_step;
+            _mm_storeu_ps(outptr, _sum0);
+            _mm_storeu_ps(outptr + output_step, _sum1);
+            _mm_storeu_ps(outptr + output_step * 2, _sum2);
+            _mm_storeu_ps(outptr + output_step * 3, _sum3);
+        }
+        for (; n < size; n++) {
+            __m128 _sum = _bias;
+
+            const float* kptr = kptr0;
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n * input_step;
+                _sum = _mm_comp_fmadd_ps(_mm_loadu_ps(kptr), _mm_load1_ps(x), _sum);
+                kptr += 4;
+            }
+
+            _mm_storeu_ps(output + n * output_step, _sum);
+        }
+        return;
+    }
+    if (block_size == 1 && input_step == 1 && output_step == 1) {
+        // the input planes are contiguous, vectorize over the outputs instead
+        const float bias0 = bias ? bias[0] : 0.f;
+#if __AVX__
+        for (; n + 15 < size; n += 16) {
+            __m256 _sum0 = _mm256_set1_ps(bias0);
+            __m256 _sum1 = _mm256_set1_ps(bias0);
+
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n;
+                __m256 _w = _mm256_set1_ps(kptr0[e]);
+                _sum0 = _mm256_comp_fmadd_ps(_w, _mm256_loadu_ps(x), _sum0);
+                _sum1 = _mm256_comp_fmadd_ps(_w, _mm256_loadu_ps(x + 8), _sum1);
+            }
+
+            _mm256_storeu_ps(output + n, _sum0);
+            _mm256_storeu_ps(output + n + 8, _sum1);
+        }
+#endif  // __AVX__
+        for (; n + 3 < size; n += 4) {
+            __m128 _sum = _mm_set1_ps(bias0);
+
+            for (int64_t e = 0; e < nnz; e++) {
+                const float* x = input + input_offset[col_index[e]] + n;
+                _sum = _mm_comp_fmadd_ps(_mm_set1_ps(kptr0[e]), _mm_loadu_ps(x), _sum);
+            }
+
+            _mm_storeu_ps(output + n, _sum);
+        }
+    }
+#endif  // __SSE2__
+    if (block_size == 1) {
+        // gemv, independent partial sums hide the latency of the gathered input
+        for (; n < size; n++) {
+            float sum0 = bias ? bias[0] : 0.f;
+            float sum1 = 0.f;
+            float sum2 = 0.f;
+            float sum3 = 0.f;
+
+            const float* x = input + n * input_step;
+            int64_t e = 0;
+            for (; e + 3 < nnz; e += 4) {
+                sum0 += kptr0[e] * x[input_offset[col_index[e]]];
+                sum1 += kptr0[e + 1] * x[input_offset[col_index[e + 1]]];
+                sum2 += kptr0[e + 2] * x[input_offset[col_index[e + 2]]];
+                sum3 += kptr0[e + 3] * x[input_offset[col_index[e + 3]]];
+            }
+            for (; e < nnz; e++) {
+                sum0 += kptr0[e] * x[input_offset[col_index[e]]];
+            }
+
+            output[n * output_step] = (sum0 + sum1) + (sum2 + sum3);
+        }
+        return;
+    }
+    for (; n < size; n++) {
+        float* outptr = output + n * output_step;
+        for (int i = 0; i < block_size; i++) {
+            float sum = bias ? bias[i] : 0.f;
+
+            const float* kptr = kptr0 + i;
+            for (int64_t e = 0; e < nnz; e++) {
+                sum += *kptr * input[input_offset[col_index[e]] + n * input_step];
+                kptr += block_size;
+            }
+
+            outptr[i] = sum;
+        }
+    }
+}
+
+static void sparse_gemm_dispatch(const SparseWeight& weight, int64_t b, const float* input, const int64_t* input_offset, int64_t input_step, int64_t size, const float* bias, float* output, int64_t output_step) {
+    const int64_t block_size = weight.block_size;
+    const int* block_offset = (const int*)weight.block_offset.data_ptr();
+    const int64_t begin = block_offset[b];
+    const int64_t nnz = block_offset[b + 1] - begin;
+
+    const float* kptr = (const float*)weight.values.data_ptr() + begin * block_size;
+    const int* col_index = (const int*)weight.col_index.data_ptr() + begin;
+    const float* bias_ptr = bias ? bias + b * block_size : nullptr;
+
+    switch (block_size) {
+        case 8:
+            sparse_gemm_block<8>(kptr, col_index, nnz, input, input_offset, input_step, size, bias_ptr, output, output_step); break;
+        case 4:
+            sparse_gemm_block<4>(kptr, col_index, nnz, input, input_offset, input_step, size, bias_ptr, output, output_step); break;
+        case 1:
+            sparse_gemm_block<1>(kptr, col_index, nnz, input, input_offset, input_step, size, bias_ptr, output, output_step); break;
+        default:
+            OTTER_CHECK(false, "Unsupported sparse block size ", block_size);
+    }
+}
+
+void sparse_gemm(const SparseWeight& weight, const float* input, int64_t elempack, int64_t size, const float* bias, float* output) {
+    std::vector<int64_t> input_offset(weight.cols);
+    for (int64_t k = 0; k < weight.cols; k++) {
+        input_offset[k] = (k / elempack) * size * elempack + k % elempack;
+    }
+
+    const int64_t block_size = weight.block_size;
+    const int64_t num_blocks = weight.rows / block_size;
+
+    otter::parallel_for(0, num_blocks, 0, [&](int64_t begin, int64_t end) {
+        for (const auto b : otter::irange(begin, end)) {
+            sparse_gemm_dispatch(weight, b, input, input_offset.data(), elempack, size, bias, output + b * size * block_size, block_size);
+        }
+    });
+}
+
+void sparse_gemv_rows(const SparseWeight& weight, const float* input, int64_t h, const float* bias, float* output) {
+    std::vector<int64_t> input_offset(weight.cols);
+    for (int64_t k = 0; k < weight.cols; k++) {
+        input_offset[k] = k;
+    }
+
+    const int64_t block_size = weight.block_size;
+    const int64_t num_blocks = weight.rows / block_size;
+
+    // every block runs over all the rows so that a weight load serves four of them
+    otter::parallel_for(0, num_blocks, 0, [&](int64_t begin, int64_t end) {
+        for (const auto b : otter::irange(begin, end)) {
+            sparse_gemm_dispatch(weight, b, input, input_offset.data(), weight.cols, h, bias, output + b * block_size, weight.rows);
+        }
+    });
+}
+
+}   // end namespace otter
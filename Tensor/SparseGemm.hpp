@@ -0,0 +1,54 @@
+//
+//  SparseGemm.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef SparseGemm_hpp
+#define SparseGemm_hpp
+
+#include "Tensor.hpp"
+
+namespace otter {
+
+// Weight of a rows x cols gemm for pruned models. The rows are grouped in blocks of block_size
+// (the output elempack), a block keeps the columns where any of its rows is nonzero and the
+// block_size weights of every kept column, so 4x1 / 8x1 blocks and unstructured or 2:4
+// sparsity (block_size = 1) share one format.
+struct SparseWeight {
+    int64_t rows = 0;
+    int64_t cols = 0;
+    int64_t block_size = 1;
+
+    Tensor values;          // nnz x block_size Float
+    Tensor col_index;       // nnz Int
+    Tensor block_offset;    // rows / block_size + 1 Int, the nnz range of every block
+
+    bool defined() const { return values.defined(); }
+};
+
+// Fraction of the block_size x 1 blocks of a rows x cols Float weight which has a nonzero
+float sparse_block_density(const Tensor& weight, int64_t block_size);
+
+// Whether the sparse kernel is expected to beat the dense one at this block density,
+// im2col is set for the kxk convolutions which unfold the input first
+bool sparse_weight_preferred(float density, int64_t block_size, bool im2col = false);
+
+// Widest block of the SIMD width dividing rows which is sparse enough for a gemv, 0 keeps the dense weight
+int64_t select_sparse_block_size(const Tensor& weight);
+
+SparseWeight make_sparse_weight(const Tensor& weight, int64_t block_size);
+
+// output[b][n][block_size] = bias[row] + sum_k W[row][k] * input(k, n), row = b * block_size + lane,
+// input(k, n) = input[(k / elempack) * size * elempack + n * elempack + k % elempack]
+// so a packed NCHW blob (size = h * w) and a plain cols x size matrix are both accepted.
+void sparse_gemm(const SparseWeight& weight, const float* input, int64_t elempack, int64_t size, const float* bias, float* output);
+
+// h independent rows of cols features, output is h x rows in the natural row order
+// whatever the block size, every weight block is loaded once for four input rows
+void sparse_gemv_rows(const SparseWeight& weight, const float* input, int64_t h, const float* bias, float* output);
+
+}   // end namespace otter
+
+#endif /* SparseGemm_hpp */
@@ -0,0 +1,205 @@
+//
+//  SqueezeExcitationLayer.cpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#include "SqueezeExcitationLayer.hpp"
+#include "ActivationLayer.hpp"
+#include "Pool.hpp"
+#include "Parallel.hpp"
+#include "TensorFactory.hpp"
+#include "TensorMaker.hpp"
+#include "VecIntrinsic.hpp"
+
+namespace otter {
+
+SqueezeExcitationLayer::SqueezeExcitationLayer() {
+    one_blob_only = true;
+    support_inplace = true;
+    
+#if __SSE2__
+    support_packing = true;
+#elif __ARM_NEON__
+    support_packing = true;
+#endif
+}
+
+int SqueezeExcitationLayer::parse_param(LayerOption& option, ParamDict& pd) {
+    pd.clear();
+    int squeeze_channels = opt_find_int(option, "squeeze_channels", 0);
+    int reduction = opt_find_int(option, "reduction", 4);
+    
+    std::string activation = opt_find_string(option, "activation", "Relu");
+    std::string gate = opt_find_string(option, "gate", "Sigmoid");
+    
+    int activation_type = activation_type_from_string(activation);
+    int gate_type = activation_type_from_string(gate);
+    
+    OTTER_CHECK(activation_type != 2, "SqueezeExcitation does not support LRelu activation");
+    OTTER_CHECK(gate_type == 4 || gate_type == 7, "SqueezeExcitation gate should be Sigmoid or HardSigmoid but get ", gate);
+    
+    pd.set((int)SqueezeExcitationParam::Squeeze_channels, squeeze_channels);
+    pd.set((int)SqueezeExcitationParam::Reduction, reduction);
+    pd.set((int)SqueezeExcitationParam::Activation_type, activation_type);
+    pd.set((int)SqueezeExcitationParam::Gate_type, gate_type);
+    
+    return 0;
+}
+
+int SqueezeExcitationLayer::compute_output_shape(ParamDict& pd) {
+    auto shape_a = bottom_shapes[0].accessor<int, 2>()[0];
+    int input_channels = shape_a[1];
+    
+    int reduction = pd.get((int)SqueezeExcitationParam::Reduction, 4);
+    if (pd.get((int)SqueezeExcitationParam::Squeeze_channels, 0) <= 0) {
+        pd.set((int)SqueezeExcitationParam::Squeeze_channels, std::max(input_channels / reduction, 1));
+    }
+    
+    pd.set((int)SqueezeExcitationParam::Channels, input_channels);
+    pd.set(OUTPUT_SHAPE_HINT, bottom_shapes[0]);
+    
+    return 0;
+}
+
+int SqueezeExcitationLayer::load_param(const ParamDict& pd) {
+    channels = pd.get((int)SqueezeExcitationParam::Channels, 0);
+    squeeze_channels = pd.get((int)SqueezeExcitationParam::Squeeze_channels, 0);
+    activation_type = pd.get((int)SqueezeExcitationParam::Activation_type, 1);
+    gate_type = pd.get((int)SqueezeExcitationParam::Gate_type, 4);
+    
+    return 0;
+}
+
+int SqueezeExcitationLayer::init_model() {
+    fc1_weight_data = otter::rand({squeeze_channels, channels}, otter::ScalarType::Float);
+    fc1_bias_data = otter::rand({squeeze_channels}, otter::ScalarType::Float);
+    fc2_weight_data = otter::rand({channels, squeeze_channels}, otter::ScalarType::Float);
+    fc2_bias_data = otter::rand({channels}, otter::ScalarType::Float);
+    
+    return 0;
+}
+
+int SqueezeExcitationLayer::load_model(const Initializer& initializer) {
+    fc1_weight_data = initializer.load({squeeze_channels, channels}, 0);
+    fc1_bias_data = initializer.load({squeeze_channels}, 1);
+    fc2_weight_data = initializer.load({channels, squeeze_channels}, 0);
+    fc2_bias_data = initializer.load({channels}, 1);
+    
+    return 0;
+}
+
+int SqueezeExcitationLayer::forward_inplace(Tensor& bottom_blob, const NetOption& /*opt*/) const {
+    if (!bottom_blob.is_contiguous())
+        bottom_blob = bottom_blob.contiguous();
+    
+    int batch = (int)bottom_blob.size(0);
+    int channels_packed = (int)bottom_blob.size(1);
+    int elempack = bottom_blob.elempack();
+    int size = (int)(bottom_blob.size(2) * bottom_blob.size(3));
+    
+    OTTER_CHECK(channels_packed * elempack == channels, "SqueezeExcitation expect ", channels, " channels but get ", channels_packed * elempack);
+    
+    // [N, C / elempack, 1, 1] with elempack lanes is the pooled vector in channel order
+    Tensor pooled = otter::global_avg_pool2d(bottom_blob);
+    Tensor squeeze = otter::empty({squeeze_channels}, otter::ScalarType::Float);
+    Tensor scale = otter::empty({channels}, otter::ScalarType::Float);
+    
+    const float* fc1_weight_ptr = (const float*)fc1_weight_data.data_ptr();
+    const float* fc1_bias_ptr = (const float*)fc1_bias_data.data_ptr();
+    const float* fc2_weight_ptr = (const float*)fc2_weight_data.data_ptr();
+    const float* fc2_bias_ptr = (const float*)fc2_bias_data.data_ptr();
+    float* squeeze_ptr = (float*)squeeze.data_ptr();
+    float* scale_ptr = (float*)scale.data_ptr();
+    
+    for (const auto b : otter::irange(batch)) {
+        const float* pooled_ptr = (const float*)pooled.data_ptr() + b * channels;
+        
+        for (const auto j : otter::irange(squeeze_channels)) {
+            const float* w = fc1_weight_ptr + j * channels;
+            float sum = fc1_bias_ptr[j];
+            for (int c = 0; c < channels; ++c) {
+                sum += w[c] * pooled_ptr[c];
+            }
+            squeeze_ptr[j] = activation_ss(sum, activation_type, Tensor());
+        }
+        
+        for (const auto c : otter::irange(channels)) {
+            const float* w = fc2_weight_ptr + c * squeeze_channels;
+            float sum = fc2_bias_ptr[c];
+            for (int j = 0; j < squeeze_channels; ++j) {
+                sum += w[j] * squeeze_ptr[j];
+            }
+            scale_ptr[c] = activation_ss(sum, gate_type, Tensor());
+        }
+        
+        float* batch_ptr = (float*)bottom_blob.data_ptr() + (int64_t)b * channels_packed * size * elempack;
+        
+        otter::parallel_for(0, channels_packed, 0, [&](int64_t begin, int64_t end) {
+            for (const auto q : otter::irange(begin, end)) {
+                float* ptr = batch_ptr + q * size * elempack;
+                const float* s = scale_ptr + q * elempack;
+                
+                int i = 0;
+#if __SSE2__
+#if __AVX__
+                if (elempack == 8) {
+                    __m256 _s = _mm256_loadu_ps(s);
+                    for (; i < size; ++i) {
+                        _mm256_storeu_ps(ptr, _mm256_mul_ps(_mm256_loadu_ps(ptr), _s));
+                        ptr += 8;
+                    }
+                }
+#endif  // __AVX__
+                if (elempack == 4) {
+                    __m128 _s = _mm_loadu_ps(s);
+                    for (; i < size; ++i) {
+                        _mm_storeu_ps(ptr, _mm_mul_ps(_mm_loadu_ps(ptr), _s));
+                        ptr += 4;
+                    }
+                }
+                if (elempack == 1) {
+#if __AVX__
+                    __m256 _s_avx = _mm256_set1_ps(s[0]);
+                    for (; i + 7 < size; i += 8) {
+                        _mm256_storeu_ps(ptr, _mm256_mul_ps(_mm256_loadu_ps(ptr), _s_avx));
+                        ptr += 8;
+                    }
+#endif  // __AVX__
+                    __m128 _s = _mm_set1_ps(s[0]);
+                    for (; i + 3 < size; i += 4) {
+                        _mm_storeu_ps(ptr, _mm_mul_ps(_mm_loadu_ps(ptr), _s));
+                        ptr += 4;
+                    }
+                }
+#elif __ARM_NEON__
+                if (elempack == 4) {
+                    float32x4_t _s = vld1q_f32(s);
+                    for (; i < size; ++i) {
+                        vst1q_f32(ptr, vmulq_f32(vld1q_f32(ptr), _s));
+                        ptr += 4;
+                    }
+                }
+                if (elempack == 1) {
+                    float32x4_t _s = vdupq_n_f32(s[0]);
+                    for (; i + 3 < size; i += 4) {
+                        vst1q_f32(ptr, vmulq_f32(vld1q_f32(ptr), _s));
+                        ptr += 4;
+                    }
+                }
+#endif
+                for (; i < size; ++i) {
+                    for (int k = 0; k < elempack; ++k) {
+                        ptr[k] *= s[k];
+                    }
+                    ptr += elempack;
+                }
+            }
+        });
+    }
+    
+    return 0;
+}
+
+}   // end namespace otter
@@ -0,0 +1,57 @@
+//
+//  SqueezeExcitationLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef SqueezeExcitationLayer_hpp
+#define SqueezeExcitationLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+// Global average pool -> InnerProduct + activation -> InnerProduct + gate -> channel scale,
+// the whole block runs in place on the packed blob without materializing the pooled tensors
+class SqueezeExcitationLayer : public Layer {
+public:
+    SqueezeExcitationLayer();
+    
+    virtual int parse_param(LayerOption& option, ParamDict& pd);
+    
+    virtual int compute_output_shape(ParamDict& pd);
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int init_model();
+    
+    virtual int load_model(const Initializer& initializer);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "SqueezeExcitation"; }
+public:
+    int channels;
+    int squeeze_channels;
+    
+    int activation_type;
+    int gate_type;
+    
+    Tensor fc1_weight_data;
+    Tensor fc1_bias_data;
+    Tensor fc2_weight_data;
+    Tensor fc2_bias_data;
+};
+
+enum class SqueezeExcitationParam : int {
+    Channels,
+    Squeeze_channels,
+    Reduction,
+    Activation_type,
+    Gate_type
+};
+
+}   // end namespace otter
+
+#endif /* SqueezeExcitationLayer_hpp */
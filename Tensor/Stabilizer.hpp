@@ -8,13 +8,13 @@
 #ifndef Stabilizer_hpp
 #define Stabilizer_hpp
 
-#include <set>
+#include <cfloat>
 #include <vector>
 
 #include "KalmanTracker.hpp"
 #include "GraphicAPI.hpp"
 #include "DrawDetection.hpp"
-#include "Hungarian.hpp"
+#include "LinearAssignment.hpp"
 #include "Stabilizer.hpp"
 
 namespace otter {
@@ -70,59 +70,45 @@ public:
         trkNum = predictedBoxes.size();
         detNum = detected_objs.size();
 
-        iouMatrix.clear();
-        iouMatrix.resize(trkNum, std::vector<double>(detNum, 0));
+        iouMatrix.resize(trkNum * detNum);
 
         for (unsigned int i = 0; i < trkNum; i++) // compute iou matrix as a distance matrix
         {
             for (unsigned int j = 0; j < detNum; j++) {
-                // use 1-iou because the hungarian algorithm computes a minimum-cost assignment.
-                iouMatrix[i][j] = 1 - GetIOU(predictedBoxes[i], detected_objs[j].rect);
+                // use 1-iou because the assignment solver computes a minimum-cost assignment.
+                iouMatrix[i * detNum + j] = 1 - (float)GetIOU(predictedBoxes[i], detected_objs[j].rect);
             }
         }
 
-        // solve the assignment problem using hungarian algorithm.
+        // solve the assignment problem, pairs without overlap (cost = 1) are gated out so the
+        // solver only works on the connected groups of tracks and detections.
         // the resulting assignment is [track(prediction) : detection], with len=preNum
-        HungarianAlgorithm HungAlgo;
-        assignment.clear();
-        HungAlgo.Solve(iouMatrix, assignment);
+        assignment.resize(trkNum);
+        assigner.solve(iouMatrix.data(), trkNum, detNum, 1.f, assignment.data());
 
         // find matches, unmatched_detections and unmatched_predictions
         unmatchedTrajectories.clear();
         unmatchedDetections.clear();
-        allItems.clear();
-        matchedItems.clear();
-
-        if (detNum > trkNum) //    there are unmatched detections
-        {
-            for (unsigned int n = 0; n < detNum; n++)
-                allItems.insert(n);
-
-            for (unsigned int i = 0; i < trkNum; ++i)
-                matchedItems.insert(assignment[i]);
-
-            set_difference(allItems.begin(), allItems.end(),
-                matchedItems.begin(), matchedItems.end(),
-                insert_iterator<set<int>>(unmatchedDetections, unmatchedDetections.begin()));
-        } else if (detNum < trkNum) // there are unmatched trajectory/predictions
-        {
-            for (unsigned int i = 0; i < trkNum; ++i)
-                if (assignment[i] == -1) // unassigned label will be set as -1 in the assignment algorithm
-                    unmatchedTrajectories.insert(i);
-        }
+        detectionMatched.assign(detNum, 0);
 
         matchedPairs.clear();
         for (unsigned int i = 0; i < trkNum; ++i)
         {
-            if (assignment[i] == -1) // pass over invalid values
+            if (assignment[i] == -1) { // unassigned label will be set as -1 in the assignment algorithm
+                unmatchedTrajectories.push_back(i);
                 continue;
-            if (1 - iouMatrix[i][assignment[i]] < iouThreshold) {
-                unmatchedTrajectories.insert(i);
-                unmatchedDetections.insert(assignment[i]);
+            }
+            if (1 - iouMatrix[i * detNum + assignment[i]] < iouThreshold) {
+                unmatchedTrajectories.push_back(i);
             } else {
                 matchedPairs.push_back(cv::Point(i, assignment[i]));
+                detectionMatched[assignment[i]] = 1;
             }
         }
+        for (unsigned int j = 0; j < detNum; ++j) {
+            if (!detectionMatched[j])
+                unmatchedDetections.push_back(j);
+        }
         int detIdx, trkIdx;
         for (unsigned int i = 0; i < matchedPairs.size(); i++) {
             trkIdx = matchedPairs[i].x;
@@ -168,12 +154,12 @@ private:
     unsigned int detNum = 0;
     std::vector<otter::cv::KalmanTracker> trackers;
     std::vector<otter::cv::Rect_<float>> predictedBoxes;
-    std::vector<std::vector<double>> iouMatrix;
+    std::vector<float> iouMatrix;
     std::vector<int> assignment;
-    std::set<int> unmatchedDetections;
-    std::set<int> unmatchedTrajectories;
-    std::set<int> allItems;
-    std::set<int> matchedItems;
+    otter::cv::LinearAssignment assigner;
+    std::vector<int> unmatchedDetections;
+    std::vector<int> unmatchedTrajectories;
+    std::vector<char> detectionMatched;
     std::vector<otter::cv::Point> matchedPairs;
     std::vector<TrackingBox> frameTrackingResult;
 };
@@ -0,0 +1,28 @@
+//
+//  SwishLayer.hpp
+//  Tensor
+//
+//  Created by 陳均豪 on 2022/10/22.
+//
+
+#ifndef SwishLayer_hpp
+#define SwishLayer_hpp
+
+#include "Layer.hpp"
+
+namespace otter {
+
+class SwishLayer : public Layer {
+public:
+    SwishLayer();
+    
+    virtual int load_param(const ParamDict& pd);
+    
+    virtual int forward_inplace(Tensor& bottom_blob, const NetOption& opt) const;
+    
+    virtual std::string type() const { return "Swish"; }
+};
+
+}   // end namespace otter
+
+#endif /* SwishLayer_hpp */
@@ -11,6 +11,7 @@
 #include "Loop.hpp"
 #include "Parallel.hpp"
 #include "TypeCast.hpp"
+#include "VecIntrinsic.hpp"
 
 namespace otter {
 
@@ -22,7 +23,276 @@ void direct_copy_kernel(TensorIterator& iter) {
     });
 }
 
+// Transposed copy
+//
+// A same dtype copy whose output is contiguous along the fastest dimension of the iterator
+// (dim 0) while the input is contiguous along another dimension k is a batch of 2D
+// transposes, e.g. NCHW <-> NHWC or a matrix .t().contiguous(). The element wise loop
+// walks the input with a large stride there, so the copy is done tile by tile instead,
+// each tile is transposed in registers and both sides are accessed along cache lines.
+
+static constexpr int64_t TRANSPOSE_TILE = 64;
+
+// b[j * ldb + i] = a[i * lda + j] for i < m, j < n, strides in elements
+template <typename T>
+static void transpose_block_naive(const T* a, int64_t lda, T* b, int64_t ldb, int64_t m, int64_t n) {
+    for (int64_t j = 0; j < n; ++j) {
+        for (int64_t i = 0; i < m; ++i) {
+            b[j * ldb + i] = a[i * lda + j];
+        }
+    }
+}
+
+#if __SSE2__
+// unpacking rows i and i + N / 2 together log2(N) times transposes a N x N block
+template <typename T>
+static inline __m128i transpose_unpacklo(__m128i a, __m128i b) {
+    switch (sizeof(T)) {
+        case 1: return _mm_unpacklo_epi8(a, b);
+        case 2: return _mm_unpacklo_epi16(a, b);
+        default: return _mm_unpacklo_epi32(a, b);
+    }
+}
+
+template <typename T>
+static inline __m128i transpose_unpackhi(__m128i a, __m128i b) {
+    switch (sizeof(T)) {
+        case 1: return _mm_unpackhi_epi8(a, b);
+        case 2: return _mm_unpackhi_epi16(a, b);
+        default: return _mm_unpackhi_epi32(a, b);
+    }
+}
+
+template <typename T>
+static inline void transpose_micro_sse2(const T* a, int64_t lda, T* b, int64_t ldb) {
+    constexpr int N = 16 / sizeof(T);
+    __m128i r[N];
+    __m128i t[N];
+    for (int i = 0; i < N; ++i) {
+        r[i] = _mm_loadu_si128((const __m128i*)(a + i * lda));
+    }
+    for (int step = 1; step < N; step *= 2) {
+        for (int i = 0; i < N / 2; ++i) {
+            t[2 * i + 0] = transpose_unpacklo<T>(r[i], r[i + N / 2]);
+            t[2 * i + 1] = transpose_unpackhi<T>(r[i], r[i + N / 2]);
+        }
+        for (int i = 0; i < N; ++i) {
+            r[i] = t[i];
+        }
+    }
+    for (int i = 0; i < N; ++i) {
+        _mm_storeu_si128((__m128i*)(b + i * ldb), r[i]);
+    }
+}
+#endif
+
+#if __AVX__
+static inline void transpose_micro_avx_8x8(const uint32_t* a, int64_t lda, uint32_t* b, int64_t ldb) {
+    __m256 r0 = _mm256_loadu_ps((const float*)(a + 0 * lda));
+    __m256 r1 = _mm256_loadu_ps((const float*)(a + 1 * lda));
+    __m256 r2 = _mm256_loadu_ps((const float*)(a + 2 * lda));
+    __m256 r3 = _mm256_loadu_ps((const float*)(a + 3 * lda));
+    __m256 r4 = _mm256_loadu_ps((const float*)(a + 4 * lda));
+    __m256 r5 = _mm256_loadu_ps((const float*)(a + 5 * lda));
+    __m256 r6 = _mm256_loadu_ps((const float*)(a + 6 * lda));
+    __m256 r7 = _mm256_loadu_ps((const float*)(a + 7 * lda));
+    
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+    
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    
+    _mm256_storeu_ps((float*)(b + 0 * ldb), _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps((float*)(b + 1 * ldb), _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps((float*)(b + 2 * ldb), _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps((float*)(b + 3 * ldb), _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps((float*)(b + 4 * ldb), _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps((float*)(b + 5 * ldb), _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps((float*)(b + 6 * ldb), _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps((float*)(b + 7 * ldb), _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+#endif
+
+template <typename T>
+static void transpose_block(const T* a, int64_t lda, T* b, int64_t ldb, int64_t m, int64_t n) {
+#if __AVX__
+    constexpr int64_t N = (sizeof(T) == 4) ? 8 : 16 / sizeof(T);
+#elif __SSE2__
+    constexpr int64_t N = 16 / sizeof(T);
+#else
+    constexpr int64_t N = 0;
+#endif
+    
+    int64_t i = 0;
+#if __SSE2__
+    if (sizeof(T) <= 4) {
+        for (; i + N <= m; i += N) {
+            int64_t j = 0;
+            for (; j + N <= n; j += N) {
+#if __AVX__
+                if (sizeof(T) == 4) {
+                    transpose_micro_avx_8x8((const uint32_t*)(a + i * lda + j), lda, (uint32_t*)(b + j * ldb + i), ldb);
+                    continue;
+                }
+#endif
+                transpose_micro_sse2<T>(a + i * lda + j, lda, b + j * ldb + i, ldb);
+            }
+            transpose_block_naive<T>(a + i * lda + j, lda, b + j * ldb + i, ldb, N, n - j);
+        }
+    }
+#endif
+    (void)N;
+    transpose_block_naive<T>(a + i * lda, lda, b + i, ldb, m - i, n);
+}
+
+// The output side has only a few elements per row (like NCHW -> NHWC with 3 channels),
+// interleave the M input rows at once instead of tiling.
+template <typename T, int M>
+static void transpose_interleave(const T* a, int64_t lda, T* b, int64_t ldb, int64_t n) {
+    for (int64_t j = 0; j < n; ++j) {
+        for (int i = 0; i < M; ++i) {
+            b[j * ldb + i] = a[i * lda + j];
+        }
+    }
+}
+
+// The input side has only a few elements per row (like NHWC -> NCHW), split them into N output rows.
+template <typename T, int N>
+static void transpose_deinterleave(const T* a, int64_t lda, T* b, int64_t ldb, int64_t m) {
+    for (int64_t i = 0; i < m; ++i) {
+        for (int j = 0; j < N; ++j) {
+            b[j * ldb + i] = a[i * lda + j];
+        }
+    }
+}
+
+template <typename T>
+static void transpose_plane(const T* a, int64_t lda, T* b, int64_t ldb, int64_t m, int64_t n) {
+    switch (m) {
+        case 2: return transpose_interleave<T, 2>(a, lda, b, ldb, n);
+        case 3: return transpose_interleave<T, 3>(a, lda, b, ldb, n);
+        case 4: return transpose_interleave<T, 4>(a, lda, b, ldb, n);
+    }
+    switch (n) {
+        case 2: return transpose_deinterleave<T, 2>(a, lda, b, ldb, m);
+        case 3: return transpose_deinterleave<T, 3>(a, lda, b, ldb, m);
+        case 4: return transpose_deinterleave<T, 4>(a, lda, b, ldb, m);
+    }
+    transpose_block<T>(a, lda, b, ldb, m, n);
+}
+
+template <typename T>
+static void transpose_copy(char* dst, const char* src, int64_t m, int64_t n, int64_t lda, int64_t ldb, const std::vector<int64_t>& batch_sizes, const std::vector<int64_t>& batch_src_strides, const std::vector<int64_t>& batch_dst_strides) {
+    int64_t batch = 1;
+    for (int64_t size : batch_sizes)
+        batch *= size;
+    
+    // narrow planes are split along their long side only
+    const bool narrow = (m <= 4 || n <= 4);
+    const int64_t tiles_m = narrow && m <= 4 ? 1 : divup(m, TRANSPOSE_TILE);
+    const int64_t tiles_n = narrow && m > 4 ? 1 : divup(n, TRANSPOSE_TILE);
+    const int64_t tile_m = narrow && m <= 4 ? m : TRANSPOSE_TILE;
+    const int64_t tile_n = narrow && m > 4 ? n : TRANSPOSE_TILE;
+    const int64_t tiles = batch * tiles_m * tiles_n;
+    const int64_t grain = std::max<int64_t>(1, 16384 / (tile_m * tile_n));
+    
+    otter::parallel_for(0, tiles, grain, [&](int64_t begin, int64_t end) {
+        for (int64_t t = begin; t < end; ++t) {
+            const int64_t tn = t % tiles_n;
+            const int64_t tm = (t / tiles_n) % tiles_m;
+            int64_t b = t / (tiles_n * tiles_m);
+            
+            // byte offsets of the batch
+            int64_t src_offset = 0;
+            int64_t dst_offset = 0;
+            for (size_t d = 0; d < batch_sizes.size(); ++d) {
+                const int64_t index = b % batch_sizes[d];
+                b /= batch_sizes[d];
+                src_offset += index * batch_src_strides[d];
+                dst_offset += index * batch_dst_strides[d];
+            }
+            
+            const int64_t i = tm * tile_m;
+            const int64_t j = tn * tile_n;
+            const T* a = (const T*)(src + src_offset) + i * lda + j;
+            T* bp = (T*)(dst + dst_offset) + j * ldb + i;
+            
+            transpose_plane<T>(a, lda, bp, ldb, std::min(tile_m, m - i), std::min(tile_n, n - j));
+        }
+    });
+}
+
+static bool transpose_copy_kernel(TensorIterator& iter) {
+    const int ndim = iter.ndim();
+    if (ndim < 2)
+        return false;
+    
+    const int64_t element_size = iter.element_size(0);
+    IntArrayRef shape = iter.shape();
+    IntArrayRef dst_strides = iter.strides(0);
+    IntArrayRef src_strides = iter.strides(1);
+    
+    if (dst_strides[0] != element_size || src_strides[0] == element_size || shape[0] < 2)
+        return false;
+    
+    int k = -1;
+    for (int d = 1; d < ndim; ++d) {
+        if (src_strides[d] == element_size && shape[d] >= 2) {
+            k = d;
+            break;
+        }
+    }
+    if (k == -1)
+        return false;
+    
+    const int64_t m = shape[0];
+    const int64_t n = shape[k];
+    const int64_t lda = src_strides[0] / element_size;
+    const int64_t ldb = dst_strides[k] / element_size;
+    if (src_strides[0] % element_size || dst_strides[k] % element_size)
+        return false;
+    
+    std::vector<int64_t> batch_sizes;
+    std::vector<int64_t> batch_src_strides;
+    std::vector<int64_t> batch_dst_strides;
+    for (int d = 1; d < ndim; ++d) {
+        if (d == k)
+            continue;
+        batch_sizes.push_back(shape[d]);
+        batch_src_strides.push_back(src_strides[d]);
+        batch_dst_strides.push_back(dst_strides[d]);
+    }
+    
+    char* dst = (char*)iter.data_ptr(0);
+    const char* src = (const char*)iter.data_ptr(1);
+    
+    switch (element_size) {
+        case 1: transpose_copy<uint8_t>(dst, src, m, n, lda, ldb, batch_sizes, batch_src_strides, batch_dst_strides); return true;
+        case 2: transpose_copy<uint16_t>(dst, src, m, n, lda, ldb, batch_sizes, batch_src_strides, batch_dst_strides); return true;
+        case 4: transpose_copy<uint32_t>(dst, src, m, n, lda, ldb, batch_sizes, batch_src_strides, batch_dst_strides); return true;
+        case 8: transpose_copy<uint64_t>(dst, src, m, n, lda, ldb, batch_sizes, batch_src_strides, batch_dst_strides); return true;
+    }
+    
+    return false;
+}
+
 void copy_same_dtype(TensorIterator& iter) {
+    if (transpose_copy_kernel(iter))
+        return;
+    
     direct_copy_kernel(iter);
 }
 
@@ -17,9 +17,11 @@
 #include "TensorFactory.hpp"
 #include "ExpandUtils.hpp"
 #include "TensorResize.hpp"
+#include "Parallel.hpp"
+#include "Philox.hpp"
 
 #include "VecIntrinsic.hpp"
-#ifdef CPU_CAPABILITY_AVX2
+#if __AVX2__ && __FMA__
 #include "Avx_Math.hpp"
 #endif
 
@@ -234,13 +236,70 @@ Tensor& random_from_to_impl(Tensor& self, int64_t from, int64_t to, Generator ge
 
 namespace cpu {
 
+// See Note [Philox4x32 counter based engine]. Element i of the output always comes from the
+// same words of the stream reserved by the call, so the result only depends on the seed and
+// the offset of the generator, not on the number of threads. Each group of the stream makes
+// PHILOX_GROUP_WORDS / words elements through transform, block post-processes them in place.
+template <typename scalar_t, int words, typename RNG, typename Transform, typename Block>
+void philox_fill(scalar_t* data, int64_t size, RNG generator, const Transform& transform, const Block& block) {
+    constexpr int per_group = PHILOX_GROUP_WORDS / words;
+    const int64_t groups = divup(size, per_group);
+    const uint64_t key = generator->current_seed();
+    const uint64_t base = generator->philox_offset_reserve(groups * PHILOX_GROUP_COUNTERS);
+    
+    otter::parallel_for(0, groups, 1024, [&](int64_t begin, int64_t end) {
+        uint32_t raw[PHILOX_GROUP_WORDS];
+        scalar_t buffer[per_group];
+        for (const auto g : otter::irange(begin, end)) {
+            philox_group(raw, base + g * PHILOX_GROUP_COUNTERS, key);
+            for (int k = 0; k < per_group; ++k) {
+                if constexpr (words == 1) {
+                    buffer[k] = transform(raw[k]);
+                } else {
+                    buffer[k] = transform((static_cast<uint64_t>(raw[2 * k]) << 32) | raw[2 * k + 1]);
+                }
+            }
+            block(buffer);
+            const int64_t n = std::min<int64_t>(per_group, size - g * per_group);
+            std::copy(buffer, buffer + n, data + g * per_group);
+        }
+    });
+}
+
+template <typename scalar_t, int words, typename RNG, typename Transform>
+void philox_fill(scalar_t* data, int64_t size, RNG generator, const Transform& transform) {
+    philox_fill<scalar_t, words>(data, size, generator, transform, [](scalar_t* /*buffer*/) {});
+}
+
+// Non contiguous outputs are generated contiguously and copied, the samples keep the logical order.
+template <typename scalar_t, typename Fill>
+void philox_fill_tensor(const TensorBase& self, const Fill& fill) {
+    if (self.numel() == 0)
+        return;
+    if (self.is_contiguous()) {
+        fill(self.data_ptr<scalar_t>(), self.numel());
+    } else {
+        Tensor contiguous = otter::empty(self.sizes(), self.options());
+        fill(contiguous.data_ptr<scalar_t>(), contiguous.numel());
+        Tensor(self).copy_(contiguous);
+    }
+}
+
 template<typename RNG>
 void random_from_to_kernel(TensorIterator& iter, uint64_t range, int64_t base, RNG generator) {
     OTTER_DISPATCH_ALL_TYPES(iter.dtype(), "random_from_to_kernel_cpu", [&] {
-        std::lock_guard<std::mutex> lock(generator->mutex_);
-        cpu_serial_kernel(iter, [range, base, generator]() -> scalar_t {
-            uniform_int_from_to_distribution<scalar_t> random(range, base);
-            return random(generator);
+        philox_fill_tensor<scalar_t>(iter.tensor_base(0), [&](scalar_t* data, int64_t size) {
+            if ((std::is_same<scalar_t, int64_t>::value ||
+                 std::is_same<scalar_t, double>::value ||
+                 std::is_same<scalar_t, float>::value) && range >= 1ULL << 32) {
+                philox_fill<scalar_t, 2>(data, size, generator, [range, base](uint64_t raw) {
+                    return transformation::uniform_int_from_to<scalar_t>(raw, range, base);
+                });
+            } else {
+                philox_fill<scalar_t, 1>(data, size, generator, [range, base](uint32_t raw) {
+                    return transformation::uniform_int_from_to<scalar_t>(raw, range, base);
+                });
+            }
         });
     });
 }
@@ -250,13 +309,13 @@ void random_from_to_kernel(TensorIterator& iter, uint64_t range, int64_t base, R
 template<typename RNG>
 void random_full_64_bits_range_kernel(TensorIterator& iter, RNG generator) {
     OTTER_DISPATCH_ALL_TYPES(iter.dtype(), "random_full_64_bits_range_kernel_cpu", [&] {
-        std::lock_guard<std::mutex> lock(generator->mutex_);
         if (std::is_same<scalar_t, int64_t>::value ||
             std::is_same<scalar_t, double>::value ||
             std::is_same<scalar_t, float>::value) {
-            cpu_serial_kernel(iter, [generator]() -> scalar_t {
-                uniform_int_full_range_distribution<scalar_t> random;
-                return random(generator);
+            philox_fill_tensor<scalar_t>(iter.tensor_base(0), [&](scalar_t* data, int64_t size) {
+                philox_fill<scalar_t, 2>(data, size, generator, [](uint64_t raw) {
+                    return transformation::uniform_int_full_range<scalar_t>(raw);
+                });
             });
         } else {
             OTTER_CHECK(false, "random_full_64_bits_range_kernel_cpu handles only int64, double, float and bfloat16");
@@ -274,11 +333,17 @@ struct RandomFromToKernel {
 };
 template<typename RNG>
 void random_kernel(TensorIterator& iter, RNG generator) {
-    std::lock_guard<std::mutex> lock(generator->mutex_);
     OTTER_DISPATCH_ALL_TYPES(iter.dtype(), "random_kernel_cpu", [&] {
-        cpu_serial_kernel(iter, [generator]() -> scalar_t {
-            uniform_int_distribution<scalar_t> random;
-            return random(generator);
+        philox_fill_tensor<scalar_t>(iter.tensor_base(0), [&](scalar_t* data, int64_t size) {
+            if (std::is_same<scalar_t, double>::value || std::is_same<scalar_t, int64_t>::value) {
+                philox_fill<scalar_t, 2>(data, size, generator, [](uint64_t raw) {
+                    return transformation::uniform_int<scalar_t>(raw);
+                });
+            } else {
+                philox_fill<scalar_t, 1>(data, size, generator, [](uint32_t raw) {
+                    return transformation::uniform_int<scalar_t>(raw);
+                });
+            }
         });
     });
 }
@@ -290,7 +355,7 @@ struct RandomKernel {
 };
 
 
-#ifdef CPU_CAPABILITY_AVX2
+#if __AVX2__ && __FMA__
 static inline void normal_fill_16_AVX2(float *data,
                                 const __m256* two_pi,
                                 const __m256* one,
@@ -309,33 +374,6 @@ static inline void normal_fill_16_AVX2(float *data,
     _mm256_storeu_ps(data, _mm256_fmadd_ps(n1, *std_v, *mean));
     _mm256_storeu_ps(data + 8, _mm256_fmadd_ps(n2, *std_v, *mean));
 }
-template<typename RNG>
-void normal_fill_AVX2(const TensorBase &self, const float mean, const float std, RNG generator) {
-    float *data = self.data_ptr<float>();
-    auto size = self.numel();
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    for (const auto i : otter::irange(size)) {
-        otter::uniform_real_distribution<float> uniform(0, 1);
-        data[i] = uniform(generator);
-    }
-    const __m256 two_pi = _mm256_set1_ps(2.0f * static_cast<double>(M_PI));
-    const __m256 one = _mm256_set1_ps(1.0f);
-    const __m256 minus_two = _mm256_set1_ps(-2.0f);
-    const __m256 mean_v = _mm256_set1_ps(mean);
-    const __m256 std_v = _mm256_set1_ps(std);
-    for (int64_t i = 0; i < size - 15; i += 16) {
-        normal_fill_16_AVX2(data + i, &two_pi, &one, &minus_two, &mean_v, &std_v);
-    }
-    if (size % 16 != 0) {
-        // Recompute the last 16 values.
-        data = data + size - 16;
-        for (const auto i : otter::irange(16)) {
-            otter::uniform_real_distribution<float> uniform(0, 1);
-            data[i] = uniform(generator);
-        }
-        normal_fill_16_AVX2(data, &two_pi, &one, &minus_two, &mean_v, &std_v);
-    }
-}
 #endif
 template <typename scalar_t>
 static void normal_fill_16(scalar_t *data, const scalar_t mean, const scalar_t std) {
@@ -348,51 +386,47 @@ static void normal_fill_16(scalar_t *data, const scalar_t mean, const scalar_t s
         data[j + 8] = radius * std::sin(theta) * std + mean;
     }
 }
+// Box-Muller on blocks of 16 uniforms, a group of the stream holds whole blocks so the
+// tail needs no extra samples.
 template <typename scalar_t, typename RNG>
-void normal_fill(const TensorBase &self, const scalar_t mean, const scalar_t std, RNG generator) {
-    scalar_t *data = self.data_ptr<scalar_t>();
-    auto size = self.numel();
-    std::lock_guard<std::mutex> lock(generator->mutex_);
-    for (const auto i : otter::irange(size)) {
-        otter::uniform_real_distribution<scalar_t> uniform(0, 1);
-        data[i] = uniform(generator);
-    }
-    for (int64_t i = 0; i < size - 15; i += 16) {
-        normal_fill_16<scalar_t>(data + i, mean, std);
+void normal_fill(scalar_t* data, int64_t size, const scalar_t mean, const scalar_t std, RNG generator) {
+    constexpr int words = std::is_same<scalar_t, double>::value ? 2 : 1;
+    using raw_t = typename std::conditional<words == 2, uint64_t, uint32_t>::type;
+    constexpr int per_group = PHILOX_GROUP_WORDS / words;
+    static_assert(per_group % 16 == 0, "normal_fill expects whole blocks of 16 samples per group");
+    
+    auto uniform = [](raw_t raw) {
+        return static_cast<scalar_t>(transformation::uniform_real<scalar_t>(raw, 0, 1));
+    };
+    
+#if __AVX2__ && __FMA__
+    if constexpr (std::is_same<scalar_t, float>::value) {
+        const __m256 two_pi = _mm256_set1_ps(2.0f * static_cast<double>(M_PI));
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 minus_two = _mm256_set1_ps(-2.0f);
+        const __m256 mean_v = _mm256_set1_ps(mean);
+        const __m256 std_v = _mm256_set1_ps(std);
+        philox_fill<scalar_t, words>(data, size, generator, uniform, [&](scalar_t* buffer) {
+            for (int i = 0; i < per_group; i += 16) {
+                normal_fill_16_AVX2(buffer + i, &two_pi, &one, &minus_two, &mean_v, &std_v);
+            }
+        });
+        return;
     }
-    if (size % 16 != 0) {
-        // Recompute the last 16 values.
-        data = data + size - 16;
-        for (const auto i : otter::irange(16)) {
-            otter::uniform_real_distribution<scalar_t> uniform(0, 1);
-            data[i] = uniform(generator);
+#endif
+    philox_fill<scalar_t, words>(data, size, generator, uniform, [mean, std](scalar_t* buffer) {
+        for (int i = 0; i < per_group; i += 16) {
+            normal_fill_16<scalar_t>(buffer + i, mean, std);
         }
-        normal_fill_16<scalar_t>(data, mean, std);
-    }
+    });
 }
 template<typename RNG>
 void normal_kernel(const TensorBase &self, double mean, double std, RNG generator) {
-    auto size = self.numel();
-    if (self.scalar_type() == ScalarType::Float && size >= 16 && self.is_contiguous()) {
-#ifdef CPU_CAPABILITY_AVX2
-        normal_fill_AVX2(self, static_cast<float>(mean), static_cast<float>(std), generator);
-#else
-        normal_fill(self, static_cast<float>(mean), static_cast<float>(std), generator);
-#endif
-    } else {
-        OTTER_DISPATCH_FLOATING_TYPES(self.scalar_type(), "normal_kernel_cpu", [&] {
-            if (size >= 16 && self.is_contiguous()) {
-                normal_fill<scalar_t>(self, static_cast<scalar_t>(mean), static_cast<scalar_t>(std), generator);
-            } else {
-                auto iter = TensorIterator::borrowing_nullary_op(self);
-                std::lock_guard<std::mutex> lock(generator->mutex_);
-                cpu_serial_kernel(iter, [mean, std, generator]() -> scalar_t {
-                    otter::normal_distribution<double> normal(mean, std);
-                    return static_cast<scalar_t>(normal(generator));
-                });
-            }
+    OTTER_DISPATCH_FLOATING_TYPES(self.scalar_type(), "normal_kernel_cpu", [&] {
+        philox_fill_tensor<scalar_t>(self, [&](scalar_t* data, int64_t size) {
+            normal_fill<scalar_t>(data, size, static_cast<scalar_t>(mean), static_cast<scalar_t>(std), generator);
         });
-    }
+    });
 }
 template<typename RNG>
 struct NormalKernel {
@@ -404,12 +438,18 @@ struct NormalKernel {
 template<typename RNG>
 void uniform_kernel(TensorIterator& iter, double from_, double to_, RNG generator) {
     OTTER_DISPATCH_FLOATING_TYPES(iter.dtype(), "uniform_kernel_cpu", [&]() {
-        std::lock_guard<std::mutex> lock(generator->mutex_);
         auto from = static_cast<scalar_t>(from_);
         auto to = static_cast<scalar_t>(to_);
-        otter::uniform_real_distribution<scalar_t> uniform(from, to);
-        cpu_serial_kernel(iter, [&uniform, generator]() -> scalar_t {
-            return static_cast<scalar_t>(uniform(generator));
+        philox_fill_tensor<scalar_t>(iter.tensor_base(0), [&](scalar_t* data, int64_t size) {
+            if (std::is_same<scalar_t, double>::value) {
+                philox_fill<scalar_t, 2>(data, size, generator, [from, to](uint64_t raw) {
+                    return static_cast<scalar_t>(transformation::uniform_real<scalar_t>(raw, from, to));
+                });
+            } else {
+                philox_fill<scalar_t, 1>(data, size, generator, [from, to](uint32_t raw) {
+                    return static_cast<scalar_t>(transformation::uniform_real<scalar_t>(raw, from, to));
+                });
+            }
         });
     });
 }
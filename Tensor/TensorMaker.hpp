@@ -37,6 +37,14 @@ public:
         return *this;
     }
     
+    // Called with the data pointer when the last reference to the memory goes away,
+    // used to keep the owner of external memory alive.
+    TensorMaker& deleter(std::function<void(void*)> deleter) noexcept {
+        deleter_ = std::move(deleter);
+        
+        return *this;
+    }
+    
     Tensor make_tensor();
 private:
     explicit TensorMaker(void* data, IntArrayRef sizes) noexcept : data_(data), sizes_(sizes) {}
@@ -83,6 +91,12 @@ inline Tensor from_blob(void* data, IntArrayRef sizes, IntArrayRef strides, Scal
     return from_blob(data, sizes, strides, options);
 }
 
+inline Tensor from_blob(void* data, IntArrayRef sizes, IntArrayRef strides, const std::function<void(void*)>& deleter, ScalarType dtype) {
+    TensorOptions options(dtype);
+    
+    return for_blob(data, sizes).strides(strides).deleter(deleter).options(options).make_tensor();
+}
+
 Tensor from_float16(const unsigned short* data, IntArrayRef size);
 
 template <typename T>
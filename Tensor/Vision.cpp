@@ -6,10 +6,14 @@
 //
 
 #include "Vision.hpp"
+#include "Parallel.hpp"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_NO_THREAD_LOCALS
+// Resampling, color conversion and progressive IDCT rows run on the otter thread pool
+#define STBI_PARALLEL_ROWS(n, func, ctx) \
+    otter::parallel_for(0, (n), 16, [&](int64_t begin, int64_t end) { (func)((ctx), (int)begin, (int)end); })
 #define STBI_ONLY_JPEG
 #define STBI_ONLY_PNG
 #define STBI_ONLY_BMP
@@ -24,8 +28,10 @@
 #define STBI_NEON
 #endif
 
+#include "TensorFactory.hpp"
 #include "TensorMaker.hpp"
 #include "TensorPixel.hpp"
+#include "TensorInterpolation.hpp"
 
 namespace otter {
 namespace cv {
@@ -82,6 +88,125 @@ Tensor load_image_rgb(const char* filename) {
     return img;
 }
 
+// Header of an opened image, the file is left at its start for the decoder
+static bool image_header(FILE* f, bool& jpeg, int& h, int& w, int& c) {
+    unsigned char magic[2] = {0, 0};
+    size_t count = fread(magic, 1, 2, f);
+    fseek(f, 0, SEEK_SET);
+    jpeg = count == 2 && magic[0] == 0xFF && magic[1] == 0xD8;
+    
+    return stbi_info_from_file(f, &w, &h, &c) != 0;
+}
+
+static int decode_scale_shift(bool jpeg, int h, int w, int target_h, int target_w) {
+    if (!jpeg)
+        return 0;
+    
+    int scale_shift = 3;
+    for (; scale_shift > 0; --scale_shift) {
+        const int scale = 1 << scale_shift;
+        if ((h + scale - 1) / scale >= target_h && (w + scale - 1) / scale >= target_w)
+            break;
+    }
+    
+    return scale_shift;
+}
+
+static bool decode_pixel_into(FILE* f, bool jpeg, int scale_shift, unsigned char* dst, int dst_stride, int channels) {
+    int w, h, c;
+    
+    if (jpeg) {
+        return stbi_load_jpeg_scaled_from_file(f, &w, &h, &c, channels, scale_shift, dst, dst_stride) != nullptr;
+    }
+    
+    OTTER_CHECK(scale_shift == 0, "Reduced size decoding is only supported for JPEG");
+    unsigned char *data = stbi_load_from_file(f, &w, &h, &c, channels);
+    if (!data) return false;
+    
+    for (int y = 0; y < h; ++y) {
+        memcpy(dst + (size_t)y * dst_stride, data + (size_t)y * w * channels, (size_t)w * channels);
+    }
+    stbi_image_free(data);
+    
+    return true;
+}
+
+bool image_decode_size(const char* filename, int scale_shift, int& h, int& w, int& c) {
+    FILE* f = stbi__fopen(filename, "rb");
+    if (!f)
+        return false;
+    
+    bool jpeg;
+    bool ok = image_header(f, jpeg, h, w, c);
+    fclose(f);
+    if (!ok)
+        return false;
+    
+    const int scale = 1 << scale_shift;
+    h = (h + scale - 1) >> scale_shift;
+    w = (w + scale - 1) >> scale_shift;
+    
+    return true;
+}
+
+int image_decode_scale(const char* filename, int target_h, int target_w) {
+    FILE* f = stbi__fopen(filename, "rb");
+    if (!f)
+        return 0;
+    
+    bool jpeg;
+    int h, w, c;
+    bool ok = image_header(f, jpeg, h, w, c);
+    fclose(f);
+    
+    return ok ? decode_scale_shift(jpeg, h, w, target_h, target_w) : 0;
+}
+
+bool load_image_pixel_into(const char* filename, int scale_shift, unsigned char* dst, int dst_stride, int channels) {
+    FILE* f = stbi__fopen(filename, "rb");
+    if (!f)
+        return false;
+    
+    bool jpeg;
+    int h, w, c;
+    bool ok = image_header(f, jpeg, h, w, c);
+    OTTER_CHECK(!ok || jpeg || scale_shift == 0, "Reduced size decoding is only supported for JPEG, got ", filename);
+    if (ok)
+        ok = decode_pixel_into(f, jpeg, scale_shift, dst, dst_stride, channels);
+    fclose(f);
+    
+    return ok;
+}
+
+Tensor load_image_rgb(const char* filename, int target_h, int target_w) {
+    // One open for the header, the scale decision and the decoding
+    FILE* f = stbi__fopen(filename, "rb");
+    OTTER_CHECK(f, "Cannot open image ", filename);
+    
+    bool jpeg;
+    int h, w, c;
+    if (!image_header(f, jpeg, h, w, c)) {
+        fclose(f);
+        OTTER_CHECK(false, "Cannot load image ", filename, " STB Reason: ", stbi_failure_reason());
+    }
+    
+    const int scale_shift = decode_scale_shift(jpeg, h, w, target_h, target_w);
+    const int scale = 1 << scale_shift;
+    h = (h + scale - 1) >> scale_shift;
+    w = (w + scale - 1) >> scale_shift;
+    
+    auto pixel = otter::empty({h, w, 3}, otter::ScalarType::Byte);
+    bool ok = decode_pixel_into(f, jpeg, scale_shift, pixel.data_ptr<unsigned char>(), w * 3, 3);
+    fclose(f);
+    OTTER_CHECK(ok, "Cannot load image ", filename, " STB Reason: ", stbi_failure_reason());
+    
+    auto img = otter::cv::from_rgb(pixel.data_ptr<unsigned char>(), h, w, w * 3);
+    if (h == target_h && w == target_w)
+        return img;
+    
+    return otter::Interpolate(img, {target_h, target_w}, {0, 0}, otter::InterpolateMode::BILINEAR, false);
+}
+
 Tensor check_save_img_and_try_to_fix(const Tensor& img_) {
     OTTER_CHECK(img_.dim() <= 4, "Expect the dimension of image <= 4, but get ", img_.dim());
     
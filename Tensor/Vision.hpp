@@ -36,6 +36,21 @@ enum class IMG_TYPE {
 // Recommended for neural network input!
 Tensor load_image_rgb(const char* filename);
 
+// Translate HWC -> NCHW and bilinear resize to (target_h, target_w)
+// JPEG are decoded at 1/2, 1/4 or 1/8 scale with a reduced IDCT when the decoded size still covers the target
+Tensor load_image_rgb(const char* filename, int target_h, int target_w);
+
+// Largest scale_shift (0 to 3) whose decoded size still covers (target_h, target_w)
+// Always 0 for other formats than JPEG
+int image_decode_scale(const char* filename, int target_h, int target_w);
+
+// Size of the image decoded at 1 / (1 << scale_shift) of its size
+bool image_decode_size(const char* filename, int scale_shift, int& h, int& w, int& c);
+
+// Decode straight into a caller-provided HWC buffer with dst_stride bytes per row
+// The buffer should hold the image_decode_size of scale_shift with channels channels
+bool load_image_pixel_into(const char* filename, int scale_shift, unsigned char* dst, int dst_stride, int channels = 3);
+
 // Raw data HWC
 // For tranditional image process
 Tensor load_image_pixel(const char* filename);
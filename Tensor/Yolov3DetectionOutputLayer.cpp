@@ -10,6 +10,7 @@
 #include "TensorFactory.hpp"
 #include "TensorInterpolation.hpp"
 #include "TensorMaker.hpp"
+#include "ProposalDecode.hpp"
 
 #include <float.h>
 
@@ -26,6 +27,7 @@ int Yolov3DetectionOutputLayer::parse_param(LayerOption& option, ParamDict& pd)
     int num_box = opt_find_int(option, "num_box", 3);
     float confidence_threshold = opt_find_float(option, "confidence_threshold", 0.25f);
     float nms_threshold = opt_find_float(option, "nms_threshold", 0.45f);
+    int nms_top_k = opt_find_int(option, "nms_top_k", -1);
     float scale_x_y = opt_find_float(option, "scale_x_y", 1);
     
     int input_height = opt_find_int(option, "input_height", 416);
@@ -84,6 +86,7 @@ int Yolov3DetectionOutputLayer::parse_param(LayerOption& option, ParamDict& pd)
     pd.set((int)Yolov3DetectionParam::Num_box, num_box);
     pd.set((int)Yolov3DetectionParam::Confidence_threshold, confidence_threshold);
     pd.set((int)Yolov3DetectionParam::Nms_threshold, nms_threshold);
+    pd.set((int)Yolov3DetectionParam::Nms_top_k, nms_top_k);
     pd.set((int)Yolov3DetectionParam::Scale_x_y, scale_x_y);
     pd.set((int)Yolov3DetectionParam::Input_height, input_height);
     pd.set((int)Yolov3DetectionParam::Input_width, input_width);
@@ -105,6 +108,7 @@ int Yolov3DetectionOutputLayer::load_param(const ParamDict &pd) {
     num_box = pd.get((int)Yolov3DetectionParam::Num_box, 90);
     confidence_threshold = pd.get((int)Yolov3DetectionParam::Confidence_threshold, 0.25f);
     nms_threshold = pd.get((int)Yolov3DetectionParam::Nms_threshold, 0.45f);
+    nms_top_k = pd.get((int)Yolov3DetectionParam::Nms_top_k, -1);
     
     biases = pd.get((int)Yolov3DetectionParam::Biases, Tensor());
     mask = pd.get((int)Yolov3DetectionParam::Mask, Tensor());
@@ -113,101 +117,31 @@ int Yolov3DetectionOutputLayer::load_param(const ParamDict &pd) {
     return 0;
 }
 
-static inline float intersection_area(const Yolov3DetectionOutputLayer::BBox& a, const Yolov3DetectionOutputLayer::BBox& b) {
-    if (a.xmin > b.xmax || a.xmax < b.xmin || a.ymin > b.ymax || a.ymax < b.ymin) {
-        // no intersection
-        return 0.f;
-    }
-    
-    float inter_width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
-    float inter_height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
-    
-    return inter_width * inter_height;
-}
-
-void Yolov3DetectionOutputLayer::qsort_descent_inplace(std::vector<BBox>& datas, int left, int right) const {
-    int i = left;
-    int j = right;
-    float p = datas[(left + right) / 2].score;
-    
-    while (i <= j) {
-        while (datas[i].score > p)
-            i++;
-        
-        while (datas[j].score < p)
-            j--;
-        
-        if (i <= j) {
-            std::swap(datas[i], datas[j]);
-            
-            i++;
-            j--;
-        }
-    }
-    
-    if (left < j)
-        qsort_descent_inplace(datas, left, j);
-    
-    if (i < right)
-        qsort_descent_inplace(datas, i, right);
-}
-
-void Yolov3DetectionOutputLayer::qsort_descent_inplace(std::vector<BBox>& datas) const {
-    if (datas.empty())
-        return;
-    
-    qsort_descent_inplace(datas, 0, static_cast<int>(datas.size() - 1));
-}
-
-void Yolov3DetectionOutputLayer::nms_sorted_bboxes(std::vector<BBox>& bboxes, std::vector<size_t>& picked, float nms_threshold) const {
-    picked.clear();
-    
-    const size_t n = bboxes.size();
-    
-    for (size_t i = 0; i < n; i++) {
-        const BBox& a = bboxes[i];
-        
-        int keep = 1;
-        for (int j = 0; j < (int)picked.size(); j++) {
-            const BBox& b = bboxes[picked[j]];
-            
-            // intersection over union
-            float inter_area = intersection_area(a, b);
-            float union_area = a.area + b.area - inter_area;
-            // float IoU = inter_area / union_area
-            if (inter_area > nms_threshold * union_area) {
-                keep = 0;
-                break;
-            }
-        }
-        
-        if (keep)
-            picked.push_back(i);
-    }
-}
-
 static inline float sigmoid(float x) {
     return static_cast<float>(1.f / (1.f + exp(-x)));
 }
 
 int Yolov3DetectionOutputLayer::forward(const std::vector<Tensor>& bottom_blobs, std::vector<Tensor>& top_blobs, const NetOption& /*opt*/) const {
     
-    std::vector<BBox> all_bbox;
+    struct DecodeTask {
+        int level;
+        int box;
+        int row_begin;
+        int row_end;
+    };
     
     auto mask_a = mask.accessor<int, 1>();
     auto biases_a = biases.accessor<int, 1>();
     auto anchors_scale_a = anchors_scale.accessor<float, 1>();
     
-    for (const auto i : otter::irange(bottom_blobs.size())) {
-        std::vector<std::vector<BBox> > bbox_map;
-        bbox_map.resize(num_box);
-        
-        const Tensor& bottom = bottom_blobs[i];
-        auto bottom_a = bottom.accessor<float, 4>()[0]; // assume batch_size = 1
+    const int num_level = (int)bottom_blobs.size();
+    
+    std::vector<Tensor> bottoms(num_level);
+    int total_row = 0;
+    for (const auto i : otter::irange(num_level)) {
+        bottoms[i] = bottom_blobs[i].contiguous();  // assume batch_size = 1
         
-        int channels = (int)bottom.size(1);
-        int height   = (int)bottom.size(2);
-        int width    = (int)bottom.size(3);
+        int channels = (int)bottoms[i].size(1);
         const int channels_per_box = channels / num_box;
         
         if (channels_per_box != 4 + 1 + num_class) {
@@ -215,97 +149,118 @@ int Yolov3DetectionOutputLayer::forward(const std::vector<Tensor>& bottom_blobs,
             return -1;
         }
         
-        size_t mask_offset = i * num_box;
-        int net_h = (int)(anchors_scale_a[i] * width);
-        int net_w = (int)(anchors_scale_a[i] * height);
-        
-        otter::parallel_for(0, num_box, 0, [&](int64_t start, int64_t end) {
-            for (const auto pp : otter::irange(start, end)) {
-                int p = (int)pp * channels_per_box;
-                int biases_index = static_cast<int>(mask_a[pp + mask_offset]);
-                
-                const float bias_w = biases_a[biases_index * 2];
-                const float bias_h = biases_a[biases_index * 2 + 1];
-                
-                const float* xptr = bottom_a[p].data();
-                const float* yptr = bottom_a[p + 1].data();
-                const float* wptr = bottom_a[p + 2].data();
-                const float* hptr = bottom_a[p + 3].data();
-                
-                const float* box_score_ptr = bottom_a[p + 4].data();
+        total_row += num_box * (int)bottoms[i].size(2);
+    }
+    
+    // split every (level, box) plane into row ranges, the task order follows the output order
+    const int rows_per_task = std::max(1, total_row / (otter::get_num_threads() * 4));
+    
+    static thread_local std::vector<DecodeTask> thread_tasks;
+    std::vector<DecodeTask>& tasks = thread_tasks;
+    tasks.clear();
+    for (const auto i : otter::irange(num_level)) {
+        int height = (int)bottoms[i].size(2);
+        for (const auto pp : otter::irange(num_box)) {
+            for (int row = 0; row < height; row += rows_per_task) {
+                tasks.push_back({(int)i, (int)pp, row, std::min(height, row + rows_per_task)});
+            }
+        }
+    }
+    
+    // kept per calling thread across frames, the workers reach it through this reference
+    static thread_local ProposalDecodeScratch thread_scratch;
+    ProposalDecodeScratch& scratch = thread_scratch;
+    scratch.ensure((int)tasks.size());
+    
+    const float logit_threshold = sigmoid_threshold_logit(confidence_threshold);
+    
+    otter::parallel_for(0, tasks.size(), 0, [&](int64_t begin, int64_t end) {
+        for (const auto t : otter::irange(begin, end)) {
+            const DecodeTask& task = tasks[t];
+            BoxArray& bbox_list = scratch.chunk_proposals[t];
+            bbox_list.clear();
+            
+            const Tensor& bottom = bottoms[task.level];
+            
+            int channels = (int)bottom.size(1);
+            int height   = (int)bottom.size(2);
+            int width    = (int)bottom.size(3);
+            const int channels_per_box = channels / num_box;
+            const int64_t cstep = (int64_t)width * height;
+            
+            size_t mask_offset = task.level * num_box;
+            int net_h = (int)(anchors_scale_a[task.level] * width);
+            int net_w = (int)(anchors_scale_a[task.level] * height);
+            
+            int p = task.box * channels_per_box;
+            int biases_index = static_cast<int>(mask_a[task.box + mask_offset]);
+            
+            const float bias_w = biases_a[biases_index * 2];
+            const float bias_h = biases_a[biases_index * 2 + 1];
+            
+            const float* ptr = bottom.data_ptr<float>() + p * cstep;
+            
+            ProposalRowScratch& rows = scratch.chunk_rows[t];
+            rows.ensure(width);
+            float* max_score = rows.max_score.data();
+            int* max_label = rows.max_label.data();
+            int* candidates = rows.candidates.data();
+            
+            for (int i = task.row_begin; i < task.row_end; i++) {
+                const float* xptr = ptr + i * width;
+                const float* yptr = xptr + cstep;
+                const float* wptr = xptr + 2 * cstep;
+                const float* hptr = xptr + 3 * cstep;
+                const float* box_score_ptr = xptr + 4 * cstep;
+                const float* scores_ptr = xptr + 5 * cstep;
                 
-                Tensor scores = bottom[0].slice(0, p + 5, p + 5 + num_class);
-                auto scores_a = scores.accessor<float, 3>();
+                // find class index with max class score, both sigmoid factors have to pass the threshold
+                class_argmax_row(scores_ptr, cstep, num_class, width, max_score, max_label);
+                int num_candidate = select_candidates(max_score, width, logit_threshold, candidates);
                 
-                for (int i = 0; i < height; i++) {
-                    for (int j = 0; j < width; j++) {
-                        // find class index with max class score
-                        int class_index = 0;
-                        float class_score = -FLT_MAX;
-                        for (int q = 0; q < num_class; q++) {
-                            float score = scores_a[q][i][j];
-                            if (score > class_score) {
-                                class_index = q;
-                                class_score = score;
-                            }
-                        }
-                        
-                        //sigmoid(box_score) * sigmoid(class_score)
-                        float confidence = 1.f / ((1.f + exp(-box_score_ptr[0]) * (1.f + exp(-class_score))));
-                        if (confidence >= confidence_threshold) {
-                            // region box
-                            float bbox_cx = (j + sigmoid(xptr[0])) / width;
-                            float bbox_cy = (i + sigmoid(yptr[0])) / height;
-                            float bbox_w = static_cast<float>(exp(wptr[0]) * bias_w / net_w);
-                            float bbox_h = static_cast<float>(exp(hptr[0]) * bias_h / net_h);
-                            
-                            float bbox_xmin = bbox_cx - bbox_w * 0.5f;
-                            float bbox_ymin = bbox_cy - bbox_h * 0.5f;
-                            float bbox_xmax = bbox_cx + bbox_w * 0.5f;
-                            float bbox_ymax = bbox_cy + bbox_h * 0.5f;
-                            
-                            float area = bbox_w * bbox_h;
-                            
-                            BBox c = {class_index, confidence, bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, area};
-                            bbox_map[pp].push_back(c);
-                        }
+                for (int c = 0; c < num_candidate; c++) {
+                    const int j = candidates[c];
+                    
+                    if (box_score_ptr[j] < logit_threshold)
+                        continue;
+                    
+                    //sigmoid(box_score) * sigmoid(class_score)
+                    float confidence = 1.f / ((1.f + exp(-box_score_ptr[j])) * (1.f + exp(-max_score[j])));
+                    if (confidence >= confidence_threshold) {
+                        // region box
+                        float bbox_cx = (j + sigmoid(xptr[j])) / width;
+                        float bbox_cy = (i + sigmoid(yptr[j])) / height;
+                        float bbox_w = static_cast<float>(exp(wptr[j]) * bias_w / net_w);
+                        float bbox_h = static_cast<float>(exp(hptr[j]) * bias_h / net_h);
                         
-                        xptr++;
-                        yptr++;
-                        wptr++;
-                        hptr++;
+                        float bbox_xmin = bbox_cx - bbox_w * 0.5f;
+                        float bbox_ymin = bbox_cy - bbox_h * 0.5f;
+                        float bbox_xmax = bbox_cx + bbox_w * 0.5f;
+                        float bbox_ymax = bbox_cy + bbox_h * 0.5f;
                         
-                        box_score_ptr++;
+                        bbox_list.push_back(bbox_xmin, bbox_ymin, bbox_xmax, bbox_ymax, confidence, max_label[j]);
                     }
                 }
             }
-        });
-        
-        for (int i = 0; i < num_box; i++) {
-            const std::vector<BBox>& bbox_list = bbox_map[i];
-            
-            all_bbox.insert(all_bbox.end(), bbox_list.begin(), bbox_list.end());
         }
-    }
-    
-    // global sort inplace
-    qsort_descent_inplace(all_bbox);
+    });
     
-    // apply nms
-    std::vector<size_t> picked;
-    nms_sorted_bboxes(all_bbox, picked, nms_threshold);
+    BoxArray& all_bbox = scratch.proposals;
+    all_bbox.clear();
+    for (const auto t : otter::irange(tasks.size())) {
+        all_bbox.append(scratch.chunk_proposals[t]);
+    }
     
-    // select
-    std::vector<BBox> bbox_selected;
+    // apply nms, picked is sorted by score from highest to lowest
+    NmsOption nms_opt;
+    nms_opt.iou_threshold = nms_threshold;
+    nms_opt.top_k = nms_top_k;
     
-    for (size_t i = 0; i < picked.size(); i++)
-    {
-        size_t z = picked[i];
-        bbox_selected.push_back(all_bbox[z]);
-    }
+    std::vector<int>& picked = scratch.picked;
+    non_max_suppression(all_bbox, picked, nms_opt);
     
     // fill result
-    int num_detected = static_cast<int>(bbox_selected.size());
+    int num_detected = static_cast<int>(picked.size());
     if (num_detected == 0)
         return 0;
     
@@ -317,16 +272,15 @@ int Yolov3DetectionOutputLayer::forward(const std::vector<Tensor>& bottom_blobs,
     auto top_blob_a = top_blob.accessor<float, 2>();
     
     for (int i = 0; i < num_detected; i++) {
-        const BBox& r = bbox_selected[i];
-        float score = r.score;
+        const int k = picked[i];
         float* outptr = top_blob_a[i].data();
         
-        outptr[0] = static_cast<float>(r.label + 1); // +1 for prepend background class
-        outptr[1] = score;
-        outptr[2] = r.xmin;
-        outptr[3] = r.ymin;
-        outptr[4] = r.xmax;
-        outptr[5] = r.ymax;
+        outptr[0] = static_cast<float>(all_bbox.label[k] + 1); // +1 for prepend background class
+        outptr[1] = all_bbox.score[k];
+        outptr[2] = all_bbox.x0[k];
+        outptr[3] = all_bbox.y0[k];
+        outptr[4] = all_bbox.x1[k];
+        outptr[5] = all_bbox.y1[k];
     }
     
     return 0;
@@ -9,6 +9,7 @@
 #define Yolov3DetectionOutputLayer_hpp
 
 #include "Layer.hpp"
+#include "NonMaxSuppression.hpp"
 
 namespace otter {
 
@@ -31,27 +32,13 @@ public:
     int num_box;
     float confidence_threshold;
     float nms_threshold;
+    int nms_top_k;
     
     float scale_x_y;
     
     Tensor biases;
     Tensor mask;
     Tensor anchors_scale;
-    
-public:
-    struct BBox {
-        int label;
-        float score;
-        float xmin;
-        float ymin;
-        float xmax;
-        float ymax;
-        float area;
-    };
-    
-    void qsort_descent_inplace(std::vector<BBox>& datas, int left, int right) const;
-    void qsort_descent_inplace(std::vector<BBox>& datas) const;
-    void nms_sorted_bboxes(std::vector<BBox>& bboxes, std::vector<size_t>& picked, float nms_threshold) const;
 };
 
 enum class Yolov3DetectionParam {
@@ -64,7 +51,8 @@ enum class Yolov3DetectionParam {
     Anchors_scale,
     Scale_x_y,
     Input_height,
-    Input_width
+    Input_width,
+    Nms_top_k
 };
 
 Tensor yolo_pre_process(const Tensor& img, int target_size);
@@ -104,6 +104,14 @@ Tensor& im2col_out_cpu_unfold2d_template(const Tensor& input, IntArrayRef kernel
     int64_t pad_width = padding[1];
     int64_t dilation_height = dilation[0];
     int64_t dilation_width = dilation[1];
+    
+    // unfold2d only walks undilated windows
+    if (dilation_height != 1 || dilation_width != 1) {
+        output = otter::empty({}, input.options());
+        im2col_out_cpu_template(output, input, kernel_size, stride, padding, dilation);
+        return output;
+    }
+    
     int64_t output_height = (input_height + 2 * pad_height - (dilation_height * (kernel_height - 1) + 1)) / stride_height + 1;
     int64_t output_width = (input_width + 2 * pad_width - (dilation_width * (kernel_width - 1) + 1)) / stride_width + 1;
     
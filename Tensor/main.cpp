@@ -199,76 +199,27 @@ int main(int argc, const char * argv[]) {
     auto feature_extractor = backbone_neck.create_extractor();
     feature_extractor.input("data_1", in);
 
-    otter::Tensor fpn_0, fpn_1, fpn_2, fpn_3, fpn_4;
-    feature_extractor.extract("conv_58", fpn_0, 1);
-    feature_extractor.extract("conv_59", fpn_1, 1);
-    feature_extractor.extract("conv_60", fpn_2, 1);
-    feature_extractor.extract("conv_61", fpn_3, 1);
-    feature_extractor.extract("pool_2", fpn_4, 1);
+    std::vector<otter::Tensor> feats;
+    feature_extractor.extract(std::vector<std::string>{"conv_58", "conv_59", "conv_60", "conv_61", "pool_2"}, feats, 1);
 
     conv_block.stop_and_show("ms (conv block)");
 
-//    cout << fpn_0 << endl;
-
-    std::vector<otter::Tensor> feats;
-    feats.push_back(fpn_0);
-    feats.push_back(fpn_1);
-    feats.push_back(fpn_2);
-    feats.push_back(fpn_3);
-    feats.push_back(fpn_4);
+//    cout << feats[0] << endl;
 
     otter::Clock rpn_clock;
     std::vector<otter::Tensor> cls_scores, bbox_preds;
     {
-        otter::Tensor rpn_0_cls, rpn_0_reg;
-        otter::Tensor rpn_1_cls, rpn_1_reg;
-        otter::Tensor rpn_2_cls, rpn_2_reg;
-        otter::Tensor rpn_3_cls, rpn_3_reg;
-        otter::Tensor rpn_4_cls, rpn_4_reg;
-        {
-            auto rpn_extractor = rpn.create_extractor();
-            rpn_extractor.input("data_1", fpn_0);
-
-            rpn_extractor.extract("conv_3", rpn_0_cls, 0);
-            rpn_extractor.extract("conv_2", rpn_0_reg, 0);
-            cls_scores.push_back(rpn_0_cls);
-            bbox_preds.push_back(rpn_0_reg);
-        }
-        {
-            auto rpn_extractor = rpn.create_extractor();
-            rpn_extractor.input("data_1", fpn_1);
-
-            rpn_extractor.extract("conv_3", rpn_1_cls, 0);
-            rpn_extractor.extract("conv_2", rpn_1_reg, 0);
-            cls_scores.push_back(rpn_1_cls);
-            bbox_preds.push_back(rpn_1_reg);
-        }
-        {
-            auto rpn_extractor = rpn.create_extractor();
-            rpn_extractor.input("data_1", fpn_2);
-
-            rpn_extractor.extract("conv_3", rpn_2_cls, 0);
-            rpn_extractor.extract("conv_2", rpn_2_reg, 0);
-            cls_scores.push_back(rpn_2_cls);
-            bbox_preds.push_back(rpn_2_reg);
-        }
-        {
-            auto rpn_extractor = rpn.create_extractor();
-            rpn_extractor.input("data_1", fpn_3);
-
-            rpn_extractor.extract("conv_3", rpn_3_cls, 0);
-            rpn_extractor.extract("conv_2", rpn_3_reg, 0);
-            cls_scores.push_back(rpn_3_cls);
-            bbox_preds.push_back(rpn_3_reg);
-        }
-        {
+        otter::BlobHandle rpn_input = rpn.blob_handle("data_1");
+        std::vector<otter::BlobHandle> rpn_outputs = {rpn.blob_handle("conv_3"), rpn.blob_handle("conv_2")};
+        
+        for (const auto& fpn : feats) {
             auto rpn_extractor = rpn.create_extractor();
-            rpn_extractor.input("data_1", fpn_4);
-
-            rpn_extractor.extract("conv_3", rpn_4_cls, 0);
-            rpn_extractor.extract("conv_2", rpn_4_reg, 0);
-            cls_scores.push_back(rpn_4_cls);
-            bbox_preds.push_back(rpn_4_reg);
+            rpn_extractor.input(rpn_input, fpn);
+            
+            std::vector<otter::Tensor> rpn_predict;
+            rpn_extractor.extract(rpn_outputs, rpn_predict, 0);
+            cls_scores.push_back(rpn_predict[0]);
+            bbox_preds.push_back(rpn_predict[1]);
         }
     }
     rpn_clock.stop_and_show("ms (rpn)");
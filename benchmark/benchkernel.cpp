@@ -0,0 +1,554 @@
+#include "OTensor.hpp"
+#include "Benchmark.hpp"
+#include "ConvolutionLayer.hpp"
+#include "ConvolutionMM2D.hpp"
+#include "TensorPacking.hpp"
+
+#if __SSE2__
+#include <immintrin.h>
+#endif
+#if __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Microbenchmark of the individual convolution, depthwise, int8, packing and gemm kernels.
+// The convolution kernels are driven through ConvolutionLayer so that the weights are
+// transformed once by create_pipeline, like in a loaded net, and only the kernel is timed.
+
+struct ConvCase {
+    const char* name;
+    int in_channels;
+    int out_channels;
+    int height;
+    int width;
+    int kernel;
+    int stride;
+    int groups;
+    bool int8;
+};
+
+struct GemmCase {
+    const char* name;
+    int m;
+    int n;
+    int k;
+};
+
+struct PackingCase {
+    const char* name;
+    int channels;
+    int height;
+    int width;
+    int elempack;
+    int out_elempack;
+};
+
+static const ConvCase conv_cases[] = {
+    // name                     in   out  h    w    k  s  g    int8
+    {"conv3x3s2_3x16_224",       3,   16, 224, 224, 3, 2, 1,   false},
+    {"conv3x3s1_12x24_56",       12,  24, 56,  56,  3, 1, 1,   false},
+    {"conv3x3s1_32x32_56",       32,  32, 56,  56,  3, 1, 1,   false},
+    {"conv3x3s1_64x64_56",       64,  64, 56,  56,  3, 1, 1,   false},
+    {"conv3x3s2_64x128_56",      64,  128, 56, 56,  3, 2, 1,   false},
+    {"conv3x3s1_64x12_28",       64,  12, 28,  28,  3, 1, 1,   false},
+    {"conv5x5s1_32x32_28",       32,  32, 28,  28,  5, 1, 1,   false},
+    {"conv1x1s1_32x64_56",       32,  64, 56,  56,  1, 1, 1,   false},
+    {"conv1x1s1_128x128_28",     128, 128, 28, 28,  1, 1, 1,   false},
+    {"conv1x1s2_64x128_56",      64,  128, 56, 56,  1, 2, 1,   false},
+    {"conv1x1s1_64x3_56",        64,  3,  56,  56,  1, 1, 1,   false},
+    {"dw3x3s1_64_112",           64,  64, 112, 112, 3, 1, 64,  false},
+    {"dw3x3s2_64_112",           64,  64, 112, 112, 3, 2, 64,  false},
+    {"dw3x3s1_12_56",            12,  12, 56,  56,  3, 1, 12,  false},
+    {"dw5x5s1_96_28",            96,  96, 28,  28,  5, 1, 96,  false},
+    {"dw5x5s2_96_56",            96,  96, 56,  56,  5, 2, 96,  false},
+    {"int8_conv3x3s1_32x32_56",  32,  32, 56,  56,  3, 1, 1,   true},
+    {"int8_conv3x3s2_3x16_224",  3,   16, 224, 224, 3, 2, 1,   true},
+    {"int8_conv1x1s1_64x64_56",  64,  64, 56,  56,  1, 1, 1,   true},
+    {"int8_conv1x1s1_64x3_56",   64,  3,  56,  56,  1, 1, 1,   true},
+    {"int8_dw3x3s1_64_112",      64,  64, 112, 112, 3, 1, 64,  true},
+};
+
+static const GemmCase gemm_cases[] = {
+    {"gemm_256x256x256",   256, 256,  256},
+    {"gemm_512x512x512",   512, 512,  512},
+    {"gemm_64x3136x576",   64,  3136, 576},
+};
+
+static const PackingCase packing_cases[] = {
+    {"packing_1to4_64x112",  64, 112, 112, 1, 4},
+    {"packing_4to1_64x112",  64, 112, 112, 4, 1},
+    {"packing_1to8_64x112",  64, 112, 112, 1, 8},
+    {"packing_8to1_64x112",  64, 112, 112, 8, 1},
+    {"packing_4to8_64x112",  64, 112, 112, 4, 8},
+    {"packing_8to4_64x112",  64, 112, 112, 8, 4},
+};
+
+struct BenchConfig {
+    std::vector<int> threads;
+    std::vector<int> packings;
+    std::string filter;
+    int loop_count = 10;
+    int warmup_count = 2;
+    double peak = 0;    // GFLOP/s per thread, measured when 0
+    bool verify = true;
+};
+
+struct Timing {
+    double min;
+    double median;
+};
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  -f, --filter STR      only run the cases whose name contains STR\n");
+    fprintf(stderr, "  -t, --threads 1,2,4   thread counts to sweep\n");
+    fprintf(stderr, "  -p, --packing 0,1     use_packing_layout values to sweep (default 0,1)\n");
+    fprintf(stderr, "  -l, --loops N         timed runs per configuration (default 10)\n");
+    fprintf(stderr, "  -w, --warmup N        warmup runs per configuration (default 2)\n");
+    fprintf(stderr, "      --peak GFLOPS     single thread peak, measured with a FMA loop by default\n");
+    fprintf(stderr, "      --no-verify       skip the comparison against slow_conv2d\n");
+    fprintf(stderr, "GFLOP/s counts the operations of a direct convolution, winograd kernels may exceed the peak.\n");
+    fprintf(stderr, "The int8 kernels count one multiply-add as two operations and are compared to the fp32 peak.\n");
+}
+
+static std::vector<int> parse_int_list(const char* str) {
+    std::vector<int> values;
+    const char* p = str;
+    while (*p) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p)
+            break;
+        values.push_back((int)v);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+template <typename Func>
+static Timing measure(const BenchConfig& config, Func func) {
+    for (int i = 0; i < config.warmup_count; i++)
+        func();
+
+    std::vector<double> times(config.loop_count);
+    for (int i = 0; i < config.loop_count; i++) {
+        double start = otter::get_current_time();
+        func();
+        times[i] = otter::get_current_time() - start;
+    }
+    std::sort(times.begin(), times.end());
+
+    return {times.front(), times[times.size() / 2]};
+}
+
+// Independent multiply-add chains, enough of them to hide the latency of the FMA units.
+static float peak_kernel(int64_t iters) {
+#if __AVX__
+    __m256 acc[10];
+    for (int j = 0; j < 10; j++)
+        acc[j] = _mm256_set1_ps((float)j);
+    const __m256 m = _mm256_set1_ps(0.999999f);
+    const __m256 a = _mm256_set1_ps(1e-6f);
+    for (int64_t i = 0; i < iters; i++) {
+        for (int j = 0; j < 10; j++) {
+#if __FMA__
+            acc[j] = _mm256_fmadd_ps(acc[j], m, a);
+#else
+            acc[j] = _mm256_add_ps(_mm256_mul_ps(acc[j], m), a);
+#endif
+        }
+    }
+    __m256 sum = acc[0];
+    for (int j = 1; j < 10; j++)
+        sum = _mm256_add_ps(sum, acc[j]);
+    return _mm256_cvtss_f32(sum);
+#elif __SSE2__
+    __m128 acc[10];
+    for (int j = 0; j < 10; j++)
+        acc[j] = _mm_set1_ps((float)j);
+    const __m128 m = _mm_set1_ps(0.999999f);
+    const __m128 a = _mm_set1_ps(1e-6f);
+    for (int64_t i = 0; i < iters; i++) {
+        for (int j = 0; j < 10; j++)
+            acc[j] = _mm_add_ps(_mm_mul_ps(acc[j], m), a);
+    }
+    __m128 sum = acc[0];
+    for (int j = 1; j < 10; j++)
+        sum = _mm_add_ps(sum, acc[j]);
+    return _mm_cvtss_f32(sum);
+#elif __ARM_NEON
+    float32x4_t acc[10];
+    for (int j = 0; j < 10; j++)
+        acc[j] = vdupq_n_f32((float)j);
+    const float32x4_t m = vdupq_n_f32(0.999999f);
+    const float32x4_t a = vdupq_n_f32(1e-6f);
+    for (int64_t i = 0; i < iters; i++) {
+        for (int j = 0; j < 10; j++)
+            acc[j] = vmlaq_f32(a, acc[j], m);
+    }
+    float32x4_t sum = acc[0];
+    for (int j = 1; j < 10; j++)
+        sum = vaddq_f32(sum, acc[j]);
+    return vgetq_lane_f32(sum, 0);
+#else
+    float acc[10];
+    for (int j = 0; j < 10; j++)
+        acc[j] = (float)j;
+    for (int64_t i = 0; i < iters; i++) {
+        for (int j = 0; j < 10; j++)
+            acc[j] = acc[j] * 0.999999f + 1e-6f;
+    }
+    float sum = 0;
+    for (int j = 0; j < 10; j++)
+        sum += acc[j];
+    return sum;
+#endif
+}
+
+static int peak_lanes() {
+#if __AVX__
+    return 8;
+#elif __SSE2__ || __ARM_NEON
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+static double measure_peak_gflops() {
+    const int64_t iters = 20000000;
+    volatile float sink = peak_kernel(iters / 10);
+
+    double best = DBL_MAX;
+    for (int i = 0; i < 3; i++) {
+        double start = otter::get_current_time();
+        sink = peak_kernel(iters);
+        best = std::min(best, otter::get_current_time() - start);
+    }
+    (void)sink;
+
+    const double flops = (double)iters * 10 * peak_lanes() * 2;
+    return flops / (best * 1e6);
+}
+
+static double max_relative_error(const otter::Tensor& result, const otter::Tensor& reference) {
+    otter::Tensor r = result.packing(1).contiguous();
+    otter::Tensor f = reference.contiguous();
+    if (r.numel() != f.numel())
+        return DBL_MAX;
+
+    const float* rp = r.data_ptr<float>();
+    const float* fp = f.data_ptr<float>();
+
+    double max_ref = 0;
+    double max_diff = 0;
+    for (int64_t i = 0; i < f.numel(); i++) {
+        max_ref = std::max(max_ref, (double)fabsf(fp[i]));
+        max_diff = std::max(max_diff, (double)fabsf(rp[i] - fp[i]));
+    }
+    return max_ref > 0 ? max_diff / max_ref : max_diff;
+}
+
+static otter::Tensor reference_conv(const ConvCase& c, const otter::Tensor& input, const otter::Tensor& weight, const otter::Tensor& bias) {
+    const int k = c.kernel;
+    const int pad = k / 2;
+
+    if (c.groups == 1)
+        return otter::slow_conv2d(input, weight, bias, {k, k}, {c.stride, c.stride}, {pad, pad});
+
+    // slow_conv2d has no groups, the depthwise reference is computed channel by channel
+    std::vector<otter::Tensor> outputs;
+    otter::Tensor output;
+    for (int g = 0; g < c.groups; g++) {
+        otter::Tensor out_g = otter::slow_conv2d(
+            input.slice(1, g, g + 1).contiguous(),
+            weight.slice(0, g, g + 1).contiguous(),
+            bias.slice(0, g, g + 1).contiguous(),
+            {k, k}, {c.stride, c.stride}, {pad, pad});
+        if (!output.defined())
+            output = otter::empty({1, c.out_channels, out_g.size(2), out_g.size(3)}, otter::ScalarType::Float);
+        output.slice(1, g, g + 1).copy_(out_g);
+    }
+    return output;
+}
+
+// With unit weight scales and an input scale of 127 the int8 convolution is exactly the
+// float convolution of the quantized input, scaled back and biased.
+static otter::Tensor reference_conv_int8(const ConvCase& c, const otter::Tensor& input, const otter::Tensor& weight, const otter::Tensor& bias) {
+    otter::Tensor input_q = input.clone();
+    float* ptr = input_q.data_ptr<float>();
+    for (int64_t i = 0; i < input_q.numel(); i++)
+        ptr[i] = std::min(std::max(roundf(ptr[i] * 127.f), -127.f), 127.f);
+
+    otter::Tensor zero_bias = otter::zeros({c.out_channels}, otter::ScalarType::Float);
+    otter::Tensor output = reference_conv(c, input_q, weight.to(otter::ScalarType::Float), zero_bias);
+
+    const int64_t plane = output.size(2) * output.size(3);
+    float* outptr = output.data_ptr<float>();
+    const float* bias_ptr = bias.data_ptr<float>();
+    for (int p = 0; p < c.out_channels; p++) {
+        for (int64_t i = 0; i < plane; i++)
+            outptr[p * plane + i] = outptr[p * plane + i] / 127.f + bias_ptr[p];
+    }
+    return output;
+}
+
+static int input_elempack(int channels, bool packing) {
+    if (!packing)
+        return 1;
+#if __AVX__
+    return channels % 8 == 0 ? 8 : channels % 4 == 0 ? 4 : 1;
+#elif __SSE2__ || __ARM_NEON
+    return channels % 4 == 0 ? 4 : 1;
+#else
+    (void)channels;
+    return 1;
+#endif
+}
+
+static int bench_conv(const BenchConfig& config, const ConvCase& c, int packing) {
+    otter::NetOption opt;
+    opt.use_packing_layout = packing != 0;
+
+    otter::ParamDict pd;
+    pd.set((int)otter::ConvParam::In_channels, c.in_channels);
+    pd.set((int)otter::ConvParam::Out_channels, c.out_channels);
+    pd.set((int)otter::ConvParam::Kernel_height, c.kernel);
+    pd.set((int)otter::ConvParam::Kernel_width, c.kernel);
+    pd.set((int)otter::ConvParam::Stride_height, c.stride);
+    pd.set((int)otter::ConvParam::Stride_width, c.stride);
+    pd.set((int)otter::ConvParam::Padding_height, c.kernel / 2);
+    pd.set((int)otter::ConvParam::Padding_width, c.kernel / 2);
+    pd.set((int)otter::ConvParam::Group, c.groups);
+    pd.set((int)otter::ConvParam::Bias_term, 1);
+    pd.set((int)otter::ConvParam::Int8_scale_term, c.int8 ? 1 : 0);
+
+    otter::ConvolutionLayer layer;
+    layer.load_param(pd);
+    layer.init_model();
+    if (c.int8) {
+        const int scales = (c.groups == 1) ? c.out_channels : c.groups;
+        layer.weight_data_int8_scales = otter::full({scales}, 1.f, otter::ScalarType::Float);
+        layer.bottom_blob_int8_scales = otter::full({(c.groups == 1) ? 1 : scales}, 127.f, otter::ScalarType::Float);
+    }
+    layer.create_pipeline(opt);
+
+    otter::Tensor input = otter::rand({1, c.in_channels, c.height, c.width}, otter::ScalarType::Float);
+    otter::Tensor input_packed = input.packing(input_elempack(c.in_channels, packing));
+
+    const char* backend = nullptr;
+    otter::Tensor output;
+    auto run = [&]() {
+        otter::set_profile_backend(nullptr);
+        layer.forward(input_packed, output, opt);
+        backend = otter::get_profile_backend();
+    };
+
+    double error = -1;
+    if (config.verify) {
+        run();
+        otter::Tensor reference = c.int8
+            ? reference_conv_int8(c, input, layer.weight_data, layer.bias_data)
+            : reference_conv(c, input, layer.weight_data, layer.bias_data);
+        error = max_relative_error(output, reference);
+    }
+
+    const int64_t out_elements = output.defined() ? output.numel() * output.elempack() : 0;
+    const double flops = 2.0 * out_elements * (c.in_channels / c.groups) * c.kernel * c.kernel;
+
+    // winograd trades exactness for speed
+    const double tolerance = c.int8 ? 1e-4 : (backend && strstr(backend, "Winograd")) ? 1e-2 : 1e-3;
+    bool failed = false;
+
+    for (int threads : config.threads) {
+        otter::set_num_threads(threads);
+        Timing t = measure(config, run);
+
+        const double gflops = flops / (t.median * 1e6);
+        const double peak = config.peak * threads;
+        failed |= error > tolerance;
+
+        fprintf(stderr, "%-26s  packing = %d  threads = %2d  %4d -> %-4d  min = %8.3f  median = %8.3f  %8.2f GFLOP/s  %5.1f%%  %-28s  %s\n",
+                c.name, packing, threads, (int)input_packed.elempack(), (int)output.elempack(),
+                t.min, t.median, gflops, peak > 0 ? gflops * 100 / peak : 0,
+                backend ? backend : "",
+                error < 0 ? "" : (error > tolerance ? "MISMATCH" : "ok"));
+    }
+    if (failed)
+        fprintf(stderr, "%-26s  max relative error %g exceeds %g\n", c.name, error, tolerance);
+
+    return failed ? 1 : 0;
+}
+
+static int bench_gemm(const BenchConfig& config, const GemmCase& c) {
+    otter::Tensor a = otter::rand({c.k, c.m}, otter::ScalarType::Float);
+    otter::Tensor b = otter::rand({c.n, c.k}, otter::ScalarType::Float);
+    otter::Tensor out = otter::empty({c.n, c.m}, otter::ScalarType::Float);
+
+    const float* ap = a.data_ptr<float>();
+    const float* bp = b.data_ptr<float>();
+    float* cp = out.data_ptr<float>();
+
+    // column major, C(m, n) = A(m, k) * B(k, n)
+    auto run = [&]() {
+        otter::gemm<float>(otter::TransposeType::NoTranspose, otter::TransposeType::NoTranspose,
+                           c.m, c.n, c.k, 1.f, ap, c.m, bp, c.k, 0.f, cp, c.m);
+    };
+
+    double error = -1;
+    if (config.verify) {
+        run();
+        double max_ref = 0, max_diff = 0;
+        for (int s = 0; s < 64; s++) {
+            const int i = (s * 7919) % c.m;
+            const int j = (s * 104729) % c.n;
+            double sum = 0;
+            for (int l = 0; l < c.k; l++)
+                sum += (double)ap[i + l * c.m] * bp[l + j * c.k];
+            max_ref = std::max(max_ref, fabs(sum));
+            max_diff = std::max(max_diff, fabs(sum - cp[i + j * c.m]));
+        }
+        error = max_ref > 0 ? max_diff / max_ref : max_diff;
+    }
+
+    const double flops = 2.0 * c.m * c.n * c.k;
+    const double tolerance = 1e-4;
+
+    for (int threads : config.threads) {
+        otter::set_num_threads(threads);
+        Timing t = measure(config, run);
+
+        const double gflops = flops / (t.median * 1e6);
+        const double peak = config.peak * threads;
+
+        fprintf(stderr, "%-26s  threads = %2d  min = %8.3f  median = %8.3f  %8.2f GFLOP/s  %5.1f%%  %s\n",
+                c.name, threads, t.min, t.median, gflops, peak > 0 ? gflops * 100 / peak : 0,
+                error < 0 ? "" : (error > tolerance ? "MISMATCH" : "ok"));
+    }
+
+    return error > tolerance ? 1 : 0;
+}
+
+static int bench_packing(const BenchConfig& config, const PackingCase& c) {
+    otter::Tensor input = otter::rand({1, c.channels, c.height, c.width}, otter::ScalarType::Float);
+    otter::Tensor src = input.packing(c.elempack);
+    otter::Tensor dst;
+
+    auto run = [&]() {
+        otter::convertPacking(src, dst, c.out_elempack);
+    };
+
+    bool failed = false;
+    if (config.verify) {
+        run();
+        failed = max_relative_error(dst, input) != 0;
+    }
+
+    // every element is read and written once
+    const double bytes = 2.0 * input.numel() * sizeof(float);
+
+    for (int threads : config.threads) {
+        otter::set_num_threads(threads);
+        Timing t = measure(config, run);
+
+        fprintf(stderr, "%-26s  threads = %2d  min = %8.3f  median = %8.3f  %8.2f GB/s  %s\n",
+                c.name, threads, t.min, t.median, bytes / (t.median * 1e6),
+                config.verify ? (failed ? "MISMATCH" : "ok") : "");
+    }
+
+    return failed ? 1 : 0;
+}
+
+static bool next_arg(int argc, const char* argv[], int& i, const char*& value) {
+    if (i + 1 >= argc) {
+        fprintf(stderr, "Missing value for %s\n", argv[i]);
+        return false;
+    }
+    value = argv[++i];
+    return true;
+}
+
+int main(int argc, const char * argv[]) {
+    BenchConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!strcmp(arg, "-f") || !strcmp(arg, "--filter")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.filter = value;
+        } else if (!strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.threads = parse_int_list(value);
+        } else if (!strcmp(arg, "-p") || !strcmp(arg, "--packing")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.packings = parse_int_list(value);
+        } else if (!strcmp(arg, "-l") || !strcmp(arg, "--loops")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.loop_count = std::max(1, atoi(value));
+        } else if (!strcmp(arg, "-w") || !strcmp(arg, "--warmup")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.warmup_count = std::max(0, atoi(value));
+        } else if (!strcmp(arg, "--peak")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.peak = atof(value);
+        } else if (!strcmp(arg, "--no-verify")) {
+            config.verify = false;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (config.threads.empty())
+        config.threads.push_back(otter::get_num_threads());
+    if (config.packings.empty())
+        config.packings = {0, 1};
+    if (config.peak <= 0)
+        config.peak = measure_peak_gflops();
+
+    fprintf(stderr, "single thread peak = %.2f GFLOP/s, times in ms\n", config.peak);
+
+    auto selected = [&](const char* name) {
+        return config.filter.empty() || strstr(name, config.filter.c_str()) != nullptr;
+    };
+
+    int failures = 0;
+    for (const ConvCase& c : conv_cases) {
+        if (!selected(c.name))
+            continue;
+        for (int packing : config.packings)
+            failures += bench_conv(config, c, packing);
+    }
+    for (const GemmCase& c : gemm_cases) {
+        if (selected(c.name))
+            failures += bench_gemm(config, c);
+    }
+    for (const PackingCase& c : packing_cases) {
+        if (selected(c.name))
+            failures += bench_packing(config, c);
+    }
+
+    return failures ? 1 : 0;
+}
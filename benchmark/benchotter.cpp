@@ -4,93 +4,437 @@
 #ifdef _WIN32
 #include <algorithm>
 #include <windows.h> // Sleep()
+#include <psapi.h>   // GetProcessMemoryInfo()
 #else
 #include <unistd.h> // sleep()
+#include <sys/resource.h> // getrusage()
 #endif
 
 #include <float.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <math.h>
 
-static int g_warmup_loop_count = 8;
-static int g_loop_count = 4;
-static bool g_enable_cooling_down = true;
+#include <string>
+#include <vector>
 
-void benchmark(const char* model, const otter::Tensor& _in) {
-    otter::Tensor in = _in;
-    in.fill_(0.01f);
-    
-    otter::Net net;
-    
-#ifdef __EMSCRIPTEN__
-#define MODEL_DIR "/working/"
+struct BenchModel {
+    std::string name;
+    std::vector<int64_t> shape;
+};
+
+struct BenchResult {
+    std::string model;
+    std::vector<int64_t> shape;
+    int threads;
+    int packing;
+    int loops;
+    int warmup;
+    double min;
+    double max;
+    double avg;
+    double p50;
+    double p90;
+    double p99;
+    double throughput;
+    long peak_rss_kb;
+};
+
+struct BenchConfig {
+    std::vector<BenchModel> models;
+    std::string model_dir;
+    std::vector<int> threads;
+    std::vector<int> packings;
+    int loop_count = 16;
+    int min_warmup = 4;
+    int max_warmup = 64;
+    double stable_cv = 0.05;
+    int cooling_down = 0;
+    std::string json_path;
+    std::string baseline_path;
+    double tolerance = 0.05;
+};
+
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  -m, --model NAME[:N,C,H,W]   model file without .otter, repeatable\n");
+    fprintf(stderr, "  -d, --model-dir DIR          directory of the model files\n");
+    fprintf(stderr, "  -t, --threads 1,2,4          thread counts to sweep\n");
+    fprintf(stderr, "  -p, --packing 0,1            use_packing_layout values to sweep\n");
+    fprintf(stderr, "  -l, --loops N                timed runs per configuration (default 16)\n");
+    fprintf(stderr, "  -w, --warmup MIN[,MAX]       warmup runs, continue after MIN until the last MIN runs\n");
+    fprintf(stderr, "                               have a coefficient of variation below --stable (default 4,64)\n");
+    fprintf(stderr, "      --stable CV              warmup stability threshold (default 0.05)\n");
+    fprintf(stderr, "  -c, --cooling-down SECONDS   sleep before every model to cool down the SOC (default 0)\n");
+    fprintf(stderr, "  -j, --json FILE              write the results as JSON\n");
+    fprintf(stderr, "  -b, --baseline FILE          compare the p50 with a previous JSON output\n");
+    fprintf(stderr, "      --tolerance RATIO        allowed p50 slowdown against the baseline (default 0.05)\n");
+}
+
+static std::vector<int64_t> parse_int_list(const char* str) {
+    std::vector<int64_t> values;
+    const char* p = str;
+    while (*p) {
+        char* end;
+        long long v = strtoll(p, &end, 10);
+        if (end == p)
+            break;
+        values.push_back(v);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+static std::string shape_string(const std::vector<int64_t>& shape) {
+    std::string str;
+    for (size_t i = 0; i < shape.size(); i++) {
+        if (i)
+            str += ",";
+        str += std::to_string(shape[i]);
+    }
+    return str;
+}
+
+static long get_peak_rss_kb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return (long)(pmc.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (long)(usage.ru_maxrss / 1024);
 #else
-#define MODEL_DIR ""
+    return (long)usage.ru_maxrss;
 #endif
-    
-    char parampath[256];
-    sprintf(parampath, MODEL_DIR "%s.otter", model);
-    net.load_otter(parampath, otter::CompileMode::Initial);
-    
-    const std::vector<const char*>& input_names = net.input_names();
-    const std::vector<const char*>& output_names = net.output_names();
-    
-    if (g_enable_cooling_down)
-    {
-        // sleep 10 seconds for cooling down SOC  :(
+#endif
+}
+
+static void cooling_down(int seconds) {
+    if (seconds <= 0)
+        return;
 #ifdef _WIN32
-        Sleep(10 * 1000);
+    Sleep(seconds * 1000);
 #elif defined(__unix__) || defined(__APPLE__)
-        sleep(10);
+    sleep(seconds);
 #elif _POSIX_TIMERS
-        struct timespec ts;
-        ts.tv_sec = 10;
-        ts.tv_nsec = 0;
-        nanosleep(&ts, &ts);
+    struct timespec ts;
+    ts.tv_sec = seconds;
+    ts.tv_nsec = 0;
+    nanosleep(&ts, &ts);
 #else
-        // TODO How to handle it ?
+    // TODO How to handle it ?
 #endif
-    }
-    
+}
+
+// nearest rank percentile of sorted times
+static double percentile(const std::vector<double>& sorted, double q) {
+    size_t rank = (size_t)ceil(q * sorted.size());
+    rank = std::max<size_t>(rank, 1);
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+static double coefficient_of_variation(const std::vector<double>& times, size_t window) {
+    if (times.size() < window || window < 2)
+        return DBL_MAX;
+
+    double mean = 0;
+    for (size_t i = times.size() - window; i < times.size(); i++)
+        mean += times[i];
+    mean /= window;
+
+    double var = 0;
+    for (size_t i = times.size() - window; i < times.size(); i++)
+        var += (times[i] - mean) * (times[i] - mean);
+    var /= window - 1;
+
+    return mean > 0 ? sqrt(var) / mean : DBL_MAX;
+}
+
+static double run_once(otter::Net& net, const otter::Tensor& in) {
     otter::Tensor out;
-    
-    for (int i = 0; i < g_warmup_loop_count; i++) {
+
+    double start = otter::get_current_time();
+    {
         auto ex = net.create_extractor();
-        ex.input(input_names[0], in);
-        ex.extract(output_names[0], out, 0);
+        ex.input(net.input_names()[0], in);
+        ex.extract(net.output_names()[0], out, 0);
+    }
+    double end = otter::get_current_time();
+
+    return end - start;
+}
+
+static void benchmark(const BenchConfig& config, const BenchModel& model, int packing, std::vector<BenchResult>& results) {
+    otter::Tensor in = otter::empty(model.shape, otter::ScalarType::Float);
+    in.fill_(0.01f);
+
+    otter::Net net;
+    // the pipeline is created for the packing layout while loading
+    net.option.use_packing_layout = packing != 0;
+
+    std::string path = config.model_dir + model.name + ".otter";
+    net.load_otter(path.c_str(), otter::CompileMode::Initial);
+
+    for (int threads : config.threads) {
+        otter::set_num_threads(threads);
+
+        cooling_down(config.cooling_down);
+
+        std::vector<double> warmup_times;
+        for (int i = 0; i < config.max_warmup; i++) {
+            warmup_times.push_back(run_once(net, in));
+
+            if ((int)warmup_times.size() >= config.min_warmup && coefficient_of_variation(warmup_times, config.min_warmup) < config.stable_cv)
+                break;
+        }
+
+        std::vector<double> times(config.loop_count);
+        for (int i = 0; i < config.loop_count; i++) {
+            times[i] = run_once(net, in);
+        }
+
+        std::vector<double> sorted = times;
+        std::sort(sorted.begin(), sorted.end());
+
+        BenchResult result;
+        result.model = model.name;
+        result.shape = model.shape;
+        result.threads = threads;
+        result.packing = packing;
+        result.loops = config.loop_count;
+        result.warmup = (int)warmup_times.size();
+        result.min = sorted.front();
+        result.max = sorted.back();
+        result.avg = 0;
+        for (double t : times)
+            result.avg += t;
+        result.avg /= times.size();
+        result.p50 = percentile(sorted, 0.5);
+        result.p90 = percentile(sorted, 0.9);
+        result.p99 = percentile(sorted, 0.99);
+        result.throughput = (result.p50 > 0) ? model.shape[0] * 1000.0 / result.p50 : 0;
+        result.peak_rss_kb = get_peak_rss_kb();
+
+        fprintf(stderr, "%36s  threads = %2d  packing = %d  warmup = %2d  min = %7.2f  p50 = %7.2f  p90 = %7.2f  p99 = %7.2f  max = %7.2f  avg = %7.2f  %7.2f/s  rss = %ldKB\n",
+                result.model.c_str(), threads, packing, result.warmup,
+                result.min, result.p50, result.p90, result.p99, result.max, result.avg,
+                result.throughput, result.peak_rss_kb);
+
+        results.push_back(result);
+    }
+}
+
+static int save_json(const char* path, const std::vector<BenchResult>& results) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) {
+        fprintf(stderr, "Open %s fail!\n", path);
+        return -1;
+    }
+
+    // one result per line, so that the baseline can be read back without a json parser
+    fprintf(fp, "{\"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(fp, "  {\"model\": \"%s\", \"shape\": \"%s\", \"threads\": %d, \"packing\": %d, \"loops\": %d, \"warmup\": %d, "
+                    "\"min\": %.4f, \"max\": %.4f, \"avg\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, "
+                    "\"throughput\": %.4f, \"peak_rss_kb\": %ld}%s\n",
+                r.model.c_str(), shape_string(r.shape).c_str(), r.threads, r.packing, r.loops, r.warmup,
+                r.min, r.max, r.avg, r.p50, r.p90, r.p99, r.throughput, r.peak_rss_kb,
+                (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(fp, "]}\n");
+
+    fclose(fp);
+
+    return 0;
+}
+
+static bool find_string(const char* line, const char* key, std::string& value) {
+    std::string pattern = std::string("\"") + key + "\": \"";
+    const char* p = strstr(line, pattern.c_str());
+    if (!p)
+        return false;
+    p += pattern.size();
+    const char* end = strchr(p, '"');
+    if (!end)
+        return false;
+    value.assign(p, end);
+    return true;
+}
+
+static bool find_number(const char* line, const char* key, double& value) {
+    std::string pattern = std::string("\"") + key + "\": ";
+    const char* p = strstr(line, pattern.c_str());
+    if (!p)
+        return false;
+    value = strtod(p + pattern.size(), nullptr);
+    return true;
+}
+
+// Return the number of configurations slower than the baseline by more than the tolerance.
+static int compare_baseline(const char* path, const std::vector<BenchResult>& results, double tolerance) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        fprintf(stderr, "Open baseline %s fail!\n", path);
+        return -1;
     }
 
-    double time_min = DBL_MAX;
-    double time_max = -DBL_MAX;
-    double time_avg = 0;
-    
-    for (int i = 0; i < g_loop_count; i++) {
-        double start = otter::get_current_time();
-        {
-            auto ex = net.create_extractor();
-            ex.input(input_names[0], in);
-            ex.extract(output_names[0], out, 0);
+    int regressions = 0;
+    char line[1024];
+    while (fgets(line, sizeof(line), fp)) {
+        std::string model, shape;
+        double threads, packing, p50;
+        if (!find_string(line, "model", model) || !find_string(line, "shape", shape) ||
+            !find_number(line, "threads", threads) || !find_number(line, "packing", packing) || !find_number(line, "p50", p50))
+            continue;
+
+        for (const BenchResult& r : results) {
+            if (r.model != model || shape_string(r.shape) != shape || r.threads != (int)threads || r.packing != (int)packing)
+                continue;
+
+            double ratio = (p50 > 0) ? r.p50 / p50 : 1;
+            bool regressed = ratio > 1 + tolerance;
+            regressions += regressed;
+
+            fprintf(stderr, "%36s  threads = %2d  packing = %d  p50 = %7.2f  baseline = %7.2f  %+6.1f%%%s\n",
+                    r.model.c_str(), r.threads, r.packing, r.p50, p50, (ratio - 1) * 100, regressed ? "  REGRESSION" : "");
         }
-        double end = otter::get_current_time();
-        double time = end - start;
-        time_min = std::min(time_min, time);
-        time_max = std::max(time_max, time);
-        time_avg += time;
     }
-    time_avg /= g_loop_count;
-    fprintf(stderr, "%25s  min = %7.2f  max = %7.2f  avg = %7.2f\n", model, time_min, time_max, time_avg);
+
+    fclose(fp);
+
+    return regressions;
+}
+
+static bool next_arg(int argc, const char* argv[], int& i, const char*& value) {
+    if (i + 1 >= argc) {
+        fprintf(stderr, "Missing value for %s\n", argv[i]);
+        return false;
+    }
+    value = argv[++i];
+    return true;
 }
 
 int main(int argc, const char * argv[]) {
-    
-    benchmark("nanodet-plus-m-1.5x_416_fused", otter::empty({1, 3, 416, 416}, otter::ScalarType::Float));
-    
-    benchmark("nanodet-plus-m-1.5x_416_int8_fused", otter::empty({1, 3, 416, 416}, otter::ScalarType::Float));
-    
-    benchmark("nanodet-plus-m-1.5x_416_int8_mixed", otter::empty({1, 3, 416, 416}, otter::ScalarType::Float));
-    
-    benchmark("simplepose_fused", otter::empty({1, 3, 256, 192}, otter::ScalarType::Float));
-    
+    BenchConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = nullptr;
+
+        if (!strcmp(arg, "-h") || !strcmp(arg, "--help")) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!strcmp(arg, "-m") || !strcmp(arg, "--model")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            BenchModel model;
+            const char* colon = strchr(value, ':');
+            if (colon) {
+                model.name.assign(value, colon);
+                model.shape = parse_int_list(colon + 1);
+            } else {
+                model.name = value;
+            }
+            config.models.push_back(model);
+        } else if (!strcmp(arg, "-d") || !strcmp(arg, "--model-dir")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.model_dir = value;
+            if (!config.model_dir.empty() && config.model_dir.back() != '/')
+                config.model_dir += "/";
+        } else if (!strcmp(arg, "-t") || !strcmp(arg, "--threads")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            for (int64_t t : parse_int_list(value))
+                config.threads.push_back((int)t);
+        } else if (!strcmp(arg, "-p") || !strcmp(arg, "--packing")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            for (int64_t p : parse_int_list(value))
+                config.packings.push_back(p != 0);
+        } else if (!strcmp(arg, "-l") || !strcmp(arg, "--loops")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.loop_count = std::max(1, atoi(value));
+        } else if (!strcmp(arg, "-w") || !strcmp(arg, "--warmup")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            std::vector<int64_t> warmup = parse_int_list(value);
+            if (!warmup.empty())
+                config.min_warmup = (int)warmup[0];
+            config.max_warmup = (warmup.size() > 1) ? (int)warmup[1] : std::max(config.max_warmup, config.min_warmup);
+        } else if (!strcmp(arg, "--stable")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.stable_cv = atof(value);
+        } else if (!strcmp(arg, "-c") || !strcmp(arg, "--cooling-down")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.cooling_down = atoi(value);
+        } else if (!strcmp(arg, "-j") || !strcmp(arg, "--json")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.json_path = value;
+        } else if (!strcmp(arg, "-b") || !strcmp(arg, "--baseline")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.baseline_path = value;
+        } else if (!strcmp(arg, "--tolerance")) {
+            if (!next_arg(argc, argv, i, value))
+                return -1;
+            config.tolerance = atof(value);
+        } else {
+            fprintf(stderr, "Unknown option %s\n", arg);
+            print_usage(argv[0]);
+            return -1;
+        }
+    }
+
+#ifdef __EMSCRIPTEN__
+    if (config.model_dir.empty())
+        config.model_dir = "/working/";
+#endif
+
+    if (config.models.empty()) {
+        config.models.push_back({"nanodet-plus-m-1.5x_416_fused", {1, 3, 416, 416}});
+        config.models.push_back({"nanodet-plus-m-1.5x_416_int8_fused", {1, 3, 416, 416}});
+        config.models.push_back({"nanodet-plus-m-1.5x_416_int8_mixed", {1, 3, 416, 416}});
+        config.models.push_back({"simplepose_fused", {1, 3, 256, 192}});
+    }
+    for (const BenchModel& model : config.models) {
+        if (model.shape.empty()) {
+            fprintf(stderr, "Missing input shape for %s, use --model %s:N,C,H,W\n", model.name.c_str(), model.name.c_str());
+            return -1;
+        }
+    }
+    if (config.threads.empty())
+        config.threads.push_back(otter::get_num_threads());
+    if (config.packings.empty())
+        config.packings.push_back(1);
+    config.min_warmup = std::max(1, config.min_warmup);
+    config.max_warmup = std::max(config.min_warmup, config.max_warmup);
+
+    std::vector<BenchResult> results;
+    for (const BenchModel& model : config.models) {
+        for (int packing : config.packings) {
+            benchmark(config, model, packing, results);
+        }
+    }
+
+    if (!config.json_path.empty() && save_json(config.json_path.c_str(), results) != 0)
+        return -1;
+
+    if (!config.baseline_path.empty()) {
+        int regressions = compare_baseline(config.baseline_path.c_str(), results, config.tolerance);
+        if (regressions != 0)
+            return 1;
+    }
+
     return 0;
 }
-
@@ -1,3 +1,27 @@
 from .otter import *
 
+import os
+from concurrent.futures import ThreadPoolExecutor
+
 __version__ = otter.__version__
+
+_async_executor = None
+
+def set_async_workers(workers):
+    """Set the number of threads serving Extractor.extract_async."""
+    global _async_executor
+    if _async_executor is not None:
+        _async_executor.shutdown(wait=True)
+    _async_executor = ThreadPoolExecutor(max_workers=workers)
+
+def _extract_async(self, input_name, type=0):
+    """Run extract on a worker thread and return a concurrent.futures.Future of (ret, feat).
+
+    extract releases the GIL, use one extractor per concurrent request.
+    """
+    global _async_executor
+    if _async_executor is None:
+        _async_executor = ThreadPoolExecutor(max_workers=os.cpu_count())
+    return _async_executor.submit(self.extract, input_name, type)
+
+Extractor.extract_async = _extract_async
@@ -22,6 +22,8 @@
 #include <Formatting.hpp>
 #include <Parallel.hpp>
 #include <Net.hpp>
+#include <CPUSizeClassAllocator.hpp>
+#include <CpuSet.hpp>
 
 #include "tensor_str.hpp"
 
@@ -29,6 +31,45 @@ namespace py = pybind11;
 
 using namespace otter;
 
+// The subset of the DLPack ABI (https://github.com/dmlc/dlpack) needed to exchange CPU tensors.
+enum DLDeviceType : int32_t {
+    kDLCPU = 1
+};
+
+enum DLDataTypeCode : uint8_t {
+    kDLInt = 0,
+    kDLUInt = 1,
+    kDLFloat = 2,
+    kDLBool = 6
+};
+
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides;
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(DLManagedTensor* self);
+};
+
 template <typename T>
 std::vector<T> tuple_to_vector(py::tuple tuple);
 
@@ -36,6 +77,12 @@ template <typename T, typename U>
 std::vector<T> convert_vector_dtype(std::vector<U>& vector);
 
 std::string get_tensor_format(const Tensor& t);
+std::string get_tensor_typestr(const Tensor& t);
+void check_unpacked(const Tensor& t, const char* name);
+
+Tensor tensor_from_buffer(const py::buffer& b, bool copy);
+py::capsule tensor_to_dlpack(const Tensor& t);
+Tensor tensor_from_dlpack(const py::object& obj);
 
 Tensor tensor_index(const Tensor& tensor, const py::tuple& tuple);
 Tensor tensor_index(const Tensor& tensor, int64_t dim);
@@ -108,6 +155,39 @@ PYBIND11_MODULE(otter, m) {
             strides         /* Strides (in bytes) for each index */
         );
     })
+    .def_property_readonly("__array_interface__", [](const Tensor& t) {
+        check_unpacked(t, "__array_interface__");
+        
+        py::dict interface;
+        interface["version"] = 3;
+        interface["typestr"] = get_tensor_typestr(t);
+        interface["shape"] = py::tuple(py::cast(t.sizes().vec()));
+        std::vector<int64_t> strides = t.strides().vec();
+        for (auto& stride : strides)
+            stride *= t.itemsize();
+        interface["strides"] = py::tuple(py::cast(strides));
+        interface["data"] = py::make_tuple(reinterpret_cast<uintptr_t>(t.raw_data()), false);
+        
+        return interface;
+    })
+    .def("numpy", [](py::object self) {
+        const Tensor& t = self.cast<const Tensor&>();
+        check_unpacked(t, "numpy");
+        
+        std::vector<py::ssize_t> shape(t.sizes().begin(), t.sizes().end());
+        std::vector<py::ssize_t> strides(t.strides().begin(), t.strides().end());
+        for (auto& stride : strides)
+            stride *= t.itemsize();
+        
+        // the array keeps the tensor alive and shares its memory
+        return py::array(py::dtype(get_tensor_format(t)), shape, strides, t.raw_data(), self);
+    }, "Share the memory with a numpy.ndarray")
+    .def("__dlpack__", [](const Tensor& t, py::args, py::kwargs) {
+        return tensor_to_dlpack(t);
+    })
+    .def("__dlpack_device__", [](const Tensor&) {
+        return py::make_tuple((int)kDLCPU, 0);
+    })
     .def("is_floating_point", &Tensor::is_floating_point, "Check the data type is floating type or not")
     .def("is_signed", &Tensor::is_signed, "Check the data type is singed type or not")
     .def("defined", &Tensor::defined, "Check the tensor is defined or not")
@@ -519,43 +599,25 @@ PYBIND11_MODULE(otter, m) {
         return self.bmm(other);
     });
     
-    m.def("tensor", [](py::buffer const b) {
-        py::buffer_info info = b.request();
-        
-        auto tensor_shape = convert_vector_dtype<int64_t>(info.shape);
-        auto tensor_strides = convert_vector_dtype<int64_t>(info.strides);
-        
-        ScalarType dtype = ScalarType::Undefined;
-        
-        if (info.format == py::format_descriptor<double>::format()) {
-            dtype = ScalarType::Double;
-        } else if (info.format == py::format_descriptor<float>::format()) {
-            dtype = ScalarType::Float;
-        } else if (info.format == py::format_descriptor<int>::format()) {
-            dtype = ScalarType::Int;
-        } else if (info.format == "l") {
-            dtype = ScalarType::Long;
-        } else if (info.format == "e") {
-            dtype = ScalarType::HFloat;
-        } else if (info.format == py::format_descriptor<int8_t>::format()) {
-            dtype = ScalarType::Char;
-        } else if (info.format == py::format_descriptor<uint8_t>::format()) {
-            dtype = ScalarType::Byte;
-        } else if (info.format == "?") {
-            dtype = ScalarType::Bool;
-        } else {
-            std::stringstream ss;
-            ss << "convert numpy.ndarray to otter.Tensor dtype fail get " << info.format;
-            pybind11::pybind11_fail(ss.str());
-        }
-        
-        TypeMeta meta = TypeMeta::fromScalarType(dtype);
-        int64_t itemsize = meta.itemsize();
-        std::transform(tensor_strides.begin(), tensor_strides.end(), tensor_strides.begin(),
-                       [&itemsize](auto& c) { return c / itemsize; });
-        
-        return from_blob(info.ptr, tensor_shape, tensor_strides, dtype);
+    py::class_<CPUAllocatorStats>(m, "CPUAllocatorStats")
+    .def_readonly("bytes_in_use", &CPUAllocatorStats::bytes_in_use)
+    .def_readonly("bytes_cached", &CPUAllocatorStats::bytes_cached)
+    .def_readonly("peak_bytes_in_use", &CPUAllocatorStats::peak_bytes_in_use)
+    .def_readonly("allocations", &CPUAllocatorStats::allocations)
+    .def_readonly("cache_hits", &CPUAllocatorStats::cache_hits)
+    .def_property_readonly("hit_rate", &CPUAllocatorStats::hit_rate);
+    
+    m.def("allocator_stats", &GetCPUAllocatorStats);
+    m.def("reset_allocator_peak_stats", &ResetCPUAllocatorPeakStats);
+    m.def("empty_allocator_cache", &EmptyCPUAllocatorCache);
+    m.def("set_allocator_max_cached_bytes", &SetCPUAllocatorMaxCachedBytes, py::arg("bytes"));
+    m.def("set_allocator_huge_page", &SetCPUAllocatorHugePage, py::arg("enable"));
+    
+    m.def("tensor", &tensor_from_buffer, py::arg("array"), py::arg("copy") = false);
+    m.def("from_numpy", [](py::buffer const b) {
+        return tensor_from_buffer(b, false);
     }, py::arg("array"));
+    m.def("from_dlpack", &tensor_from_dlpack, py::arg("ext_tensor"));
     m.def("tensor", [](std::vector<int>& array) {
         Tensor tensor = otter::from_blob(array.data(), {static_cast<int64_t>(array.size())}, ScalarType::Int).clone();
         
@@ -673,26 +735,80 @@ PYBIND11_MODULE(otter, m) {
     m.def("det", &otter::linalg_det);
     m.def("fft", &otter::fft, py::arg("real"), py::arg("imag") = Tensor());
     
+    py::class_<CpuSet>(m, "CpuSet")
+    .def(py::init<>())
+    .def("enable", &CpuSet::enable, py::arg("cpu"))
+    .def("disable", &CpuSet::disable, py::arg("cpu"))
+    .def("disable_all", &CpuSet::disable_all)
+    .def("is_enabled", &CpuSet::is_enabled, py::arg("cpu"))
+    .def("num_enabled", &CpuSet::num_enabled);
+    
+    py::enum_<CpuPolicy>(m, "CpuPolicy")
+    .value("All", CpuPolicy::All)
+    .value("Fast", CpuPolicy::Fast)
+    .value("Slow", CpuPolicy::Slow);
+    
+    m.def("get_cpu_count", &get_cpu_count);
+    m.def("get_cpu_affinity_mask", &get_cpu_affinity_mask, py::arg("policy"));
+    m.def("set_cpu_thread_affinity", &set_cpu_thread_affinity, py::arg("thread_affinity_mask"));
+    m.def("set_cpu_policy", &set_cpu_policy, py::arg("policy"));
+    
     py::class_<NetOption>(m, "NetOption")
     .def(py::init<>())
     .def_readwrite("lightmode", &NetOption::lightmode)
     .def_readwrite("openmp_blocktime", &NetOption::openmp_blocktime)
+    .def_readwrite("cpu_affinity", &NetOption::cpu_affinity)
     .def_readwrite("use_fp16_storage", &NetOption::use_fp16_storage)
     .def_readwrite("use_packing_layout", &NetOption::use_packing_layout)
     .def_readwrite("use_non_lib_optimize", &NetOption::use_non_lib_optimize);
     
+    py::class_<BlobHandle>(m, "BlobHandle")
+    .def(py::init<>())
+    .def_readonly("index", &BlobHandle::index)
+    .def("valid", &BlobHandle::valid);
+    
     py::class_<Extractor>(m, "Extractor")
     .def("__enter__", [](Extractor& ex) -> Extractor& { return ex; })
     .def("__exit__", [](Extractor& ex, pybind11::args) {
         ex.clear();
     })
     .def("input", (int (Extractor::*)(std::string, const Tensor&)) &Extractor::input, py::arg("input_name"), py::arg("in"))
-    .def("extract", (int (Extractor::*)(std::string, Tensor&, int)) &Extractor::extract, py::arg("input_name"), py::arg("feat"), py::arg("type") = 0)
+    .def("extract", (int (Extractor::*)(std::string, Tensor&, int)) &Extractor::extract, py::arg("input_name"), py::arg("feat"), py::arg("type") = 0, py::call_guard<py::gil_scoped_release>())
+    .def("input", (int (Extractor::*)(BlobHandle, const Tensor&)) &Extractor::input, py::arg("blob"), py::arg("in"))
+    .def("extract", [](Extractor& ex, BlobHandle blob, int type) {
+        otter::Tensor feat;
+        int ret = 0;
+        {
+            py::gil_scoped_release release;
+            ret = ex.extract(blob, feat, type);
+            feat = feat.clone();
+        }
+        return py::make_tuple(ret, feat);
+    }, py::arg("blob"), py::arg("type") = 0)
+    .def("extract", [](Extractor& ex, std::vector<BlobHandle> blobs, int type) {
+        std::vector<otter::Tensor> feats;
+        int ret = 0;
+        {
+            // every output in one run of the graph
+            py::gil_scoped_release release;
+            ret = ex.extract(blobs, feats, type);
+            for (auto& feat : feats)
+                feat = feat.clone();
+        }
+        return py::make_tuple(ret, feats);
+    }, py::arg("blobs"), py::arg("type") = 0)
     .def("extract", [](Extractor& ex, std::string input_name, int type) {
         otter::Tensor feat;
-        int ret = ex.extract(input_name, feat, type);
-        return py::make_tuple(ret, feat.clone());
+        int ret = 0;
+        {
+            // other python threads keep running during the inference
+            py::gil_scoped_release release;
+            ret = ex.extract(input_name, feat, type);
+            feat = feat.clone();
+        }
+        return py::make_tuple(ret, feat);
     }, py::arg("input_name"), py::arg("type") = 0)
+    .def("set_cpu_affinity", &Extractor::set_cpu_affinity, py::arg("thread_affinity_mask"))
     .def("clear", &Extractor::clear);
     
     py::enum_<otter::CompileMode>(m, "CompileMode")
@@ -711,8 +827,11 @@ PYBIND11_MODULE(otter, m) {
 //    .def("__exit__", [](Net& net, pybind11::args) {
 //        net.clear();
 //    })
-    .def("load_otter", (int (Net::*)(const char*, CompileMode)) &Net::load_otter, py::arg("model_structure"), py::arg("compile_mode"))
-    .def("load_weight", (int (Net::*)(const char*, otter::Net::WeightType)) &Net::load_weight, py::arg("modelpath"), py::arg("type"))
+    .def("load_otter", (int (Net::*)(const char*, CompileMode)) &Net::load_otter, py::arg("model_structure"), py::arg("compile_mode"), py::call_guard<py::gil_scoped_release>())
+    .def("save_graph", &Net::save_graph, py::arg("graph_path"))
+    .def("load_graph", (int (Net::*)(const char*, CompileMode)) &Net::load_graph, py::arg("graph_path"), py::arg("compile_mode") = CompileMode::Initial, py::call_guard<py::gil_scoped_release>())
+    .def("load_weight", (int (Net::*)(const char*, otter::Net::WeightType)) &Net::load_weight, py::arg("modelpath"), py::arg("type"), py::call_guard<py::gil_scoped_release>())
+    .def("blob_handle", &Net::blob_handle, py::arg("name"))
     .def("summary", &Net::summary)
     .def("create_extractor", &Net::create_extractor, py::keep_alive<0, 1>());
     
@@ -929,3 +1048,210 @@ std::string get_tensor_format(const Tensor& t) {
     
     return "f";
 }
+
+std::string get_tensor_typestr(const Tensor& t) {
+    ScalarType dtype = t.scalar_type();
+    
+    if (dtype == ScalarType::Byte) {
+        return "|u1";
+    } else if (dtype == ScalarType::Char) {
+        return "|i1";
+    } else if (dtype == ScalarType::Bool) {
+        return "|b1";
+    } else if (dtype == ScalarType::Short) {
+        return "<i2";
+    } else if (dtype == ScalarType::Int) {
+        return "<i4";
+    } else if (dtype == ScalarType::Long) {
+        return "<i8";
+    } else if (dtype == ScalarType::HFloat) {
+        return "<f2";
+    } else if (dtype == ScalarType::Double) {
+        return "<f8";
+    }
+    
+    return "<f4";
+}
+
+void check_unpacked(const Tensor& t, const char* name) {
+    if (t.elempack() != 1) {
+        std::stringstream ss;
+        ss << name << " expects an unpacked tensor, call packing(1) first";
+        throw py::value_error(ss.str());
+    }
+}
+
+static ScalarType scalar_type_from_format(const std::string& format) {
+    if (format == py::format_descriptor<double>::format()) {
+        return ScalarType::Double;
+    } else if (format == py::format_descriptor<float>::format()) {
+        return ScalarType::Float;
+    } else if (format == py::format_descriptor<int>::format()) {
+        return ScalarType::Int;
+    } else if (format == "l" || format == "q") {
+        return ScalarType::Long;
+    } else if (format == py::format_descriptor<int16_t>::format()) {
+        return ScalarType::Short;
+    } else if (format == "e") {
+        return ScalarType::HFloat;
+    } else if (format == py::format_descriptor<int8_t>::format()) {
+        return ScalarType::Char;
+    } else if (format == py::format_descriptor<uint8_t>::format()) {
+        return ScalarType::Byte;
+    } else if (format == "?") {
+        return ScalarType::Bool;
+    }
+    
+    std::stringstream ss;
+    ss << "convert numpy.ndarray to otter.Tensor dtype fail get " << format;
+    pybind11::pybind11_fail(ss.str());
+}
+
+Tensor tensor_from_buffer(const py::buffer& b, bool copy) {
+    // the view holds a reference to the exporter, it is released with the last tensor using the memory
+    py::buffer_info* info = new py::buffer_info(b.request());
+    
+    ScalarType dtype;
+    try {
+        dtype = scalar_type_from_format(info->format);
+    } catch (...) {
+        delete info;
+        throw;
+    }
+    
+    auto tensor_shape = convert_vector_dtype<int64_t>(info->shape);
+    auto tensor_strides = convert_vector_dtype<int64_t>(info->strides);
+    
+    int64_t itemsize = info->itemsize;
+    std::transform(tensor_strides.begin(), tensor_strides.end(), tensor_strides.begin(),
+                   [&itemsize](auto& c) { return c / itemsize; });
+    
+    Tensor tensor = from_blob(info->ptr, tensor_shape, tensor_strides, [info](void*) {
+        py::gil_scoped_acquire acquire;
+        delete info;
+    }, dtype);
+    
+    return copy ? tensor.clone() : tensor;
+}
+
+struct DLPackContext {
+    Tensor tensor;
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+    DLManagedTensor managed;
+};
+
+static DLDataType dlpack_dtype(ScalarType dtype) {
+    switch (dtype) {
+        case ScalarType::Byte:      return {kDLUInt, 8, 1};
+        case ScalarType::Char:      return {kDLInt, 8, 1};
+        case ScalarType::Short:     return {kDLInt, 16, 1};
+        case ScalarType::Int:       return {kDLInt, 32, 1};
+        case ScalarType::Long:      return {kDLInt, 64, 1};
+        case ScalarType::HFloat:    return {kDLFloat, 16, 1};
+        case ScalarType::Float:     return {kDLFloat, 32, 1};
+        case ScalarType::Double:    return {kDLFloat, 64, 1};
+        case ScalarType::Bool:      return {kDLBool, 8, 1};
+        default:
+            break;
+    }
+    throw py::type_error("the tensor dtype has no DLPack equivalent");
+}
+
+static ScalarType scalar_type_from_dlpack(DLDataType dtype) {
+    if (dtype.lanes == 1) {
+        if (dtype.code == kDLUInt && dtype.bits == 8) return ScalarType::Byte;
+        if (dtype.code == kDLInt && dtype.bits == 8) return ScalarType::Char;
+        if (dtype.code == kDLInt && dtype.bits == 16) return ScalarType::Short;
+        if (dtype.code == kDLInt && dtype.bits == 32) return ScalarType::Int;
+        if (dtype.code == kDLInt && dtype.bits == 64) return ScalarType::Long;
+        if (dtype.code == kDLFloat && dtype.bits == 16) return ScalarType::HFloat;
+        if (dtype.code == kDLFloat && dtype.bits == 32) return ScalarType::Float;
+        if (dtype.code == kDLFloat && dtype.bits == 64) return ScalarType::Double;
+        if (dtype.code == kDLBool && dtype.bits == 8) return ScalarType::Bool;
+    }
+    throw py::type_error("unsupported DLPack dtype");
+}
+
+py::capsule tensor_to_dlpack(const Tensor& t) {
+    check_unpacked(t, "__dlpack__");
+    
+    DLPackContext* ctx = new DLPackContext;
+    ctx->tensor = t;
+    ctx->shape = t.sizes().vec();
+    ctx->strides = t.strides().vec();
+    
+    DLTensor& dl = ctx->managed.dl_tensor;
+    dl.data = t.raw_data();
+    dl.device = {kDLCPU, 0};
+    dl.ndim = static_cast<int32_t>(t.dim());
+    try {
+        dl.dtype = dlpack_dtype(t.scalar_type());
+    } catch (...) {
+        delete ctx;
+        throw;
+    }
+    dl.shape = ctx->shape.data();
+    dl.strides = ctx->strides.data();
+    dl.byte_offset = 0;
+    
+    ctx->managed.manager_ctx = ctx;
+    ctx->managed.deleter = [](DLManagedTensor* self) {
+        delete static_cast<DLPackContext*>(self->manager_ctx);
+    };
+    
+    // a consumer renames the capsule to "used_dltensor" and becomes responsible for the deleter
+    PyObject* capsule = PyCapsule_New(&ctx->managed, "dltensor", [](PyObject* capsule) {
+        if (PyCapsule_IsValid(capsule, "dltensor")) {
+            DLManagedTensor* managed = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+            if (managed && managed->deleter)
+                managed->deleter(managed);
+        }
+    });
+    if (!capsule) {
+        delete ctx;
+        throw py::error_already_set();
+    }
+    
+    return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+Tensor tensor_from_dlpack(const py::object& obj) {
+    py::object capsule_obj = py::hasattr(obj, "__dlpack__") ? obj.attr("__dlpack__")() : obj;
+    PyObject* capsule = capsule_obj.ptr();
+    
+    if (!PyCapsule_IsValid(capsule, "dltensor"))
+        throw py::value_error("from_dlpack expects an unused DLPack capsule or an object implementing __dlpack__");
+    
+    DLManagedTensor* managed = static_cast<DLManagedTensor*>(PyCapsule_GetPointer(capsule, "dltensor"));
+    const DLTensor& dl = managed->dl_tensor;
+    
+    if (dl.device.device_type != kDLCPU)
+        throw py::value_error("from_dlpack only supports CPU tensors");
+    
+    ScalarType dtype = scalar_type_from_dlpack(dl.dtype);
+    
+    std::vector<int64_t> shape(dl.shape, dl.shape + dl.ndim);
+    std::vector<int64_t> strides(dl.ndim);
+    if (dl.strides) {
+        strides.assign(dl.strides, dl.strides + dl.ndim);
+    } else {
+        int64_t stride = 1;
+        for (int i = dl.ndim - 1; i >= 0; i--) {
+            strides[i] = stride;
+            stride *= shape[i];
+        }
+    }
+    
+    void* data = static_cast<char*>(dl.data) + dl.byte_offset;
+    
+    Tensor tensor = from_blob(data, shape, strides, [managed](void*) {
+        py::gil_scoped_acquire acquire;
+        if (managed->deleter)
+            managed->deleter(managed);
+    }, dtype);
+    
+    PyCapsule_SetName(capsule, "used_dltensor");
+    
+    return tensor;
+}
@@ -654,3 +654,67 @@ def test_fft():
     fft_abs = np.abs(fft)
     
     assert np.isclose(fft_abs, np.array(mag), atol = 1e-3).all()
+
+def test_zero_copy():
+    array = np.arange(24, dtype = np.float32).reshape(2, 3, 4)
+    tensor = otter.from_numpy(array)
+    array[1, 2, 3] = -1
+    assert np.array(tensor)[1, 2, 3] == -1
+    
+    view = tensor.numpy()
+    view[0, 0, 0] = 42
+    assert array[0, 0, 0] == 42
+    
+    check = np.asarray(tensor)
+    assert check.__array_interface__["data"][0] == array.__array_interface__["data"][0]
+    
+    tensor = otter.tensor(array, copy = True)
+    array[0, 0, 0] = 0
+    assert np.array(tensor)[0, 0, 0] == 42
+
+def test_dlpack():
+    array = np.random.rand(3, 5).astype(np.float32)
+    tensor = otter.from_dlpack(array)
+    assert np.array_equal(np.array(tensor), array)
+    
+    if not hasattr(np, "from_dlpack"):
+        pytest.skip("numpy without dlpack support")
+    
+    check = np.from_dlpack(tensor)
+    assert np.array_equal(check, array)
+    check[0, 0] = 7
+    assert np.array(tensor)[0, 0] == 7
+
+def test_allocator_stats():
+    otter.reset_allocator_peak_stats()
+    tensor = otter.empty((256, 256))
+    stats = otter.allocator_stats()
+    assert stats.bytes_in_use >= 256 * 256 * 4
+    assert stats.peak_bytes_in_use >= stats.bytes_in_use
+    assert 0 <= stats.hit_rate <= 1
+    
+    del tensor
+    cached = otter.allocator_stats().bytes_cached
+    otter.empty_allocator_cache()
+    assert otter.allocator_stats().bytes_cached <= cached
+
+def test_cpu_set():
+    mask = otter.CpuSet()
+    assert mask.num_enabled() == 0
+    mask.enable(0)
+    assert mask.is_enabled(0) and mask.num_enabled() == 1
+    mask.disable(0)
+    assert mask.num_enabled() == 0
+    assert otter.set_cpu_thread_affinity(mask) == -1
+    
+    assert otter.get_cpu_count() >= 1
+    for policy in (otter.CpuPolicy.All, otter.CpuPolicy.Fast, otter.CpuPolicy.Slow):
+        assert otter.get_cpu_affinity_mask(policy).num_enabled() >= 1
+    
+    option = otter.NetOption()
+    option.cpu_affinity = otter.get_cpu_affinity_mask(otter.CpuPolicy.All)
+    assert option.cpu_affinity.num_enabled() == otter.get_cpu_affinity_mask(otter.CpuPolicy.All).num_enabled()
+
+def test_blob_handle():
+    handle = otter.BlobHandle()
+    assert handle.valid() == False and handle.index == -1
@@ -185,25 +185,34 @@ void ncnn2team(Otter &team, ParamDict &pd, std::string input_name, std::string o
         ADD_TRANSFORM_MAP(output_name, bottom);
         
     } else if (type == "Pooling") {
-        team.setName("MaxPool");
-        int kernel_w = pd.get(1, 0);
-        int kernel_h = pd.get(11, kernel_w);
-        int stride_w = pd.get(2, 1);
-        int stride_h = pd.get(12, stride_w);
-        int pad_left = pd.get(3, 0);
-        int pad_right = pd.get(14, pad_left);
-        int pad_top = pd.get(13, pad_left);
-        int pad_bottom = pd.get(15, pad_top);
-        if (pad_top != pad_bottom || pad_right != pad_left) {
-            printf("Pooling unsupport!\n");
-            exit(-100);
+        int pooling_type = pd.get(0, 0);
+        int global_pooling = pd.get(4, 0);
+        if (global_pooling) {
+            team.setName((pooling_type == 0) ? "GlobalMaxPool" : "GlobalAvgPool");
+        } else {
+            team.setName((pooling_type == 0) ? "MaxPool" : "AvgPool");
+            int kernel_w = pd.get(1, 0);
+            int kernel_h = pd.get(11, kernel_w);
+            int stride_w = pd.get(2, 1);
+            int stride_h = pd.get(12, stride_w);
+            int pad_left = pd.get(3, 0);
+            int pad_right = pd.get(14, pad_left);
+            int pad_top = pd.get(13, pad_left);
+            int pad_bottom = pd.get(15, pad_top);
+            if (pad_top != pad_bottom || pad_right != pad_left) {
+                printf("Pooling unsupport!\n");
+                exit(-100);
+            }
+            ADD_PARAM("kernel_h", kernel_h);
+            ADD_PARAM("kernel_w", kernel_w);
+            ADD_PARAM("stride_h", stride_h);
+            ADD_PARAM("stride_w", stride_w);
+            ADD_PARAM("padding_h", pad_top);
+            ADD_PARAM("padding_w", pad_left);
+            if (pooling_type != 0 && pd.get(6, 0)) {
+                ADD_PARAM("count_include_pad", 1);
+            }
         }
-        ADD_PARAM("kernel_h", kernel_h);
-        ADD_PARAM("kernel_w", kernel_w);
-        ADD_PARAM("stride_h", stride_h);
-        ADD_PARAM("stride_w", stride_w);
-        ADD_PARAM("padding_h", pad_top);
-        ADD_PARAM("padding_w", pad_left);
         
         std::string input = transform_map[input_name];
         std::string output = get_layer_name("pool", pool);